@@ -24,6 +24,11 @@ int main() { __get_cpuid(1, &eax, &ebx, &ecx, &edx); return 0; }
   if (HAVE_CRC_FLAG)
     set(GALERA_CRC32C_COMPILER_FLAG "-msse4.2")
     set(GALERA_CRC32C_X86_64 ON)
+    # carry-less multiplication to combine interleaved CRC streams
+    check_c_compiler_flag(-mpclmul HAVE_CLMUL_FLAG)
+    if (HAVE_CLMUL_FLAG)
+      list(APPEND GALERA_CRC32C_COMPILER_FLAG "-mpclmul")
+    endif()
   endif()
 elseif (${CMAKE_SYSTEM_PROCESSOR} STREQUAL aarch64)
   check_c_compiler_flag(-march=armv8-a+crc HAVE_CRC_FLAG)
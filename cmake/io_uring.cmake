@@ -0,0 +1,21 @@
+#
+# Copyright (C) 2026 Codership Oy <info@codership.com>
+#
+# Check for io_uring kernel interface for gcomm io_uring protonet backend.
+# The backend uses raw system calls, so only kernel headers are needed.
+#
+
+include(CheckCSourceCompiles)
+
+check_c_source_compiles("
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+int main()
+{
+    return __NR_io_uring_enter + IORING_ENTER_EXT_ARG + IORING_OP_RECV;
+}
+" GALERA_HAVE_IO_URING)
+
+if (GALERA_HAVE_IO_URING)
+  add_definitions(-DHAVE_IO_URING)
+endif()
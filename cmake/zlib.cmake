@@ -0,0 +1,14 @@
+#
+# Copyright (C) 2026 Codership Oy <info@codership.com>
+#
+# Check for zlib for IST compression. IST works without compression
+# if zlib is not found.
+#
+
+find_package(ZLIB)
+
+if (ZLIB_FOUND)
+  add_definitions(-DHAVE_ZLIB)
+  include_directories(${ZLIB_INCLUDE_DIRS})
+  set(GALERA_ZLIB_LIBS ${ZLIB_LIBRARIES})
+endif()
@@ -7,6 +7,7 @@
 
 #include "gu_lock.hpp"
 #include "gu_throw.hpp"
+#include "gu_time.h"
 
 #include <map>
 #include <algorithm> // std::for_each
@@ -39,6 +40,14 @@ static std::string const CERT_PARAM_OPTIMISTIC_PA_DEFAULT("yes");
 static std::string const CERT_PARAM_MAX_LENGTH_DEFAULT("16384");
 static std::string const CERT_PARAM_LENGTH_CHECK_DEFAULT("127");
 
+/* Index purge and last committed report interval in committed trxs.
+ * These are local and need not be the same on all nodes. */
+static size_t    const CERT_TRX_COUNT_THRESHOLD_DEFAULT(127);
+static size_t    const CERT_TRX_COUNT_THRESHOLD_MIN    (15);
+static size_t    const CERT_TRX_COUNT_THRESHOLD_MAX    ((1 << 13) - 1);
+/* Desired interval between purges, nanoseconds */
+static long long const CERT_PURGE_INTERVAL             (100000000LL);
+
 void
 galera::Certification::register_params(gu::Config& cnf)
 {
@@ -817,6 +826,7 @@ galera::Certification::do_test(TrxHandle* trx, bool store_keys)
         break;
     case 3:
     case 4:
+    case 5:
         res = do_test_v3to4(trx, store_keys);
         break;
     default:
@@ -850,6 +860,16 @@ galera::Certification::do_test_preordered(TrxHandle* trx)
     assert(trx->new_version());
     assert(trx->preordered());
 
+    /* Older preordered writesets may be of a lower version than negotiated,
+     * but never of a higher one. */
+    if (gu_unlikely(trx->version() > version_))
+    {
+        log_warn << "preordered trx protocol version: " << trx->version()
+                 << " is higher than certification protocol version: "
+                 << version_;
+        return TEST_FAILED;
+    }
+
     /* we don't want to go any further unless the writeset checksum is ok */
     trx->verify_checksum(); // throws
     /* if checksum failed we need to throw ASAP, let the caller catch it,
@@ -914,6 +934,8 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd, gcache::
     key_count_             (0),
     byte_count_            (0),
     trx_count_             (0),
+    trx_count_threshold_   (CERT_TRX_COUNT_THRESHOLD_DEFAULT),
+    last_purge_time_       (gu_time_monotonic()),
 
     max_length_            (max_length(conf)),
     max_length_check_      (length_check(conf)),
@@ -956,6 +978,7 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
     case 2:
     case 3:
     case 4:
+    case 5:
         break;
     default:
         gu_throw_fatal << "certification/trx version "
@@ -1018,6 +1041,27 @@ galera::Certification::test(TrxHandle* trx, bool bval)
 }
 
 
+void galera::Certification::adjust_trx_count_threshold()
+{
+    long long const now(gu_time_monotonic());
+    long long const elapsed(now - last_purge_time_);
+
+    last_purge_time_ = now;
+
+    if (gu_unlikely(elapsed <= 0)) return;
+
+    /* number of trxs committed in CERT_PURGE_INTERVAL at the current rate */
+    double const target(double(trx_count_) * CERT_PURGE_INTERVAL / elapsed);
+
+    /* average with the old value to smooth out short bursts */
+    size_t threshold((trx_count_threshold_ + size_t(target)) / 2);
+
+    threshold = std::max(threshold, CERT_TRX_COUNT_THRESHOLD_MIN);
+    threshold = std::min(threshold, CERT_TRX_COUNT_THRESHOLD_MAX);
+
+    trx_count_threshold_ = threshold;
+}
+
 wsrep_seqno_t galera::Certification::get_safe_to_discard_seqno_() const
 {
     wsrep_seqno_t retval;
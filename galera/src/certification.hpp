@@ -132,17 +132,21 @@ namespace galera
         {
             static unsigned int const KEYS_THRESHOLD (1   << 10); // 1K
             static unsigned int const BYTES_THRESHOLD(128 << 20); // 128M
-            static unsigned int const TRXS_THRESHOLD (127);
 
             /* if either key count, byte count or trx count exceed their
              * threshold, zero up counts and return true. */
             return ((key_count_  > KEYS_THRESHOLD  ||
                      byte_count_ > BYTES_THRESHOLD ||
-                     trx_count_  > TRXS_THRESHOLD)
+                     trx_count_  > trx_count_threshold_)
                      &&
-                     (key_count_ = 0, byte_count_ = 0, trx_count_ = 0, true));
+                     (adjust_trx_count_threshold(),
+                      key_count_ = 0, byte_count_ = 0, trx_count_ = 0, true));
         }
 
+        /* Adjusts trx count threshold to the apply rate, so that purges (and
+         * last committed reports to the group) happen at a steady pace. */
+        void adjust_trx_count_threshold();
+
         class PurgeAndDiscard
         {
         public:
@@ -219,6 +223,8 @@ namespace galera
         size_t        key_count_;
         size_t        byte_count_;
         size_t        trx_count_;
+        size_t        trx_count_threshold_;
+        long long     last_purge_time_;     // monotonic, nanoseconds
 
         /* The only reason those are not static constants is because
          * there might be a need to thange them without recompilation.
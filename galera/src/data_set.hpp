@@ -86,13 +86,14 @@ namespace galera
                     size_t                  reserved_size,
                     const BaseName&         base_name,
                     DataSet::Version        version,
-                    gu::RecordSet::Version  rsv)
+                    gu::RecordSet::Version  rsv,
+                    int const               ws_ver)
             :
             gu::RecordSetOut<DataSet::RecordOut> (
                 reserved,
                 reserved_size,
                 base_name,
-                check_type(version),
+                check_type(version, ws_ver),
                 rsv
                 ),
             version_(version)
@@ -122,12 +123,14 @@ namespace galera
         DataSet::Version const version_;
 
         static gu::RecordSet::CheckType
-        check_type (DataSet::Version ver)
+        check_type (DataSet::Version ver, int const ws_ver)
         {
             switch (ver)
             {
             case DataSet::EMPTY: break; /* Can't create EMPTY DataSetOut */
-            case DataSet::VER1:  return gu::RecordSet::CHECK_MMH128;
+            case DataSet::VER1:
+                return (ws_ver >= 5 ? gu::RecordSet::CHECK_CRC32C3 :
+                                      gu::RecordSet::CHECK_MMH128);
             }
             throw;
         }
@@ -9,17 +9,108 @@
 #include "gu_uri.hpp"
 #include "gu_debug_sync.hpp"
 #include "gu_progress.hpp"
+#include "gu_datetime.hpp"
 
 #include "GCache.hpp"
 #include "galera_common.hpp"
 #include <boost/bind.hpp>
 #include <fstream>
 #include <algorithm>
+#include <deque>
+#include <cstring>
+#include <poll.h>
 
 namespace
 {
     static std::string const CONF_KEEP_KEYS     ("ist.keep_keys");
     static bool        const CONF_KEEP_KEYS_DEFAULT (true);
+    static std::string const CONF_STREAMS       ("ist.streams");
+    static int         const CONF_STREAMS_DEFAULT (1);
+    static std::string const CONF_ZERO_COPY     ("ist.zero_copy");
+    static bool        const CONF_ZERO_COPY_DEFAULT (false);
+    static std::string const CONF_COMPRESSION   ("ist.compression");
+    static int         const CONF_COMPRESSION_DEFAULT (0);
+    static std::string const CONF_RESUME_TIMEOUT("ist.resume_timeout");
+    static std::string const CONF_RESUME_TIMEOUT_DEFAULT ("PT10S");
+    static std::string const CONF_SEND_RATE     ("ist.send_rate");
+    static std::string const CONF_SEND_RATE_TOTAL("ist.send_rate_total");
+    static std::string const CONF_MAX_SENDERS   ("ist.max_senders");
+
+    // how long to wait for the kernel to release zero-copy pages before
+    // GCache buffers are unlocked
+    static int         const ZERO_COPY_WAIT_MS (5000);
+
+    size_t ist_streams(const gu::Config& conf)
+    {
+        int const streams(conf.get(CONF_STREAMS, CONF_STREAMS_DEFAULT));
+        if (streams < 1 || size_t(streams) > galera::ist::max_streams)
+        {
+            gu_throw_error(EINVAL) << "Invalid value for '" << CONF_STREAMS
+                                   << "': " << streams << ", must be in "
+                                   << "range [1, "
+                                   << galera::ist::max_streams << "]";
+        }
+        return streams;
+    }
+
+    // returns compression level, 0 if compression is not used
+    int ist_compression(const gu::Config& conf)
+    {
+        int const level(conf.get(CONF_COMPRESSION, CONF_COMPRESSION_DEFAULT));
+        if (level < 0 || level > 9)
+        {
+            gu_throw_error(EINVAL) << "Invalid value for '" << CONF_COMPRESSION
+                                   << "': " << level << ", must be in "
+                                   << "range [0, 9]";
+        }
+        if (level > 0 && galera::ist::compression_supported() == false)
+        {
+            log_warn << "IST compression is not supported by this build, "
+                     << "ignoring '" << CONF_COMPRESSION << "'";
+            return 0;
+        }
+        return level;
+    }
+
+    // how long transfer may be resumed after connection loss, zero
+    // disables resuming
+    gu::datetime::Period ist_resume_timeout(const gu::Config& conf)
+    {
+        return gu::datetime::Period(conf.get(CONF_RESUME_TIMEOUT,
+                                             CONF_RESUME_TIMEOUT_DEFAULT));
+    }
+
+    // returns non-negative value of key, 0 means unlimited
+    long long ist_limit(const gu::Config& conf, const std::string& key)
+    {
+        long long const val(conf.get<long long>(key, 0));
+        if (val < 0)
+        {
+            gu_throw_error(EINVAL) << "Invalid value for '" << key << "': "
+                                   << val << ", must not be negative";
+        }
+        return val;
+    }
+
+    // returns true if transfer failed with err because the connection
+    // was lost and may be resumed over a new one
+    bool connection_lost(int const err)
+    {
+        switch (err)
+        {
+        case asio::error::eof: // asio misc category, value is preserved
+        case ECONNRESET:
+        case ECONNABORTED:
+        case EPIPE:
+        case ETIMEDOUT:
+        case EHOSTUNREACH:
+        case ENETUNREACH:
+        case ENETDOWN:
+        case ENETRESET:
+            return true;
+        }
+        return false;
+    }
 }
 
 
@@ -37,7 +128,7 @@ namespace galera
                         AsyncSenderMap& asmap,
                         int version)
                 :
-                Sender (conf, asmap.gcache(), peer, version),
+                Sender (conf, asmap.gcache(), peer, version, &asmap.shaper()),
                 conf_  (conf),
                 peer_  (peer),
                 first_ (first),
@@ -67,7 +158,222 @@ namespace galera
             AsyncSender(const AsyncSender&);
             AsyncSender& operator=(const AsyncSender&);
         };
+
+        // Additional connection of multi-stream transfer
+        class Stream
+        {
+        public:
+            Stream(asio::io_service& io_service, asio::ssl::context& ssl_ctx,
+                   bool use_ssl)
+                :
+                ssl_stream_(io_service, ssl_ctx),
+                use_ssl_   (use_ssl)
+            { }
+
+            ~Stream() { close(); }
+
+            asio::ip::tcp::socket& socket()
+            {
+                return ssl_stream_.next_layer();
+            }
+
+            asio::ssl::stream<asio::ip::tcp::socket>& ssl_stream()
+            {
+                return ssl_stream_;
+            }
+
+            bool use_ssl() const { return use_ssl_; }
+
+            // unblocks reads and writes in progress in other threads
+            void shutdown()
+            {
+                asio::error_code ec;
+                socket().shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+            }
+
+            void close()
+            {
+                asio::error_code ec;
+                socket().close(ec);
+            }
+
+        private:
+            Stream(const Stream&);
+            Stream& operator=(const Stream&);
+
+            asio::ssl::stream<asio::ip::tcp::socket> ssl_stream_;
+            bool                                     use_ssl_;
+        };
+
+        // Reads write sets from one stream of multi-stream transfer in
+        // a separate thread so that the receiver can consume them in
+        // seqno order. At most capacity write sets are read ahead.
+        class StreamReader
+        {
+        public:
+            StreamReader(size_t idx)
+                :
+                mutex_  (),
+                cond_   (),
+                queue_  (),
+                thread_ (),
+                idx_    (idx),
+                error_  (0),
+                done_   (false),
+                stopped_(false),
+                started_(false)
+            { }
+
+            virtual ~StreamReader()
+            {
+                for (std::deque<TrxHandle*>::iterator i(queue_.begin());
+                     i != queue_.end(); ++i)
+                {
+                    if (*i != 0) (*i)->unref();
+                }
+            }
+
+            void start();
+            void run();
+
+            // returns next write set of the stream or null at EOF
+            TrxHandle* pop();
+
+            void stop()
+            {
+                gu::Lock lock(mutex_);
+                stopped_ = true;
+                cond_.broadcast();
+            }
+
+            void join()
+            {
+                if (started_ == false) return;
+                int err;
+                if ((err = gu_thread_join(thread_, 0)) != 0)
+                {
+                    log_warn << "Failed to join IST stream reader thread: "
+                             << err;
+                }
+                started_ = false;
+            }
+
+        protected:
+            virtual TrxHandle* recv_trx() = 0;
+
+        private:
+            StreamReader(const StreamReader&);
+            StreamReader& operator=(const StreamReader&);
+
+            static size_t const capacity = 2*stream_chunk;
+
+            gu::Mutex              mutex_;
+            gu::Cond               cond_;
+            std::deque<TrxHandle*> queue_;
+            gu_thread_t            thread_;
+            size_t const           idx_;
+            int                    error_;
+            bool                   done_;
+            bool                   stopped_;
+            bool                   started_;
+        };
+
+        template <class ST>
+        class StreamReaderImpl : public StreamReader
+        {
+        public:
+            StreamReaderImpl(size_t idx, ST& socket, TrxHandle::SlavePool& sp,
+                             int version, bool keep_keys)
+                :
+                StreamReader(idx),
+                socket_     (socket),
+                proto_      (sp, version, keep_keys)
+            { }
+
+        private:
+            TrxHandle* recv_trx() { return proto_.recv_trx(socket_); }
+
+            ST&   socket_;
+            Proto proto_;
+        };
+    }
+}
+
+
+extern "C" void* run_ist_stream_reader(void* arg)
+{
+    static_cast<galera::ist::StreamReader*>(arg)->run();
+    return 0;
+}
+
+void galera::ist::StreamReader::start()
+{
+    int err;
+    if ((err = gu_thread_create(&thread_, 0, &run_ist_stream_reader, this)))
+    {
+        gu_throw_error(err) << "Unable to create IST stream reader thread";
+    }
+    started_ = true;
+}
+
+void galera::ist::StreamReader::run()
+{
+    int err(0);
+    try
+    {
+        while (true)
+        {
+            TrxHandle* const trx(recv_trx());
+
+            gu::Lock lock(mutex_);
+            while (queue_.size() >= capacity && stopped_ == false)
+            {
+                lock.wait(cond_);
+            }
+            if (stopped_)
+            {
+                if (trx != 0) trx->unref();
+                break;
+            }
+            queue_.push_back(trx);
+            cond_.signal();
+            if (trx == 0) break;
+        }
+    }
+    catch (asio::system_error& e)
+    {
+        err = e.code().value();
+    }
+    catch (gu::Exception& e)
+    {
+        err = e.get_errno();
+    }
+
+    gu::Lock lock(mutex_);
+    error_ = err;
+    done_  = true;
+    cond_.signal();
+}
+
+galera::TrxHandle* galera::ist::StreamReader::pop()
+{
+    gu::Lock lock(mutex_);
+    while (queue_.empty() && done_ == false)
+    {
+        lock.wait(cond_);
+    }
+    if (queue_.empty() == false)
+    {
+        TrxHandle* const trx(queue_.front());
+        queue_.pop_front();
+        cond_.signal();
+        return trx;
+    }
+    if (error_ != 0)
+    {
+        gu_throw_error(error_) << "failed to read IST stream " << idx_;
     }
+    return 0;
 }
 
 
@@ -82,6 +388,13 @@ galera::ist::register_params(gu::Config& conf)
     conf.add(Receiver::RECV_ADDR);
     conf.add(Receiver::RECV_BIND);
     conf.add(CONF_KEEP_KEYS);
+    conf.add(CONF_STREAMS, gu::to_string(CONF_STREAMS_DEFAULT));
+    conf.add(CONF_ZERO_COPY, gu::to_string(CONF_ZERO_COPY_DEFAULT));
+    conf.add(CONF_COMPRESSION, gu::to_string(CONF_COMPRESSION_DEFAULT));
+    conf.add(CONF_RESUME_TIMEOUT, CONF_RESUME_TIMEOUT_DEFAULT);
+    conf.add(CONF_SEND_RATE, "0");
+    conf.add(CONF_SEND_RATE_TOTAL, "0");
+    conf.add(CONF_MAX_SENDERS, "0");
 }
 
 galera::ist::Receiver::Receiver(gu::Config&           conf,
@@ -100,7 +413,10 @@ galera::ist::Receiver::Receiver(gu::Config&           conf,
     mutex_        (),
     cond_         (),
 #endif /* HAVE_PSI_INTERFACE */
-    consumers_    (),
+    queue_        (),
+    queue_bytes_  (0),
+    consumers_waiting_(0),
+    reader_waiting_(false),
     current_seqno_(-1),
     first_seqno_  (-1),
     last_seqno_   (-1),
@@ -377,9 +693,82 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
 
 
 void galera::ist::Receiver::run()
+{
+    gu::datetime::Period const resume_timeout(ist_resume_timeout(conf_));
+    bool const resumable(resume_timeout.get_nsecs() > 0);
+    int ec(0);
+
+    for (bool resume(false); ; resume = true)
+    {
+        ec = transfer(resume, resumable);
+
+        if (connection_lost(ec) == false || resumable == false ||
+            current_seqno_ > last_seqno_)
+        {
+            break;
+        }
+
+        log_warn << "IST connection lost before seqno " << current_seqno_
+                 << ", waiting " << resume_timeout << " for sender to resume";
+
+        if (wait_resume(resume_timeout) == false)
+        {
+            log_warn << "IST sender did not resume in " << resume_timeout;
+            break;
+        }
+    }
+
+    acceptor_.close();
+
+    gu::Lock lock(mutex_);
+
+    running_ = false;
+    if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
+    {
+        log_error << "IST didn't contain all write sets, expected last: "
+                  << last_seqno_ << " last received: " << current_seqno_ - 1;
+        ec = EPROTO;
+    }
+    if (ec != EINTR)
+    {
+        error_code_ = ec;
+    }
+    // let consumers drain the queue and see the end of IST
+    cond_.broadcast();
+}
+
+
+bool galera::ist::Receiver::wait_resume(gu::datetime::Period const& timeout)
+{
+    gu::datetime::Date const deadline(gu::datetime::Date::monotonic() +
+                                      timeout);
+    while (true)
+    {
+        long long const left((deadline - gu::datetime::Date::monotonic())
+                             .get_nsecs() / gu::datetime::MSec);
+        if (left <= 0) return false;
+
+        struct pollfd pfd = { acceptor_.native_handle(), POLLIN, 0 };
+        int const ret(::poll(&pfd, 1, int(left)));
+        if (ret > 0) return true;
+        if (ret < 0 && errno != EINTR)
+        {
+            log_warn << "waiting for IST sender failed: " << ::strerror(errno);
+            return false;
+        }
+    }
+}
+
+
+int galera::ist::Receiver::transfer(bool const resume,
+                                    bool const keep_listening)
 {
     asio::ip::tcp::socket socket(io_service_);
     asio::ssl::stream<asio::ip::tcp::socket> ssl_stream(io_service_, ssl_ctx_);
+    // additional streams and readers of multi-stream transfer,
+    // index 0 refers to the first connection
+    std::vector<Stream*>       streams;
+    std::vector<StreamReader*> readers;
     try
     {
         if (use_ssl_ == true)
@@ -396,28 +785,109 @@ void galera::ist::Receiver::run()
     }
     catch (asio::system_error& e)
     {
+        if (resume)
+        {
+            log_warn << "accept() of resumed IST connection failed: "
+                     << e.what();
+            return e.code().value();
+        }
         gu_throw_error(e.code().value()) << "accept() failed"
                                          << "', asio error '"
                                          << e.what() << "': "
                                          << gu::extra_error_info(e.code());
     }
-    acceptor_.close();
     int ec(0);
     try
     {
-        Proto p(trx_pool_, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+        bool const keep_keys(conf_.get(CONF_KEEP_KEYS,
+                                       CONF_KEEP_KEYS_DEFAULT));
+        Proto p(trx_pool_, version_, keep_keys);
+        size_t const offer(ist_streams(conf_));
+        size_t n_streams;
+        bool compression(false);
+        bool sender_resumes(false);
 
         if (use_ssl_ == true)
         {
-            p.send_handshake(ssl_stream);
-            p.recv_handshake_response(ssl_stream);
+            p.send_handshake(ssl_stream, offer);
+            n_streams = p.recv_handshake_response(ssl_stream, 0,
+                                                  &compression,
+                                                  &sender_resumes);
+        }
+        else
+        {
+            p.send_handshake(socket, offer);
+            n_streams = p.recv_handshake_response(socket, 0, &compression,
+                                                  &sender_resumes);
+        }
+
+        if (compression)
+        {
+            log_info << "IST receiver using compression";
+        }
+
+        if (n_streams > offer)
+        {
+            gu_throw_error(EPROTO) << "sender requested " << n_streams
+                                   << " streams, offered " << offer;
+        }
+
+        if (sender_resumes == false && current_seqno_ != first_seqno_)
+        {
+            gu_throw_error(EPROTO) << "sender did not resume IST from seqno "
+                                   << current_seqno_;
+        }
+
+        streams.resize(n_streams, 0);
+        for (size_t i(1); i < n_streams; ++i)
+        {
+            Stream* const s(new Stream(io_service_, ssl_ctx_, use_ssl_));
+            std::auto_ptr<Stream> sp(s);
+            int idx(-1);
+            if (use_ssl_ == true)
+            {
+                acceptor_.accept(s->socket());
+                gu::set_fd_options(s->socket());
+                s->ssl_stream().handshake(
+                    asio::ssl::stream<asio::ip::tcp::socket>::server);
+                p.send_handshake(s->ssl_stream(), n_streams);
+                p.recv_handshake_response(s->ssl_stream(), &idx);
+            }
+            else
+            {
+                acceptor_.accept(s->socket());
+                gu::set_fd_options(s->socket());
+                p.send_handshake(s->socket(), n_streams);
+                p.recv_handshake_response(s->socket(), &idx);
+            }
+            if (idx < 1 || size_t(idx) >= n_streams || streams[idx] != 0)
+            {
+                gu_throw_error(EPROTO) << "invalid IST stream index " << idx;
+            }
+            streams[idx] = sp.release();
+        }
+        // with resume enabled the acceptor stays open for reconnection
+        // until the end of transfer
+        if (keep_listening == false) acceptor_.close();
+
+        if (sender_resumes)
+        {
+            log_info << "IST sender resumes from seqno " << current_seqno_;
+            if (use_ssl_ == true)
+            {
+                p.send_resume(ssl_stream, current_seqno_);
+            }
+            else
+            {
+                p.send_resume(socket, current_seqno_);
+            }
+        }
+        else if (use_ssl_ == true)
+        {
             p.send_ctrl(ssl_stream, Ctrl::C_OK);
         }
         else
         {
-            p.send_handshake(socket);
-            p.recv_handshake_response(socket);
             p.send_ctrl(socket, Ctrl::C_OK);
         }
 
@@ -434,6 +904,32 @@ void galera::ist::Receiver::run()
             }
         }
 
+        if (n_streams > 1)
+        {
+            for (size_t i(0); i < n_streams; ++i)
+            {
+                if (use_ssl_ == true)
+                {
+                    typedef asio::ssl::stream<asio::ip::tcp::socket> SS;
+                    readers.push_back(new StreamReaderImpl<SS>(
+                        i, i == 0 ? ssl_stream : streams[i]->ssl_stream(),
+                        trx_pool_, version_, keep_keys));
+                }
+                else
+                {
+                    typedef asio::ip::tcp::socket S;
+                    readers.push_back(new StreamReaderImpl<S>(
+                        i, i == 0 ? socket : streams[i]->socket(),
+                        trx_pool_, version_, keep_keys));
+                }
+                readers.back()->start();
+            }
+        }
+
+        // streams are assigned relative to the seqno the sender
+        // (re)started from
+        wsrep_seqno_t const base(current_seqno_);
+
         gu::Progress<wsrep_seqno_t> progress(
             "Receiving IST",
             " events",
@@ -445,7 +941,28 @@ void galera::ist::Receiver::run()
         while (true)
         {
             TrxHandle* trx;
-            if (use_ssl_ == true)
+            if (readers.empty() == false)
+            {
+                trx = readers[stream_index(base, current_seqno_,
+                                           readers.size())]->pop();
+                if (trx == 0)
+                {
+                    // sender ends all streams after the same write set
+                    for (size_t i(0); i < readers.size(); ++i)
+                    {
+                        TrxHandle* const extra(readers[i]->pop());
+                        if (extra != 0)
+                        {
+                            log_error << "unexpected trx after EOF: "
+                                      << extra->global_seqno();
+                            extra->unref();
+                            ec = EINVAL;
+                            goto err;
+                        }
+                    }
+                }
+            }
+            else if (use_ssl_ == true)
             {
                 trx = p.recv_trx(ssl_stream);
             }
@@ -465,22 +982,13 @@ void galera::ist::Receiver::run()
                 ++current_seqno_;
 
                 progress.update(1);
-            }
-            gu::Lock lock(mutex_);
-            assert(ready_ || interrupted_);
-            while (consumers_.empty())
-            {
-                if (interrupted_)
+
+                if (push(trx) == false)
                 {
                     goto Intrrupted;
                 }
-                lock.wait(cond_);
             }
-            Consumer* cons(consumers_.top());
-            consumers_.pop();
-            cons->trx(trx);
-            cons->cond().signal();
-            if (trx == 0)
+            else
             {
                 log_debug << "eof received, closing socket";
                 break;
@@ -505,7 +1013,29 @@ void galera::ist::Receiver::run()
 
 Intrrupted:
 err:
-    gu::Lock lock(mutex_);
+    if (readers.empty() == false)
+    {
+        // unblock reader threads
+        asio::error_code ignore;
+        if (use_ssl_ == true)
+        {
+            ssl_stream.lowest_layer().shutdown(
+                asio::ip::tcp::socket::shutdown_both, ignore);
+        }
+        else
+        {
+            socket.shutdown(asio::ip::tcp::socket::shutdown_both, ignore);
+        }
+        for (size_t i(1); i < streams.size(); ++i) streams[i]->shutdown();
+        for (size_t i(0); i < readers.size(); ++i)
+        {
+            readers[i]->stop();
+            readers[i]->join();
+            delete readers[i];
+        }
+    }
+    for (size_t i(0); i < streams.size(); ++i) delete streams[i];
+
     if (use_ssl_ == true)
     {
         ssl_stream.lowest_layer().close();
@@ -516,22 +1046,38 @@ err:
         socket.close();
     }
 
-    running_ = false;
-    if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
+    return ec;
+}
+
+
+bool galera::ist::Receiver::push(TrxHandle* const trx)
+{
+    size_t const size(trx->write_set_collection().size());
+
+    gu::Lock lock(mutex_);
+    assert(ready_ || interrupted_);
+    while ((queue_.size() >= queue_limit ||
+            (queue_bytes_ + size > queue_bytes_limit && !queue_.empty())) &&
+           interrupted_ == false)
     {
-        log_error << "IST didn't contain all write sets, expected last: "
-                  << last_seqno_ << " last received: " << current_seqno_ - 1;
-        ec = EPROTO;
+        reader_waiting_ = true;
+        lock.wait(cond_);
+        reader_waiting_ = false;
     }
-    if (ec != EINTR)
+    if (interrupted_)
     {
-        error_code_ = ec;
+        trx->unref();
+        return false;
     }
-    while (consumers_.empty() == false)
+
+    queue_.push_back(trx);
+    queue_bytes_ += size;
+    // only consumers may be waiting now, wake up one if any
+    if (consumers_waiting_ > 0)
     {
-        consumers_.top()->cond().signal();
-        consumers_.pop();
+        cond_.signal();
     }
+    return true;
 }
 
 
@@ -539,14 +1085,35 @@ void galera::ist::Receiver::ready()
 {
     gu::Lock lock(mutex_);
     ready_ = true;
-    cond_.signal();
+    // consumers wait on the same condition
+    cond_.broadcast();
 }
 
 int galera::ist::Receiver::recv(TrxHandle** trx)
 {
-    Consumer cons;
+    std::vector<TrxHandle*> trxs;
+    int const ret(recv(trxs, 1));
+    if (ret == 0)
+    {
+        *trx = trxs[0];
+    }
+    return ret;
+}
+
+
+int galera::ist::Receiver::recv(std::vector<TrxHandle*>& trxs, size_t max)
+{
+    assert(max > 0);
+    trxs.clear();
+
     gu::Lock lock(mutex_);
-    if (running_ == false)
+    while (queue_.empty() && running_)
+    {
+        ++consumers_waiting_;
+        lock.wait(cond_);
+        --consumers_waiting_;
+    }
+    if (queue_.empty())
     {
         if (error_code_ != 0)
         {
@@ -554,18 +1121,28 @@ int galera::ist::Receiver::recv(TrxHandle** trx)
         }
         return EINTR;
     }
-    consumers_.push(&cons);
-    cond_.signal();
-    lock.wait(cons.cond());
-    if (cons.trx() == 0)
+
+    while (queue_.empty() == false && trxs.size() < max)
     {
-        if (error_code_ != 0)
+        TrxHandle* const trx(queue_.front());
+        // Write set which may be applied in parallel with the previous
+        // one is left to idle consumers. Dependent one would wait for
+        // the previous anyway, so it is taken along.
+        if (trxs.empty() == false && consumers_waiting_ > 0 &&
+            trx->depends_seqno() < trxs.back()->global_seqno())
         {
-            gu_throw_error(error_code_) << "IST receiver reported error";
+            break;
         }
-        return EINTR;
+        queue_.pop_front();
+        queue_bytes_ -= trx->write_set_collection().size();
+        trxs.push_back(trx);
+    }
+    // consumers may be waiting too, so make sure that reader and idle
+    // consumers wake up
+    if (reader_waiting_ || (queue_.empty() == false && consumers_waiting_ > 0))
+    {
+        cond_.broadcast();
     }
-    *trx = cons.trx();
     return 0;
 }
 
@@ -578,17 +1155,19 @@ wsrep_seqno_t galera::ist::Receiver::finished()
     }
     else
     {
-        interrupt();
-
         // It is necessary to push the loop in the run() method
-        // ahead - if now it awaiting the signal:
+        // ahead - if now it awaiting the signal. This must be done
+        // before interrupt(), acceptor may be kept open for resuming
+        // and nobody would serve the connection.
         if (!ready_)
         {
             gu::Lock local_lock(mutex_);
             interrupted_ = true;
-            cond_.signal();
+            cond_.broadcast();
         }
 
+        interrupt();
+
         int err;
         if ((err = gu_thread_join(thread_, 0)) != 0)
         {
@@ -601,11 +1180,13 @@ wsrep_seqno_t galera::ist::Receiver::finished()
 
         running_ = false;
 
-        while (consumers_.empty() == false)
+        while (queue_.empty() == false)
         {
-            consumers_.top()->cond().signal();
-            consumers_.pop();
+            queue_.front()->unref();
+            queue_.pop_front();
         }
+        queue_bytes_ = 0;
+        cond_.broadcast();
 
         recv_addr_ = "";
     }
@@ -671,16 +1252,24 @@ void galera::ist::Receiver::interrupt()
 galera::ist::Sender::Sender(const gu::Config&  conf,
                             gcache::GCache&    gcache,
                             const std::string& peer,
-                            int                version)
+                            int                version,
+                            Shaper*            total)
     :
     io_service_(),
     socket_    (io_service_),
     ssl_ctx_   (io_service_, asio::ssl::context::sslv23),
     ssl_stream_(0),
+    endpoint_  (),
+    streams_   (),
+    zero_copy_ (),
+    streams_mutex_(),
     conf_      (conf),
     gcache_    (gcache),
     version_   (version),
-    use_ssl_   (false)
+    shaper_    (ist_limit(conf, CONF_SEND_RATE), total),
+    compression_(0),
+    use_ssl_   (false),
+    cancelled_ (false)
 {
     gu::URI uri(peer);
     try
@@ -691,6 +1280,7 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                   uri.get_port(),
                   asio::ip::tcp::resolver::query::flags(0));
         asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
+        endpoint_ = *i;
         if (uri.get_scheme() == "ssl")
         {
             use_ssl_ = true;
@@ -702,15 +1292,8 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
             // ssl_stream must be created after ssl_ctx_ is prepared...
             ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
                 io_service_, ssl_ctx_);
-            ssl_stream_->lowest_layer().connect(*i);
-            gu::set_fd_options(ssl_stream_->lowest_layer());
-            ssl_stream_->handshake(asio::ssl::stream<asio::ip::tcp::socket>::client);
-        }
-        else
-        {
-            socket_.connect(*i);
-            gu::set_fd_options(socket_);
         }
+        connect();
     }
     catch (asio::system_error& e)
     {
@@ -720,8 +1303,100 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
 }
 
 
+void galera::ist::Sender::connect()
+{
+    if (use_ssl_ == true)
+    {
+        ssl_stream_->lowest_layer().connect(endpoint_);
+        gu::set_fd_options(ssl_stream_->lowest_layer());
+        ssl_stream_->handshake(asio::ssl::stream<asio::ip::tcp::socket>::client);
+    }
+    else
+    {
+        socket_.connect(endpoint_);
+        gu::set_fd_options(socket_);
+    }
+}
+
+
+void galera::ist::Sender::reconnect(const gu::datetime::Date& deadline)
+{
+    {
+        // payload still queued on broken connections is discarded, it must
+        // not be sent once GCache buffers are unlocked
+        gu::Lock lock(streams_mutex_);
+        for (size_t i(0); i < zero_copy_.size(); ++i)
+        {
+            zero_copy_[i]->abort();
+            delete zero_copy_[i];
+        }
+        zero_copy_.clear();
+    }
+
+    while (true)
+    {
+        {
+            gu::Lock lock(streams_mutex_);
+            if (cancelled_) gu_throw_error(EINTR) << "IST sender cancelled";
+            for (size_t i(0); i < streams_.size(); ++i) delete streams_[i];
+            streams_.clear();
+            asio::error_code ec;
+            if (use_ssl_ == true)
+            {
+                // SSL session state can't be reused
+                ssl_stream_->lowest_layer().close(ec);
+                delete ssl_stream_;
+                ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
+                    io_service_, ssl_ctx_);
+            }
+            else
+            {
+                socket_.close(ec);
+            }
+        }
+
+        try
+        {
+            connect();
+            gu::Lock lock(streams_mutex_);
+            if (cancelled_) gu_throw_error(EINTR) << "IST sender cancelled";
+            return;
+        }
+        catch (asio::system_error& e)
+        {
+            if (!(gu::datetime::Date::monotonic() < deadline))
+            {
+                gu_throw_error(e.code().value())
+                    << "IST sender failed to reconnect: " << e.what();
+            }
+        }
+        ::usleep(100000);
+    }
+}
+
+
 galera::ist::Sender::~Sender()
 {
+    // payload pages may not be reused before the kernel has released them,
+    // connections that do not drain in time are reset so that queued
+    // payload is never sent from unlocked GCache buffers
+    for (size_t i(0); i < zero_copy_.size(); ++i)
+    {
+        ZeroCopy& zc(*zero_copy_[i]);
+        if (zc.wait(ZERO_COPY_WAIT_MS) == false)
+        {
+            log_warn << "IST zero-copy sends still pending on stream " << i
+                     << ", resetting connection";
+            zc.abort();
+            if (zc.wait(ZERO_COPY_WAIT_MS) == false)
+            {
+                log_warn << "IST zero-copy completions not reported on "
+                         << "stream " << i << " after reset";
+            }
+        }
+        delete zero_copy_[i];
+    }
+    for (size_t i(0); i < streams_.size(); ++i) delete streams_[i];
     if (use_ssl_ == true)
     {
         ssl_stream_->lowest_layer().close();
@@ -741,30 +1416,118 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
         gu_throw_error(EINVAL) << "sender send first greater than last: "
                                << first << " > " << last ;
     }
+
+    gu::datetime::Period const resume_timeout(ist_resume_timeout(conf_));
+
+    for (bool resume(false); ; resume = true)
+    {
+        try
+        {
+            send_session(first, last, resume);
+            return;
+        }
+        catch (gu::Exception& e)
+        {
+            if (resume_timeout.get_nsecs() == 0 ||
+                connection_lost(e.get_errno()) == false)
+            {
+                throw;
+            }
+            log_warn << e.what() << ", trying to resume for "
+                     << resume_timeout;
+        }
+
+        reconnect(gu::datetime::Date::monotonic() + resume_timeout);
+    }
+}
+
+
+void galera::ist::Sender::send_session(wsrep_seqno_t       first,
+                                       wsrep_seqno_t const last,
+                                       bool const          resume)
+{
     try
     {
         TrxHandle::SlavePool unused(1, 0, "");
         Proto p(unused, version_,
                 conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
-        int32_t ctrl;
+        p.set_shaper(&shaper_);
+        int32_t ctrl(0);
+        wsrep_seqno_t resume_seqno(-1);
+        size_t streams;
+        bool peer_compression(false);
 
         if (use_ssl_ == true)
         {
-            p.recv_handshake(*ssl_stream_);
-            p.send_handshake_response(*ssl_stream_);
-            ctrl = p.recv_ctrl(*ssl_stream_);
+            streams = std::min(p.recv_handshake(*ssl_stream_,
+                                                &peer_compression),
+                               ist_streams(conf_));
+            compression_ = peer_compression ? ist_compression(conf_) : 0;
+            p.send_handshake_response(*ssl_stream_, streams, 0,
+                                      compression_ > 0, resume);
+            connect_streams(p, streams);
+            if (resume)
+            {
+                resume_seqno = p.recv_resume(*ssl_stream_);
+            }
+            else
+            {
+                ctrl = p.recv_ctrl(*ssl_stream_);
+            }
         }
         else
         {
-            p.recv_handshake(socket_);
-            p.send_handshake_response(socket_);
-            ctrl = p.recv_ctrl(socket_);
+            streams = std::min(p.recv_handshake(socket_, &peer_compression),
+                               ist_streams(conf_));
+            compression_ = peer_compression ? ist_compression(conf_) : 0;
+            p.send_handshake_response(socket_, streams, 0, compression_ > 0,
+                                      resume);
+            connect_streams(p, streams);
+            if (resume)
+            {
+                resume_seqno = p.recv_resume(socket_);
+            }
+            else
+            {
+                ctrl = p.recv_ctrl(socket_);
+            }
         }
         if (ctrl < 0)
         {
             gu_throw_error(EPROTO)
                 << "ist send failed, peer reported error: " << ctrl;
         }
+        if (resume)
+        {
+            // receiver may only have got more since the last attempt
+            if (resume_seqno < first || resume_seqno > last)
+            {
+                gu_throw_error(EPROTO) << "invalid IST resume seqno "
+                                       << resume_seqno << ", range "
+                                       << first << "-" << last;
+            }
+            log_info << "IST sender resuming from seqno " << resume_seqno;
+            first = resume_seqno;
+        }
+
+        if (compression_ > 0)
+        {
+            log_info << "IST sender using compression level " << compression_;
+            p.set_compression(compression_);
+        }
+        else if (use_ssl_ == false &&
+                 conf_.get(CONF_ZERO_COPY, CONF_ZERO_COPY_DEFAULT))
+        {
+            setup_zero_copy(streams);
+            p.set_zero_copy(zero_copy(0));
+        }
+
+        if (streams > 1)
+        {
+            log_info << "IST sender using " << streams << " streams";
+            send_streams(first, last);
+            return;
+        }
 
         std::vector<gcache::GCache::Buffer> buf_vec(
             std::min(static_cast<size_t>(last - first + 1),
@@ -842,6 +1605,275 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
 
 
 
+void galera::ist::Sender::cancel()
+{
+    {
+        gu::Lock lock(streams_mutex_);
+        cancelled_ = true;
+    }
+    shaper_.interrupt();
+    close_streams();
+}
+
+
+void galera::ist::Sender::close_streams()
+{
+    gu::Lock lock(streams_mutex_);
+    // plain close would let the kernel send queued zero-copy payload later
+    for (size_t i(0); i < zero_copy_.size(); ++i) zero_copy_[i]->abort();
+    for (size_t i(0); i < streams_.size(); ++i)
+    {
+        if (streams_[i] != 0) streams_[i]->shutdown();
+    }
+    if (use_ssl_ == true)
+    {
+        ssl_stream_->lowest_layer().close();
+    }
+    else
+    {
+        socket_.close();
+    }
+}
+
+
+void galera::ist::Sender::setup_zero_copy(size_t const streams)
+{
+    gu::Lock lock(streams_mutex_);
+    zero_copy_.reserve(streams);
+    zero_copy_.push_back(new ZeroCopy(socket_));
+    for (size_t i(1); i < streams; ++i)
+    {
+        zero_copy_.push_back(new ZeroCopy(streams_[i]->socket()));
+    }
+}
+
+
+void galera::ist::Sender::connect_streams(Proto& p, size_t const streams)
+{
+    gu::Lock lock(streams_mutex_);
+    streams_.resize(streams, 0);
+    for (size_t i(1); i < streams; ++i)
+    {
+        streams_[i] = new Stream(io_service_, ssl_ctx_, use_ssl_);
+        Stream& s(*streams_[i]);
+        s.socket().connect(endpoint_);
+        gu::set_fd_options(s.socket());
+        if (use_ssl_ == true)
+        {
+            s.ssl_stream().handshake(
+                asio::ssl::stream<asio::ip::tcp::socket>::client);
+            p.recv_handshake(s.ssl_stream());
+            p.send_handshake_response(s.ssl_stream(), streams, i,
+                                      compression_ > 0);
+        }
+        else
+        {
+            p.recv_handshake(s.socket());
+            p.send_handshake_response(s.socket(), streams, i,
+                                      compression_ > 0);
+        }
+    }
+}
+
+
+namespace
+{
+    struct SendStreamArgs
+    {
+        galera::ist::Sender* sender;
+        size_t               idx;
+        size_t               streams;
+        wsrep_seqno_t        first;
+        wsrep_seqno_t        last;
+        int                  err;
+        std::string          what;
+    };
+}
+
+extern "C" void* run_ist_send_stream(void* arg)
+{
+    SendStreamArgs* const a(static_cast<SendStreamArgs*>(arg));
+    try
+    {
+        a->sender->send_stream(a->idx, a->streams, a->first, a->last);
+    }
+    catch (asio::system_error& e)
+    {
+        a->err  = e.code().value();
+        a->what = e.what();
+    }
+    catch (gu::Exception& e)
+    {
+        a->err  = e.get_errno();
+        a->what = e.what();
+    }
+    return 0;
+}
+
+
+void galera::ist::Sender::send_streams(wsrep_seqno_t const first,
+                                       wsrep_seqno_t const last)
+{
+    size_t const streams(streams_.size());
+    std::vector<SendStreamArgs> args(streams);
+    std::vector<gu_thread_t>    threads(streams);
+    size_t started(1);
+    int    err(0);
+
+    for (; started < streams; ++started)
+    {
+        SendStreamArgs& a(args[started]);
+        a.sender  = this;
+        a.idx     = started;
+        a.streams = streams;
+        a.first   = first;
+        a.last    = last;
+        a.err     = 0;
+        if ((err = gu_thread_create(&threads[started], 0,
+                                    &run_ist_send_stream, &a)) != 0)
+        {
+            break;
+        }
+    }
+
+    std::string what;
+    if (err != 0)
+    {
+        what = "failed to start IST stream sender thread";
+        close_streams();
+    }
+    else
+    {
+        try
+        {
+            send_stream(0, streams, first, last);
+        }
+        catch (asio::system_error& e)
+        {
+            err  = e.code().value();
+            what = e.what();
+            close_streams();
+        }
+        catch (gu::Exception& e)
+        {
+            err  = e.get_errno();
+            what = e.what();
+            close_streams();
+        }
+    }
+
+    for (size_t i(1); i < started; ++i)
+    {
+        gu_thread_join(threads[i], 0);
+        if (err == 0 && args[i].err != 0)
+        {
+            err  = args[i].err;
+            what = args[i].what;
+        }
+    }
+
+    if (err != 0)
+    {
+        gu_throw_error(err) << "ist send failed: " << what;
+    }
+}
+
+
+namespace
+{
+    // sends chunks of stream idx followed by EOF
+    template <class ST>
+    void send_stream_chunks(galera::ist::Proto&  p,
+                            ST&                  socket,
+                            gcache::GCache&      gcache,
+                            size_t const         idx,
+                            size_t const         streams,
+                            wsrep_seqno_t const  first,
+                            wsrep_seqno_t const  last)
+    {
+        using galera::ist::stream_chunk;
+        std::vector<gcache::GCache::Buffer> buf_vec;
+
+        // stream idx carries chunks idx, idx + streams, idx + 2*streams, ...
+        for (wsrep_seqno_t chunk(first + idx*stream_chunk); chunk <= last;
+             chunk += streams*stream_chunk)
+        {
+            wsrep_seqno_t const chunk_last(
+                std::min<wsrep_seqno_t>(chunk + stream_chunk - 1, last));
+
+            for (wsrep_seqno_t seqno(chunk); seqno <= chunk_last; )
+            {
+                buf_vec.resize(chunk_last - seqno + 1);
+                ssize_t const n_read(gcache.seqno_get_buffers(buf_vec, seqno));
+                if (n_read <= 0)
+                {
+                    gu_throw_error(ENODATA) << "failed to get write set "
+                                            << seqno << " from gcache";
+                }
+                GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
+                for (ssize_t i(0); i < n_read; ++i)
+                {
+                    p.send_trx(socket, buf_vec[i]);
+                }
+                seqno += n_read;
+            }
+        }
+
+        p.send_ctrl(socket, galera::ist::Ctrl::C_EOF);
+
+        // wait until receiver closes the connection
+        try
+        {
+            gu::byte_t b;
+            size_t const n(asio::read(socket, asio::buffer(&b, 1)));
+            if (n > 0)
+            {
+                log_warn << "received " << n << " bytes, expected none";
+            }
+        }
+        catch (asio::system_error& e)
+        { }
+    }
+}
+
+void galera::ist::Sender::send_stream(size_t const        idx,
+                                      size_t const        streams,
+                                      wsrep_seqno_t const first,
+                                      wsrep_seqno_t const last)
+{
+    TrxHandle::SlavePool unused(1, 0, "");
+    Proto p(unused, version_,
+            conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+    p.set_zero_copy(zero_copy(idx));
+    p.set_compression(compression_);
+    p.set_shaper(&shaper_);
+
+    if (idx == 0)
+    {
+        if (use_ssl_ == true)
+        {
+            send_stream_chunks(p, *ssl_stream_, gcache_, idx, streams,
+                               first, last);
+        }
+        else
+        {
+            send_stream_chunks(p, socket_, gcache_, idx, streams,
+                               first, last);
+        }
+    }
+    else if (use_ssl_ == true)
+    {
+        send_stream_chunks(p, streams_[idx]->ssl_stream(), gcache_, idx,
+                           streams, first, last);
+    }
+    else
+    {
+        send_stream_chunks(p, streams_[idx]->socket(), gcache_, idx,
+                           streams, first, last);
+    }
+}
+
+
 extern "C"
 void* run_async_sender(void* arg)
 {
@@ -857,8 +1889,13 @@ void* run_async_sender(void* arg)
     log_info << "async IST sender starting to serve " << as->peer().c_str()
              << " sending " << as->first() << "-" << as->last();
     wsrep_seqno_t join_seqno;
+    bool const admitted(as->asmap().acquire(as));
     try
     {
+        if (admitted == false)
+        {
+            gu_throw_error(EINTR) << "cancelled while waiting for a slot";
+        }
         as->send(as->first(), as->last());
         join_seqno = as->last();
     }
@@ -874,6 +1911,8 @@ void* run_async_sender(void* arg)
         throw;
     }
 
+    if (admitted) as->asmap().release();
+
     try
     {
         as->asmap().remove(as, join_seqno);
@@ -897,6 +1936,27 @@ void* run_async_sender(void* arg)
 }
 
 
+galera::ist::AsyncSenderMap::AsyncSenderMap(const gu::Config& conf,
+                                            GCS_IMPL&         gcs,
+                                            gcache::GCache&   gcache)
+    :
+    senders_    (),
+#ifdef HAVE_PSI_INTERFACE
+    monitor_    (WSREP_PFS_INSTR_TAG_ASYNC_SENDER_MONITOR_MUTEX,
+                 WSREP_PFS_INSTR_TAG_ASYNC_SENDER_MONITOR_CONDVAR),
+#else
+    monitor_    (),
+#endif /* HAVE_PSI_INTERFACE */
+    gcache_     (gcache),
+    shaper_     (ist_limit(conf, CONF_SEND_RATE_TOTAL)),
+    slots_mutex_(),
+    slots_cond_ (),
+    waiting_    (),
+    active_     (0),
+    max_senders_(ist_limit(conf, CONF_MAX_SENDERS))
+{ }
+
+
 void galera::ist::AsyncSenderMap::run(const gu::Config&  conf,
                                       const std::string& peer,
                                       wsrep_seqno_t      first,
@@ -905,9 +1965,15 @@ void galera::ist::AsyncSenderMap::run(const gu::Config&  conf,
 {
     gu::Critical crit(monitor_);
     AsyncSender* as(new AsyncSender(conf, peer, first, last, *this, version));
+    {
+        // queued before the thread starts so that cancel() finds it
+        gu::Lock lock(slots_mutex_);
+        waiting_.push_back(as);
+    }
     int err(gu_thread_create(&as->thread_, 0, &run_async_sender, as));
     if (err != 0)
     {
+        dequeue(as);
         delete as;
         gu_throw_error(err) << "failed to start sender thread";
     }
@@ -935,6 +2001,7 @@ void galera::ist::AsyncSenderMap::cancel()
         AsyncSender* as(*senders_.begin());
         senders_.erase(*senders_.begin());
         int err;
+        dequeue(as);
         as->cancel();
         monitor_.leave();
         if ((err = gu_thread_join(as->thread_, 0)) != 0)
@@ -946,3 +2013,72 @@ void galera::ist::AsyncSenderMap::cancel()
     }
 
 }
+
+
+bool galera::ist::AsyncSenderMap::acquire(AsyncSender* const as)
+{
+    gu::Lock lock(slots_mutex_);
+    bool logged(false);
+    while (true)
+    {
+        std::deque<AsyncSender*>::iterator const i(
+            std::find(waiting_.begin(), waiting_.end(), as));
+        if (i == waiting_.end()) return false;
+
+        if (i == waiting_.begin() &&
+            (max_senders_ == 0 || active_ < max_senders_))
+        {
+            waiting_.pop_front();
+            ++active_;
+            // next one may be admitted too
+            slots_cond_.broadcast();
+            return true;
+        }
+
+        if (logged == false)
+        {
+            log_info << "async IST sender to " << as->peer()
+                     << " waiting, " << active_ << " senders active, "
+                     << (i - waiting_.begin()) << " waiting before it";
+            logged = true;
+        }
+        lock.wait(slots_cond_);
+    }
+}
+
+
+void galera::ist::AsyncSenderMap::release()
+{
+    gu::Lock lock(slots_mutex_);
+    assert(active_ > 0);
+    --active_;
+    slots_cond_.broadcast();
+}
+
+
+void galera::ist::AsyncSenderMap::dequeue(AsyncSender* const as)
+{
+    gu::Lock lock(slots_mutex_);
+    std::deque<AsyncSender*>::iterator const i(
+        std::find(waiting_.begin(), waiting_.end(), as));
+    if (i != waiting_.end())
+    {
+        waiting_.erase(i);
+        slots_cond_.broadcast();
+    }
+}
+
+
+void galera::ist::AsyncSenderMap::get_stats(long long& active,
+                                            long long& queued,
+                                            long long& bytes,
+                                            long long& rate) const
+{
+    {
+        gu::Lock lock(slots_mutex_);
+        active = active_;
+        queued = waiting_.size();
+    }
+    bytes = shaper_.bytes();
+    rate  = shaper_.current_rate();
+}
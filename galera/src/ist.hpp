@@ -13,9 +13,12 @@
 #include "gu_lock.hpp"
 #include "gu_monitor.hpp"
 #include "gu_asio.hpp"
+#include "gu_datetime.hpp"
+#include "ist_shaper.hpp"
 
-#include <stack>
+#include <deque>
 #include <set>
+#include <vector>
 
 namespace gcache
 {
@@ -30,6 +33,10 @@ namespace galera
     {
         void register_params(gu::Config& conf);
 
+        class Proto;
+        class Stream;
+        class ZeroCopy;
+
         class Receiver
         {
         public:
@@ -41,7 +48,16 @@ namespace galera
 
             std::string   prepare(wsrep_seqno_t, wsrep_seqno_t, int);
             void          ready();
+            // Receives next write set, returns EINTR when IST has ended
             int           recv(TrxHandle** trx);
+            // Receives up to max write sets in seqno order with single
+            // wait, returns EINTR when IST has ended. While other
+            // consumers are idle, only write sets depending on their
+            // predecessor are received together, so that independent
+            // ones are applied in parallel.
+            int           recv(std::vector<TrxHandle*>& trxs, size_t max);
+            // Batch size for consumers
+            static size_t const recv_batch_max = 64;
             wsrep_seqno_t finished();
             void          run();
 
@@ -53,6 +69,14 @@ namespace galera
         private:
 
             void interrupt();
+            // queues trx for consumers, returns false if interrupted
+            bool push(TrxHandle* trx);
+            // receives write sets from the next connection (or set of
+            // connections of multi-stream transfer) accepted, returns
+            // error code
+            int  transfer(bool resume, bool keep_listening);
+            // waits for sender to reconnect, returns false on timeout
+            bool wait_resume(const gu::datetime::Period& timeout);
 
             std::string                                   recv_addr_;
             std::string                                   recv_bind_;
@@ -67,44 +91,15 @@ namespace galera
             gu::Cond                                      cond_;
 #endif /* HAVE_PSI_INTERFACE */
 
-            class Consumer
-            {
-            public:
-
-#ifdef HAVE_PSI_INTERFACE
-                Consumer()
-                    :
-                    cond_(WSREP_PFS_INSTR_TAG_IST_CONSUMER_CONDVAR),
-                    trx_(0)
-                { }
-#else
-                Consumer() : cond_(), trx_(0) { }
-#endif
-                ~Consumer() { }
-
-#ifdef HAVE_PSI_INTERFACE
-                gu::CondWithPFS&  cond()        { return cond_; }
-#else
-                gu::Cond&  cond()              { return cond_; }
-#endif /* HAVE_PSI_INTERFACE */
-                void       trx(TrxHandle* trx) { trx_ = trx;   }
-                TrxHandle* trx() const         { return trx_;  }
-
-            private:
-
-                // Non-copyable
-                Consumer(const Consumer&);
-                Consumer& operator=(const Consumer&);
-
-#ifdef HAVE_PSI_INTERFACE
-                gu::CondWithPFS   cond_;
-#else
-                gu::Cond   cond_;
-#endif /* HAVE_PSI_INTERFACE */
-                TrxHandle* trx_;
-            };
-
-            std::stack<Consumer*> consumers_;
+            // Write sets received but not consumed yet. Reader thread
+            // stays at most queue_limit write sets or queue_bytes_limit
+            // bytes ahead of consumers.
+            static size_t const    queue_limit = 1024;
+            static size_t const    queue_bytes_limit = (1 << 26);
+            std::deque<TrxHandle*> queue_;
+            size_t                 queue_bytes_;
+            int                    consumers_waiting_;
+            bool                   reader_waiting_;
             wsrep_seqno_t         current_seqno_;
             wsrep_seqno_t         first_seqno_;
             wsrep_seqno_t         last_seqno_;
@@ -127,36 +122,67 @@ namespace galera
         {
         public:
 
+            // bytes sent are also charged to total if it is given
             Sender(const gu::Config& conf,
                    gcache::GCache& gcache,
                    const std::string& peer,
-                   int version);
+                   int version,
+                   Shaper* total = 0);
             virtual ~Sender();
 
             void send(wsrep_seqno_t first, wsrep_seqno_t last);
 
-            void cancel()
-            {
-                if (use_ssl_ == true)
-                {
-                    ssl_stream_->lowest_layer().close();
-                }
-                else
-                {
-                    socket_.close();
-                }
-            }
+            void cancel();
+
+            // sends the share of stream i of multi-stream transfer
+            void send_stream(size_t i, size_t streams,
+                             wsrep_seqno_t first, wsrep_seqno_t last);
 
         private:
 
+            // sends write sets from first to last over a connection
+            // established by connect(), if resume is true the receiver
+            // decides where the transfer continues from
+            void send_session(wsrep_seqno_t first, wsrep_seqno_t last,
+                              bool resume);
+            void connect();
+            // unblocks senders of all streams
+            void close_streams();
+            // replaces broken connections with a new one, retries until
+            // deadline or until cancelled
+            void reconnect(const gu::datetime::Date& deadline);
+            // opens additional connections for multi-stream transfer
+            void connect_streams(Proto& p, size_t streams);
+            void send_streams(wsrep_seqno_t first, wsrep_seqno_t last);
+            // enables zero-copy payload sending on plaintext connections
+            void setup_zero_copy(size_t streams);
+            ZeroCopy* zero_copy(size_t idx) const
+            {
+                return (idx < zero_copy_.size() ? zero_copy_[idx] : 0);
+            }
+
             asio::io_service                          io_service_;
             asio::ip::tcp::socket                     socket_;
             asio::ssl::context                        ssl_ctx_;
             asio::ssl::stream<asio::ip::tcp::socket>* ssl_stream_;
+            asio::ip::tcp::endpoint                   endpoint_;
+            // connections of multi-stream transfer, the first one is
+            // represented by socket_/ssl_stream_ and is null here
+            std::vector<Stream*>                      streams_;
+            // zero-copy state of each connection, empty if not used,
+            // modified under streams_mutex_
+            std::vector<ZeroCopy*>                    zero_copy_;
+            gu::Mutex                                 streams_mutex_;
             const gu::Config&                         conf_;
             gcache::GCache&                           gcache_;
             int                                       version_;
+            // limits the rate of this transfer to ist.send_rate
+            Shaper                                    shaper_;
+            // negotiated compression level, 0 if not compressed
+            int                                       compression_;
             bool                                      use_ssl_;
+            // set by cancel(), protected by streams_mutex_
+            bool                                      cancelled_;
 
             Sender(const Sender&);
             void operator=(const Sender&);
@@ -167,16 +193,9 @@ namespace galera
         class AsyncSenderMap
         {
         public:
-            AsyncSenderMap(GCS_IMPL& gcs, gcache::GCache& gcache)
-                :
-                senders_(),
-#ifdef HAVE_PSI_INTERFACE
-                monitor_(WSREP_PFS_INSTR_TAG_ASYNC_SENDER_MONITOR_MUTEX,
-                         WSREP_PFS_INSTR_TAG_ASYNC_SENDER_MONITOR_CONDVAR),
-#else
-                monitor_(),
-#endif /* HAVE_PSI_INTERFACE */
-                gcache_(gcache) { }
+            AsyncSenderMap(const gu::Config& conf,
+                           GCS_IMPL& gcs,
+                           gcache::GCache& gcache);
             void run(const gu::Config& conf,
                      const std::string& peer,
                      wsrep_seqno_t,
@@ -185,11 +204,33 @@ namespace galera
             void remove(AsyncSender*, wsrep_seqno_t);
             void cancel();
             gcache::GCache& gcache() { return gcache_; }
+            // aggregate rate limit of all senders, ist.send_rate_total
+            Shaper& shaper() { return shaper_; }
+
+            // Waits until the number of active senders drops below
+            // ist.max_senders, senders are admitted in the order they
+            // were started. Returns false if the sender was cancelled
+            // while waiting.
+            bool acquire(AsyncSender*);
+            void release();
+
+            void get_stats(long long& active, long long& queued,
+                           long long& bytes, long long& rate) const;
         private:
-            std::set<AsyncSender*> senders_;
+            // drops sender from the queue of waiting senders
+            void dequeue(AsyncSender*);
+
+            std::set<AsyncSender*>   senders_;
             // use monitor instead of mutex, it provides cancellation point
-            gu::Monitor            monitor_;
-            gcache::GCache&        gcache_;
+            gu::Monitor              monitor_;
+            gcache::GCache&          gcache_;
+            Shaper                   shaper_;
+            gu::Mutex                slots_mutex_;
+            gu::Cond                 slots_cond_;
+            // senders waiting for a slot, in the order they were started
+            std::deque<AsyncSender*> waiting_;
+            size_t                   active_;
+            size_t const             max_senders_; // 0 for unlimited
         };
 
 
@@ -0,0 +1,172 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "ist_compression.hpp"
+
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif /* HAVE_ZLIB */
+
+bool galera::ist::compression_supported()
+{
+#ifdef HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif /* HAVE_ZLIB */
+}
+
+
+extern "C" void* run_ist_compressor(void* arg)
+{
+    static_cast<galera::ist::Compressor*>(arg)->run();
+    return 0;
+}
+
+
+galera::ist::Compressor::Compressor(int const level)
+    :
+    mutex_    (),
+    cond_     (),
+    todo_     (),
+    done_     (),
+    thread_   (),
+    in_flight_(0),
+    level_    (level),
+    error_    (0),
+    stopped_  (false)
+{
+    if (compression_supported() == false)
+    {
+        gu_throw_error(ENOTSUP) << "IST compression is not supported";
+    }
+
+    int err;
+    if ((err = gu_thread_create(&thread_, 0, &run_ist_compressor, this)))
+    {
+        gu_throw_error(err) << "Unable to create IST compressor thread";
+    }
+}
+
+
+galera::ist::Compressor::~Compressor()
+{
+    {
+        gu::Lock lock(mutex_);
+        stopped_ = true;
+        cond_.broadcast();
+    }
+    gu_thread_join(thread_, 0);
+
+    for (size_t i(0); i < todo_.size(); ++i) delete todo_[i];
+    for (size_t i(0); i < done_.size(); ++i) delete done_[i];
+}
+
+
+void galera::ist::Compressor::push(gu::Buffer& raw)
+{
+    Batch* const b(new Batch);
+    b->raw.swap(raw);
+
+    gu::Lock lock(mutex_);
+    todo_.push_back(b);
+    ++in_flight_;
+    cond_.broadcast();
+}
+
+
+size_t galera::ist::Compressor::pop(gu::Buffer& out)
+{
+    gu::Lock lock(mutex_);
+    while (done_.empty() && error_ == 0)
+    {
+        lock.wait(cond_);
+    }
+    if (done_.empty())
+    {
+        gu_throw_error(error_) << "IST compression failed";
+    }
+
+    Batch* const b(done_.front());
+    done_.pop_front();
+    --in_flight_;
+
+    out.swap(b->out);
+    size_t const ret(b->raw.size());
+    delete b;
+    return ret;
+}
+
+
+void galera::ist::Compressor::run()
+{
+    while (true)
+    {
+        Batch* b;
+        {
+            gu::Lock lock(mutex_);
+            while (todo_.empty() && stopped_ == false)
+            {
+                lock.wait(cond_);
+            }
+            if (stopped_) return;
+
+            b = todo_.front();
+            todo_.pop_front();
+        }
+
+        int err(0);
+#ifdef HAVE_ZLIB
+        uLongf out_len(compressBound(b->raw.size()));
+        b->out.resize(out_len);
+        int const zerr(compress2(&b->out[0], &out_len,
+                                 &b->raw[0], b->raw.size(), level_));
+        if (zerr == Z_OK)
+        {
+            b->out.resize(out_len);
+        }
+        else
+        {
+            log_error << "IST compression failed: " << zerr;
+            err = EINVAL;
+        }
+#else
+        err = ENOTSUP;
+#endif /* HAVE_ZLIB */
+
+        gu::Lock lock(mutex_);
+        if (err == 0)
+        {
+            done_.push_back(b);
+        }
+        else
+        {
+            error_ = err;
+            delete b;
+        }
+        cond_.broadcast();
+    }
+}
+
+
+void galera::ist::decompress(const gu::byte_t* const buf,
+                             size_t const            len,
+                             gu::Buffer&             out)
+{
+#ifdef HAVE_ZLIB
+    uLongf out_len(out.size());
+    int const zerr(uncompress(&out[0], &out_len, buf, len));
+    if (zerr != Z_OK || out_len != out.size())
+    {
+        gu_throw_error(EPROTO) << "failed to decompress IST batch: " << zerr
+                               << ", size " << out_len << ", expected "
+                               << out.size();
+    }
+#else
+    gu_throw_error(ENOTSUP) << "IST compression is not supported";
+#endif /* HAVE_ZLIB */
+}
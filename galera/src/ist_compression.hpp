@@ -0,0 +1,76 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_IST_COMPRESSION_HPP
+#define GALERA_IST_COMPRESSION_HPP
+
+#include "gu_buffer.hpp"
+#include "gu_lock.hpp"
+#include "gu_threads.h"
+
+#include <deque>
+
+namespace galera
+{
+    namespace ist
+    {
+        // Returns true if IST compression was enabled at build time
+        bool compression_supported();
+
+        //
+        // Compresses batches of serialized IST messages in a separate
+        // thread so that compression overlaps with reading GCache and
+        // writing to socket. Batches are returned in the order they were
+        // pushed.
+        //
+        class Compressor
+        {
+        public:
+
+            // level: zlib compression level 1-9
+            explicit Compressor(int level);
+            ~Compressor();
+
+            // Queues batch for compression, the contents of raw are
+            // swapped with an empty buffer
+            void push(gu::Buffer& raw);
+
+            // Waits until the oldest pushed batch is compressed, stores
+            // compressed data in out and returns uncompressed size
+            size_t pop(gu::Buffer& out);
+
+            // Number of batches pushed but not popped yet
+            size_t in_flight() const { return in_flight_; }
+
+            void run();
+
+        private:
+
+            Compressor(const Compressor&);
+            Compressor& operator=(const Compressor&);
+
+            struct Batch
+            {
+                gu::Buffer raw;
+                gu::Buffer out;
+            };
+
+            gu::Mutex          mutex_;
+            gu::Cond           cond_;
+            std::deque<Batch*> todo_;
+            std::deque<Batch*> done_;
+            gu_thread_t        thread_;
+            size_t             in_flight_;
+            int const          level_;
+            int                error_;
+            bool               stopped_;
+        };
+
+        // Decompresses len bytes from buf to out, the size of out must
+        // be equal to uncompressed size
+        void decompress(const gu::byte_t* buf, size_t len, gu::Buffer& out);
+    }
+}
+
+#endif // GALERA_IST_COMPRESSION_HPP
@@ -6,6 +6,9 @@
 #define GALERA_IST_PROTO_HPP
 
 #include "trx_handle.hpp"
+#include "ist_zero_copy.hpp"
+#include "ist_compression.hpp"
+#include "ist_shaper.hpp"
 
 #include "GCache.hpp"
 
@@ -37,6 +40,52 @@
 // send_ctrl(EOF)            ----->
 //                          <-----   close()
 // close()
+//
+// Multi-stream transfer: receiver offers the number of streams it
+// accepts in the len field of handshake and sender replies with the
+// number of streams it is going to use in the len field of handshake
+// response. Older implementations leave the fields zero, which means
+// single stream. With more than one stream the sender opens the
+// additional connections before the receiver sends OK on the first one,
+// each of them carrying stream index in the ctrl field of handshake
+// response:
+//
+// Sender                            Receiver
+// connect()                 ----->  accept()
+//                          <-----   send_handshake(K)
+// send_handshake_response(K, 0) --->
+// connect()                 ----->  accept()
+//                          <-----   send_handshake(K)
+// send_handshake_response(K, 1) --->
+// ...                               ...
+//                          <-----   send_ctrl(OK) on stream 0
+// send_trx() on stream_index()  --->
+// send_ctrl(EOF) on each stream --->
+//                          <-----   close() all
+//
+// Write sets are distributed over streams in chunks of stream_chunk
+// consecutive seqnos and the receiver reads them back in seqno order.
+//
+// Compression: receiver sets F_COMPRESSION flag in handshake if it can
+// decompress and sender sets it in handshake responses if it is going to
+// compress. Then Trx messages are serialized into batches of about
+// batch_size bytes, each sent as single T_TRX_BATCH message carrying
+// uncompressed size followed by compressed data. Ctrl messages are
+// never compressed.
+//
+// Resume: if the connection is lost before the last write set, sender
+// reconnects and sets F_RESUME flag in handshake response. Receiver then
+// replies with T_RESUME message carrying the seqno to continue from in
+// the len field instead of send_ctrl(OK), and the transfer continues as
+// if it had started from that seqno:
+//
+// Sender                            Receiver
+// connect()                 ----->  accept()
+//                          <-----   send_handshake()
+// send_handshake_response(RESUME) ->
+//                          <-----   send_resume(seqno)
+// send_trx(seqno)           ----->
+// ...
 
 //
 // Note about protocol/message versioning:
@@ -50,6 +99,21 @@ namespace galera
 {
     namespace ist
     {
+        // Maximum number of streams, stream index must fit in ctrl field
+        static size_t const max_streams = 32;
+        // Number of consecutive write sets sent over one stream
+        static size_t const stream_chunk = 16;
+
+        // Uncompressed size of Trx message batch to compress
+        static size_t const batch_size = 1 << 16;
+
+        // Returns index of the stream which carries seqno
+        inline size_t stream_index(wsrep_seqno_t first, wsrep_seqno_t seqno,
+                                   size_t streams)
+        {
+            return (size_t(seqno - first)/stream_chunk) % streams;
+        }
+
         class Message
         {
         public:
@@ -59,9 +123,18 @@ namespace galera
                 T_HANDSHAKE = 1,
                 T_HANDSHAKE_RESPONSE = 2,
                 T_CTRL = 3,
-                T_TRX = 4
+                T_TRX = 4,
+                T_TRX_BATCH = 5,
+                T_RESUME = 6
             } Type;
 
+            // flags of handshake messages
+            enum
+            {
+                F_COMPRESSION = 0x1,
+                F_RESUME      = 0x2
+            };
+
             Message(int       version = -1,
                     Type      type    = T_NONE,
                     uint8_t   flags   = 0,
@@ -195,18 +268,23 @@ namespace galera
         class Handshake : public Message
         {
         public:
-            Handshake(int version = -1)
+            Handshake(int version = -1, uint64_t streams = 0,
+                      uint8_t flags = 0)
                 :
-                Message(version, Message::T_HANDSHAKE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE, flags, 0, streams)
             { }
         };
 
         class HandshakeResponse : public Message
         {
         public:
-            HandshakeResponse(int version = -1)
+            HandshakeResponse(int      version = -1,
+                              uint64_t streams = 0,
+                              int8_t   stream  = 0,
+                              uint8_t  flags   = 0)
                 :
-                Message(version, Message::T_HANDSHAKE_RESPONSE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE_RESPONSE, flags, stream,
+                        streams)
             { }
         };
 
@@ -225,6 +303,15 @@ namespace galera
             { }
         };
 
+        class Resume : public Message
+        {
+        public:
+            Resume(int version = -1, wsrep_seqno_t seqno = 0)
+                :
+                Message(version, Message::T_RESUME, 0, 0, seqno)
+            { }
+        };
+
         class Trx : public Message
         {
         public:
@@ -242,6 +329,12 @@ namespace galera
             Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys)
                 :
                 trx_pool_ (sp),
+                zero_copy_(0),
+                compressor_(0),
+                shaper_   (0),
+                out_batch_(),
+                in_batch_ (),
+                zbuf_     (),
                 raw_sent_ (0),
                 real_sent_(0),
                 version_  (version),
@@ -260,12 +353,15 @@ namespace galera
                              << (raw_sent_ == 0 ? 0. :
                                  static_cast<double>(real_sent_)/raw_sent_);
                 }
+                delete compressor_;
             }
 
             template <class ST>
-            void send_handshake(ST& socket)
+            void send_handshake(ST& socket, size_t streams = 1)
             {
-                Handshake  hs(version_);
+                Handshake  hs(version_, streams,
+                              compression_supported() ?
+                              Message::F_COMPRESSION : 0);
                 gu::Buffer buf(hs.serial_size());
                 size_t offset(hs.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],
@@ -276,8 +372,10 @@ namespace galera
                 }
             }
 
+            // returns the number of streams offered by receiver, whether
+            // receiver accepts compression is stored in compression if given
             template <class ST>
-            void recv_handshake(ST& socket)
+            size_t recv_handshake(ST& socket, bool* compression = 0)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -319,12 +417,25 @@ namespace galera
                                            << version_;
                 }
                 // TODO: Figure out protocol versions to use
+
+                if (compression)
+                {
+                    *compression = (msg.flags() & Message::F_COMPRESSION);
+                }
+                return (msg.len() > 0 ? msg.len() : 1);
             }
 
             template <class ST>
-            void send_handshake_response(ST& socket)
+            void send_handshake_response(ST&    socket,
+                                         size_t streams     = 1,
+                                         int    stream      = 0,
+                                         bool   compression = false,
+                                         bool   resume      = false)
             {
-                HandshakeResponse hsr(version_);
+                HandshakeResponse hsr(version_, streams, stream,
+                                      (compression ?
+                                       Message::F_COMPRESSION : 0) |
+                                      (resume ? Message::F_RESUME : 0));
                 gu::Buffer buf(hsr.serial_size());
                 size_t offset(hsr.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0], buf.size())));
@@ -335,8 +446,14 @@ namespace galera
                 }
             }
 
+            // returns the number of streams chosen by sender, index of the
+            // stream is stored in stream, whether sender compresses
+            // in compression and whether it resumes in resume if given
             template <class ST>
-            void recv_handshake_response(ST& socket)
+            size_t recv_handshake_response(ST&   socket,
+                                           int*  stream      = 0,
+                                           bool* compression = 0,
+                                           bool* resume      = 0)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -356,7 +473,16 @@ namespace galera
                 switch (msg.type())
                 {
                 case Message::T_HANDSHAKE_RESPONSE:
-                    break;
+                    if (stream) *stream = msg.ctrl();
+                    if (compression)
+                    {
+                        *compression = (msg.flags() & Message::F_COMPRESSION);
+                    }
+                    if (resume)
+                    {
+                        *resume = (msg.flags() & Message::F_RESUME);
+                    }
+                    return (msg.len() > 0 ? msg.len() : 1);
                 case Message::T_CTRL:
                     switch (msg.ctrl())
                     {
@@ -370,11 +496,33 @@ namespace galera
                     gu_throw_error(EINVAL) << "unexpected message type: "
                                            << msg.type();
                 }
+
+                return 1; // keep compiler happy
+            }
+
+            // Write set payloads are sent through zc if it is given. It
+            // must wrap the same plaintext socket passed to send_trx().
+            void set_zero_copy(ZeroCopy* zc) { zero_copy_ = zc; }
+
+            // Bytes of Trx messages written to socket are charged to
+            // shaper if it is given
+            void set_shaper(Shaper* shaper) { shaper_ = shaper; }
+
+            // Trx messages are sent in compressed batches if level > 0,
+            // must be agreed in handshake
+            void set_compression(int level)
+            {
+                if (level > 0 && compressor_ == 0)
+                {
+                    compressor_ = new Compressor(level);
+                }
             }
 
             template <class ST>
             void send_ctrl(ST& socket, int8_t code)
             {
+                if (compressor_ != 0) flush_batch(socket, true);
+
                 Ctrl       ctrl(version_, code);
                 gu::Buffer buf(ctrl.serial_size());
                 size_t offset(ctrl.serialize(&buf[0], buf.size(), 0));
@@ -413,6 +561,55 @@ namespace galera
                 return msg.ctrl();
             }
 
+            template <class ST>
+            void send_resume(ST& socket, wsrep_seqno_t const seqno)
+            {
+                Resume     resume(version_, seqno);
+                gu::Buffer buf(resume.serial_size());
+                size_t offset(resume.serialize(&buf[0], buf.size(), 0));
+                size_t n(asio::write(socket, asio::buffer(&buf[0],buf.size())));
+                if (n != offset)
+                {
+                    gu_throw_error(EPROTO) << "error sending resume message";
+                }
+            }
+
+            // returns seqno to resume from
+            template <class ST>
+            wsrep_seqno_t recv_resume(ST& socket)
+            {
+                Message    msg(version_);
+                gu::Buffer buf(msg.serial_size());
+                size_t n(asio::read(socket, asio::buffer(&buf[0], buf.size())));
+
+                if (n != buf.size())
+                {
+                    gu_throw_error(EPROTO) << "error receiving resume message";
+                }
+
+                (void)msg.unserialize(&buf[0], buf.size(), 0);
+
+                switch (msg.type())
+                {
+                case Message::T_RESUME:
+                    return msg.len();
+                case Message::T_CTRL:
+                    switch (msg.ctrl())
+                    {
+                    case Ctrl::C_EOF:
+                        gu_throw_error(EINTR) << "interrupted by ctrl";
+                    default:
+                        gu_throw_error(EPROTO) << "peer reported error: "
+                                               << int(msg.ctrl());
+                    }
+                default:
+                    gu_throw_error(EPROTO) << "unexpected message type: "
+                                           << msg.type();
+                }
+
+                return -1; // keep compiler happy
+            }
+
 
             template <class ST>
             void send_trx(ST&                           socket,
@@ -467,9 +664,33 @@ namespace galera
                                         &buf[0], buf.size(), offset);
                 cbs[0] = asio::const_buffer(&buf[0], buf.size());
 
+                if (compressor_ != 0)
+                {
+                    for (size_t i(0); i < (payload_size ? 3 : 1); ++i)
+                    {
+                        const gu::byte_t* const ptr(
+                            asio::buffer_cast<const gu::byte_t*>(cbs[i]));
+                        out_batch_.insert(out_batch_.end(), ptr,
+                                          ptr + asio::buffer_size(cbs[i]));
+                    }
+                    if (out_batch_.size() >= batch_size)
+                    {
+                        flush_batch(socket, false);
+                    }
+                    return;
+                }
+
                 if (gu_likely(payload_size))
                 {
-                    sent = asio::write(socket, cbs);
+                    if (zero_copy_ != 0 && zero_copy_->enabled() &&
+                        payload_size >= ZeroCopy::min_size)
+                    {
+                        sent = zero_copy_->send(cbs);
+                    }
+                    else
+                    {
+                        sent = asio::write(socket, cbs);
+                    }
                 }
                 else
                 {
@@ -477,12 +698,151 @@ namespace galera
                 }
 
                 log_debug << "sent " << sent << " bytes";
+
+                if (shaper_ != 0) shaper_->consume(sent);
             }
 
 
             template <class ST>
             galera::TrxHandle*
             recv_trx(ST& socket)
+            {
+                galera::TrxHandle* trx;
+                while (true)
+                {
+                    if (in_batch_.pending())
+                    {
+                        if (recv_msg(in_batch_, trx) == false)
+                        {
+                            gu_throw_error(EPROTO) << "nested Trx batch";
+                        }
+                        return trx;
+                    }
+                    if (recv_msg(socket, trx)) return trx;
+                }
+            }
+
+        private:
+
+            Proto(const Proto&);
+            Proto& operator=(const Proto&);
+
+            // Reads serialized messages from decompressed batch
+            class BatchStream
+            {
+            public:
+                BatchStream() : buf_(), offset_(0) { }
+
+                bool pending() const { return offset_ < buf_.size(); }
+
+                gu::Buffer& reset(size_t size)
+                {
+                    buf_.resize(size);
+                    offset_ = 0;
+                    return buf_;
+                }
+
+                template <typename MutableBufferSequence>
+                size_t read_some(const MutableBufferSequence& bufs,
+                                 asio::error_code& ec)
+                {
+                    size_t const n(asio::buffer_copy(
+                                       bufs,
+                                       asio::buffer(&buf_[0] + offset_,
+                                                    buf_.size() - offset_)));
+                    offset_ += n;
+                    if (n == 0 && asio::buffer_size(bufs) > 0)
+                    {
+                        ec = asio::error::eof;
+                    }
+                    return n;
+                }
+
+                template <typename MutableBufferSequence>
+                size_t read_some(const MutableBufferSequence& bufs)
+                {
+                    asio::error_code ec;
+                    size_t const n(read_some(bufs, ec));
+                    if (ec) throw asio::system_error(ec);
+                    return n;
+                }
+
+            private:
+                gu::Buffer buf_;
+                size_t     offset_;
+            };
+
+            // sends batch being collected and waits until at most
+            // one batch is in compression, or none if all is true
+            template <class ST>
+            void flush_batch(ST& socket, bool all)
+            {
+                if (out_batch_.empty() == false)
+                {
+                    compressor_->push(out_batch_);
+                    out_batch_.clear();
+                }
+
+                while (compressor_->in_flight() > (all ? 0 : 1))
+                {
+                    size_t const raw_size(compressor_->pop(zbuf_));
+                    Message msg(version_, Message::T_TRX_BATCH, 0, 0,
+                                8 + zbuf_.size());
+                    gu::Buffer buf(msg.serial_size() + 8);
+                    size_t offset(msg.serialize(&buf[0], buf.size(), 0));
+                    offset = gu::serialize8(uint64_t(raw_size),
+                                            &buf[0], buf.size(), offset);
+
+                    gu::array<asio::const_buffer, 2>::type cbs;
+                    cbs[0] = asio::const_buffer(&buf[0], buf.size());
+                    cbs[1] = asio::const_buffer(&zbuf_[0], zbuf_.size());
+                    asio::write(socket, cbs);
+
+                    raw_sent_  += raw_size;
+                    real_sent_ += buf.size() + zbuf_.size();
+
+                    if (shaper_ != 0)
+                    {
+                        shaper_->consume(buf.size() + zbuf_.size());
+                    }
+                }
+            }
+
+            // reads and decompresses Trx batch of len bytes
+            template <class ST>
+            void recv_batch(ST& socket, uint64_t const len)
+            {
+                if (compression_supported() == false)
+                {
+                    gu_throw_error(EPROTO)
+                        << "compressed IST batch not expected";
+                }
+
+                uint64_t raw_size;
+                if (len <= 8)
+                {
+                    gu_throw_error(EPROTO) << "invalid IST batch size " << len;
+                }
+                zbuf_.resize(len);
+                size_t const n(asio::read(socket, asio::buffer(&zbuf_[0],
+                                                               zbuf_.size())));
+                if (n != zbuf_.size())
+                {
+                    gu_throw_error(EPROTO) << "error reading IST batch";
+                }
+                (void)gu::unserialize8(&zbuf_[0], zbuf_.size(), 0, raw_size);
+                if (raw_size == 0)
+                {
+                    gu_throw_error(EPROTO) << "empty IST batch";
+                }
+                decompress(&zbuf_[0] + 8, zbuf_.size() - 8,
+                           in_batch_.reset(raw_size));
+            }
+
+            // returns false if message was Trx batch which was loaded into
+            // in_batch_, otherwise stores received trx or null at EOF
+            template <class ST>
+            bool recv_msg(ST& socket, galera::TrxHandle*& ret)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -523,55 +883,74 @@ namespace galera
 
                     galera::TrxHandle* trx(galera::TrxHandle::New(trx_pool_));
 
-                    if (seqno_d == WSREP_SEQNO_UNDEFINED)
+                    // connection may be lost in the middle of write set,
+                    // unfinished trx must be released
+                    try
                     {
-                        if (offset != msg.len())
+                        if (seqno_d == WSREP_SEQNO_UNDEFINED)
                         {
-                            gu_throw_error(EINVAL)
-                                << "message size " << msg.len()
-                                << " does not match expected size " << offset;
+                            if (offset != msg.len())
+                            {
+                                gu_throw_error(EINVAL)
+                                    << "message size " << msg.len()
+                                    << " does not match expected size "
+                                    << offset;
+                            }
                         }
-                    }
-                    else
-                    {
-                        MappedBuffer& wbuf(trx->write_set_collection());
-                        size_t const wsize(msg.len() - offset);
-                        wbuf.resize(wsize);
+                        else
+                        {
+                            MappedBuffer& wbuf(trx->write_set_collection());
+                            size_t const wsize(msg.len() - offset);
+                            wbuf.resize(wsize);
 
-                        n = asio::read(socket,
-                                       asio::buffer(&wbuf[0], wbuf.size()));
+                            n = asio::read(socket,
+                                           asio::buffer(&wbuf[0], wbuf.size()));
 
-                        if (gu_unlikely(n != wbuf.size()))
-                        {
-                            gu_throw_error(EPROTO)
-                                << "error reading write set data";
-                        }
+                            if (gu_unlikely(n != wbuf.size()))
+                            {
+                                gu_throw_error(EPROTO)
+                                    << "error reading write set data";
+                            }
 
-                        trx->unserialize(&wbuf[0], wbuf.size(), 0);
-                    }
+                            trx->unserialize(&wbuf[0], wbuf.size(), 0);
+                        }
 
-                    if (seqno_d == WSREP_SEQNO_UNDEFINED ||
-                        trx->version() < 3)
-                    {
-                        trx->set_received(0, -1, seqno_g);
-                        trx->set_depends_seqno(seqno_d);
+                        if (seqno_d == WSREP_SEQNO_UNDEFINED ||
+                            trx->version() < 3)
+                        {
+                            trx->set_received(0, -1, seqno_g);
+                            trx->set_depends_seqno(seqno_d);
+                        }
+                        else
+                        {
+                            trx->set_received_from_ws();
+                            assert(trx->global_seqno() == seqno_g);
+                            assert(trx->depends_seqno() >= seqno_d);
+                            // PA range in write set header is capped,
+                            // donor recorded the exact dependency
+                            trx->set_depends_seqno(seqno_d);
+                        }
+                        trx->mark_certified();
                     }
-                    else
+                    catch (...)
                     {
-                        trx->set_received_from_ws();
-                        assert(trx->global_seqno() == seqno_g);
-                        assert(trx->depends_seqno() >= seqno_d);
+                        trx->unref();
+                        throw;
                     }
-                    trx->mark_certified();
 
                     log_debug << "received trx body: " << *trx;
-                    return trx;
+                    ret = trx;
+                    return true;
                 }
+                case Message::T_TRX_BATCH:
+                    recv_batch(socket, msg.len());
+                    return false;
                 case Message::T_CTRL:
                     switch (msg.ctrl())
                     {
                     case Ctrl::C_EOF:
-                        return 0;
+                        ret = 0;
+                        return true;
                     default:
                         if (msg.ctrl() >= 0)
                         {
@@ -589,12 +968,16 @@ namespace galera
                 }
 
                 gu_throw_fatal; throw;
-                return 0; // keep compiler happy
+                return false; // keep compiler happy
             }
 
-        private:
-
             TrxHandle::SlavePool& trx_pool_;
+            ZeroCopy*             zero_copy_;
+            Compressor*           compressor_;
+            Shaper*               shaper_;
+            gu::Buffer            out_batch_; // Trx messages to compress
+            BatchStream           in_batch_;  // decompressed Trx messages
+            gu::Buffer            zbuf_;      // compressed data
 
             uint64_t raw_sent_;
             uint64_t real_sent_;
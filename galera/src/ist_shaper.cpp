@@ -0,0 +1,117 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "ist_shaper.hpp"
+
+#include "gu_throw.hpp"
+#include "gu_datetime.hpp"
+#include "gu_time.h"
+
+namespace
+{
+    long long const NSEC(1000000000LL);
+}
+
+
+galera::ist::Shaper::Shaper(long long const rate, Shaper* const parent)
+    :
+    mutex_       (),
+    cond_        (),
+    parent_      (parent),
+    rate_        (rate > 0 ? rate : 0),
+    burst_       (rate_ * 0.1),
+    tokens_      (burst_),
+    last_        (gu_time_monotonic()),
+    bytes_       (0),
+    window_start_(last_),
+    window_bytes_(0),
+    window_rate_ (0),
+    interrupted_ (false)
+{ }
+
+
+long long galera::ist::Shaper::charge(size_t const len)
+{
+    gu::Lock lock(mutex_);
+
+    long long const now(gu_time_monotonic());
+
+    bytes_        += len;
+    window_bytes_ += len;
+    if (now - window_start_ >= NSEC)
+    {
+        window_rate_  = double(window_bytes_) * NSEC / (now - window_start_);
+        window_start_ = now;
+        window_bytes_ = 0;
+    }
+
+    if (rate_ == 0) return 0;
+
+    tokens_ += double(now - last_) * rate_ / NSEC;
+    if (tokens_ > burst_) tokens_ = burst_;
+    last_ = now;
+
+    tokens_ -= len;
+
+    return (tokens_ < 0 ? (long long)(-tokens_ * NSEC / rate_) : 0);
+}
+
+
+void galera::ist::Shaper::consume(size_t const len)
+{
+    long long wait(charge(len));
+    if (parent_ != 0)
+    {
+        long long const parent_wait(parent_->charge(len));
+        if (parent_wait > wait) wait = parent_wait;
+    }
+
+    gu::Lock lock(mutex_);
+
+    if (wait > 0)
+    {
+        gu::datetime::Date const until(gu::datetime::Date::calendar() +
+                                       gu::datetime::Period(wait));
+        while (interrupted_ == false && gu::datetime::Date::calendar() < until)
+        {
+            try
+            {
+                lock.wait(cond_, until);
+            }
+            catch (gu::Exception& e)
+            {
+                if (e.get_errno() != ETIMEDOUT) throw;
+            }
+        }
+    }
+
+    if (interrupted_)
+    {
+        gu_throw_error(EINTR) << "IST sender interrupted";
+    }
+}
+
+
+void galera::ist::Shaper::interrupt()
+{
+    gu::Lock lock(mutex_);
+    interrupted_ = true;
+    cond_.broadcast();
+}
+
+
+uint64_t galera::ist::Shaper::bytes() const
+{
+    gu::Lock lock(mutex_);
+    return bytes_;
+}
+
+
+long long galera::ist::Shaper::current_rate() const
+{
+    gu::Lock lock(mutex_);
+    // nothing was sent for a while
+    if (gu_time_monotonic() - window_start_ >= 2*NSEC) return 0;
+    return window_rate_;
+}
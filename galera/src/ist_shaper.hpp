@@ -0,0 +1,71 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_IST_SHAPER_HPP
+#define GALERA_IST_SHAPER_HPP
+
+#include "gu_lock.hpp"
+
+#include <stdint.h>
+
+namespace galera
+{
+    namespace ist
+    {
+        //
+        // Limits the rate of bytes sent by IST sender with a token bucket.
+        //
+        // Bucket holds up to 100ms worth of tokens. Bytes are charged
+        // after they have been sent, so the bucket may go into debt by
+        // one message, the sender then waits until the debt is paid off.
+        // Shaper may have a parent which is charged for the same bytes,
+        // this way senders are limited both individually and in total.
+        //
+        // Shaper also keeps the count of bytes charged and the rate
+        // measured over the last second for status reporting.
+        //
+        class Shaper
+        {
+        public:
+
+            // rate: bytes per second, 0 for unlimited
+            explicit Shaper(long long rate, Shaper* parent = 0);
+
+            // Charges len bytes and waits until the rate allows sending
+            // more. Throws EINTR if interrupted.
+            void consume(size_t len);
+
+            // Makes current and future consume() calls throw EINTR
+            void interrupt();
+
+            long long rate()  const { return rate_; }
+            uint64_t  bytes() const;
+            // bytes per second over the last full second
+            long long current_rate() const;
+
+        private:
+
+            Shaper(const Shaper&);
+            Shaper& operator=(const Shaper&);
+
+            // charges len bytes, returns nanoseconds to wait
+            long long charge(size_t len);
+
+            gu::Mutex         mutex_;
+            gu::Cond          cond_;
+            Shaper* const     parent_;
+            long long const   rate_;
+            double const      burst_;
+            double            tokens_;
+            long long         last_;          // last refill, ns
+            uint64_t          bytes_;
+            long long         window_start_;  // ns
+            uint64_t          window_bytes_;
+            long long         window_rate_;
+            bool              interrupted_;
+        };
+    }
+}
+
+#endif // GALERA_IST_SHAPER_HPP
@@ -0,0 +1,250 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#include "ist_zero_copy.hpp"
+
+#include "gu_logger.hpp"
+#include "gu_throw.hpp"
+#include "gu_datetime.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__) && defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+#include <linux/errqueue.h>
+#define GALERA_HAVE_ZERO_COPY 1
+#endif /* __linux__ && SO_ZEROCOPY && MSG_ZEROCOPY */
+
+namespace
+{
+    void throw_system_error(int err)
+    {
+        throw asio::system_error(
+            asio::error_code(err, asio::error::get_system_category()));
+    }
+
+    // waits until socket becomes writable after EAGAIN
+    void wait_writable(int fd)
+    {
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        if (::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+        {
+            throw_system_error(errno);
+        }
+    }
+
+    // sends the whole iovec array, consumed entries are zeroed so that
+    // the call can be repeated after failure, successful calls are
+    // counted in calls
+    void send_iov(int fd, struct iovec* iov, size_t iovlen, int flags,
+                  uint32_t& calls)
+    {
+        while (iovlen > 0)
+        {
+            struct msghdr msg;
+            ::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = iov;
+            msg.msg_iovlen = iovlen;
+
+            ssize_t n(::sendmsg(fd, &msg, flags));
+            if (n < 0)
+            {
+                switch (errno)
+                {
+                case EINTR:  continue;
+                case EAGAIN: wait_writable(fd); continue;
+                default:     throw_system_error(errno);
+                }
+            }
+            ++calls;
+            while (iovlen > 0 && size_t(n) >= iov->iov_len)
+            {
+                n -= iov->iov_len;
+                iov->iov_len = 0;
+                ++iov;
+                --iovlen;
+            }
+            if (iovlen > 0)
+            {
+                iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+                iov->iov_len -= n;
+            }
+        }
+    }
+}
+
+
+galera::ist::ZeroCopy::ZeroCopy(asio::ip::tcp::socket& socket)
+    :
+    socket_   (socket),
+    sent_     (0),
+    completed_(0),
+    bytes_    (0),
+    enabled_  (false)
+{
+#ifdef GALERA_HAVE_ZERO_COPY
+    int const one(1);
+    if (::setsockopt(socket_.native_handle(), SOL_SOCKET, SO_ZEROCOPY,
+                     &one, sizeof(one)) == 0)
+    {
+        enabled_ = true;
+    }
+    else
+    {
+        log_info << "IST zero-copy send not supported: " << ::strerror(errno);
+    }
+#else
+    log_info << "IST zero-copy send not supported on this platform";
+#endif /* GALERA_HAVE_ZERO_COPY */
+}
+
+
+galera::ist::ZeroCopy::~ZeroCopy()
+{
+    log_debug << "IST zero-copy sent " << bytes_ << " bytes in " << sent_
+              << " calls, " << (sent_ - completed_) << " pending";
+}
+
+
+size_t
+galera::ist::ZeroCopy::send(const gu::array<asio::const_buffer, 3>::type& cbs)
+{
+    if (enabled_ == false)
+    {
+        return asio::write(socket_, cbs);
+    }
+
+#ifdef GALERA_HAVE_ZERO_COPY
+    int const fd(socket_.native_handle());
+    struct iovec iov[3];
+    for (size_t i(0); i < 3; ++i)
+    {
+        iov[i].iov_base = const_cast<void*>(
+            asio::buffer_cast<const void*>(cbs[i]));
+        iov[i].iov_len  = asio::buffer_size(cbs[i]);
+    }
+    size_t const payload(iov[1].iov_len + iov[2].iov_len);
+    size_t const total(iov[0].iov_len + payload);
+    uint32_t copy_calls(0);
+
+    // header buffer is released after return, so it must be copied
+    send_iov(fd, iov, 1, MSG_MORE, copy_calls);
+
+    try
+    {
+        send_iov(fd, iov + 1, 2, MSG_ZEROCOPY, sent_);
+        bytes_ += payload;
+    }
+    catch (asio::system_error& e)
+    {
+        // out of socket option memory, too many sends pending
+        if (e.code().value() != ENOBUFS) throw;
+        reap();
+        send_iov(fd, iov + 1, 2, 0, copy_calls);
+    }
+
+    reap();
+
+    return total;
+#else
+    assert(0);
+    return 0;
+#endif /* GALERA_HAVE_ZERO_COPY */
+}
+
+
+void galera::ist::ZeroCopy::reap()
+{
+#ifdef GALERA_HAVE_ZERO_COPY
+    int const fd(socket_.native_handle());
+    while (sent_ != completed_)
+    {
+        char control[128];
+        struct msghdr msg;
+        ::memset(&msg, 0, sizeof(msg));
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+
+        for (struct cmsghdr* cm(CMSG_FIRSTHDR(&msg)); cm != 0;
+             cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!((cm->cmsg_level == SOL_IP   && cm->cmsg_type == IP_RECVERR) ||
+                  (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+            {
+                continue;
+            }
+
+            struct sock_extended_err ee;
+            ::memcpy(&ee, CMSG_DATA(cm), sizeof(ee));
+            if (ee.ee_errno != 0 || ee.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            {
+                continue;
+            }
+
+            // notification covers range of send calls [ee_info, ee_data]
+            completed_ += ee.ee_data - ee.ee_info + 1;
+
+            if ((ee.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && enabled_)
+            {
+                log_info << "IST zero-copy send disabled, kernel copies "
+                         << "data for this connection";
+                enabled_ = false;
+            }
+        }
+    }
+#endif /* GALERA_HAVE_ZERO_COPY */
+}
+
+
+bool galera::ist::ZeroCopy::wait(int const timeout_ms)
+{
+    gu::datetime::Date const deadline(gu::datetime::Date::monotonic() +
+                                      timeout_ms*gu::datetime::MSec);
+    while (sent_ != completed_)
+    {
+        // pages stay referenced by the kernel if connection was closed
+        // while sends were pending, there is nobody to notify
+        if (socket_.is_open() == false) return false;
+
+        reap();
+        if (sent_ == completed_) break;
+
+        long long const left((deadline - gu::datetime::Date::monotonic())
+                             .get_nsecs() / gu::datetime::MSec);
+        if (left <= 0) return false;
+
+        // error queue readiness is reported as POLLERR
+        struct pollfd pfd = { socket_.native_handle(), 0, 0 };
+        if (::poll(&pfd, 1, int(left)) < 0 && errno != EINTR)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+void galera::ist::ZeroCopy::abort()
+{
+#ifdef GALERA_HAVE_ZERO_COPY
+    if (socket_.is_open() == false) return;
+
+    // disconnect sends RST and purges the send queue but keeps the socket
+    // open, so that the completions can still be read from error queue
+    struct sockaddr sa;
+    ::memset(&sa, 0, sizeof(sa));
+    sa.sa_family = AF_UNSPEC;
+    if (::connect(socket_.native_handle(), &sa, sizeof(sa)) < 0)
+    {
+        log_warn << "IST zero-copy: failed to reset connection: "
+                 << ::strerror(errno);
+    }
+#endif /* GALERA_HAVE_ZERO_COPY */
+}
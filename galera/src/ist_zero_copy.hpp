@@ -0,0 +1,73 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_IST_ZERO_COPY_HPP
+#define GALERA_IST_ZERO_COPY_HPP
+
+#include "gu_asio.hpp"
+#include "gu_array.hpp"
+
+#include <stdint.h>
+
+namespace galera
+{
+    namespace ist
+    {
+        //
+        // Sends write set payload from GCache over plaintext TCP socket
+        // without copying it into socket buffers (Linux MSG_ZEROCOPY).
+        //
+        // The kernel references the payload pages until the data has been
+        // acknowledged by the peer, so GCache buffers must stay locked
+        // until wait() has returned true or the connection has been reset
+        // with abort(). Message header is always copied as
+        // it lives in temporary buffer.
+        //
+        // If the kernel does not support zero-copy or it reports that
+        // the payload was copied anyway (e.g. loopback), zero-copy is
+        // disabled and send() falls back to regular writes.
+        //
+        class ZeroCopy
+        {
+        public:
+
+            // Payloads smaller than this are cheaper to copy
+            static size_t const min_size = 16384;
+
+            explicit ZeroCopy(asio::ip::tcp::socket& socket);
+            ~ZeroCopy();
+
+            bool enabled() const { return enabled_; }
+
+            // Sends header cbs[0] followed by payload cbs[1], cbs[2],
+            // returns the number of bytes sent
+            size_t send(const gu::array<asio::const_buffer, 3>::type& cbs);
+
+            // Waits until the kernel has released all payload pages or
+            // timeout_ms has passed. Returns true if nothing is pending.
+            bool wait(int timeout_ms);
+
+            // Resets the connection. Data still queued in the socket is
+            // discarded and never transmitted, the kernel releases its
+            // payload pages and reports them completed to wait().
+            void abort();
+
+        private:
+
+            ZeroCopy(const ZeroCopy&);
+            ZeroCopy& operator=(const ZeroCopy&);
+
+            // processes completion notifications available
+            void reap();
+
+            asio::ip::tcp::socket& socket_;
+            uint32_t               sent_;       // zero-copy sends issued
+            uint32_t               completed_;  // sends completed by kernel
+            uint64_t               bytes_;      // bytes sent with zero-copy
+            bool                   enabled_;
+        };
+    }
+}
+
+#endif // GALERA_IST_ZERO_COPY_HPP
@@ -206,9 +206,11 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
                              const KeyData& kd,
                              int const      part_num,
                              int const      ws_ver,
-                             int const      alignment)
+                             int const      alignment,
+                             const gu::Hash*                  ctx,
+                             const KeySet::KeyPart::HashData* hd)
     :
-    hash_ (parent->hash_),
+    hash_ (ctx ? *ctx : parent->hash_),
     part_ (0),
     value_(static_cast<const gu::byte_t*>(kd.parts[part_num].ptr)),
     size_ (kd.parts[part_num].len),
@@ -216,14 +218,20 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
     own_  (false)
 {
     assert (ver_);
-    uint32_t const s(gu::htog(size_));
-    hash_.append (&s, sizeof(s));
-    hash_.append (value_, size_);
+    assert (!ctx == !hd);
 
     KeySet::KeyPart::TmpStore ts;
-    KeySet::KeyPart::HashData hd;
+    KeySet::KeyPart::HashData tmp;
 
-    hash_.gather<sizeof(hd.buf)>(hd.buf);
+    if (!ctx)
+    {
+        uint32_t const s(gu::htog(size_));
+        hash_.append (&s, sizeof(s));
+        hash_.append (value_, size_);
+
+        hash_.gather<sizeof(tmp.buf)>(tmp.buf);
+        hd = &tmp;
+    }
 
     /* only leaf part of the key can be not WSREP_KEY_SHARED */
     bool const leaf (part_num + 1 == kd.parts_num);
@@ -232,7 +240,7 @@ KeySetOut::KeyPart::KeyPart (KeyParts&      added,
 
     assert (kd.parts_num > part_num);
 
-    KeySet::KeyPart kp(ts, hd, kd.parts, ver_, prefix, part_num, alignment);
+    KeySet::KeyPart kp(ts, *hd, kd.parts, ver_, prefix, part_num, alignment);
 
 #if 0 /* find() way */
     /* the reason to use find() first, instead of going straight to insert()
@@ -329,7 +337,10 @@ KeySetOut::KeyPart::print (std::ostream& os) const
 #define CHECK_PREVIOUS_KEY 1
 
 size_t
-KeySetOut::append (const KeyData& kd)
+KeySetOut::append_ (const KeyData&                         kd,
+                    const gu::Hash*                  const ctx,
+                    const KeySet::KeyPart::HashData* const hd,
+                    long                             const first)
 {
     int i(0);
 
@@ -400,7 +411,9 @@ KeySetOut::append (const KeyData& kd)
     {
         try
         {
-            KeyPart kp(added_, *this, parent, kd, i, ws_ver_, alignment());
+            bool const pre(i >= first);
+            KeyPart kp(added_, *this, parent, kd, i, ws_ver_, alignment(),
+                       pre ? ctx + i : 0, pre ? hd + (i - first) : 0);
 
 #ifdef CHECK_PREVIOUS_KEY
             if (size_t(j) < new_.size())
@@ -454,6 +467,112 @@ out:
     return size() - old_size;
 }
 
+static inline bool
+key_part_equal (const wsrep_buf_t& l, const wsrep_buf_t& r)
+{
+    return (l.len == r.len && !::memcmp(l.ptr, r.ptr, l.len));
+}
+
+size_t
+KeySetOut::append (const wsrep_key_t* const keys,
+                   size_t             const keys_num,
+                   wsrep_key_type_t   const type,
+                   bool               const copy)
+{
+    size_t const old_size (size());
+
+    for (size_t b(0); b < keys_num; b += BULK_KEYS)
+    {
+        size_t const n(std::min(keys_num - b, size_t(BULK_KEYS)));
+
+        /* hash contexts of all parts of all keys in the batch. Part hash
+         * depends only on the part and its ancestors, so contexts of the
+         * ancestors shared with the previous key are copied, the rest are
+         * computed here and finalized together. */
+        gu::Vector<gu::Hash, 32>        ctx;
+        size_t                          off[BULK_KEYS];
+        long                            first[BULK_KEYS];
+
+        for (size_t k(0); k < n; ++k)
+        {
+            const wsrep_key_t& key(keys[b + k]);
+            long j(0);
+
+            off[k] = ctx.size();
+
+            if (0 == k)
+            {
+                for (; j < long(key.key_parts_num) &&
+                         size_t(j + 1) < prev_.size() &&
+                         prev_[j + 1].match(key.key_parts[j].ptr,
+                                            key.key_parts[j].len); ++j)
+                {
+                    ctx().push_back(prev_[j + 1].hash());
+                }
+            }
+            else
+            {
+                const wsrep_key_t& pkey(keys[b + k - 1]);
+
+                for (; j < long(key.key_parts_num) &&
+                         j < long(pkey.key_parts_num) &&
+                         key_part_equal(key.key_parts[j], pkey.key_parts[j]);
+                     ++j)
+                {
+                    gu::Hash const h(ctx[off[k - 1] + j]);
+                    ctx().push_back(h);
+                }
+            }
+
+            first[k] = j;
+
+            for (; j < long(key.key_parts_num); ++j)
+            {
+                gu::Hash h(j > 0 ? ctx[off[k] + j - 1] : gu::Hash());
+                uint32_t const s(gu::htog(uint32_t(key.key_parts[j].len)));
+                h.append (&s, sizeof(s));
+                h.append (key.key_parts[j].ptr, key.key_parts[j].len);
+                ctx().push_back(h);
+            }
+        }
+
+        gu::Vector<const gu::Hash*, 32>           fin;
+        gu::Vector<KeySet::KeyPart::HashData, 32> hd;
+        size_t                                    hd_off[BULK_KEYS];
+
+        for (size_t k(0); k < n; ++k)
+        {
+            hd_off[k] = fin.size();
+            for (long j(first[k]); j < long(keys[b + k].key_parts_num); ++j)
+            {
+                fin().push_back(&ctx[off[k] + j]);
+            }
+        }
+
+        hd.resize(fin.size());
+        if (fin.size() > 0)
+        {
+            gu::Hash::gather16(&fin[0], fin.size(), &hd[0]);
+        }
+
+        for (size_t k(0); k < n; ++k)
+        {
+            KeyData const kd(ws_ver_,
+                             keys[b + k].key_parts,
+                             keys[b + k].key_parts_num,
+                             type,
+                             copy);
+
+            append_(kd,
+                    ctx.size() > 0 ? &ctx[0] + off[k]    : 0,
+                    hd.size()  > 0 ? &hd[0]  + hd_off[k] : 0,
+                    first[k]);
+        }
+    }
+
+    return size() - old_size;
+}
+
 #if 0
 const KeyIn&
 galera::KeySetIn::get_key() const
@@ -134,7 +134,7 @@ public:
          * version */
         static int prefix(wsrep_key_type_t const ws_type, int const ws_ver)
         {
-            if (ws_ver >= 0 && ws_ver <= 4)
+            if (ws_ver >= 0 && ws_ver <= 5)
             {
                 switch (ws_type)
                 {
@@ -159,7 +159,7 @@ public:
 
         wsrep_key_type_t wsrep_type(int const ws_ver) const
         {
-            assert(ws_ver >= 0 && ws_ver <= 4);
+            assert(ws_ver >= 0 && ws_ver <= 5);
 
             wsrep_key_type_t ret;
 
@@ -169,10 +169,10 @@ public:
                 ret = WSREP_KEY_SHARED;
                 break;
             case 1:
-                ret = ws_ver == 4 ? WSREP_KEY_SEMI : WSREP_KEY_EXCLUSIVE;
+                ret = ws_ver >= 4 ? WSREP_KEY_SEMI : WSREP_KEY_EXCLUSIVE;
                 break;
             case 2:
-                assert(ws_ver == 4);
+                assert(ws_ver >= 4);
                 ret = WSREP_KEY_EXCLUSIVE;
                 break;
             default:
@@ -575,13 +575,17 @@ public:
         /* to throw in KeyPart() ctor in case it is a duplicate */
         class DUPLICATE {};
 
+        /* ctx and hd, if given, are precomputed hash context and hash of
+         * this part, otherwise they are computed from parent */
         KeyPart (KeyParts&      added,
                  KeySetOut&     store,
                  const KeyPart* parent,
                  const KeyData& kd,
                  int const      part_num,
                  int const      ws_ver,
-                 int const      alignment);
+                 int const      alignment,
+                 const gu::Hash*                  ctx = 0,
+                 const KeySet::KeyPart::HashData* hd  = 0);
 
         KeyPart (const KeyPart& k)
         :
@@ -621,6 +625,9 @@ public:
         int
         prefix() const { return (part_ ? part_->prefix() : 0); }
 
+        const gu::Hash&
+        hash() const { return hash_; }
+
         void
         acquire()
         {
@@ -681,7 +688,7 @@ public:
             reserved,
             reserved_size,
             base_name,
-            check_type(version),
+            check_type(version, ws_ver),
             rsv
             ),
         added_(),
@@ -692,7 +699,7 @@ public:
     {
         assert (version_ != KeySet::EMPTY);
         assert ((uintptr_t(reserved) % GU_WORD_BYTES) == 0);
-        assert (ws_ver <= 4);
+        assert (ws_ver <= 5);
         KeyPart zero(version_);
         prev_().push_back(zero);
     }
@@ -700,13 +707,29 @@ public:
     ~KeySetOut () {}
 
     size_t
-    append (const KeyData& kd);
+    append (const KeyData& kd) { return append_(kd, 0, 0, kd.parts_num); }
+
+    /* Appends keys_num keys of the same type. Key part hashes are computed
+     * for several keys at once, which is faster than appending the keys
+     * one by one when there are many of them. */
+    size_t
+    append (const wsrep_key_t* keys, size_t keys_num,
+            wsrep_key_type_t type, bool copy);
 
     KeySet::Version
     version () { return count() ? version_ : KeySet::EMPTY; }
 
 private:
 
+    /* number of keys to hash at once in bulk append() */
+    static size_t const BULK_KEYS = 8;
+
+    /* hash contexts of all key parts are in ctx, hashes of the parts starting
+     * from first are in hd, hd[0] being the hash of part first */
+    size_t
+    append_ (const KeyData& kd, const gu::Hash* ctx,
+             const KeySet::KeyPart::HashData* hd, long first);
+
     // depending on version we may pack data differently
     KeyParts              added_;
     gu::Vector<KeyPart,5> prev_;
@@ -715,12 +738,13 @@ private:
     int                   ws_ver_;
 
     static gu::RecordSet::CheckType
-    check_type (KeySet::Version ver)
+    check_type (KeySet::Version ver, int const ws_ver)
     {
         switch (ver)
         {
         case KeySet::EMPTY: break; /* Can't create EMPTY KeySetOut */
-        default: return gu::RecordSet::CHECK_MMH128;
+        default: return (ws_ver >= 5 ? gu::RecordSet::CHECK_CRC32C3 :
+                                       gu::RecordSet::CHECK_MMH128);
         }
 
         KeySet::throw_version(ver);
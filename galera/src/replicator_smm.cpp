@@ -175,7 +175,7 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     gcs_as_             (slave_pool_, gcs_, *this, gcache_),
     ist_receiver_       (config_, slave_pool_, args->node_address),
     ist_prepared_       (false),
-    ist_senders_        (gcs_, gcache_),
+    ist_senders_        (config_, gcs_, gcache_),
     wsdb_               (),
     cert_               (config_, service_thd_, gcache_),
 #ifdef HAVE_PSI_INTERFACE
@@ -1269,7 +1269,8 @@ writeset_from_handle (wsrep_po_handle_t& handle,
                 /* key format is not essential since we're not adding keys */
                 KeySet::version(trx_params.key_format_), NULL, 0, 0,
                 trx_params.record_set_ver_,
-                WriteSetNG::MAX_VERSION, DataSet::MAX_VERSION, DataSet::MAX_VERSION,
+                WriteSetNG::Version(trx_params.version_),
+                DataSet::MAX_VERSION, DataSet::MAX_VERSION,
                 trx_params.max_write_set_size_);
 
             handle.opaque = ret;
@@ -1518,6 +1519,12 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
         trx_params_.record_set_ver_ = gu::RecordSet::VER2;
         str_proto_ver_ = 2;
         break;
+    case 10:
+        // Protocol upgrade to use hardware CRC32C for writeset checksums.
+        trx_params_.version_ = 5;
+        trx_params_.record_set_ver_ = gu::RecordSet::VER2;
+        str_proto_ver_ = 2;
+        break;
     default:
         log_fatal << "Configuration change resulted in an unsupported protocol "
             "version: " << proto_ver << ". Can't continue.";
@@ -556,6 +556,7 @@ namespace galera
         } init_ssl_; // initialize global SSL parameters
 
         static int const       MAX_PROTO_VER;
+        static int const       DEFAULT_PROTO_VER; // repl.proto_max default
         /*
          * |--------------------------------------------------------------------|
          * | protocol_version_ | trx version | str_proto_ver_ | record_set_ver_ |
@@ -569,6 +570,7 @@ namespace galera
          * |                 7 |           3 |              2 |               1 |
          * |                 8 |           3 |              2 |               2 |
          * |                 9 |           4 |              2 |               2 |
+         * |                10 |           5 |              2 |               2 |
          * |--------------------------------------------------------------------|
          */
 
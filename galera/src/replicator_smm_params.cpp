@@ -25,13 +25,16 @@ const std::string galera::ReplicatorSMM::Param::key_format =
 const std::string galera::ReplicatorSMM::Param::max_write_set_size =
     common_prefix + "max_ws_size";
 
-int const galera::ReplicatorSMM::MAX_PROTO_VER(9);
+int const galera::ReplicatorSMM::MAX_PROTO_VER(10);
+/* Protocol 10 changes writeset checksums to CRC32C and must be enabled
+ * explicitly by setting repl.proto_max */
+int const galera::ReplicatorSMM::DEFAULT_PROTO_VER(9);
 
 galera::ReplicatorSMM::Defaults::Defaults() : map_()
 {
     map_.insert(Default(Param::base_port, BASE_PORT_DEFAULT));
     map_.insert(Default(Param::base_dir, BASE_DIR_DEFAULT));
-    map_.insert(Default(Param::proto_max,  gu::to_string(MAX_PROTO_VER)));
+    map_.insert(Default(Param::proto_max,  gu::to_string(DEFAULT_PROTO_VER)));
     map_.insert(Default(Param::key_format, "FLAT8"));
     map_.insert(Default(Param::commit_order, "3"));
     map_.insert(Default(Param::causal_read_timeout, "PT30S"));
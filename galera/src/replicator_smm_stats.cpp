@@ -129,6 +129,10 @@ typedef enum status_vars
     STATS_IST_RECEIVE_SEQNO_START,
     STATS_IST_RECEIVE_SEQNO_CURRENT,
     STATS_IST_RECEIVE_SEQNO_END,
+    STATS_IST_SEND_ACTIVE,
+    STATS_IST_SEND_QUEUED,
+    STATS_IST_SEND_BYTES,
+    STATS_IST_SEND_RATE,
     STATS_INCOMING_LIST,
     STATS_MAX
 } StatusVars;
@@ -190,6 +194,10 @@ static const struct wsrep_stats_var wsrep_stats[STATS_MAX + 1] =
     { "ist_receive_seqno_start",  WSREP_VAR_INT64,  { 0 }  },
     { "ist_receive_seqno_current",WSREP_VAR_INT64,  { 0 }  },
     { "ist_receive_seqno_end",    WSREP_VAR_INT64,  { 0 }  },
+    { "ist_send_active",          WSREP_VAR_INT64,  { 0 }  },
+    { "ist_send_queued",          WSREP_VAR_INT64,  { 0 }  },
+    { "ist_send_bytes",           WSREP_VAR_INT64,  { 0 }  },
+    { "ist_send_rate",            WSREP_VAR_INT64,  { 0 }  },
     { "incoming_addresses",       WSREP_VAR_STRING, { 0 }  },
     { 0,                          WSREP_VAR_STRING, { 0 }  }
 };
@@ -334,6 +342,15 @@ galera::ReplicatorSMM::stats_get()
         sv[STATS_IST_RECEIVE_SEQNO_END].value._int64 = 0;
     }
 
+    {
+        long long active, queued, bytes, rate;
+        ist_senders_.get_stats(active, queued, bytes, rate);
+        sv[STATS_IST_SEND_ACTIVE].value._int64 = active;
+        sv[STATS_IST_SEND_QUEUED].value._int64 = queued;
+        sv[STATS_IST_SEND_BYTES ].value._int64 = bytes;
+        sv[STATS_IST_SEND_RATE  ].value._int64 = rate;
+    }
+
     // Get gcs backend status
     gu::Status status;
     gcs_.get_status(status);
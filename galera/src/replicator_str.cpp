@@ -974,14 +974,45 @@ ReplicatorSMM::request_state_transfer (void* recv_ctx,
 void ReplicatorSMM::recv_IST(void* recv_ctx)
 {
     bool first= true;
+    std::vector<TrxHandle*> trxs;
     while (true)
     {
         TrxHandle* trx(0);
-        int err;
         try
         {
-            if ((err = ist_receiver_.recv(&trx)) == 0)
+            int err;
+            try
+            {
+                err = ist_receiver_.recv(trxs, ist::Receiver::recv_batch_max);
+            }
+            catch (gu::Exception& e)
+            {
+                // Transfer was broken and could not be resumed. Write sets
+                // received so far are applied in order, so the state at
+                // the last of them is consistent. Save it, so that after
+                // restart IST is requested from there instead of SST.
+                wsrep_seqno_t const last(ist_receiver_.current_seqno() - 1);
+                apply_monitor_.wait(last);
+                st_.set(state_uuid_, last, safe_to_bootstrap_);
+                log_fatal << "receiving IST failed, node restart required: "
+                          << e.what() << ". State saved at seqno " << last
+                          << ", IST will be resumed from there.";
+                abort();
+            }
+
+            if (err != 0)
+            {
+                // IST completed after applying n transactions where n can be 0.
+                // if recv_IST is called from async_recv then recv_IST may have
+                // return with 0 transaction applied.
+                // If n > 0 then state is marked as unsafe in if loop below.
+                return;
+            }
+
+            for (size_t i(0); i < trxs.size(); ++i)
             {
+                trx = trxs[i];
+
                 // Loop below will recieve and apply IST write-set(s). If apply
                 // fails then we should mark leave the state of server = unsafe
                 // in-order to initiate full SST on restart.
@@ -1008,39 +1039,33 @@ void ReplicatorSMM::recv_IST(void* recv_ctx)
                 }
 
                 assert(trx != 0);
-                TrxHandleLock lock(*trx);
-                // Verify checksum before applying. This is also required
-                // to synchronize with possible background checksum thread.
-                trx->verify_checksum();
-                if (trx->depends_seqno() == -1)
                 {
-                    ApplyOrder ao(*trx);
-                    apply_monitor_.self_cancel(ao);
-                    if (co_mode_ != CommitOrder::BYPASS)
+                    TrxHandleLock lock(*trx);
+                    // Verify checksum before applying. This is also required
+                    // to synchronize with possible background checksum thread.
+                    trx->verify_checksum();
+                    if (trx->depends_seqno() == -1)
                     {
-                        CommitOrder co(*trx, co_mode_);
-                        commit_monitor_.self_cancel(co);
+                        ApplyOrder ao(*trx);
+                        apply_monitor_.self_cancel(ao);
+                        if (co_mode_ != CommitOrder::BYPASS)
+                        {
+                            CommitOrder co(*trx, co_mode_);
+                            commit_monitor_.self_cancel(co);
+                        }
+                    }
+                    else
+                    {
+                        // replicating and certifying stages have been
+                        // processed on donor, just adjust states here
+                        trx->set_state(TrxHandle::S_REPLICATING);
+                        trx->set_state(TrxHandle::S_CERTIFYING);
+                        apply_trx(recv_ctx, trx);
+                        GU_DBUG_SYNC_WAIT("recv_IST_after_apply_trx");
                     }
                 }
-                else
-                {
-                    // replicating and certifying stages have been
-                    // processed on donor, just adjust states here
-                    trx->set_state(TrxHandle::S_REPLICATING);
-                    trx->set_state(TrxHandle::S_CERTIFYING);
-                    apply_trx(recv_ctx, trx);
-                    GU_DBUG_SYNC_WAIT("recv_IST_after_apply_trx");
-                }
-            }
-            else
-            {
-                // IST completed after applying n transactions where n can be 0.
-                // if recv_IST is called from async_recv then recv_IST may have
-                // return with 0 transaction applied.
-		// If n > 0 then state is marked as unsafe in if loop above.
-                return;
+                trx->unref();
             }
-            trx->unref();
         }
         catch (gu::Exception& e)
         {
@@ -231,6 +231,7 @@ galera::TrxHandle::unserialize(const gu::byte_t* const buf, size_t const buflen,
             break;
         case 3:
         case 4:
+        case 5:
             write_set_in_.read_buf (buf, buflen);
             write_set_flags_ = wsng_flags_to_trx_flags(write_set_in_.flags());
             source_id_       = write_set_in_.source_id();
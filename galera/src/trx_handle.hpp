@@ -385,6 +385,34 @@ namespace galera
             }
         }
 
+        void append_keys(int                const proto_ver,
+                         const wsrep_key_t* const keys,
+                         size_t             const keys_num,
+                         wsrep_key_type_t   const type,
+                         bool               const copy)
+        {
+            if (proto_ver != version_)
+            {
+                gu_throw_error(EINVAL) << "key version '" << proto_ver
+                                       << "' does not match to trx version' "
+                                       << version_ << "'";
+            }
+
+            if (new_version())
+            {
+                write_set_out().append_keys(keys, keys_num, type, copy);
+            }
+            else
+            {
+                for (size_t i(0); i < keys_num; ++i)
+                {
+                    KeyData const k(proto_ver, keys[i].key_parts,
+                                    keys[i].key_parts_num, type, copy);
+                    write_set_.append_key(k);
+                }
+            }
+        }
+
         void append_data(const void* data, const size_t data_len,
                          wsrep_data_type_t type, bool store)
         {
@@ -38,11 +38,12 @@ namespace galera
         enum Version
         {
             VER3 = 3,
-            VER4
+            VER4,
+            VER5  /* hardware CRC checksums for record sets */
         };
 
         /* Max header version that we can understand */
-        static Version const MAX_VERSION = VER4;
+        static Version const MAX_VERSION = VER5;
 
         /* Parses beginning of the header to detect writeset version and
          * returns it as raw integer for backward compatibility
@@ -89,6 +90,7 @@ namespace galera
             {
             case VER3: return VER3;
             case VER4: return VER4;
+            case VER5: return VER5;
             }
 
             gu_throw_error (EPROTO) << "Unrecognized writeset version: " << v;
@@ -134,6 +136,7 @@ namespace galera
                 {
                 case VER3:
                 case VER4:
+                case VER5:
                 {
                     GU_COMPILE_ASSERT(0 == (V3_SIZE % GU_MIN_ALIGNMENT),
                                       unaligned_header_size);
@@ -503,10 +506,12 @@ namespace galera
                     kbn_, kver, rsv, ver),
             /* 5/8 of reserved goes to data set  */
             dbn_   (base_name_),
-            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver, rsv),
+            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver, rsv,
+                    ver),
             /* 2/8 of reserved goes to unordered set  */
             ubn_   (base_name_),
-            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,rsv),
+            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,rsv,
+                    ver),
             /* annotation set is not allocated unless requested */
             abn_   (base_name_),
             annt_  (NULL),
@@ -524,6 +529,12 @@ namespace galera
             left_ -= keys_.append(k);
         }
 
+        void append_keys(const wsrep_key_t* keys, size_t keys_num,
+                         wsrep_key_type_t type, bool copy)
+        {
+            left_ -= keys_.append(keys, keys_num, type, copy);
+        }
+
         void append_data(const void* data, size_t data_len, bool store)
         {
             left_ -= data_.append(data, data_len, store);
@@ -540,7 +551,8 @@ namespace galera
             {
                 annt_ = new DataSetOut(NULL, 0, abn_, DataSet::MAX_VERSION,
                                        // use the same version as the dataset
-                                       data_.gu::RecordSet::version());
+                                       data_.gu::RecordSet::version(),
+                                       header_.version());
                 left_ -= annt_->size();
             }
 
@@ -760,15 +760,8 @@ wsrep_status_t galera_append_key(wsrep_t*           const gh,
     try
     {
         TrxHandleLock lock(*trx);
-        for (size_t i(0); i < keys_num; ++i)
-        {
-            galera::KeyData k (repl->trx_proto_ver(),
-                               keys[i].key_parts,
-                               keys[i].key_parts_num,
-                               key_type,
-                               copy);
-            trx->append_key(k);
-        }
+        trx->append_keys(repl->trx_proto_ver(), keys, keys_num, key_type,
+                         copy);
         retval = WSREP_OK;
     }
     catch (std::exception& e)
@@ -899,13 +892,8 @@ wsrep_status_t galera_to_execute_start(wsrep_t*                const gh,
     try
     {
         TrxHandleLock lock(*trx);
-        for (size_t i(0); i < keys_num; ++i)
-        {
-            galera::KeyData k(repl->trx_proto_ver(),
-                              keys[i].key_parts,
-                              keys[i].key_parts_num, WSREP_KEY_EXCLUSIVE,false);
-            trx->append_key(k);
-        }
+        trx->append_keys(repl->trx_proto_ver(), keys, keys_num,
+                         WSREP_KEY_EXCLUSIVE, false);
 
         append_data_array(trx, data, count, WSREP_DATA_ORDERED, false);
 
@@ -104,7 +104,7 @@ private:
 };
 
 
-static void test_ver(gu::RecordSet::Version const rsv)
+static void test_ver(gu::RecordSet::Version const rsv, int const ws_ver)
 {
     int const alignment
         (rsv >= gu::RecordSet::VER2 ? gu::RecordSet::VER2_ALIGNMENT : 1);
@@ -129,7 +129,7 @@ static void test_ver(gu::RecordSet::Version const rsv)
     union { gu::byte_t buf[1024]; gu_word_t align; } reserved;
     TestBaseName str("data_set_test");
     DataSetOut dset_out(reserved.buf, sizeof(reserved.buf), str, DataSet::VER1,
-                        rsv);
+                        rsv, ws_ver);
 
     size_t offset(dset_out.size());
 
@@ -214,6 +214,9 @@ static void test_ver(gu::RecordSet::Version const rsv)
 
     ck_assert(dset_in.size()  == dset_out.size());
     ck_assert(dset_in.count() == dset_out.count());
+    ck_assert(dset_in.check_type() == (ws_ver >= 5 ?
+                                       gu::RecordSet::CHECK_CRC32C3 :
+                                       gu::RecordSet::CHECK_MMH128));
     try { dset_in.checksum(); }
     catch(gu::Exception& e) { ck_abort_msg("%s", e.what()); }
 
@@ -245,14 +248,20 @@ static void test_ver(gu::RecordSet::Version const rsv)
 #ifndef GALERA_ONLY_ALIGNED
 START_TEST (ver1)
 {
-    test_ver(gu::RecordSet::VER1);
+    test_ver(gu::RecordSet::VER1, 3);
 }
 END_TEST
 #endif /* GALERA_ONLY_ALIGNED */
 
 START_TEST (ver2)
 {
-    test_ver(gu::RecordSet::VER2);
+    test_ver(gu::RecordSet::VER2, 4);
+}
+END_TEST
+
+START_TEST (ver2_crc)
+{
+    test_ver(gu::RecordSet::VER2, 5);
 }
 END_TEST
 
@@ -263,6 +272,7 @@ Suite* data_set_suite ()
     tcase_add_test (t, ver1);
 #endif
     tcase_add_test (t, ver2);
+    tcase_add_test (t, ver2_crc);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("DataSet");
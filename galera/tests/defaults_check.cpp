@@ -34,6 +34,7 @@ static const char* Defaults[] =
 #ifdef GU_DBUG_ON
     "dbug",                        "",
 #endif
+    "evs.aggregate_delay",         "PT0S",
     "evs.auto_evict",              "0",
     "evs.causal_keepalive_period", "PT1S",
     "evs.debug_log_mask",          "0x1",
@@ -66,12 +67,16 @@ static const char* Defaults[] =
     "gcache.recover",              "no",
     "gcache.size",                 "128M",
     "gcomm.thread_prio",           "",
+    "gcs.batch_window",            "PT0S",
+    "gcs.defrag_threads",          "0",
     "gcs.fc_debug",                "0",
     "gcs.fc_factor",               "1",
     "gcs.fc_limit",                "100",
     "gcs.fc_master_slave",         "no",
+    "gcs.max_batch_len",           "1",
     "gcs.max_packet_size",         "64500",
     "gcs.max_throttle",            "0.25",
+    "gcs.proto_max",               "0",
 #if (GU_WORDSIZE == 32)
     "gcs.recv_q_hard_limit",       "2147483647",
 #elif (GU_WORDSIZE == 64)
@@ -84,9 +89,18 @@ static const char* Defaults[] =
     "gmcast.mcast_ttl",            "1",
     "gmcast.peer_timeout",         "PT3S",
     "gmcast.segment",              "0",
+    "gmcast.segment_fanout",       "0",
+    "gmcast.segment_relay_rtt",    "false",
     "gmcast.time_wait",            "PT5S",
     "gmcast.version",              "0",
+    "ist.compression",             "0",
+    "ist.max_senders",             "0",
 //  "ist.recv_addr",               no default,
+    "ist.resume_timeout",          "PT10S",
+    "ist.send_rate",               "0",
+    "ist.send_rate_total",         "0",
+    "ist.streams",                 "1",
+    "ist.zero_copy",               "false",
     "pc.announce_timeout",         "PT3S",
     "pc.checksum",                 "false",
     "pc.ignore_quorum",            "false",
@@ -99,6 +113,7 @@ static const char* Defaults[] =
     "pc.wait_prim_timeout",        "PT30S",
     "pc.weight",                   "1",
     "protonet.backend",            "asio",
+    "protonet.io_threads",         "0",
     "protonet.version",            "0",
     "repl.causal_read_timeout",    "PT30S",
     "repl.commit_order",           "3",
@@ -21,6 +21,7 @@ extern Suite* service_thd_suite();
 extern Suite* ist_suite();
 extern Suite* saved_state_suite();
 extern Suite* defaults_suite();
+extern Suite* replicator_smm_suite();
 
 static suite_creator_t suites[] =
 {
@@ -33,11 +34,13 @@ static suite_creator_t suites[] =
     ist_suite,
     saved_state_suite,
     defaults_suite,
+    replicator_smm_suite,
     0
 };
 
 extern "C" {
 #include <galerautils.h>
+#include <gu_crc32c.h>
 }
 
 #define LOG_FILE "galera_check.log"
@@ -55,6 +58,7 @@ int main(int argc, char* argv[])
     }
 
     gu_conf_debug_on();
+    gu_crc32c_configure();
 
     int failed = 0;
 
@@ -0,0 +1,330 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+/**
+ * In-process IST throughput benchmark.
+ *
+ * Populates GCache with synthetic writesets, then transfers them from
+ * ist::Sender to ist::Receiver over loopback and hands them to consumer
+ * threads which only release them. The result reflects the cost of reading
+ * GCache, the wire protocol and the receiver hand-off, not of applying.
+ *
+ * Reports writesets/s and MB/s for each payload size.
+ */
+
+#include "ist.hpp"
+#include "trx_handle.hpp"
+#include "GCache.hpp"
+#include "replicator_smm.hpp"
+
+#include <gu_logger.hpp>
+#include <gu_time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <getopt.h>
+#include <unistd.h>
+
+struct bench_params
+{
+    size_t              count;     // max writesets per run
+    size_t              max_bytes; // max payload bytes per run
+    std::vector<size_t> sizes;     // payload sizes to run with
+    int                 consumers; // consumer threads
+    size_t              batch;     // writesets per Receiver::recv() call
+    std::string         options;   // extra provider options
+
+    bench_params()
+        :
+        count    (200000),
+        max_bytes(256 << 20),
+        sizes    (),
+        consumers(4),
+        batch    (galera::ist::Receiver::recv_batch_max),
+        options  ()
+    {
+        sizes.push_back(100);
+        sizes.push_back(65536);
+    }
+};
+
+// IST protocol version and the matching writeset version
+static int const ist_version(5);
+static int const trx_version(3);
+
+struct consumer_args
+{
+    galera::ist::Receiver* receiver;
+    size_t                 batch;
+    size_t                 received;
+};
+
+extern "C" void* consumer_thread(void* arg)
+{
+    consumer_args* const ca(static_cast<consumer_args*>(arg));
+    std::vector<galera::TrxHandle*> trxs;
+
+    try
+    {
+        while (ca->receiver->recv(trxs, ca->batch) == 0)
+        {
+            for (size_t i(0); i < trxs.size(); ++i) trxs[i]->unref();
+            ca->received += trxs.size();
+        }
+    }
+    catch (gu::Exception& e)
+    {
+        log_error << "IST consumer failed: " << e.what();
+    }
+
+    return 0;
+}
+
+struct sender_args
+{
+    const gu::Config* conf;
+    gcache::GCache*   gcache;
+    std::string       peer;
+    wsrep_seqno_t     last;
+};
+
+extern "C" void* sender_thread(void* arg)
+{
+    sender_args* const sa(static_cast<sender_args*>(arg));
+
+    try
+    {
+        sa->gcache->seqno_lock(1); // unlocked in Sender destructor
+        galera::ist::Sender sender(*sa->conf, *sa->gcache, sa->peer,
+                                   ist_version);
+        sender.send(1, sa->last);
+    }
+    catch (gu::Exception& e)
+    {
+        log_error << "IST sender failed: " << e.what();
+    }
+
+    return 0;
+}
+
+static void
+populate(gcache::GCache& gcache, size_t const count, size_t const size)
+{
+    galera::TrxHandle::LocalPool lp(galera::TrxHandle::LOCAL_STORAGE_SIZE(),
+                                    4, "ist_bench");
+    galera::TrxHandle::Params const trx_params("", trx_version,
+                                               galera::KeySet::MAX_VERSION);
+    wsrep_uuid_t uuid;
+    gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&uuid), 0, 0);
+
+    std::vector<char> data(size);
+    for (size_t i(0); i < data.size(); ++i) data[i] = char(i);
+
+    for (size_t i(1); i <= count; ++i)
+    {
+        galera::TrxHandle* const trx(
+            galera::TrxHandle::New(lp, trx_params, uuid, 1, i));
+
+        uint64_t const k(i);
+        const wsrep_buf_t key[2] = {
+            { "ist_bench", 9 },
+            { &k, sizeof(k) }
+        };
+        trx->append_key(galera::KeyData(trx_version, key, 2,
+                                        WSREP_KEY_EXCLUSIVE, true));
+        trx->append_data(&data[0], data.size(), WSREP_DATA_ORDERED, true);
+
+        galera::WriteSetNG::GatherVector bufs;
+        ssize_t const trx_size(trx->write_set_out().gather(trx->source_id(),
+                                                           trx->conn_id(),
+                                                           trx->trx_id(),
+                                                           bufs));
+        trx->set_last_seen_seqno(i - 1);
+        gu::byte_t* const ptr(static_cast<gu::byte_t*>(gcache.malloc(trx_size)));
+
+        gu::byte_t* p(ptr);
+        for (size_t b(0); b < bufs->size(); ++b)
+        {
+            ::memcpy(p, bufs[b].ptr, bufs[b].size); p += bufs[b].size;
+        }
+
+        gu::Buf ws_buf = { ptr, trx_size };
+        galera::WriteSetIn wsi(ws_buf);
+        wsi.set_seqno(i, 1);
+
+        gcache.seqno_assign(ptr, i, i - 1);
+        trx->unref();
+    }
+}
+
+// returns false if not all writesets were received
+static bool
+run(const bench_params& params, size_t const size)
+{
+    size_t const count(std::max<size_t>(
+                           1, std::min(params.count, params.max_bytes / size)));
+
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    if (!params.options.empty()) conf.parse(params.options);
+
+    std::string const gcache_file("ist_bench.cache");
+    std::ostringstream gcache_size;
+    gcache_size << (count * (size + 256) + (16 << 20));
+    conf.set("gcache.name", gcache_file);
+    conf.set("gcache.size", gcache_size.str());
+    conf.set(galera::ist::Receiver::RECV_ADDR, "tcp://127.0.0.1:0");
+
+    gcache::GCache* const gcache(new gcache::GCache(conf, "."));
+    populate(*gcache, count, size);
+
+    galera::TrxHandle::SlavePool sp(sizeof(galera::TrxHandle), 1024,
+                                    "ist_bench");
+    galera::ist::Receiver receiver(conf, sp, 0);
+
+    sender_args sa;
+    sa.conf   = &conf;
+    sa.gcache = gcache;
+    sa.peer   = receiver.prepare(1, count, ist_version);
+    sa.last   = count;
+
+    std::vector<consumer_args> cas(params.consumers);
+    std::vector<gu_thread_t>   threads(params.consumers);
+    for (size_t i(0); i < cas.size(); ++i)
+    {
+        cas[i].receiver = &receiver;
+        cas[i].batch    = params.batch;
+        cas[i].received = 0;
+        gu_thread_create(&threads[i], NULL, consumer_thread, &cas[i]);
+    }
+    receiver.ready();
+
+    long long const start(gu_time_monotonic());
+
+    gu_thread_t sender;
+    gu_thread_create(&sender, NULL, sender_thread, &sa);
+
+    size_t received(0);
+    for (size_t i(0); i < threads.size(); ++i)
+    {
+        gu_thread_join(threads[i], NULL);
+        received += cas[i].received;
+    }
+
+    long long const duration(gu_time_monotonic() - start);
+
+    gu_thread_join(sender, NULL);
+    receiver.finished();
+    delete gcache;
+    ::unlink(gcache_file.c_str());
+
+    double const secs(duration * 1.0e-9);
+    std::cout << std::setw(8) << size << std::setw(10) << received
+              << std::fixed << std::setprecision(3)
+              << std::setw(10) << secs
+              << std::setprecision(0)
+              << std::setw(12) << received / secs
+              << std::setprecision(1)
+              << std::setw(10) << received * double(size) / secs / (1 << 20)
+              << std::endl;
+
+    return (received == count);
+}
+
+static void
+usage(const char* const name)
+{
+    bench_params const d;
+
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "  -n, --count=N      max writesets per run (" << d.count << ")\n"
+        << "  -m, --max-bytes=B  max payload bytes per run (" << d.max_bytes
+        << ")\n"
+        << "  -s, --sizes=B,...  payload sizes (100,65536)\n"
+        << "  -c, --consumers=N  consumer threads (" << d.consumers << ")\n"
+        << "  -b, --batch=N      writesets per receive call (" << d.batch
+        << ")\n"
+        << "  -O, --options=STR  extra provider options, e.g. "
+        << "\"ist.streams=4\"\n";
+}
+
+static bool
+parse_sizes(const char* const str, std::vector<size_t>& sizes)
+{
+    sizes.clear();
+    std::istringstream is(str);
+    std::string s;
+    while (std::getline(is, s, ','))
+    {
+        long const size(::atol(s.c_str()));
+        if (size < 1) return false;
+        sizes.push_back(size);
+    }
+    return !sizes.empty();
+}
+
+int main(int argc, char* argv[])
+{
+    bench_params params;
+
+    static struct option const long_opts[] = {
+        { "count",     required_argument, 0, 'n' },
+        { "max-bytes", required_argument, 0, 'm' },
+        { "sizes",     required_argument, 0, 's' },
+        { "consumers", required_argument, 0, 'c' },
+        { "batch",     required_argument, 0, 'b' },
+        { "options",   required_argument, 0, 'O' },
+        { 0, 0, 0, 0 }
+    };
+
+    int opt;
+    bool ok(true);
+    while ((opt = getopt_long(argc, argv, "n:m:s:c:b:O:", long_opts, 0)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': params.count     = ::atol(optarg); break;
+        case 'm': params.max_bytes = ::atol(optarg); break;
+        case 's': ok = parse_sizes(optarg, params.sizes) && ok; break;
+        case 'c': params.consumers = ::atoi(optarg); break;
+        case 'b': params.batch     = ::atol(optarg); break;
+        case 'O': params.options   = optarg; break;
+        default:  ok = false;
+        }
+    }
+
+    if (!ok || params.count < 1 || params.max_bytes < 1 ||
+        params.consumers < 1 || params.batch < 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::setw(8) << "size" << std::setw(10) << "writesets"
+              << std::setw(10) << "seconds" << std::setw(12) << "ws/s"
+              << std::setw(10) << "MB/s" << std::endl;
+
+    for (size_t i(0); ok && i < params.sizes.size(); ++i)
+    {
+        try
+        {
+            ok = run(params, params.sizes[i]);
+        }
+        catch (gu::Exception& e)
+        {
+            std::cerr << "Benchmark failed: " << e.what() << '\n';
+            ok = false;
+        }
+    }
+
+    return (ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
@@ -5,14 +5,22 @@
 
 #include "ist.hpp"
 #include "ist_proto.hpp"
+#include "ist_zero_copy.hpp"
 #include "trx_handle.hpp"
 #include "uuid.hpp"
 #include "monitor.hpp"
 #include "GCache.hpp"
 #include "gu_arch.h"
 #include "replicator_smm.hpp"
+#include "gu_uri.hpp"
 #include <check.h>
 
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
 using namespace galera;
 
 // Message tests
@@ -92,16 +100,25 @@ struct sender_args
     wsrep_seqno_t first_;
     wsrep_seqno_t last_;
     int version_;
+    int streams_;
+    bool zero_copy_;
+    int compression_;
+    long long send_rate_;
     sender_args(gcache::GCache& gcache,
                 const std::string& peer,
                 wsrep_seqno_t first, wsrep_seqno_t last,
-                int version)
+                int version, int streams = 1, bool zero_copy = false,
+                int compression = 0, long long send_rate = 0)
         :
         gcache_(gcache),
         peer_  (peer),
         first_ (first),
         last_  (last),
-        version_(version)
+        version_(version),
+        streams_(streams),
+        zero_copy_(zero_copy),
+        compression_(compression),
+        send_rate_(send_rate)
     { }
 };
 
@@ -114,17 +131,20 @@ struct receiver_args
     size_t        n_receivers_;
     TrxHandle::SlavePool& trx_pool_;
     int           version_;
+    int           streams_;
 
     receiver_args(const std::string listen_addr,
                   wsrep_seqno_t first, wsrep_seqno_t last,
-                  size_t n_receivers, TrxHandle::SlavePool& sp, int version)
+                  size_t n_receivers, TrxHandle::SlavePool& sp, int version,
+                  int streams = 1)
         :
         listen_addr_(listen_addr),
         first_      (first),
         last_       (last),
         n_receivers_(n_receivers),
         trx_pool_   (sp),
-        version_    (version)
+        version_    (version),
+        streams_    (streams)
     { }
 };
 
@@ -152,6 +172,10 @@ extern "C" void* sender_thd(void* arg)
 
     gu::Config conf;
     galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    conf.set("ist.streams", sargs->streams_);
+    conf.set("ist.zero_copy", sargs->zero_copy_);
+    conf.set("ist.compression", sargs->compression_);
+    conf.set("ist.send_rate", sargs->send_rate_);
     gu_barrier_wait(&start_barrier);
     sargs->gcache_.seqno_lock(sargs->first_); // unlocked in sender dtor
     galera::ist::Sender sender(conf, sargs->gcache_, sargs->peer_,
@@ -197,6 +221,7 @@ extern "C" void* receiver_thd(void* arg)
     mark_point();
 
     conf.set(galera::ist::Receiver::RECV_ADDR, rargs->listen_addr_);
+    conf.set("ist.streams", rargs->streams_);
     galera::ist::Receiver receiver(conf, rargs->trx_pool_, 0);
     rargs->listen_addr_ = receiver.prepare(rargs->first_, rargs->last_,
                                            rargs->version_);
@@ -245,34 +270,22 @@ static int select_trx_version(int protocol_version)
 }
 
 
-static void test_ist_common(int const version)
+// populates gcache with write sets 1..n_trx, all independent, PA range
+// recorded in write set header is capped to pa_range_cap if it is given
+static void populate_gcache(gcache::GCache& gcache, int const trx_version,
+                            size_t const n_trx, size_t const data_size,
+                            int const pa_range_cap = 0)
 {
     using galera::KeyData;
     using galera::TrxHandle;
-    using galera::KeyOS;
 
     TrxHandle::LocalPool lp(TrxHandle::LOCAL_STORAGE_SIZE(), 4, "ist_common");
-    TrxHandle::SlavePool sp(sizeof(TrxHandle), 4, "ist_common");
-
-    int const trx_version(select_trx_version(version));
     TrxHandle::Params const trx_params("", trx_version,
                                        galera::KeySet::MAX_VERSION);
-    gu::Config conf;
-    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
-    std::string gcache_file("ist_check.cache");
-    conf.set("gcache.name", gcache_file);
-    conf.set("gcache.size", "1M");
-    std::string dir(".");
-    std::string receiver_addr("tcp://127.0.0.1:0");
     wsrep_uuid_t uuid;
     gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&uuid), 0, 0);
 
-    gcache::GCache* gcache = new gcache::GCache(conf, dir);
-
-    mark_point();
-
-    // populate gcache
-    for (size_t i(1); i <= 10; ++i)
+    for (size_t i(1); i <= n_trx; ++i)
     {
         TrxHandle* trx(TrxHandle::New(lp, trx_params, uuid, 1234+i, 5678+i));
 
@@ -282,10 +295,13 @@ static void test_ist_common(int const version)
         };
 
         trx->append_key(KeyData(trx_version, key, 2, WSREP_KEY_EXCLUSIVE,true));
-        trx->append_data("bar", 3, WSREP_DATA_ORDERED, true);
+        std::vector<char> const data(data_size, 'a' + i % 26);
+        trx->append_data(&data[0], data.size(), WSREP_DATA_ORDERED, true);
         assert (i > 0);
         int last_seen(i - 1);
         int pa_range(i);
+        int const ws_pa_range(pa_range_cap > 0 && pa_range > pa_range_cap ?
+                              pa_range_cap : pa_range);
 
         gu::byte_t* ptr(0);
 
@@ -293,7 +309,7 @@ static void test_ist_common(int const version)
         {
             trx->set_last_seen_seqno(last_seen);
             size_t trx_size(trx->serial_size());
-            ptr = static_cast<gu::byte_t*>(gcache->malloc(trx_size));
+            ptr = static_cast<gu::byte_t*>(gcache.malloc(trx_size));
             trx->serialize(ptr, trx_size, 0);
         }
         else
@@ -304,7 +320,7 @@ static void test_ist_common(int const version)
                                                          trx->trx_id(),
                                                          bufs));
             trx->set_last_seen_seqno(last_seen);
-            ptr = static_cast<gu::byte_t*>(gcache->malloc(trx_size));
+            ptr = static_cast<gu::byte_t*>(gcache.malloc(trx_size));
 
             /* concatenate buffer vector */
             gu::byte_t* p(ptr);
@@ -318,19 +334,51 @@ static void test_ist_common(int const version)
             galera::WriteSetIn wsi(ws_buf);
             assert (wsi.last_seen() == last_seen);
             assert (wsi.pa_range()  == 0);
-            wsi.set_seqno(i, pa_range);
+            wsi.set_seqno(i, ws_pa_range);
             assert (wsi.seqno()     == int64_t(i));
-            assert (wsi.pa_range()  == pa_range);
+            assert (wsi.pa_range()  == ws_pa_range);
         }
 
-        gcache->seqno_assign(ptr, i, i - pa_range);
+        gcache.seqno_assign(ptr, i, i - pa_range);
         trx->unref();
     }
+}
+
+
+static void test_ist_common(int const version,
+                            int const sender_streams   = 1,
+                            int const receiver_streams = 1,
+                            size_t const n_trx         = 10,
+                            bool const zero_copy       = false,
+                            size_t const data_size     = 3,
+                            int const compression      = 0,
+                            long long const send_rate  = 0)
+{
+    using galera::TrxHandle;
+
+    TrxHandle::SlavePool sp(sizeof(TrxHandle), 4, "ist_common");
+
+    int const trx_version(select_trx_version(version));
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    std::string gcache_file("ist_check.cache");
+    conf.set("gcache.name", gcache_file);
+    conf.set("gcache.size", "1M");
+    std::string dir(".");
+    std::string receiver_addr("tcp://127.0.0.1:0");
+
+    gcache::GCache* gcache = new gcache::GCache(conf, dir);
+
+    mark_point();
+
+    populate_gcache(*gcache, trx_version, n_trx, data_size);
 
     mark_point();
 
-    receiver_args rargs(receiver_addr, 1, 10, 1, sp, version);
-    sender_args sargs(*gcache, rargs.listen_addr_, 1, 10, version);
+    receiver_args rargs(receiver_addr, 1, n_trx, 1, sp, version,
+                        receiver_streams);
+    sender_args sargs(*gcache, rargs.listen_addr_, 1, n_trx, version,
+                      sender_streams, zero_copy, compression, send_rate);
 
     gu_barrier_init(&start_barrier, 0, 1 + 1 + rargs.n_receivers_);
 
@@ -387,6 +435,564 @@ START_TEST(test_ist_v5)
 }
 END_TEST
 
+// sender uses the smaller of stream counts of sender and receiver
+START_TEST(test_ist_streams)
+{
+    test_ist_common(5, 4, 3, 100);
+}
+END_TEST
+
+// payloads above zero-copy threshold, over one and two streams
+START_TEST(test_ist_zero_copy)
+{
+    test_ist_common(5, 1, 1, 20, true, 32768);
+    test_ist_common(5, 2, 2, 20, true, 32768);
+}
+END_TEST
+
+// payload stuck in the send queue of a stalled connection is released
+// only after the connection is aborted
+START_TEST(test_ist_zero_copy_abort)
+{
+    asio::io_service io_service;
+    asio::ip::tcp::acceptor acceptor(io_service);
+    asio::ip::tcp::endpoint const any(
+        asio::ip::address::from_string("127.0.0.1"), 0);
+    acceptor.open(any.protocol());
+    // receive window is inherited by accepted socket, keep it small
+    acceptor.set_option(asio::socket_base::receive_buffer_size(4096));
+    acceptor.bind(any);
+    acceptor.listen();
+
+    asio::ip::tcp::socket sender(io_service);
+    asio::ip::tcp::socket receiver(io_service);
+    sender.connect(acceptor.local_endpoint());
+    acceptor.accept(receiver);
+    sender.set_option(asio::socket_base::send_buffer_size(1 << 20));
+
+    galera::ist::ZeroCopy zc(sender);
+    if (zc.enabled() == false)
+    {
+        log_info << "zero-copy not supported, skipping";
+        return;
+    }
+
+    // receiver never reads, so most of the payload stays queued
+    std::vector<gu::byte_t> const header(16, 0);
+    std::vector<gu::byte_t> const payload(1 << 16, 0xab);
+    gu::array<asio::const_buffer, 3>::type cbs;
+    cbs[0] = asio::const_buffer(&header[0], header.size());
+    cbs[1] = asio::const_buffer(&payload[0], payload.size());
+    cbs[2] = asio::const_buffer(&payload[0], payload.size());
+    ck_assert(zc.send(cbs) == header.size() + 2*payload.size());
+
+    ck_assert(zc.wait(100) == false);
+    zc.abort();
+    ck_assert(zc.wait(1000) == true);
+}
+END_TEST
+
+// compressed batches with write sets smaller and larger than batch size
+START_TEST(test_ist_compression)
+{
+    test_ist_common(5, 1, 1, 100, false, 1000, 1);
+    test_ist_common(5, 2, 2, 100, false, 1000, 6);
+    test_ist_common(5, 1, 1, 10, false, 100000, 1);
+}
+END_TEST
+
+// receiver does not offer multiple streams
+START_TEST(test_ist_streams_single)
+{
+    test_ist_common(5, 4, 1, 100);
+}
+END_TEST
+
+// Parallel apply tests
+
+struct parallel_consumer_args
+{
+    galera::ist::Receiver&     receiver_;
+    galera::Monitor<TestOrder> monitor_;
+    gu::Mutex                  mutex_;
+    size_t                     received_;
+    size_t                     batches_;
+
+    parallel_consumer_args(galera::ist::Receiver& receiver)
+        :
+        receiver_(receiver),
+#ifdef HAVE_PSI_INTERFACE
+        monitor_ (WSREP_PFS_INSTR_TAG_IST_RECEIVER_MONITOR_MUTEX,
+                  WSREP_PFS_INSTR_TAG_IST_RECEIVER_MONITOR_CONDVAR),
+#else
+        monitor_ (),
+#endif /* HAVE_PSI_INTERFACE */
+        mutex_   (),
+        received_(0),
+        batches_ (0)
+    { }
+};
+
+extern "C" void* parallel_consumer_thd(void* arg)
+{
+    parallel_consumer_args* cargs(
+        reinterpret_cast<parallel_consumer_args*>(arg));
+
+    std::vector<galera::TrxHandle*> trxs;
+    while (cargs->receiver_.recv(trxs, galera::ist::Receiver::recv_batch_max)
+           == 0)
+    {
+        for (size_t i(0); i < trxs.size(); ++i)
+        {
+            // dependency recorded by donor, not the one in write set
+            ck_assert_msg(trxs[i]->depends_seqno() == 0,
+                          "trx %lld depends on %lld",
+                          (long long)trxs[i]->global_seqno(),
+                          (long long)trxs[i]->depends_seqno());
+            TestOrder to(*trxs[i]);
+            cargs->monitor_.enter(to);
+            usleep(100);
+            cargs->monitor_.leave(to);
+            trxs[i]->unref();
+        }
+        gu::Lock lock(cargs->mutex_);
+        cargs->received_ += trxs.size();
+        ++cargs->batches_;
+    }
+    return 0;
+}
+
+// write sets are independent according to donor, but their headers say
+// that each depends on the previous one, consumers must not wait for
+// each other
+START_TEST(test_ist_parallel)
+{
+    int const    version(5);
+    size_t const n_trx(1000);
+    size_t const n_consumers(4);
+
+    galera::TrxHandle::SlavePool sp(sizeof(galera::TrxHandle), 4,
+                                    "ist_parallel");
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    conf.set("gcache.name", "ist_check.cache");
+    conf.set("gcache.size", "1M");
+    gcache::GCache* const gcache(new gcache::GCache(conf, "."));
+    populate_gcache(*gcache, select_trx_version(version), n_trx, 3, 1);
+
+    gu::Config rconf;
+    galera::ReplicatorSMM::InitConfig(rconf, NULL, NULL);
+    rconf.set(galera::ist::Receiver::RECV_ADDR, "tcp://127.0.0.1:0");
+    galera::ist::Receiver receiver(rconf, sp, 0);
+    std::string const addr(receiver.prepare(1, n_trx, version));
+
+    parallel_consumer_args cargs(receiver);
+    cargs.monitor_.set_initial_position(0);
+    std::vector<gu_thread_t> consumers(n_consumers);
+    for (size_t i(0); i < consumers.size(); ++i)
+    {
+        gu_thread_create(&consumers[i], 0, &parallel_consumer_thd, &cargs);
+    }
+    receiver.ready();
+
+    gcache->seqno_lock(1);
+    {
+        galera::ist::Sender sender(conf, *gcache, addr, version);
+        sender.send(1, n_trx);
+    }
+
+    for (size_t i(0); i < consumers.size(); ++i)
+    {
+        gu_thread_join(consumers[i], 0);
+    }
+
+    ck_assert(cargs.received_ == n_trx);
+    ck_assert(receiver.finished() == wsrep_seqno_t(n_trx));
+    log_info << "IST parallel: " << n_trx << " write sets in "
+             << cargs.batches_ << " batches";
+
+    delete gcache;
+    ::unlink("ist_check.cache");
+}
+END_TEST
+
+// Rate limiting tests
+
+static double shaper_consume(galera::ist::Shaper& shaper, size_t const len,
+                             int const times)
+{
+    gu::datetime::Date const start(gu::datetime::Date::monotonic());
+    for (int i(0); i < times; ++i) shaper.consume(len);
+    return double((gu::datetime::Date::monotonic() - start).get_nsecs())
+        / gu::datetime::Sec;
+}
+
+START_TEST(test_ist_shaper)
+{
+    // 500KB at 1MB/s, 100KB of it fits in the initial burst
+    galera::ist::Shaper limited(1 << 20);
+    double secs(shaper_consume(limited, 50 << 10, 10));
+    ck_assert_msg(secs > 0.3 && secs < 2.0, "limited: %f s", secs);
+    ck_assert(limited.bytes() == 500 << 10);
+
+    // the same limit inherited from parent, which counts bytes of both
+    galera::ist::Shaper total(1 << 20);
+    galera::ist::Shaper child(0, &total);
+    secs = shaper_consume(child, 50 << 10, 10);
+    ck_assert_msg(secs > 0.3 && secs < 2.0, "total: %f s", secs);
+    ck_assert(total.bytes() == 500 << 10);
+    ck_assert(child.bytes() == 500 << 10);
+
+    // unlimited does not wait
+    galera::ist::Shaper unlimited(0);
+    secs = shaper_consume(unlimited, 1 << 20, 100);
+    ck_assert_msg(secs < 0.5, "unlimited: %f s", secs);
+
+    limited.interrupt();
+    try
+    {
+        limited.consume(1);
+        ck_abort_msg("consume() did not throw after interrupt()");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert_msg(e.get_errno() == EINTR, "errno %d", e.get_errno());
+    }
+}
+END_TEST
+
+// about 200KB at 200KB/s over one and two streams
+START_TEST(test_ist_send_rate)
+{
+    for (int streams(1); streams <= 2; ++streams)
+    {
+        gu::datetime::Date const start(gu::datetime::Date::monotonic());
+        test_ist_common(5, streams, streams, 20, false, 10000, 0, 200 << 10);
+        double const secs(
+            double((gu::datetime::Date::monotonic() - start).get_nsecs())
+            / gu::datetime::Sec);
+        ck_assert_msg(secs > 0.7, "%d streams: %f s", streams, secs);
+    }
+}
+END_TEST
+
+// Resume tests
+
+// Forwards connections to IST receiver, the first connection is broken
+// after cut bytes have passed from sender to receiver
+struct proxy_args
+{
+    int      listen_fd_;
+    uint16_t target_port_;
+    size_t   cut_;
+    int      connections_;
+};
+
+static int proxy_socket(uint16_t const port, bool const listen)
+{
+    int const fd(::socket(AF_INET, SOCK_STREAM, 0));
+    ck_assert(fd >= 0);
+    struct sockaddr_in sa;
+    ::memset(&sa, 0, sizeof(sa));
+    sa.sin_family      = AF_INET;
+    sa.sin_port        = htons(port);
+    sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (listen)
+    {
+        ck_assert(::bind(fd, reinterpret_cast<struct sockaddr*>(&sa),
+                         sizeof(sa)) == 0);
+        ck_assert(::listen(fd, 4) == 0);
+    }
+    else
+    {
+        ck_assert(::connect(fd, reinterpret_cast<struct sockaddr*>(&sa),
+                            sizeof(sa)) == 0);
+    }
+    return fd;
+}
+
+// returns false if limit bytes from a to b were reached
+static bool proxy_forward(int const a, int const b, size_t const limit)
+{
+    size_t passed(0);
+    char   buf[16384];
+    struct pollfd pfd[2] = { { a, POLLIN, 0 }, { b, POLLIN, 0 } };
+
+    while (::poll(pfd, 2, -1) > 0)
+    {
+        for (int i(0); i < 2; ++i)
+        {
+            if (pfd[i].revents == 0) continue;
+            size_t want(sizeof(buf));
+            if (i == 0 && limit > 0 && limit - passed < want)
+            {
+                want = limit - passed;
+            }
+            ssize_t const n(::read(pfd[i].fd, buf, want));
+            if (n <= 0) return true;
+            for (ssize_t off(0); off < n; )
+            {
+                ssize_t const w(::write(pfd[1 - i].fd, buf + off, n - off));
+                if (w <= 0) return true;
+                off += w;
+            }
+            if (i == 0 && (passed += n) == limit) return false;
+        }
+    }
+    return true;
+}
+
+extern "C" void* proxy_thd(void* arg)
+{
+    proxy_args* pargs(reinterpret_cast<proxy_args*>(arg));
+
+    for (int c(0); c < pargs->connections_; ++c)
+    {
+        int const a(::accept(pargs->listen_fd_, 0, 0));
+        if (a < 0) break;
+        int const b(proxy_socket(pargs->target_port_, false));
+        bool const cut(proxy_forward(a, b, c == 0 ? pargs->cut_ : 0) == false);
+        if (cut)
+        {
+            log_info << "proxy broke connection " << c;
+        }
+        ::close(a);
+        ::close(b);
+    }
+    return 0;
+}
+
+// Receives write sets in seqno order, after pause_at write sets waits
+// twice on pause_barrier
+static gu_barrier_t pause_barrier;
+
+struct resume_consumer_args
+{
+    galera::ist::Receiver& receiver_;
+    wsrep_seqno_t          next_;
+    size_t                 pause_at_;
+    size_t                 received_;
+    int                    error_;
+
+    resume_consumer_args(galera::ist::Receiver& receiver,
+                         wsrep_seqno_t first, size_t pause_at = 0)
+        :
+        receiver_(receiver),
+        next_    (first),
+        pause_at_(pause_at),
+        received_(0),
+        error_   (0)
+    { }
+};
+
+extern "C" void* resume_consumer_thd(void* arg)
+{
+    resume_consumer_args* cargs(reinterpret_cast<resume_consumer_args*>(arg));
+    cargs->receiver_.ready();
+
+    std::vector<galera::TrxHandle*> trxs;
+    try
+    {
+        while (cargs->receiver_.recv(trxs, 4) == 0)
+        {
+            for (size_t i(0); i < trxs.size(); ++i)
+            {
+                ck_assert(trxs[i]->global_seqno() == cargs->next_);
+                ++cargs->next_;
+                trxs[i]->unref();
+                if (++cargs->received_ == cargs->pause_at_)
+                {
+                    gu_barrier_wait(&pause_barrier);
+                    gu_barrier_wait(&pause_barrier);
+                }
+            }
+        }
+    }
+    catch (gu::Exception& e)
+    {
+        log_info << "IST consumer: " << e.what();
+        cargs->error_ = e.get_errno();
+    }
+    return 0;
+}
+
+struct resume_sender_args
+{
+    galera::ist::Sender& sender_;
+    wsrep_seqno_t        first_;
+    wsrep_seqno_t        last_;
+    int                  error_;
+
+    resume_sender_args(galera::ist::Sender& sender,
+                       wsrep_seqno_t first, wsrep_seqno_t last)
+        :
+        sender_(sender),
+        first_ (first),
+        last_  (last),
+        error_ (0)
+    { }
+};
+
+extern "C" void* resume_sender_thd(void* arg)
+{
+    resume_sender_args* sargs(reinterpret_cast<resume_sender_args*>(arg));
+    try
+    {
+        sargs->sender_.send(sargs->first_, sargs->last_);
+    }
+    catch (gu::Exception& e)
+    {
+        log_info << "IST sender: " << e.what();
+        sargs->error_ = e.get_errno();
+    }
+    return 0;
+}
+
+static int const resume_version(5);
+// write sets must not fit into receiver queue and socket buffers
+static size_t const resume_n_trx(1024);
+
+static gcache::GCache* resume_gcache(gu::Config& conf)
+{
+    galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    conf.set("gcache.name", "ist_check.cache");
+    conf.set("gcache.size", "160M");
+    gcache::GCache* const gcache(new gcache::GCache(conf, "."));
+    populate_gcache(*gcache, select_trx_version(resume_version),
+                    resume_n_trx, 1 << 17);
+    return gcache;
+}
+
+// connection is broken mid-stream, sender reconnects and resumes
+START_TEST(test_ist_resume)
+{
+    galera::TrxHandle::SlavePool sp(sizeof(galera::TrxHandle), 4, "ist_resume");
+    gu::Config conf;
+    gcache::GCache* const gcache(resume_gcache(conf));
+
+    gu::Config rconf;
+    galera::ReplicatorSMM::InitConfig(rconf, NULL, NULL);
+    rconf.set(galera::ist::Receiver::RECV_ADDR, "tcp://127.0.0.1:0");
+    galera::ist::Receiver receiver(rconf, sp, 0);
+    std::string const addr(receiver.prepare(1, resume_n_trx, resume_version));
+
+    int const listen_fd(proxy_socket(0, true));
+    struct sockaddr_in sa;
+    socklen_t sa_len(sizeof(sa));
+    ck_assert(::getsockname(listen_fd, reinterpret_cast<struct sockaddr*>(&sa),
+                            &sa_len) == 0);
+    proxy_args pargs = { listen_fd,
+                         gu::from_string<uint16_t>(gu::URI(addr).get_port()),
+                         1 << 20, 2 };
+    gu_thread_t proxy_thread;
+    gu_thread_create(&proxy_thread, 0, &proxy_thd, &pargs);
+
+    resume_consumer_args cargs(receiver, 1);
+    gu_thread_t consumer_thread;
+    gu_thread_create(&consumer_thread, 0, &resume_consumer_thd, &cargs);
+
+    gcache->seqno_lock(1);
+    {
+        galera::ist::Sender sender(conf, *gcache,
+                                   "tcp://127.0.0.1:" +
+                                   gu::to_string(ntohs(sa.sin_port)),
+                                   resume_version);
+        resume_sender_args sargs(sender, 1, resume_n_trx);
+        gu_thread_t sender_thread;
+        gu_thread_create(&sender_thread, 0, &resume_sender_thd, &sargs);
+        gu_thread_join(sender_thread, 0);
+        ck_assert_msg(sargs.error_ == 0, "sender failed: %d", sargs.error_);
+    }
+
+    gu_thread_join(consumer_thread, 0);
+    gu_thread_join(proxy_thread, 0);
+    ::close(listen_fd);
+
+    ck_assert_msg(cargs.error_ == 0, "receiver failed: %d", cargs.error_);
+    ck_assert(cargs.received_ == resume_n_trx);
+    ck_assert(receiver.finished() == wsrep_seqno_t(resume_n_trx));
+
+    delete gcache;
+    ::unlink("ist_check.cache");
+}
+END_TEST
+
+// sender is killed mid-stream, joiner gives up waiting for it and
+// continues from the position reached with a new receiver and sender
+START_TEST(test_ist_resume_new_sender)
+{
+    galera::TrxHandle::SlavePool sp(sizeof(galera::TrxHandle), 4, "ist_resume");
+    gu::Config conf;
+    gcache::GCache* const gcache(resume_gcache(conf));
+
+    gu::Config rconf;
+    galera::ReplicatorSMM::InitConfig(rconf, NULL, NULL);
+    rconf.set(galera::ist::Receiver::RECV_ADDR, "tcp://127.0.0.1:0");
+    rconf.set("ist.resume_timeout", "PT1S");
+
+    wsrep_seqno_t resume_from;
+    {
+        galera::ist::Receiver receiver(rconf, sp, 0);
+        std::string const addr(receiver.prepare(1, resume_n_trx,
+                                                resume_version));
+
+        // consumer stops in the middle so that sender blocks
+        gu_barrier_init(&pause_barrier, 0, 2);
+        resume_consumer_args cargs(receiver, 1, resume_n_trx / 4);
+        gu_thread_t consumer_thread;
+        gu_thread_create(&consumer_thread, 0, &resume_consumer_thd, &cargs);
+
+        gcache->seqno_lock(1);
+        {
+            galera::ist::Sender sender(conf, *gcache, addr, resume_version);
+            resume_sender_args sargs(sender, 1, resume_n_trx);
+            gu_thread_t sender_thread;
+            gu_thread_create(&sender_thread, 0, &resume_sender_thd, &sargs);
+
+            gu_barrier_wait(&pause_barrier);
+            sender.cancel();
+            gu_thread_join(sender_thread, 0);
+            ck_assert(sargs.error_ != 0);
+        }
+        gu_barrier_wait(&pause_barrier);
+
+        gu_thread_join(consumer_thread, 0);
+        ck_assert(cargs.error_ != 0);
+        ck_assert(cargs.received_ >= resume_n_trx / 4);
+        ck_assert(cargs.received_ <  resume_n_trx);
+        resume_from = receiver.current_seqno();
+        ck_assert(resume_from == cargs.next_);
+        receiver.finished();
+        gu_barrier_destroy(&pause_barrier);
+    }
+
+    galera::ist::Receiver receiver(rconf, sp, 0);
+    std::string const addr(receiver.prepare(resume_from, resume_n_trx,
+                                            resume_version));
+    resume_consumer_args cargs(receiver, resume_from);
+    gu_thread_t consumer_thread;
+    gu_thread_create(&consumer_thread, 0, &resume_consumer_thd, &cargs);
+
+    gcache->seqno_lock(resume_from);
+    {
+        galera::ist::Sender sender(conf, *gcache, addr, resume_version);
+        resume_sender_args sargs(sender, resume_from, resume_n_trx);
+        gu_thread_t sender_thread;
+        gu_thread_create(&sender_thread, 0, &resume_sender_thd, &sargs);
+        gu_thread_join(sender_thread, 0);
+        ck_assert_msg(sargs.error_ == 0, "sender failed: %d", sargs.error_);
+    }
+
+    gu_thread_join(consumer_thread, 0);
+    ck_assert_msg(cargs.error_ == 0, "receiver failed: %d", cargs.error_);
+    ck_assert(cargs.next_ == wsrep_seqno_t(resume_n_trx) + 1);
+    ck_assert(receiver.finished() == wsrep_seqno_t(resume_n_trx));
+
+    delete gcache;
+    ::unlink("ist_check.cache");
+}
+END_TEST
+
 Suite* ist_suite()
 {
     Suite* s  = suite_create("ist");
@@ -421,5 +1027,43 @@ Suite* ist_suite()
     tcase_add_test(tc, test_ist_v5);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_ist_streams");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_streams);
+    tcase_add_test(tc, test_ist_streams_single);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_resume");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_resume);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_resume_new_sender");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_resume_new_sender);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_zero_copy");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_zero_copy);
+    tcase_add_test(tc, test_ist_zero_copy_abort);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_compression");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_compression);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_parallel");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_parallel);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_shaper");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_shaper);
+    tcase_add_test(tc, test_ist_send_rate);
+    suite_add_tcase(s, tc);
+
     return s;
 }
@@ -13,6 +13,8 @@
 
 #include <check.h>
 
+#include <sstream>
+
 using namespace galera;
 
 class TestBaseName : public gu::Allocator::BaseName
@@ -188,9 +190,9 @@ static void test_ver(gu::RecordSet::Version const rsv, int ws_ver)
         /* version 3 does not distinguish SEMI and EXCLUSIVE,
            the key should be ignored */
     }
-    else if (4 == ws_ver)
+    else if (ws_ver >= 4)
     {
-        /* in verson 4 EXCLUSIVE is a stronger key than SEMI - should be added
+        /* since verson 4 EXCLUSIVE is a stronger key than SEMI - should be added
            to the set */
 
         expected_count++;
@@ -332,6 +334,115 @@ START_TEST (ver2_4)
 }
 END_TEST
 
+START_TEST (ver2_5)
+{
+    test_ver(gu::RecordSet::VER2, 5);
+}
+END_TEST
+
+static std::vector<gu::byte_t>
+gather_keys (KeySetOut& kso)
+{
+    KeySetOut::GatherVector out;
+    out->reserve(kso.page_count());
+    kso.gather(out);
+
+    std::vector<gu::byte_t> ret;
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(reinterpret_cast<const gu::byte_t*>(out[i].ptr));
+        ret.insert (ret.end(), ptr, ptr + out[i].size);
+    }
+
+    return ret;
+}
+
+/* keys appended in bulk must produce the same key set as appended one by one */
+static void test_bulk(KeySet::Version const tk_ver, int const ws_ver)
+{
+    int const num_keys(43);
+    std::vector<std::string> values;
+    values.reserve(3 * num_keys);
+    std::vector<std::vector<wsrep_buf_t> > parts(num_keys);
+
+    for (int k(0); k < num_keys; ++k)
+    {
+        std::ostringstream tbl, row;
+        tbl << "table" << k / 10;
+        row << "row" << (k % 7 ? k : k - 1); // some duplicates
+
+        values.push_back("db");
+        values.push_back(tbl.str());
+        values.push_back(row.str());
+
+        /* every 5th key is a table key, which makes the next row key match
+         * only two parts of it */
+        int const parts_num(k % 5 ? 3 : 2);
+        for (int j(0); j < parts_num; ++j)
+        {
+            const std::string& v(values[values.size() - 3 + j]);
+            wsrep_buf_t const b = { v.c_str(), v.length() };
+            parts[k].push_back(b);
+        }
+    }
+
+    std::vector<wsrep_key_t> keys(num_keys);
+    for (int k(0); k < num_keys; ++k)
+    {
+        keys[k].key_parts     = &parts[k][0];
+        keys[k].key_parts_num = parts[k].size();
+    }
+
+    union { gu::byte_t buf[1024]; gu_word_t align; } reserved1, reserved2;
+    TestBaseName const str("key_set_bulk_test");
+    KeySetOut kso1(reserved1.buf, sizeof(reserved1.buf), str, tk_ver,
+                   gu::RecordSet::VER2, ws_ver);
+    KeySetOut kso2(reserved2.buf, sizeof(reserved2.buf), str, tk_ver,
+                   gu::RecordSet::VER2, ws_ver);
+
+    /* bulks of various sizes, exclusive key in the middle to make sure that
+     * the first key of a bulk is checked against the previous key */
+    int const bulks[] = { 0, 1, 3, 17, 8, 14 };
+    int b(0);
+    for (size_t i(0); i < sizeof(bulks)/sizeof(bulks[0]); ++i)
+    {
+        for (int k(b); k < b + bulks[i]; ++k)
+        {
+            KeyData const kd(ws_ver, keys[k].key_parts, keys[k].key_parts_num,
+                             WSREP_KEY_SHARED, false);
+            kso1.append(kd);
+        }
+
+        size_t const old_size(kso2.size());
+        size_t const ret(kso2.append(&keys[b], bulks[i], WSREP_KEY_SHARED,
+                                     false));
+        ck_assert_msg(ret == kso2.size() - old_size,
+                      "bulk append() returned %zu, expected %zu",
+                      ret, kso2.size() - old_size);
+        b += bulks[i];
+
+        if (3 == i)
+        {
+            KeyData const kd(ws_ver, keys[b].key_parts, keys[b].key_parts_num,
+                             WSREP_KEY_EXCLUSIVE, false);
+            kso1.append(kd);
+            kso2.append(kd);
+        }
+    }
+    ck_assert(num_keys == b);
+
+    ck_assert_msg(kso1.count() == kso2.count(), "key count: %d, expected %d",
+                  kso2.count(), kso1.count());
+    ck_assert(gather_keys(kso1) == gather_keys(kso2));
+}
+
+START_TEST (bulk)
+{
+    test_bulk(KeySet::FLAT16A, 4);
+    test_bulk(KeySet::FLAT8A,  5);
+}
+END_TEST
+
 Suite* key_set_suite ()
 {
     TCase* t = tcase_create ("KeySet");
@@ -340,6 +451,8 @@ Suite* key_set_suite ()
 #endif
     tcase_add_test (t, ver2_3);
     tcase_add_test (t, ver2_4);
+    tcase_add_test (t, ver2_5);
+    tcase_add_test (t, bulk);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("KeySet");
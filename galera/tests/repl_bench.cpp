@@ -0,0 +1,678 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+/**
+ * In-process replication throughput benchmark.
+ *
+ * Starts several provider instances in one process, connects them into
+ * a cluster over loopback gcomm (or uses a single node on the dummy GCS
+ * backend) and drives synthetic writesets through the full
+ * replicate()/pre_commit()/post_commit() path. Apply and commit callbacks
+ * do nothing except ordering, so the result reflects provider overhead only.
+ *
+ * Reports transaction rate, commit latency percentiles, certification
+ * failures and the fraction of time replication was paused by flow control.
+ */
+
+#include <wsrep_api.h>
+extern "C" int wsrep_loader(wsrep_t*);
+
+#include <gu_logger.hpp>
+#include <gu_mutex.hpp>
+#include <gu_cond.hpp>
+#include <gu_lock.hpp>
+#include <gu_time.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+#include <getopt.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdint.h>
+
+struct bench_params
+{
+    int         nodes;      // number of nodes in the cluster
+    int         clients;    // client threads per node
+    int         appliers;   // applier (recv) threads per node
+    int         keys;       // keys per writeset
+    int         overlap;    // percentage of keys taken from the shared set
+    long        hot_keys;   // size of the shared key set
+    size_t      payload;    // writeset payload size
+    int         duration;   // seconds
+    int         port;       // base port
+    bool        dummy;      // use dummy GCS backend (single node only)
+    std::string options;    // extra provider options
+
+    bench_params()
+        :
+        nodes   (3),
+        clients (4),
+        appliers(4),
+        keys    (1),
+        overlap (0),
+        hot_keys(1000),
+        payload (256),
+        duration(10),
+        port    (14567),
+        dummy   (false),
+        options ()
+    {}
+};
+
+static bench_params params;
+
+struct bench_node
+{
+    gu::Mutex                mtx;
+    gu::Cond                 cond;
+    wsrep_t                  provider;
+    std::string              dir;
+    int                      idx;
+    bool                     synced;
+    bool                     stopping;
+    std::vector<gu_thread_t> appliers;
+
+    bench_node() : mtx(), cond(), provider(), dir(), idx(-1), synced(false),
+                   stopping(false), appliers()
+    {}
+
+private:
+    bench_node(const bench_node&);
+    bench_node& operator=(const bench_node&);
+};
+
+struct bench_client
+{
+    bench_node*         node;
+    int                 idx;
+    long long           deadline;
+    unsigned int        seed;
+    long                commits;
+    long                failures;
+    std::vector<double> latencies; // microseconds
+};
+
+static std::vector<char> payload;
+
+static void
+log_cb(wsrep_log_level_t l, const char* c)
+{
+    if (l <= WSREP_LOG_ERROR) // only log errors to avoid output clutter
+    {
+        std::cerr << c << '\n';
+    }
+}
+
+static enum wsrep_cb_status
+view_cb(void*                    app_ctx,
+        void*                    recv_ctx,
+        const wsrep_view_info_t* view,
+        const char*              state,
+        size_t                   state_len,
+        void**                   sst_req,
+        size_t*                  sst_req_len)
+{
+    if (view->state_gap)
+    {
+        /* joiner adopts the group state as is, there is no data to transfer */
+        size_t const len(strlen(WSREP_STATE_TRANSFER_TRIVIAL) + 1);
+        *sst_req = ::malloc(len);
+        if (!*sst_req) return WSREP_CB_FAILURE;
+        ::memcpy(*sst_req, WSREP_STATE_TRANSFER_TRIVIAL, len);
+        *sst_req_len = len;
+    }
+
+    return WSREP_CB_SUCCESS;
+}
+
+static enum wsrep_cb_status
+apply_cb(void*                   recv_ctx,
+         const void*             data,
+         size_t                  size,
+         uint32_t                flags,
+         const wsrep_trx_meta_t* meta)
+{
+    return WSREP_CB_SUCCESS;
+}
+
+static enum wsrep_cb_status
+commit_cb(void*                   recv_ctx,
+          const void*             trx_handle,
+          uint32_t                flags,
+          const wsrep_trx_meta_t* meta,
+          wsrep_bool_t*           exit,
+          wsrep_bool_t            commit)
+{
+    if (commit && trx_handle)
+    {
+        /* commit ordering is left to the application */
+        wsrep_t& provider(static_cast<bench_node*>(recv_ctx)->provider);
+        void* const trx(const_cast<void*>(trx_handle));
+
+        if (WSREP_OK != provider.applier_pre_commit(&provider, trx) ||
+            WSREP_OK != provider.applier_post_commit(&provider, trx))
+        {
+            return WSREP_CB_FAILURE;
+        }
+    }
+
+    return WSREP_CB_SUCCESS;
+}
+
+static enum wsrep_cb_status
+sst_donate_cb(void*               app_ctx,
+              void*               recv_ctx,
+              const void*         msg,
+              size_t              msg_len,
+              const wsrep_gtid_t* state_id,
+              const char*         state,
+              size_t              state_len,
+              wsrep_bool_t        bypass)
+{
+    /* only trivial state transfers are requested, this must not happen */
+    std::cerr << "Unexpected state transfer request\n";
+    return WSREP_CB_FAILURE;
+}
+
+static void
+synced_cb(void* app_ctx)
+{
+    bench_node* const node(static_cast<bench_node*>(app_ctx));
+    gu::Lock lock(node->mtx);
+    node->synced = true;
+    node->cond.broadcast();
+}
+
+static void*
+applier_thread(void* arg)
+{
+    bench_node* const node(static_cast<bench_node*>(arg));
+    wsrep_t&    provider(node->provider);
+
+    wsrep_status_t const ret(provider.recv(&provider, node));
+
+    gu::Lock lock(node->mtx);
+    if (WSREP_OK != ret && !node->stopping)
+    {
+        std::cerr << "Node " << node->idx << ": recv() returned " << ret
+                  << '\n';
+    }
+
+    return NULL;
+}
+
+static uint64_t
+next_key(bench_client& c, long n)
+{
+    if (params.overlap > 0 && int(rand_r(&c.seed) % 100) < params.overlap)
+    {
+        return rand_r(&c.seed) % params.hot_keys;
+    }
+
+    /* private keys never clash with the shared set or other clients */
+    return (uint64_t(1) << 63) | (uint64_t(c.node->idx) << 48) |
+        (uint64_t(c.idx) << 32) | uint64_t(n);
+}
+
+static void*
+client_thread(void* arg)
+{
+    bench_client& c(*static_cast<bench_client*>(arg));
+    wsrep_t&      provider(c.node->provider);
+
+    static const char table[] = "bench";
+
+    wsrep_conn_id_t const conn_id(c.idx);
+    long n(0);
+
+    struct wsrep_buf const data = { &payload[0], payload.size() };
+
+    while (gu_time_monotonic() < c.deadline)
+    {
+        // trx ids must be non-zero
+        wsrep_trx_id_t const trx_id((wsrep_trx_id_t(c.idx) << 40) | (n + 1));
+        wsrep_ws_handle_t ws = { trx_id, NULL };
+
+        for (int k(0); k < params.keys; ++k)
+        {
+            uint64_t const row(next_key(c, n * params.keys + k));
+
+            wsrep_buf_t const parts[2] = {
+                { table, sizeof(table) },
+                { &row,  sizeof(row)   }
+            };
+            wsrep_key_t const key = { parts, 2 };
+
+            provider.append_key(&provider, &ws, &key, 1, WSREP_KEY_EXCLUSIVE,
+                                true);
+        }
+
+        provider.append_data(&provider, &ws, &data, 1, WSREP_DATA_ORDERED,
+                             false);
+
+        wsrep_trx_meta_t meta;
+        long long const start(gu_time_monotonic());
+
+        wsrep_status_t ret(provider.replicate(&provider, conn_id, &ws,
+                                              WSREP_FLAG_COMMIT, &meta));
+        if (WSREP_OK == ret)
+        {
+            ret = provider.pre_commit(&provider, conn_id, &ws,
+                                      WSREP_FLAG_COMMIT, &meta);
+        }
+
+        if (WSREP_OK == ret)
+        {
+            provider.post_commit(&provider, &ws);
+            c.latencies.push_back((gu_time_monotonic() - start)*1.0e-3);
+            ++c.commits;
+        }
+        else if (WSREP_TRX_FAIL == ret)
+        {
+            provider.post_rollback(&provider, &ws);
+            ++c.failures;
+        }
+        else
+        {
+            std::cerr << "Node " << c.node->idx << ", client " << c.idx
+                      << ": replication failed: " << ret << '\n';
+            provider.post_rollback(&provider, &ws);
+            break;
+        }
+
+        ++n;
+    }
+
+    provider.free_connection(&provider, conn_id);
+
+    return NULL;
+}
+
+static long long
+stats_int64(wsrep_t& provider, const char* const name)
+{
+    long long ret(0);
+    struct wsrep_stats_var* const stats(provider.stats_get(&provider));
+
+    for (struct wsrep_stats_var* v(stats); v && v->name; ++v)
+    {
+        if (!strcmp(v->name, name) && WSREP_VAR_INT64 == v->type)
+        {
+            ret = v->value._int64;
+            break;
+        }
+    }
+
+    provider.stats_free(&provider, stats);
+
+    return ret;
+}
+
+static void
+remove_dir(const std::string& dir)
+{
+    DIR* const d(::opendir(dir.c_str()));
+
+    if (d)
+    {
+        struct dirent* e;
+        while ((e = ::readdir(d)) != NULL)
+        {
+            if (strcmp(e->d_name, ".") && strcmp(e->d_name, ".."))
+            {
+                ::unlink((dir + '/' + e->d_name).c_str());
+            }
+        }
+        ::closedir(d);
+    }
+
+    ::rmdir(dir.c_str());
+}
+
+static bool
+start_node(bench_node& node, const std::string& root)
+{
+    wsrep_t& provider(node.provider);
+
+    std::ostringstream dir;
+    dir << root << "/node" << node.idx;
+    node.dir = dir.str();
+    if (::mkdir(node.dir.c_str(), 0700))
+    {
+        std::cerr << "Failed to create " << node.dir << ": "
+                  << strerror(errno) << '\n';
+        return false;
+    }
+
+    int const port(params.port + 10 * node.idx);
+
+    std::ostringstream opts;
+    opts << "base_dir=" << node.dir
+         << "; gcache.size=32M"
+         << "; gmcast.listen_addr=tcp://127.0.0.1:" << port
+         << "; ist.recv_addr=127.0.0.1:" << port + 1;
+    if (!params.options.empty()) opts << "; " << params.options;
+    std::string const options(opts.str());
+
+    if (WSREP_OK != wsrep_loader(&provider)) return false;
+
+    struct wsrep_init_args init_args =
+        {
+            &node,                  // void* app_ctx
+
+            /* Configuration parameters */
+            NULL,                   // const char* node_name
+            "127.0.0.1",            // const char* node_address
+            NULL,                   // const char* node_incoming
+            node.dir.c_str(),       // const char* data_dir
+            options.c_str(),        // const char* options
+            0,                      // int         proto_ver
+
+            /* Application initial state information. */
+            NULL,                   // const wsrep_gtid_t* state_id
+            NULL,                   // const char*         state
+            0,                      // size_t              state_len
+
+            /* Application callbacks */
+            log_cb,                 // wsrep_log_cb_t      logger_cb
+            view_cb,                // wsrep_view_cb_t     view_handler_cb
+
+            /* Applier callbacks */
+            apply_cb,               // wsrep_apply_cb_t      apply_cb
+            commit_cb,              // wsrep_commit_cb_t     commit_cb
+            NULL,                   // wsrep_unordered_cb_t  unordered_cb
+
+            /* State Snapshot Transfer callbacks */
+            sst_donate_cb,          // wsrep_sst_donate_cb_t sst_donate_cb
+            synced_cb,              // wsrep_synced_cb_t     synced_cb
+
+            /* Abnormal termination callback: */
+            NULL,                   // wsrep_abort_cb_t      abort_cb
+
+            /* Performance Schema instrumentation callback */
+            NULL,                   // wsrep_pfs_instr_cb_t  pfs_instr_cb
+        };
+
+    if (WSREP_OK != provider.init(&provider, &init_args))
+    {
+        std::cerr << "Failed to initialize node " << node.idx << '\n';
+        return false;
+    }
+
+    std::ostringstream url;
+    if (params.dummy)
+        url << "dummy://";
+    else if (0 == node.idx)
+        url << "gcomm://";
+    else
+        url << "gcomm://127.0.0.1:" << params.port;
+
+    wsrep_status_t const ret(provider.connect(&provider, "repl_bench",
+                                              url.str().c_str(), "",
+                                              0 == node.idx));
+    if (WSREP_OK != ret)
+    {
+        std::cerr << "Node " << node.idx << ": connect() returned " << ret
+                  << '\n';
+        return false;
+    }
+
+    node.appliers.resize(params.appliers);
+    for (size_t i(0); i < node.appliers.size(); ++i)
+    {
+        gu_thread_create(&node.appliers[i], NULL, applier_thread, &node);
+    }
+
+    gu::Lock lock(node.mtx);
+    while (!node.synced) lock.wait(node.cond);
+
+    return true;
+}
+
+static void
+stop_node(bench_node& node)
+{
+    wsrep_t& provider(node.provider);
+
+    if (!node.appliers.empty())
+    {
+        {
+            gu::Lock lock(node.mtx);
+            node.stopping = true;
+        }
+
+        provider.disconnect(&provider);
+
+        for (size_t i(0); i < node.appliers.size(); ++i)
+        {
+            gu_thread_join(node.appliers[i], NULL);
+        }
+    }
+
+    if (provider.free) provider.free(&provider);
+
+    remove_dir(node.dir);
+}
+
+static double
+percentile(const std::vector<double>& sorted, double const p)
+{
+    if (sorted.empty()) return 0.0;
+
+    size_t const i(std::min(sorted.size() - 1,
+                            size_t(p * 0.01 * sorted.size())));
+    return sorted[i];
+}
+
+static void
+usage(const char* const name)
+{
+    bench_params const d;
+
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "  -n, --nodes=N      nodes in the cluster (" << d.nodes << ")\n"
+        << "  -c, --clients=N    client threads per node (" << d.clients
+        << ")\n"
+        << "  -a, --appliers=N   applier threads per node (" << d.appliers
+        << ")\n"
+        << "  -k, --keys=N       keys per writeset (" << d.keys << ")\n"
+        << "  -o, --overlap=P    percentage of keys from the shared set ("
+        << d.overlap << ")\n"
+        << "  -h, --hot-keys=N   size of the shared key set (" << d.hot_keys
+        << ")\n"
+        << "  -s, --payload=B    writeset payload size (" << d.payload
+        << ")\n"
+        << "  -d, --duration=S   benchmark duration in seconds ("
+        << d.duration << ")\n"
+        << "  -p, --port=P       base port for gcomm and IST (" << d.port
+        << ")\n"
+        << "  -D, --dummy        single node on dummy GCS backend\n"
+        << "  -O, --options=STR  extra provider options\n";
+}
+
+int main(int argc, char* argv[])
+{
+    static struct option const long_opts[] =
+    {
+        { "nodes",    required_argument, NULL, 'n' },
+        { "clients",  required_argument, NULL, 'c' },
+        { "appliers", required_argument, NULL, 'a' },
+        { "keys",     required_argument, NULL, 'k' },
+        { "overlap",  required_argument, NULL, 'o' },
+        { "hot-keys", required_argument, NULL, 'h' },
+        { "payload",  required_argument, NULL, 's' },
+        { "duration", required_argument, NULL, 'd' },
+        { "port",     required_argument, NULL, 'p' },
+        { "dummy",    no_argument,       NULL, 'D' },
+        { "options",  required_argument, NULL, 'O' },
+        { NULL, 0, NULL, 0 }
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:c:a:k:o:h:s:d:p:DO:", long_opts,
+                              NULL)) != -1)
+    {
+        switch (opt)
+        {
+        case 'n': params.nodes    = atoi(optarg);  break;
+        case 'c': params.clients  = atoi(optarg);  break;
+        case 'a': params.appliers = atoi(optarg);  break;
+        case 'k': params.keys     = atoi(optarg);  break;
+        case 'o': params.overlap  = atoi(optarg);  break;
+        case 'h': params.hot_keys = atol(optarg);  break;
+        case 's': params.payload  = atol(optarg);  break;
+        case 'd': params.duration = atoi(optarg);  break;
+        case 'p': params.port     = atoi(optarg);  break;
+        case 'D': params.dummy    = true;          break;
+        case 'O': params.options  = optarg;        break;
+        default:  usage(argv[0]);                  return EXIT_FAILURE;
+        }
+    }
+
+    if (params.dummy) params.nodes = 1;
+
+    if (params.nodes < 1 || params.clients < 1 || params.appliers < 1 ||
+        params.keys < 1 || params.overlap < 0 || params.overlap > 100 ||
+        params.hot_keys < 1 || params.payload < 1 || params.duration < 1)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    payload.resize(params.payload);
+    for (size_t i(0); i < payload.size(); ++i) payload[i] = char(i);
+
+    char root_tmpl[] = "/tmp/repl_bench.XXXXXX";
+    const char* const root(::mkdtemp(root_tmpl));
+    if (!root)
+    {
+        std::cerr << "Failed to create working directory: " << strerror(errno)
+                  << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::vector<bench_node*> nodes;
+    bool ok(true);
+
+    for (int i(0); ok && i < params.nodes; ++i)
+    {
+        nodes.push_back(new bench_node);
+        nodes.back()->idx = i;
+        ok = start_node(*nodes.back(), root);
+    }
+
+    std::vector<bench_client> clients;
+    std::vector<long long>    fc_paused_before;
+    long long                 duration(0);
+
+    if (ok)
+    {
+        for (size_t i(0); i < nodes.size(); ++i)
+        {
+            fc_paused_before.push_back(
+                stats_int64(nodes[i]->provider, "flow_control_paused_ns"));
+        }
+
+        long long const start(gu_time_monotonic());
+        long long const deadline(start + params.duration * 1000000000LL);
+
+        clients.resize(nodes.size() * params.clients);
+        for (size_t i(0); i < clients.size(); ++i)
+        {
+            bench_client& c(clients[i]);
+            c.node     = nodes[i / params.clients];
+            c.idx      = i % params.clients;
+            c.deadline = deadline;
+            c.seed     = i + 1;
+            c.commits  = 0;
+            c.failures = 0;
+            c.latencies.reserve(1 << 16);
+        }
+
+        std::vector<gu_thread_t> threads(clients.size());
+        for (size_t i(0); i < threads.size(); ++i)
+        {
+            gu_thread_create(&threads[i], NULL, client_thread, &clients[i]);
+        }
+
+        for (size_t i(0); i < threads.size(); ++i)
+        {
+            gu_thread_join(threads[i], NULL);
+        }
+
+        duration = gu_time_monotonic() - start;
+    }
+
+    std::vector<double> fc_paused;
+    for (size_t i(0); ok && i < nodes.size(); ++i)
+    {
+        long long const paused(
+            stats_int64(nodes[i]->provider, "flow_control_paused_ns"));
+        fc_paused.push_back(double(paused - fc_paused_before[i]) / duration);
+    }
+
+    for (size_t i(nodes.size()); i > 0; --i)
+    {
+        stop_node(*nodes[i - 1]);
+        delete nodes[i - 1];
+    }
+
+    ::rmdir(root);
+
+    if (!ok) return EXIT_FAILURE;
+
+    long commits(0), failures(0);
+    std::vector<double> latencies;
+    for (size_t i(0); i < clients.size(); ++i)
+    {
+        commits  += clients[i].commits;
+        failures += clients[i].failures;
+        latencies.insert(latencies.end(), clients[i].latencies.begin(),
+                         clients[i].latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    double const secs(duration * 1.0e-9);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Nodes: " << params.nodes
+              << (params.dummy ? " (dummy)" : "")
+              << ", clients/node: " << params.clients
+              << ", appliers/node: " << params.appliers
+              << ", keys/trx: " << params.keys
+              << ", overlap: " << params.overlap << '%'
+              << ", payload: " << params.payload << "B\n"
+              << "Duration:     " << secs << " s\n"
+              << "Commits:      " << commits
+              << " (" << commits / secs << " TPS)\n"
+              << "Cert failures: " << failures
+              << " (" << (commits + failures ?
+                          100.0 * failures / (commits + failures) : 0.0)
+              << "%)\n"
+              << "Latency, us:  p50 " << percentile(latencies, 50)
+              << ", p95 " << percentile(latencies, 95)
+              << ", p99 " << percentile(latencies, 99)
+              << ", max " << (latencies.empty() ? 0.0 : latencies.back())
+              << '\n'
+              << "FC paused:   " << std::setprecision(3);
+
+    for (size_t i(0); i < fc_paused.size(); ++i)
+    {
+        std::cout << ' ' << fc_paused[i];
+    }
+    std::cout << '\n';
+
+    return EXIT_SUCCESS;
+}
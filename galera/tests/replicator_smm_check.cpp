@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include <wsrep_api.h>
+extern "C" int wsrep_loader(wsrep_t*);
+
+#include "gu_logger.hpp"
+#include "gu_mutex.hpp"
+#include "gu_cond.hpp"
+#include "gu_lock.hpp"
+#include "gu_uuid.h"
+#include "gu_datetime.hpp"
+
+#include <check.h>
+#include <errno.h>
+
+#include <cstring>
+#include <sstream>
+#include <string>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+    /* Single provider instance running on the dummy GCS backend. */
+    class TestNode
+    {
+    public:
+
+        TestNode()
+            :
+            mtx_     (),
+            cond_    (),
+            provider_(),
+            dir_     ("replicator_smm_check.dir"),
+            applier_ (),
+            synced_  (false),
+            applied_ ()
+        {}
+
+        ~TestNode()
+        {
+            DIR* const d(::opendir(dir_.c_str()));
+            if (d)
+            {
+                struct dirent* e;
+                while ((e = ::readdir(d)) != NULL)
+                {
+                    if (strcmp(e->d_name, ".") && strcmp(e->d_name, ".."))
+                    {
+                        ::unlink((dir_ + '/' + e->d_name).c_str());
+                    }
+                }
+                ::closedir(d);
+            }
+            ::rmdir(dir_.c_str());
+        }
+
+        void start(int proto_max)
+        {
+            ck_assert(0 == ::mkdir(dir_.c_str(), 0700));
+
+            std::ostringstream opts;
+            opts << "base_dir=" << dir_ << "; gcache.size=1M"
+                 << "; repl.proto_max=" << proto_max;
+            std::string const options(opts.str());
+
+            ck_assert(WSREP_OK == wsrep_loader(&provider_));
+
+            struct wsrep_init_args init_args =
+                {
+                    this,                   // void* app_ctx
+
+                    NULL,                   // const char* node_name
+                    "127.0.0.1",            // const char* node_address
+                    NULL,                   // const char* node_incoming
+                    dir_.c_str(),           // const char* data_dir
+                    options.c_str(),        // const char* options
+                    0,                      // int         proto_ver
+
+                    NULL,                   // const wsrep_gtid_t* state_id
+                    NULL,                   // const char*         state
+                    0,                      // size_t              state_len
+
+                    NULL,                   // wsrep_log_cb_t      logger_cb
+                    view_cb,                // wsrep_view_cb_t     view_handler_cb
+
+                    apply_cb,               // wsrep_apply_cb_t      apply_cb
+                    commit_cb,              // wsrep_commit_cb_t     commit_cb
+                    NULL,                   // wsrep_unordered_cb_t  unordered_cb
+
+                    sst_donate_cb,          // wsrep_sst_donate_cb_t sst_donate_cb
+                    synced_cb,              // wsrep_synced_cb_t     synced_cb
+
+                    NULL,                   // wsrep_abort_cb_t      abort_cb
+
+                    NULL,                   // wsrep_pfs_instr_cb_t  pfs_instr_cb
+                };
+
+            ck_assert(WSREP_OK == provider_.init(&provider_, &init_args));
+            ck_assert(WSREP_OK == provider_.connect(&provider_,
+                                                    "replicator_smm_check",
+                                                    "dummy://", "", true));
+
+            gu_thread_create(&applier_, NULL, applier_thread, this);
+
+            gu::Lock lock(mtx_);
+            while (!synced_) lock.wait(cond_);
+        }
+
+        void stop()
+        {
+            provider_.disconnect(&provider_);
+            gu_thread_join(applier_, NULL);
+            provider_.free(&provider_);
+        }
+
+        wsrep_t& provider() { return provider_; }
+
+        long long stats_int64(const char* const name)
+        {
+            long long ret(-1);
+            struct wsrep_stats_var* const stats
+                (provider_.stats_get(&provider_));
+
+            for (struct wsrep_stats_var* v(stats); v && v->name; ++v)
+            {
+                if (!strcmp(v->name, name) && WSREP_VAR_INT64 == v->type)
+                {
+                    ret = v->value._int64;
+                    break;
+                }
+            }
+
+            provider_.stats_free(&provider_, stats);
+
+            return ret;
+        }
+
+        /* waits until a writeset carrying data is applied, returns the data
+         * or an empty string on timeout */
+        std::string wait_applied(int const timeout_sec)
+        {
+            gu::datetime::Date const deadline(gu::datetime::Date::calendar() +
+                                              timeout_sec*gu::datetime::Sec);
+            gu::Lock lock(mtx_);
+            try
+            {
+                while (applied_.empty()) lock.wait(cond_, deadline);
+            }
+            catch (gu::Exception& e)
+            {
+                ck_assert(e.get_errno() == ETIMEDOUT);
+            }
+            return applied_;
+        }
+
+    private:
+
+        TestNode(const TestNode&);
+        TestNode& operator=(const TestNode&);
+
+        static enum wsrep_cb_status
+        view_cb(void*, void*, const wsrep_view_info_t*, const char*, size_t,
+                void**, size_t*)
+        {
+            return WSREP_CB_SUCCESS;
+        }
+
+        static enum wsrep_cb_status
+        apply_cb(void* recv_ctx, const void* data, size_t size, uint32_t,
+                 const wsrep_trx_meta_t*)
+        {
+            TestNode* const node(static_cast<TestNode*>(recv_ctx));
+            gu::Lock lock(node->mtx_);
+            node->applied_.append(static_cast<const char*>(data), size);
+            node->cond_.broadcast();
+            return WSREP_CB_SUCCESS;
+        }
+
+        static enum wsrep_cb_status
+        commit_cb(void* recv_ctx, const void* trx_handle, uint32_t,
+                  const wsrep_trx_meta_t*, wsrep_bool_t*,
+                  wsrep_bool_t const commit)
+        {
+            if (commit && trx_handle)
+            {
+                /* commit ordering is left to the application */
+                wsrep_t& provider(static_cast<TestNode*>(recv_ctx)->provider_);
+                void* const trx(const_cast<void*>(trx_handle));
+
+                if (WSREP_OK != provider.applier_pre_commit(&provider, trx) ||
+                    WSREP_OK != provider.applier_post_commit(&provider, trx))
+                {
+                    return WSREP_CB_FAILURE;
+                }
+            }
+
+            return WSREP_CB_SUCCESS;
+        }
+
+        static enum wsrep_cb_status
+        sst_donate_cb(void*, void*, const void*, size_t, const wsrep_gtid_t*,
+                      const char*, size_t, wsrep_bool_t)
+        {
+            return WSREP_CB_FAILURE;
+        }
+
+        static void
+        synced_cb(void* app_ctx)
+        {
+            TestNode* const node(static_cast<TestNode*>(app_ctx));
+            gu::Lock lock(node->mtx_);
+            node->synced_ = true;
+            node->cond_.broadcast();
+        }
+
+        static void*
+        applier_thread(void* arg)
+        {
+            TestNode* const node(static_cast<TestNode*>(arg));
+            node->provider_.recv(&node->provider_, node);
+            return NULL;
+        }
+
+        gu::Mutex   mtx_;
+        gu::Cond    cond_;
+        wsrep_t     provider_;
+        std::string dir_;
+        gu_thread_t applier_;
+        bool        synced_;
+        std::string applied_;
+    };
+}
+
+/* Preordered writesets must be built with the writeset version of the
+ * negotiated protocol, otherwise certification rejects them. */
+static void
+preordered(int const proto_max)
+{
+    TestNode node;
+    node.start(proto_max);
+
+    ck_assert_msg(node.stats_int64("protocol_version") == proto_max,
+                  "protocol version %lld, expected %d",
+                  node.stats_int64("protocol_version"), proto_max);
+
+    wsrep_t& provider(node.provider());
+
+    static const char payload[] = "preordered writeset";
+    struct wsrep_buf const data = { payload, sizeof(payload) };
+
+    wsrep_uuid_t source;
+    gu_uuid_generate(reinterpret_cast<gu_uuid_t*>(&source), NULL, 0);
+
+    wsrep_po_handle_t handle(WSREP_PO_INITIALIZER);
+    ck_assert(WSREP_OK == provider.preordered_collect(&provider, &handle,
+                                                      &data, 1, true));
+    ck_assert(WSREP_OK == provider.preordered_commit(&provider, &handle,
+                                                     &source,
+                                                     WSREP_FLAG_COMMIT, 1,
+                                                     true));
+
+    std::string const applied(node.wait_applied(10));
+    ck_assert_msg(applied == std::string(payload, sizeof(payload)),
+                  "preordered writeset was not applied under protocol %d",
+                  proto_max);
+
+    node.stop();
+}
+
+START_TEST(preordered_proto9)
+{
+    preordered(9);
+}
+END_TEST
+
+START_TEST(preordered_proto10)
+{
+    preordered(10);
+}
+END_TEST
+
+Suite* replicator_smm_suite()
+{
+    Suite* s = suite_create("replicator_smm");
+    TCase* tc;
+
+    tc = tcase_create("preordered");
+    tcase_add_test(tc, preordered_proto9);
+    tcase_add_test(tc, preordered_proto10);
+    tcase_set_timeout(tc, 60);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
@@ -48,6 +48,11 @@ namespace gu
         {
             buf_.insert(pos, first, last);
         }
+        template <class InputIt>
+        void assign(InputIt first, InputIt last)
+        {
+            buf_.assign(first, last);
+        }
         byte_t& operator[](size_t i)
         {
             assert(i < buf_.size());
@@ -65,6 +70,7 @@ namespace gu
         void resize(size_t size) { buf_.resize(size); }
         void reserve(size_t size) { buf_.reserve(size); }
         void clear() { buf_.clear(); }
+        void swap(Buffer& other) { buf_.swap(other.buf_); }
         bool empty() const { return buf_.empty(); }
         size_t size() const { return buf_.size(); }
         bool operator==(const Buffer& other) const
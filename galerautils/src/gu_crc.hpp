@@ -10,6 +10,11 @@
 #define GU_CRC_HPP
 
 #include "gu_crc32c.h"
+#include "gu_byteswap.hpp"
+#include "gu_types.hpp"
+
+#include <algorithm> // std::min()
+#include <string.h>  // memcpy()
 
 namespace gu
 {
@@ -40,6 +45,92 @@ private:
 
 }; /* class CRC32C */
 
+/*! 64-bit checksum made of three CRC-32C streams over interleaved 8-byte
+ *  words (see gu_crc32c_x3_func_t). Streams are independent, so unlike plain
+ *  CRC32C this can be computed at the full throughput of crc32 instruction.
+ *  Input is buffered up to a full GU_CRC32C_X3_BLOCK, the last partial block
+ *  is distributed between the streams in the same manner. */
+class CRC32C3
+{
+public:
+
+    CRC32C3() : tail_len_(0)
+    {
+        state_[0] = state_[1] = state_[2] = GU_CRC32C_INIT;
+    }
+
+    void append(const void* const data, size_t size)
+    {
+        const byte_t* ptr(static_cast<const byte_t*>(data));
+
+        if (tail_len_ > 0)
+        {
+            size_t const fill(std::min(size, size_t(BLOCK) - tail_len_));
+            ::memcpy(tail_ + tail_len_, ptr, fill);
+            tail_len_ += fill;
+            ptr       += fill;
+            size      -= fill;
+
+            if (tail_len_ < BLOCK) return;
+
+            gu_crc32c_x3_func(state_, tail_, BLOCK);
+            tail_len_ = 0;
+        }
+
+        size_t const blocks(size - size % BLOCK);
+        if (blocks > 0) gu_crc32c_x3_func(state_, ptr, blocks);
+
+        tail_len_ = size - blocks;
+        ::memcpy(tail_, ptr + blocks, tail_len_);
+    }
+
+    uint64_t get() const
+    {
+        gu_crc32c_t s[3] = { state_[0], state_[1], state_[2] };
+
+        for (size_t i(0); i < 3 && i * WORD < tail_len_; ++i)
+        {
+            size_t const len(std::min(size_t(WORD), tail_len_ - i * WORD));
+            s[i] = gu_crc32c_func(s[i], tail_ + i * WORD, len);
+        }
+
+        uint64_t const c0(gu_crc32c_get(s[0]));
+        uint64_t const c1(gu_crc32c_get(s[1]));
+        uint64_t const c2(gu_crc32c_get(s[2]));
+
+        return ((c1 << 32) | c0) ^ (c2 << 16);
+    }
+
+    uint64_t operator() () const { return get(); }
+
+    /*! writes up to 8 bytes of checksum in little-endian order */
+    void gather(void* const buf, size_t const size) const
+    {
+        uint64_t const res(htog<uint64_t>(get()));
+        ::memcpy(buf, &res, std::min(size, sizeof(res)));
+    }
+
+    static uint64_t digest(const void* const data, size_t const size)
+    {
+        CRC32C3 crc;
+        crc.append(data, size);
+        return crc.get();
+    }
+
+private:
+
+    enum
+    {
+        BLOCK = GU_CRC32C_X3_BLOCK,
+        WORD  = BLOCK / 3
+    };
+
+    gu_crc32c_t state_[3];
+    byte_t      tail_[BLOCK];
+    size_t      tail_len_;
+
+}; /* class CRC32C3 */
+
 } /* namespace gu */
 
 #endif /* GU_CRC_HPP */
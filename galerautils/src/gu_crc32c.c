@@ -13,6 +13,8 @@
 #include "gu_arch.h"     // GU_ASSERT_ALIGNMENT()
 #include "gu_byteswap.h" // gu_le32()
 
+#include <string.h> // memcpy()
+
 static uint32_t crc32c_lut[8][256]; /* CRC32C lookup tables */
 
 static void
@@ -183,6 +185,44 @@ gu_crc32c_slicing_by_8(gu_crc32c_t state, const void* data, size_t len)
     return crc32c_3bytes(state, ptr, len);
 }
 
+/** Slicing-by-8 step over a single, possibly misaligned, 8-byte word */
+static inline gu_crc32c_t
+crc32c_8bytes(gu_crc32c_t state, const uint8_t* ptr)
+{
+    uint32_t slices[2];
+    memcpy(slices, ptr, sizeof(slices));
+
+    gu_crc32c_t state0 = gu_le32(slices[0]) ^ state;
+    GU_CRC32C_4BYTE_BLOCK(state0, 4);
+
+    gu_crc32c_t state1 = gu_le32(slices[1]);
+    GU_CRC32C_4BYTE_BLOCK(state1, 0);
+
+    return state0 ^ state1;
+}
+
+void
+gu_crc32c_x3_slicing_by_8(gu_crc32c_t state[3], const void* data, size_t len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    assert(0 == len % GU_CRC32C_X3_BLOCK);
+
+    gu_crc32c_t s0 = state[0], s1 = state[1], s2 = state[2];
+
+    while (len >= GU_CRC32C_X3_BLOCK)
+    {
+        s0 = crc32c_8bytes(s0, ptr);
+        s1 = crc32c_8bytes(s1, ptr + 8);
+        s2 = crc32c_8bytes(s2, ptr + 16);
+
+        len -= GU_CRC32C_X3_BLOCK;
+        ptr += GU_CRC32C_X3_BLOCK;
+    }
+
+    state[0] = s0; state[1] = s1; state[2] = s2;
+}
+
 static gu_crc32c_func_t
 crc32c_best_algorithm()
 {
@@ -209,11 +249,30 @@ crc32c_best_algorithm()
     return ret;
 }
 
-gu_crc32c_func_t gu_crc32c_func = NULL;
+static gu_crc32c_x3_func_t
+crc32c_x3_best_algorithm()
+{
+    gu_crc32c_x3_func_t ret = NULL;
+
+#if !defined(GU_CRC32C_NO_HARDWARE)
+    ret = gu_crc32c_x3_hardware();
+#endif
+
+    if (!ret)
+    {
+        ret = gu_crc32c_x3_slicing_by_8;
+    }
+
+    return ret;
+}
+
+gu_crc32c_func_t    gu_crc32c_func    = NULL;
+gu_crc32c_x3_func_t gu_crc32c_x3_func = NULL;
 
 void
 gu_crc32c_configure()
 {
     crc32c_compute_lut();
-    gu_crc32c_func = crc32c_best_algorithm();
+    gu_crc32c_func    = crc32c_best_algorithm();
+    gu_crc32c_x3_func = crc32c_x3_best_algorithm();
 }
@@ -56,6 +56,18 @@ gu_crc32c (const void* data, size_t size)
     return (~(gu_crc32c_func (GU_CRC32C_INIT, data, size)));
 }
 
+/*! Three independent CRC32-C streams over interleaved data: input is split
+ *  into 8-byte words which are fed to streams 0, 1 and 2 in turn, so that the
+ *  three dependency chains can be computed in parallel.
+ *  Length must be a multiple of GU_CRC32C_X3_BLOCK. */
+#define GU_CRC32C_X3_BLOCK 24
+
+typedef void (*gu_crc32c_x3_func_t) (gu_crc32c_t state[3],
+                                     const void* data,
+                                     size_t      length);
+
+extern gu_crc32c_x3_func_t gu_crc32c_x3_func;
+
 /* Portable software-only CRC32-C implementations for gu_crc32c_func */
 extern gu_crc32c_t
 gu_crc32c_sarwate     (gu_crc32c_t state, const void* data, size_t length);
@@ -64,6 +76,10 @@ gu_crc32c_slicing_by_4(gu_crc32c_t state, const void* data, size_t length);
 extern gu_crc32c_t
 gu_crc32c_slicing_by_8(gu_crc32c_t state, const void* data, size_t length);
 
+/* Portable software-only implementation for gu_crc32c_x3_func */
+extern void
+gu_crc32c_x3_slicing_by_8(gu_crc32c_t state[3], const void* data, size_t len);
+
 #if !defined(GU_CRC32C_NO_HARDWARE)
 
 #if defined(__x86_64) || defined(_M_AMD64) || defined(_M_X64)
@@ -81,6 +97,12 @@ gu_crc32c_x86(gu_crc32c_t state, const void* data, size_t length);
 #if defined(GU_CRC32C_X86_64)
 extern gu_crc32c_t
 gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t length);
+extern void
+gu_crc32c_x3_x86_64(gu_crc32c_t state[3], const void* data, size_t length);
+/* 3-way interleaved with PCLMULQDQ combination, falls back to
+ * gu_crc32c_x86_64() if not compiled with PCLMUL support */
+extern gu_crc32c_t
+gu_crc32c_x86_64_pclmul(gu_crc32c_t state, const void* data, size_t length);
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
@@ -88,11 +110,15 @@ gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t length);
 #define GU_CRC32C_ARM64
 extern gu_crc32c_t
 gu_crc32c_arm64(gu_crc32c_t state, const void* data, size_t length);
+extern void
+gu_crc32c_x3_arm64(gu_crc32c_t state[3], const void* data, size_t length);
 #endif /* __aarch64__ || __AARCH64__ */
 
 #if defined(GU_CRC32C_X86) || defined(GU_CRC32C_ARM64)
 /** Returns hardware-accelerated CRC32C implementation */
 extern gu_crc32c_func_t gu_crc32c_hardware();
+/** Returns hardware-accelerated 3-stream CRC32C implementation */
+extern gu_crc32c_x3_func_t gu_crc32c_x3_hardware();
 #else
 #define GU_CRC32C_NO_HARDWARE 1
 #endif
@@ -68,6 +68,28 @@ gu_crc32c_arm64(gu_crc32c_t state, const void* data, size_t len)
     return crc32c_arm64_tail7(state, ptr, len);
 }
 
+void
+gu_crc32c_x3_arm64(gu_crc32c_t state[3], const void* data, size_t len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    assert(0 == len % GU_CRC32C_X3_BLOCK);
+
+    gu_crc32c_t s0 = state[0], s1 = state[1], s2 = state[2];
+
+    while (len >= GU_CRC32C_X3_BLOCK)
+    {
+        /* three independent chains hide crc32 instruction latency */
+        s0 = __crc32cd(s0, *(uint64_t*)(ptr));
+        s1 = __crc32cd(s1, *(uint64_t*)(ptr + 8));
+        s2 = __crc32cd(s2, *(uint64_t*)(ptr + 16));
+        len -= GU_CRC32C_X3_BLOCK;
+        ptr += GU_CRC32C_X3_BLOCK;
+    }
+
+    state[0] = s0; state[1] = s1; state[2] = s2;
+}
+
 #include <sys/auxv.h>
 
 #if defined(__FreeBSD__)
@@ -110,4 +132,13 @@ gu_crc32c_hardware()
 #endif /* GU_AT_HWCAP */
 }
 
+gu_crc32c_x3_func_t
+gu_crc32c_x3_hardware()
+{
+#if defined(GU_AT_HWCAP)
+    if (getauxval(GU_AT_HWCAP) & GU_HWCAP_CRC32) return gu_crc32c_x3_arm64;
+#endif /* GU_AT_HWCAP */
+    return NULL;
+}
+
 #endif /* GU_CRC32C_ARM64 */
@@ -65,11 +65,9 @@ gu_crc32c_x86(gu_crc32c_t state, const void* data, size_t len)
 }
 
 #if defined(GU_CRC32C_X86_64)
-gu_crc32c_t
-gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t len)
+static inline gu_crc32c_t
+crc32c_x86_64(gu_crc32c_t state, const uint8_t* ptr, size_t len)
 {
-    const uint8_t* ptr = (const uint8_t*)data;
-
 #ifdef __LP64__
     static size_t const arg_size = sizeof(uint64_t);
     uint64_t state64 = state;
@@ -86,6 +84,146 @@ gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t len)
 
     return crc32c_x86(state, ptr, len);
 }
+
+gu_crc32c_t
+gu_crc32c_x86_64(gu_crc32c_t state, const void* data, size_t len)
+{
+    return crc32c_x86_64(state, (const uint8_t*)data, len);
+}
+
+void
+gu_crc32c_x3_x86_64(gu_crc32c_t state[3], const void* data, size_t len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    assert(0 == len % GU_CRC32C_X3_BLOCK);
+
+#ifdef __LP64__
+    uint64_t s0 = state[0], s1 = state[1], s2 = state[2];
+
+    while (len >= GU_CRC32C_X3_BLOCK)
+    {
+        /* three independent chains hide crc32 instruction latency */
+        s0 = __builtin_ia32_crc32di(s0, *(uint64_t*)(ptr));
+        s1 = __builtin_ia32_crc32di(s1, *(uint64_t*)(ptr + 8));
+        s2 = __builtin_ia32_crc32di(s2, *(uint64_t*)(ptr + 16));
+        len -= GU_CRC32C_X3_BLOCK;
+        ptr += GU_CRC32C_X3_BLOCK;
+    }
+#else
+    uint32_t s0 = state[0], s1 = state[1], s2 = state[2];
+
+    while (len >= GU_CRC32C_X3_BLOCK)
+    {
+        s0 = __builtin_ia32_crc32si(s0, *(uint32_t*)(ptr));
+        s1 = __builtin_ia32_crc32si(s1, *(uint32_t*)(ptr + 8));
+        s2 = __builtin_ia32_crc32si(s2, *(uint32_t*)(ptr + 16));
+        s0 = __builtin_ia32_crc32si(s0, *(uint32_t*)(ptr + 4));
+        s1 = __builtin_ia32_crc32si(s1, *(uint32_t*)(ptr + 12));
+        s2 = __builtin_ia32_crc32si(s2, *(uint32_t*)(ptr + 20));
+        len -= GU_CRC32C_X3_BLOCK;
+        ptr += GU_CRC32C_X3_BLOCK;
+    }
+#endif /* __LP64__ */
+
+    state[0] = (uint32_t)s0;
+    state[1] = (uint32_t)s1;
+    state[2] = (uint32_t)s2;
+}
+
+#if defined(__PCLMUL__) && defined(__LP64__)
+
+#include <wmmintrin.h> // _mm_clmulepi64_si128()
+
+/*
+ * A single chain of crc32 instructions is bound by their 3-cycle latency.
+ * Here the buffer is split into three adjacent parts which are processed in
+ * parallel, the second and the third starting from zero state. The results are
+ * then combined as
+ *
+ *     crc = crc0 * x^(2*8*L) + crc1 * x^(8*L) + crc2 (mod P)
+ *
+ * where L is the length of each part. Multiplication by x^(8*L) is done by
+ * carry-less multiplication by a constant k = x^(8*L - 33) mod P followed by
+ * crc32 instruction over the 64-bit product, which contributes x^32 and the
+ * remaining x comes from the bit-reflected product of 32-bit operands.
+ */
+#define CRC32C_LONG  8192
+#define CRC32C_SHORT 256
+
+/* x^(8*L - 33) and x^(2*8*L - 33) mod P, bit-reflected */
+static uint32_t const crc32c_long_k1  = 0x54a86326;
+static uint32_t const crc32c_long_k2  = 0x1dc403cc;
+static uint32_t const crc32c_short_k1 = 0xb9e02b86;
+static uint32_t const crc32c_short_k2 = 0xdd7e3b0c;
+
+static inline uint64_t
+crc32c_shift_pclmul(uint64_t const crc, uint32_t const k)
+{
+    __m128i const prod = _mm_clmulepi64_si128(_mm_cvtsi64_si128(crc),
+                                              _mm_cvtsi32_si128(k), 0);
+    return __builtin_ia32_crc32di(0, _mm_cvtsi128_si64(prod));
+}
+
+static inline uint64_t
+crc32c_3way(uint64_t state, const uint8_t** ptr, size_t* len,
+            size_t const part, uint32_t const k1, uint32_t const k2)
+{
+    while (*len >= 3 * part)
+    {
+        const uint8_t* p = *ptr;
+        const uint8_t* const end = p + part;
+        uint64_t crc0 = state, crc1 = 0, crc2 = 0;
+
+        while (p < end)
+        {
+            crc0 = __builtin_ia32_crc32di(crc0, *(uint64_t*)(p));
+            crc1 = __builtin_ia32_crc32di(crc1, *(uint64_t*)(p + part));
+            crc2 = __builtin_ia32_crc32di(crc2, *(uint64_t*)(p + 2 * part));
+            p += sizeof(uint64_t);
+        }
+
+        state = crc32c_shift_pclmul(crc0, k2) ^ crc32c_shift_pclmul(crc1, k1)
+            ^ crc2;
+
+        *ptr += 3 * part;
+        *len -= 3 * part;
+    }
+
+    return state;
+}
+
+gu_crc32c_t
+gu_crc32c_x86_64_pclmul(gu_crc32c_t state, const void* data, size_t len)
+{
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    if (len >= 3 * CRC32C_SHORT) /* short buffers go straight to single chain */
+    {
+        uint64_t state64 = state;
+
+        state64 = crc32c_3way(state64, &ptr, &len, CRC32C_LONG,
+                              crc32c_long_k1, crc32c_long_k2);
+        state64 = crc32c_3way(state64, &ptr, &len, CRC32C_SHORT,
+                              crc32c_short_k1, crc32c_short_k2);
+
+        state = (uint32_t)state64;
+    }
+
+    return crc32c_x86_64(state, ptr, len);
+}
+
+#define GU_CRC32C_HAVE_PCLMUL 1
+
+#else
+
+gu_crc32c_t
+gu_crc32c_x86_64_pclmul(gu_crc32c_t state, const void* data, size_t len)
+{
+    return gu_crc32c_x86_64(state, data, len);
+}
+
+#endif /* __PCLMUL__ && __LP64__ */
 #endif /* GU_CRC32C_X86_64 */
 
 #include <cpuid.h>
@@ -100,15 +238,36 @@ x86_cpuid(uint32_t input)
         return 0;
 }
 
-gu_crc32c_func_t
-gu_crc32c_hardware()
+static bool
+x86_sse42_present()
 {
     static uint32_t const SSE42_BIT = 1 << 20;
     uint32_t const cpuid = x86_cpuid(1);
-    bool const SSE42_present = cpuid & SSE42_BIT;
+    return cpuid & SSE42_BIT;
+}
+
+#if defined(GU_CRC32C_HAVE_PCLMUL)
+static bool
+x86_pclmul_present()
+{
+    static uint32_t const PCLMUL_BIT = 1 << 1;
+    uint32_t const cpuid = x86_cpuid(1);
+    return cpuid & PCLMUL_BIT;
+}
+#endif /* GU_CRC32C_HAVE_PCLMUL */
 
-    if (SSE42_present)
+gu_crc32c_func_t
+gu_crc32c_hardware()
+{
+    if (x86_sse42_present())
     {
+#if defined(GU_CRC32C_HAVE_PCLMUL)
+        if (x86_pclmul_present())
+        {
+            gu_info ("CRC-32C: using 64-bit x86 acceleration with PCLMUL.");
+            return gu_crc32c_x86_64_pclmul;
+        }
+#endif
 #if defined(GU_CRC32C_X86_64)
         gu_info ("CRC-32C: using 64-bit x86 acceleration.");
         return gu_crc32c_x86_64;
@@ -123,4 +282,13 @@ gu_crc32c_hardware()
     }
 }
 
+gu_crc32c_x3_func_t
+gu_crc32c_x3_hardware()
+{
+#if defined(GU_CRC32C_X86_64)
+    if (x86_sse42_present()) return gu_crc32c_x3_x86_64;
+#endif
+    return NULL;
+}
+
 #endif /* GU_CRC32C_X86 */
@@ -78,6 +78,23 @@ public:
 
     uint32_t gather4() const { return gu_mmh128_get32 (&ctx_); }
 
+    /* gathers 16-byte hashes of n contexts at once into consecutive
+     * positions in buf, same as calling gather16() on each */
+    static void
+    gather16 (const MMH3* const ctx[], size_t const n, void* const buf)
+    {
+        enum { BATCH = 16 };
+        const gu_mmh128_ctx_t* c[BATCH];
+        byte_t* const out(static_cast<byte_t*>(buf));
+
+        for (size_t i(0); i < n; i += BATCH)
+        {
+            size_t const m(std::min(n - i, size_t(BATCH)));
+            for (size_t l(0); l < m; ++l) c[l] = &ctx[i + l]->ctx_;
+            gu_mmh128_get_multi (c, m, out + (i << 4));
+        }
+    }
+
     // a questionable feature
     template <typename T> int
     operator() (T& out) const { return gather<sizeof(out)>(&out); }
@@ -375,6 +375,89 @@ gu_mmh128_get32 (const gu_mmh128_ctx_t* const mmh)
     return (uint32_t)res[0];
 }
 
+/*
+ * Functions to hash several messages at once
+ */
+
+/*! Same as _mmh3_128_tail(), but instead of switch() on the tail length tail
+ *  words are masked: a zero word does not change the state, so the result is
+ *  the same. Without a data-dependent branch there are no mispredictions on
+ *  keys of varying length and finalization of independent hashes overlaps in
+ *  the pipeline. Tail must be 16 bytes, only len & 15 of them are used. */
+static GU_FORCE_INLINE void
+_mmh3_128_tail_nb (const uint64_t tail[2], size_t const len,
+                   uint64_t h1, uint64_t h2, void* const out)
+{
+    size_t   const t  = len & 15;
+    uint64_t const m1 = t >= 8 ? ~GU_ULONG_LONG(0) :
+        (GU_ULONG_LONG(1) << (t << 3)) - 1;
+    uint64_t const m2 = t <= 8 ? 0 :
+        (GU_ULONG_LONG(1) << ((t - 8) << 3)) - 1;
+
+    uint64_t k1 = gu_le64(tail[0]) & m1;
+    uint64_t k2 = gu_le64(tail[1]) & m2;
+    uint64_t r[2];
+
+    k2 *= _mmh3_128_c2; k2 = GU_ROTL64(k2,33); k2 *= _mmh3_128_c1; h2 ^= k2;
+    k1 *= _mmh3_128_c1; k1 = GU_ROTL64(k1,31); k1 *= _mmh3_128_c2; h1 ^= k1;
+
+    //----------
+    // finalization
+
+    h1 ^= len; h2 ^= len;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = _mmh3_fmix64(h1);
+    h2 = _mmh3_fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    r[0] = gu_le64(h1);
+    r[1] = gu_le64(h2);
+    memcpy(out, r, sizeof(r));
+}
+
+void
+gu_mmh128_multi (const void* const msg[],
+                 const size_t      len[],
+                 size_t      const n,
+                 void*       const out)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        size_t const nblocks = (len[i] >> 4) << 1; /* 64-bit half-blocks */
+        const uint64_t* const blocks = (const uint64_t*)(msg[i]);
+        uint64_t h1 = GU_MMH128_SEED1;
+        uint64_t h2 = GU_MMH128_SEED2;
+        uint64_t tail[2] = { 0, 0 };
+
+        _mmh3_128_blocks (blocks, nblocks, &h1, &h2);
+        memcpy (tail, blocks + nblocks, len[i] & 15);
+
+        _mmh3_128_tail_nb (tail, len[i], h1, h2, (uint8_t*)out + (i << 4));
+    }
+}
+
+void
+gu_mmh128_get_multi (const gu_mmh128_ctx_t* const mmh[],
+                     size_t                 const n,
+                     void*                  const res)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        _mmh3_128_tail_nb (mmh[i]->tail, mmh[i]->length,
+                           mmh[i]->hash[0], mmh[i]->hash[1],
+                           (uint8_t*)res + (i << 4));
+    }
+}
+
 void
 gu_mmh3_32 (const void* const key, int const len, uint32_t const seed, void* const out)
 {
@@ -69,6 +69,22 @@ gu_mmh128_get64(const gu_mmh128_ctx_t* mmh);
 extern uint32_t
 gu_mmh128_get32(const gu_mmh128_ctx_t* mmh);
 
+/*
+ * Functions to hash several independent messages at once
+ * (meant for short keys where finalization dominates)
+ */
+
+/*! Hash n messages, same as calling gu_mmh128() on each.
+ *  Hashes are written to out one after another, 16 bytes each. */
+extern void
+gu_mmh128_multi(const void* const msg[], const size_t len[], size_t n,
+                void* out);
+
+/*! Get accumulated hashes of n contexts, same as calling gu_mmh128_get()
+ *  on each. Hashes are written to res one after another, 16 bytes each. */
+extern void
+gu_mmh128_get_multi(const gu_mmh128_ctx_t* const mmh[], size_t n, void* res);
+
 /*
  * Below are fuctions with reference signatures for implementation verification
  */
@@ -35,6 +35,7 @@ RecordSet::check_size (RecordSet::CheckType const ct)
     case RecordSet::CHECK_MMH32:  return 4;
     case RecordSet::CHECK_MMH64:  return 8;
     case RecordSet::CHECK_MMH128: return 16;
+    case RecordSet::CHECK_CRC32C3: return 8;
 #define MAX_CHECKSUM_SIZE                16
     }
 
@@ -374,7 +375,7 @@ RecordSetOutBase::RecordSetOutBase (byte_t*                 reserved,
     max_size_   (max_size),
 #endif
     alloc_      (base_name, reserved, reserved_size),
-    check_      (),
+    check_      (ct),
     bufs_       (),
     prev_stored_(true)
 {
@@ -427,6 +428,8 @@ header_check_type(RecordSet::Version const ver,
             return RecordSet::CHECK_MMH32;
         case RecordSet::CHECK_MMH64:  return RecordSet::CHECK_MMH64;
         case RecordSet::CHECK_MMH128: return RecordSet::CHECK_MMH128;
+        case RecordSet::CHECK_CRC32C3: if (RecordSet::VER1 == ver) break;
+            return RecordSet::CHECK_CRC32C3;
         }
 
         gu_throw_error (EPROTO) << "Unsupported RecordSet checksum type: " << ct;
@@ -535,14 +538,14 @@ RecordSetInBase::checksum() const
 
     if (cs > 0) /* checksum records */
     {
-        Hash check;
+        Checksum check(check_type());
 
         check.append (head_ + begin_, serial_size() - begin_); /* records */
         check.append (head_, begin_ - cs);                     /* header  */
 
         assert(cs <= MAX_CHECKSUM_SIZE);
         byte_t result[MAX_CHECKSUM_SIZE];
-        check.gather<sizeof(result)>(result);
+        check.gather(result, cs);
 
         const byte_t* const stored_checksum(head_ + begin_ - cs);
 
@@ -16,6 +16,7 @@
 #include "gu_vector.hpp"
 #include "gu_alloc.hpp"
 #include "gu_digest.hpp"
+#include "gu_crc.hpp"
 
 #include "gu_limits.h" // GU_MIN_ALIGNMENT
 
@@ -46,7 +47,8 @@ public:
         CHECK_NONE   = 0,
         CHECK_MMH32,
         CHECK_MMH64,
-        CHECK_MMH128
+        CHECK_MMH128,
+        CHECK_CRC32C3  /* 3 interleaved CRC32C streams, VER2 and above */
     };
 
     static int check_size(CheckType ct);
@@ -95,6 +97,34 @@ protected:
     void init (const byte_t* buf, ssize_t size);
 
     ~RecordSet() {}
+
+    /* Payload checksum: MMH3 flavours are all computed as MMH128 and then
+     * truncated to check_size(), CHECK_CRC32C3 uses hardware CRC32C if
+     * available. */
+    class Checksum
+    {
+    public:
+
+        explicit Checksum (CheckType const ct = CHECK_NONE)
+            : mmh_(), crc_(), crc3_(CHECK_CRC32C3 == ct)
+        {}
+
+        void append (const void* const ptr, size_t const size)
+        {
+            if (crc3_) crc_.append(ptr, size); else mmh_.append(ptr, size);
+        }
+
+        void gather (void* const buf, size_t const size) const
+        {
+            if (crc3_) crc_.gather(buf, size); else mmh_.gather(buf, size);
+        }
+
+    private:
+
+        Hash    mmh_;
+        CRC32C3 crc_;
+        bool    crc3_;
+    };
 };
 
 
@@ -214,7 +244,7 @@ private:
     ssize_t const max_size_;
 #endif
     Allocator     alloc_;
-    Hash          check_;
+    Checksum      check_;
     Vector<Buf, Allocator::INITIAL_VECTOR_SIZE> bufs_;
     bool          prev_stored_;
 
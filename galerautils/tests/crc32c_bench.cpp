@@ -3,6 +3,8 @@
  */
 
 #include "../src/gu_crc32c.h"
+#include "../src/gu_crc.hpp"
+#include "../src/gu_digest.hpp"
 
 #include <iostream>
 #include <sstream>
@@ -107,13 +109,71 @@ one_length(size_t const len, size_t const reps)
     run_bench_with_impl(gu_crc32c_x86,          len, reps, "GU x86_32  ");
 #if defined(GU_CRC32C_X86_64)
     run_bench_with_impl(gu_crc32c_x86_64,       len, reps, "GU x86_64  ");
+    if (gu_crc32c_x86_64_pclmul == configured_impl)
+        run_bench_with_impl(gu_crc32c_x86_64_pclmul, len, reps, "GU PCLMUL  ");
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
 #if defined(GU_CRC32C_ARM64)
     if (gu_crc32c_arm64 == configured_impl)
         run_bench_with_impl(gu_crc32c_arm64,    len, reps, "GU arm64   ");
-#endif /* GU_CRC32C_X86 */
+#endif /* GU_CRC32C_ARM64 */
+}
+
+// RecordSet payload checksums: CHECK_MMH* is always computed as MMH128,
+// CHECK_CRC32C3 is 3-stream CRC32C.
+static std::vector<unsigned char> record(1<<24 /* 16M */);
+
+template <class Check>
+static uint64_t
+run_check(size_t const len, size_t const reps)
+{
+    uint64_t result(0);
+
+    for (size_t r(0); r < reps; ++r)
+    {
+        Check check;
+        check.append(&record[0], len);
+        uint64_t res;
+        check.gather(&res, sizeof(res));
+        result += res;
+    }
+
+    return result;
+}
+
+template <class Check>
+static void
+run_check_bench(size_t const len, size_t const reps, const char* comment)
+{
+#if __cplusplus >= 201103L
+    auto start(std::chrono::steady_clock::now());
+    auto result(run_check<Check>(len, reps));
+    auto stop(std::chrono::steady_clock::now());
+    auto duration(std::chrono::duration<double>(stop - start).count());
+#else
+    struct timeval start, stop;
+    gettimeofday(&start, NULL);
+    uint64_t result(run_check<Check>(len, reps));
+    gettimeofday(&stop,  NULL);
+    double const duration(time_diff(stop, start));
+#endif // C++11
+
+    std::cout << comment << '\t' << len << '\t'
+              << std::fixed << duration << '\t'
+              << double(len) * reps / duration / (1 << 20) << '\t'
+              << std::hex << result << std::dec << '\n';
+}
+
+static void
+one_record(size_t const len)
+{
+    size_t const reps((size_t(1) << 30) / len); // 1G total
+
+    std::cout << "\nCheck:  \tBytes:\tDuration:\tMB/s:\tResult:\n";
+
+    run_check_bench<gu::MMH3>(len, reps, "MMH128     ");
+    run_check_bench<gu::CRC32C3>(len, reps, "CRC32C x 3 ");
 }
 
 int main()
@@ -126,5 +186,19 @@ int main()
     one_length(31,  1<<21 /* 2M   */);
     one_length(64,  1<<20 /* 1M   */);
     one_length(512, 1<<17 /* 128K */);
+    one_length(4096,  1<<14 /* 16K  */);
+    one_length(1<<16, 1<<10 /* 1K   */);
     one_length(1<<20,  64 /* 1M   */);
+
+    gu_crc32c_func = configured_impl;
+    for (size_t i(0); i < record.size(); ++i)
+    {
+        record[i] = static_cast<unsigned char>(i * 7);
+    }
+
+    one_record(1<<10 /* 1K   */);
+    one_record(1<<14 /* 16K  */);
+    one_record(1<<18 /* 256K */);
+    one_record(1<<22 /* 4M   */);
+    one_record(1<<24 /* 16M  */);
 }
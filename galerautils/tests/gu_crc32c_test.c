@@ -102,6 +102,80 @@ test_function(void)
                   "Generated %#08x, expected %#08x\n", ret, output);
 }
 
+/* compares gu_crc32c_func with slicing-by-8 on buffers long enough to engage
+ * multi-stream processing */
+static void
+test_long_function(void)
+{
+    static uint8_t buf[65536 + 8];
+    static size_t const lengths[] =
+        { 0, 767, 768, 769, 3*256*5 + 7, 3*8192, 3*8192 + 3*256 + 5,
+          65536 };
+
+    size_t i;
+    for (i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 131 + (i >> 8));
+
+    gu_crc32c_func_t const func = gu_crc32c_func;
+
+    for (i = 0; i < sizeof(lengths)/sizeof(lengths[0]); i++)
+    {
+        size_t off;
+        for (off = 0; off < 8; off += 3)
+        {
+            size_t const len = lengths[i];
+
+            gu_crc32c_func = gu_crc32c_slicing_by_8;
+            uint32_t const expected = gu_crc32c(buf + off, len);
+
+            gu_crc32c_func = func;
+            uint32_t const ret = gu_crc32c(buf + off, len);
+
+            ck_assert_msg(ret == expected,
+                          "Length %zu, offset %zu: generated %#08x, "
+                          "expected %#08x\n", len, off, ret, expected);
+        }
+    }
+}
+
+/* each of 3 streams must be equal to plain CRC32C over its words */
+static void
+test_x3_function(gu_crc32c_x3_func_t const func)
+{
+    const char* const input = long_input;
+    size_t const size = strlen(input);
+    size_t const word = GU_CRC32C_X3_BLOCK / 3;
+
+    ck_assert(0 == size % GU_CRC32C_X3_BLOCK);
+
+    gu_crc32c_t state[3] = { GU_CRC32C_INIT, GU_CRC32C_INIT, GU_CRC32C_INIT };
+
+    /* in two steps to check that state is carried over */
+    func(state, input, GU_CRC32C_X3_BLOCK);
+    func(state, input + GU_CRC32C_X3_BLOCK, size - GU_CRC32C_X3_BLOCK);
+
+    int s;
+    for (s = 0; s < 3; s++)
+    {
+        char   stream[sizeof(long_input)];
+        size_t len = 0;
+        size_t off;
+
+        for (off = s * word; off < size; off += GU_CRC32C_X3_BLOCK)
+        {
+            memcpy(stream + len, input + off, word);
+            len += word;
+        }
+
+        uint32_t const expected = gu_crc32c_get(
+            gu_crc32c_sarwate(GU_CRC32C_INIT, stream, len));
+        uint32_t const ret = gu_crc32c_get(state[s]);
+
+        ck_assert_msg(ret == expected,
+                      "Stream %d: generated %#08x, expected %#08x\n",
+                      s, ret, expected);
+    }
+}
+
 START_TEST(test_gu_crc32c_sarwate)
 {
     gu_crc32c_func = gu_crc32c_sarwate;
@@ -123,6 +197,12 @@ START_TEST(test_gu_crc32c_slicing_by_8)
 }
 END_TEST
 
+START_TEST(test_gu_crc32c_x3_slicing_by_8)
+{
+    test_x3_function(gu_crc32c_x3_slicing_by_8);
+}
+END_TEST
+
 #if defined(GU_CRC32C_X86)
 START_TEST(test_gu_crc32c_x86)
 {
@@ -138,6 +218,24 @@ START_TEST(test_gu_crc32c_x86_64)
     test_function();
 }
 END_TEST
+
+START_TEST(test_gu_crc32c_x86_64_pclmul)
+{
+    gu_crc32c_func = gu_crc32c_hardware();
+
+    if (gu_crc32c_x86_64_pclmul == gu_crc32c_func)
+    {
+        test_function();
+        test_long_function();
+    }
+}
+END_TEST
+
+START_TEST(test_gu_crc32c_x3_x86_64)
+{
+    test_x3_function(gu_crc32c_x3_x86_64);
+}
+END_TEST
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
@@ -153,6 +251,18 @@ START_TEST(test_gu_crc32c_arm64)
     }
 }
 END_TEST
+
+START_TEST(test_gu_crc32c_x3_arm64)
+{
+    gu_crc32c_x3_func_t const func = gu_crc32c_x3_hardware();
+
+    if (NULL != func)
+    {
+        ck_assert(gu_crc32c_x3_arm64 == func);
+        test_x3_function(func);
+    }
+}
+END_TEST
 #endif /* GU_CRC32C_ARM64 */
 
 Suite *gu_crc32c_suite(void)
@@ -167,6 +277,7 @@ Suite *gu_crc32c_suite(void)
     tcase_add_test  (t, test_gu_crc32c_sarwate);
     tcase_add_test  (t, test_gu_crc32c_slicing_by_4);
     tcase_add_test  (t, test_gu_crc32c_slicing_by_8);
+    tcase_add_test  (t, test_gu_crc32c_x3_slicing_by_8);
 
 #if defined(GU_CRC32C_X86)
     t = tcase_create("gu_crc32c_hw_x86");
@@ -174,6 +285,8 @@ Suite *gu_crc32c_suite(void)
     tcase_add_test  (t, test_gu_crc32c_x86);
 #if defined(GU_CRC32C_X86_64)
     tcase_add_test  (t, test_gu_crc32c_x86_64);
+    tcase_add_test  (t, test_gu_crc32c_x86_64_pclmul);
+    tcase_add_test  (t, test_gu_crc32c_x3_x86_64);
 #endif /* GU_CRC32C_X86_64 */
 #endif /* GU_CRC32C_X86 */
 
@@ -181,6 +294,7 @@ Suite *gu_crc32c_suite(void)
     t = tcase_create("gu_crc32c_hw_arm64");
     suite_add_tcase (suite, t);
     tcase_add_test  (t, test_gu_crc32c_arm64);
+    tcase_add_test  (t, test_gu_crc32c_x3_arm64);
 #endif /* GU_CRC32C_ARM64 */
 
     return suite;
@@ -9,6 +9,8 @@
 #include "../src/gu_hexdump.h"
 #include "../src/gu_byteswap.h"
 
+#include <string.h> // memset(), memcpy(), memcmp()
+
 /* This is to verify all tails plus block + all tails. Max block is 16 bytes */
 static const char test_input[] = "0123456789ABCDEF0123456789abcde";
 
@@ -229,6 +231,58 @@ START_TEST (gu_mmh128_partial)
 }
 END_TEST
 
+/* Tests functions hashing several messages at once */
+START_TEST (gu_mmh128_multi_test)
+{
+    const void*     msg[NUM_128_TESTS];
+    size_t          len[NUM_128_TESTS];
+    gu_mmh128_ctx_t ctx[NUM_128_TESTS];
+    const gu_mmh128_ctx_t* ctx_ptr[NUM_128_TESTS];
+    hash128_t       res[NUM_128_TESTS];
+    int i, n;
+
+    for (i = 0; i < NUM_128_TESTS; i++)
+    {
+        msg[i] = test_input;
+        len[i] = i;
+
+        /* append in 7-byte pieces to leave stale bytes in context tail */
+        gu_mmh128_init (&ctx[i]);
+        for (n = 0; n < i; n += 7)
+        {
+            gu_mmh128_append (&ctx[i], test_input + n, i - n < 7 ? i - n : 7);
+        }
+        ctx_ptr[i] = &ctx[i];
+    }
+
+    /* all numbers of messages, including incomplete lane groups */
+    for (n = 0; n <= NUM_128_TESTS; n++)
+    {
+        int const first = NUM_128_TESTS - n;
+
+        memset (res, 0, sizeof(res));
+        gu_mmh128_multi (msg + first, len + first, n, res);
+        for (i = 0; i < n; i++)
+        {
+            ck_assert_msg(!check(&test_output128[first + i], &res[i],
+                                 sizeof(res[i])),
+                          "gu_mmh128_multi() failed at length %d, n = %d",
+                          first + i, n);
+        }
+
+        memset (res, 0, sizeof(res));
+        gu_mmh128_get_multi (ctx_ptr + first, n, res);
+        for (i = 0; i < n; i++)
+        {
+            ck_assert_msg(!check(&test_output128[first + i], &res[i],
+                                 sizeof(res[i])),
+                          "gu_mmh128_get_multi() failed at length %d, n = %d",
+                          first + i, n);
+        }
+    }
+}
+END_TEST
+
 Suite *gu_mmh3_suite(void)
 {
   Suite *s  = suite_create("MurmurHash3");
@@ -239,6 +293,7 @@ Suite *gu_mmh3_suite(void)
 //  tcase_add_test (tc, gu_mmh128_x86_test);
   tcase_add_test (tc, gu_mmh128_x64_test);
   tcase_add_test (tc, gu_mmh128_partial);
+  tcase_add_test (tc, gu_mmh128_multi_test);
 
   return s;
 }
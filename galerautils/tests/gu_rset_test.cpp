@@ -13,6 +13,7 @@
 #include "gu_hexdump.hpp"
 
 #include "gu_macros.h"
+#include "../src/gu_inttypes.hpp" // PRIx64
 
 class TestBaseName : public gu::Allocator::BaseName
 {
@@ -126,7 +127,8 @@ START_TEST (empty)
 END_TEST
 
 static void
-test_version (gu::RecordSet::Version version)
+test_version (gu::RecordSet::Version   version,
+              gu::RecordSet::CheckType ct = gu::RecordSet::CHECK_MMH64)
 {
     int const alignment(gu::RecordSet::VER2 == version ?
                         gu::RecordSet::VER2_ALIGNMENT : 1);
@@ -155,10 +157,10 @@ test_version (gu::RecordSet::Version version)
     union { gu_word_t align; gu::byte_t buf[1024]; } reserved;
     assert((uintptr_t(reserved.buf) % GU_WORD_BYTES) == 0);
     std::ostringstream os;
-    os << "gu_rset_test_ver" << version;
+    os << "gu_rset_test_ver" << version << "_ct" << ct;
     TestBaseName str(os.str().c_str());
     gu::RecordSetOut<TestRecord> rset_out(reserved.buf, sizeof(reserved), str,
-                                          gu::RecordSet::CHECK_MMH64, version);
+                                          ct, version);
 
     size_t offset(rset_out.size());
     ck_assert(1 == rset_out.page_count());
@@ -347,6 +349,7 @@ test_version (gu::RecordSet::Version version)
     ck_assert(rset_in.size()  == rset_out.size());
     ck_assert(rset_in.count() == rset_out.count());
     ck_assert(rset_in.serial_size() == rset_out.serial_size());
+    ck_assert(rset_in.check_type() == ct);
 
     for (ssize_t i = 0; i < rset_in.count(); ++i)
     {
@@ -424,6 +427,49 @@ START_TEST (ver2)
 }
 END_TEST
 
+START_TEST (ver2_crc32c3)
+{
+    test_version(gu::RecordSet::VER2, gu::RecordSet::CHECK_CRC32C3);
+}
+END_TEST
+
+/* CRC32C3 result must not depend on how input is split between appends */
+START_TEST (crc32c3)
+{
+    std::vector<gu::byte_t> data(1000);
+    for (size_t i(0); i < data.size(); ++i) data[i] = gu::byte_t(i * 7);
+
+    uint64_t const whole(gu::CRC32C3::digest(data.data(), data.size()));
+
+    for (size_t step(1); step < 50; step += 3)
+    {
+        for (size_t len(0); len <= data.size(); len += 83)
+        {
+            gu::CRC32C3 crc;
+            for (size_t off(0); off < len; off += step)
+            {
+                crc.append(&data[off], std::min(step, len - off));
+            }
+
+            if (len == data.size())
+            {
+                ck_assert_msg(crc.get() == whole,
+                              "step %zu: %#" PRIx64 " != %#" PRIx64,
+                              step, crc.get(), whole);
+            }
+            else
+            {
+                ck_assert(crc.get() == gu::CRC32C3::digest(data.data(), len));
+            }
+        }
+    }
+
+    /* a single bit flip must change the result */
+    data[data.size() / 2] ^= 0x10;
+    ck_assert(gu::CRC32C3::digest(data.data(), data.size()) != whole);
+}
+END_TEST
+
 /* This test is to test how padding mixes with persistent (stored outside)
  * pages. In this case new padding buf needs to be allocated */
 static void
@@ -605,6 +651,8 @@ Suite* gu_rset_suite ()
     tcase_add_test (t, ver2);
     tcase_add_test (t, ver2_padding);
     tcase_add_test (t, ver2_sizes);
+    tcase_add_test (t, ver2_crc32c3);
+    tcase_add_test (t, crc32c3);
     suite_add_tcase (s, t);
 //    tcase_set_timeout(t, 60);
 
@@ -7,6 +7,7 @@
 
 extern "C" {
 #include "../src/gu_conf.h"
+#include "../src/gu_crc32c.h"
 }
 
 #include "gu_tests++.hpp"
@@ -24,6 +25,7 @@ int main(int argc, char* argv[])
     }
 
     gu_conf_debug_on();
+    gu_crc32c_configure();
 
     int failed = 0;
 
@@ -25,6 +25,7 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
     gcomm::Protonet(conf, "asio", version),
     mutex_(),
     poll_until_(gu::datetime::Date::max()),
+    io_threads_(),
     io_service_(),
     timer_(io_service_),
     ssl_context_(io_service_, asio::ssl::context::sslv23),
@@ -50,11 +51,89 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
         log_info << "initializing ssl context";
         gu::ssl_prepare_context(conf_, ssl_context_);
     }
+
+    const int io_threads(conf_.get<int>(gcomm::Conf::ProtonetIoThreads));
+    if (io_threads < 0)
+    {
+        gu_throw_error(EINVAL) << "invalid " << gcomm::Conf::ProtonetIoThreads
+                               << ": " << io_threads;
+    }
+    if (io_threads > 0)
+    {
+        log_info << "starting " << io_threads << " socket I/O threads";
+        io_threads_.start(io_threads);
+    }
 }
 
 gcomm::AsioProtonet::~AsioProtonet()
 {
+    io_threads_.stop();
+}
+
+gcomm::AsioProtonet::IoThreads::~IoThreads()
+{
+    stop();
+    for (size_t i(0); i < threads_.size(); ++i)
+    {
+        delete threads_[i];
+    }
+}
 
+void gcomm::AsioProtonet::IoThreads::start(size_t const n)
+{
+    for (size_t i(0); i < n; ++i)
+    {
+        Thread* t(new Thread());
+        int const err(gu_thread_create(&t->thread_, 0, &IoThreads::run, t));
+        if (err != 0)
+        {
+            delete t;
+            gu_throw_error(err) << "failed to start socket I/O thread";
+        }
+        threads_.push_back(t);
+    }
+}
+
+void gcomm::AsioProtonet::IoThreads::stop()
+{
+    for (size_t i(0); i < threads_.size(); ++i)
+    {
+        if (threads_[i]->io_service_.stopped() == false)
+        {
+            threads_[i]->io_service_.stop();
+            gu_thread_join(threads_[i]->thread_, 0);
+        }
+    }
+}
+
+asio::io_service& gcomm::AsioProtonet::IoThreads::next()
+{
+    assert(threads_.empty() == false);
+    Thread* const t(threads_[next_]);
+    next_ = (next_ + 1) % threads_.size();
+    return t->io_service_;
+}
+
+void* gcomm::AsioProtonet::IoThreads::run(void* arg)
+{
+    asio::io_service& io_service(static_cast<Thread*>(arg)->io_service_);
+    while (io_service.stopped() == false)
+    {
+        try
+        {
+            io_service.run();
+        }
+        catch (const std::exception& e)
+        {
+            log_error << "exception in socket I/O thread: " << e.what();
+        }
+    }
+    return 0;
+}
+
+asio::io_service& gcomm::AsioProtonet::socket_io_service()
+{
+    return (io_threads_.empty() ? io_service_ : io_threads_.next());
 }
 
 void gcomm::AsioProtonet::enter()
@@ -137,6 +216,9 @@ void gcomm::AsioProtonet::interrupt()
 
 void gcomm::AsioProtonet::handle_wait(const asio::error_code& ec)
 {
+    // Timer was rearmed by event_loop() after interrupt()
+    if (ec == asio::error::operation_aborted) return;
+
     gu::datetime::Date now(gu::datetime::Date::monotonic());
     const gu::datetime::Period p(handle_timers_helper(*this, poll_until_ - now));
     using std::rel_ops::operator>=;
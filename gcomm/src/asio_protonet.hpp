@@ -10,6 +10,7 @@
 
 #include "gu_monitor.hpp"
 #include "gu_asio.hpp"
+#include "gu_threads.h"
 
 #include <vector>
 #include <deque>
@@ -46,10 +47,50 @@ private:
     friend class AsioUdpSocket;
     AsioProtonet(const AsioProtonet&);
 
+    //
+    // Threads running io_services of sockets if protonet.io_threads
+    // is set. Each socket is served by one thread so that its handlers
+    // never run concurrently.
+    //
+    class IoThreads
+    {
+    public:
+        IoThreads() : threads_(), next_(0) { }
+        ~IoThreads();
+        void start(size_t n);
+        // Stops and joins threads, handlers pending in io_services
+        // are destroyed only in destructor
+        void stop();
+        bool empty() const { return threads_.empty(); }
+        // Returns io_service of the next thread in round robin
+        asio::io_service& next();
+    private:
+        IoThreads(const IoThreads&);
+        void operator=(const IoThreads&);
+
+        struct Thread
+        {
+            Thread() : io_service_(), work_(io_service_), thread_() { }
+            asio::io_service       io_service_;
+            asio::io_service::work work_;
+            gu_thread_t            thread_;
+        };
+        static void* run(void* arg);
+
+        std::vector<Thread*> threads_;
+        size_t               next_;
+    };
+
+    // Returns io_service for a new socket
+    asio::io_service& socket_io_service();
+
     void handle_wait(const asio::error_code& ec);
 
     gu::RecursiveMutex          mutex_;
     gu::datetime::Date          poll_until_;
+    // Declared before io_service_ so that handlers pending in io_service_
+    // are destroyed before the io_services of the sockets they refer to
+    IoThreads                   io_threads_;
     asio::io_service            io_service_;
     asio::deadline_timer        timer_;
     asio::ssl::context          ssl_context_;
@@ -5,6 +5,7 @@
 #include "asio_tcp.hpp"
 #include "gcomm/util.hpp"
 #include "gcomm/common.hpp"
+#include "gu_atomic.h" // gu_atomic_fence_acquire()
 
 #define FAILED_HANDLER(_e) failed_handler(_e, __FUNCTION__, __LINE__)
 
@@ -69,11 +70,26 @@ gcomm::AsioTcpSocket::AsioTcpSocket(AsioProtonet& net, const gu::URI& uri)
     net_         (net),
     socket_      (net.io_service_),
     ssl_socket_  (0),
+    io_thread_   (false),
+    read_socket_ (net.socket_io_service()),
+    recv_q_      (&read_socket_.get_io_service() != &net.io_service_ ?
+                  recv_q_size : 1),
+    recv_q_pending_(0),
+    recv_paused_ (0),
     send_q_      (),
+    write_dgs_   (),
+    write_cbs_   (),
+    write_bytes_ (0),
     last_queued_tstamp_(),
     recv_buf_    (net_.mtu() + NetHeader::serial_size_),
     recv_offset_ (0),
+    recv_pool_   (),
+    recv_pool_next_(0),
     last_delivered_tstamp_(),
+    sent_msgs_   (0),
+    sent_bytes_  (0),
+    recv_msgs_   (0),
+    recv_bytes_  (0),
     state_       (S_CLOSED),
     local_addr_  (),
     remote_addr_ ()
@@ -271,7 +287,8 @@ void gcomm::AsioTcpSocket::close()
     log_debug << "closing " << id() << " state " << state()
               << " send_q size " << send_q_.size();
 
-    if (send_q_.empty() == true || state() != S_CONNECTED)
+    if ((send_q_.empty() == true && write_dgs_.empty() == true) ||
+        state() != S_CONNECTED)
     {
         close_socket();
         state_ = S_CLOSED;
@@ -290,8 +307,7 @@ void gcomm::AsioTcpSocket::write_handler(const asio::error_code& ec,
 {
 #ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
     static const long empty_rate(10000);
-    static const long bytes_transferred_less_than_rate(10000);
-    static const long bytes_transferred_not_zero_rate(10000);
+    static const long bytes_transferred_mismatch_rate(10000);
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
 
     Critical<AsioProtonet> crit(net_);
@@ -313,63 +329,41 @@ void gcomm::AsioTcpSocket::write_handler(const asio::error_code& ec,
 
     if (!ec)
     {
-        if (send_q_.empty() == true
+        if (write_dgs_.empty() == true
 #ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
             || ::rand() % empty_rate == 0
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
             )
         {
-            log_warn << "write_handler() called with empty send_q_. "
+            log_warn << "write_handler() called with no write in progress. "
                      << "Transport may not be reliable, closing the socket";
             FAILED_HANDLER(asio::error_code(EPROTO,
                                             asio::error::system_category));
         }
-        else if (send_q_.front().len() < bytes_transferred
+        // async_write() completes only after all buffers have been
+        // written or an error has occurred
+        else if (bytes_transferred != write_bytes_
 #ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-                 || ::rand() % bytes_transferred_less_than_rate == 0
+                 || ::rand() % bytes_transferred_mismatch_rate == 0
 #endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
             )
         {
             log_warn << "write_handler() bytes_transferred "
                      << bytes_transferred
-                     << " less than sent "
-                     << send_q_.front().len()
+                     << " differs from sent "
+                     << write_bytes_
                      << ". Transport may not be reliable, closing the socket";
             FAILED_HANDLER(asio::error_code(EPROTO,
                                             asio::error::system_category));
         }
         else
         {
-            while (send_q_.empty() == false &&
-                   bytes_transferred >= send_q_.front().len())
-            {
-                const Datagram& dg(send_q_.front());
-                bytes_transferred -= dg.len();
-                send_q_.pop_front();
-            }
-            if (bytes_transferred != 0
-#ifdef GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-                || ::rand() % bytes_transferred_not_zero_rate == 0
-#endif // GCOMM_ASIO_TCP_SIMULATE_WRITE_HANDLER_ERROR
-                )
-            {
-                log_warn << "write_handler() bytes_transferred "
-                         << bytes_transferred
-                         << " after processing the send_q_. "
-                         << "Transport may not be reliable, closing the socket";
-                FAILED_HANDLER(asio::error_code(EPROTO,
-                                                asio::error::system_category));
-            }
-            else if (send_q_.empty() == false)
+            write_dgs_.clear();
+            write_bytes_ = 0;
+
+            if (send_q_.empty() == false)
             {
-                const Datagram& dg(send_q_.front());
-                gu::array<asio::const_buffer, 2>::type cbs;
-                cbs[0] = asio::const_buffer(dg.header()
-                                            + dg.header_offset(),
-                                            dg.header_len());
-                cbs[1] = asio::const_buffer(dg.payload().data(),
-                                            dg.payload().size());
-                write_one(cbs);
+                write_queued();
             }
             else if (state_ == S_CLOSING)
             {
@@ -421,16 +415,10 @@ namespace gcomm
             // upper layers.
             if ((socket_->state() == gcomm::Socket::S_CONNECTED ||
                  socket_->state() == gcomm::Socket::S_CLOSING) &&
+                socket_->write_dgs_.empty() == true &&
                 socket_->send_q_.empty() == false)
             {
-                const gcomm::Datagram& dg(socket_->send_q_.front());
-                gu::array<asio::const_buffer, 2>::type cbs;
-                cbs[0] = asio::const_buffer(dg.header()
-                                            + dg.header_offset(),
-                                            dg.header_len());
-                cbs[1] = asio::const_buffer(dg.payload().data(),
-                                            dg.payload().size());
-                socket_->write_one(cbs);
+                socket_->write_queued();
             }
         }
     private:
@@ -469,7 +457,10 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
               priv_dg.header_size(),
               priv_dg.header_offset());
     send_q_.push_back(segment, priv_dg);
-    if (send_q_.size() == 1)
+    ++sent_msgs_;
+    sent_bytes_ += dg.len();
+    // If write is in progress, write_handler() will pick up the datagram
+    if (send_q_.size() == 1 && write_dgs_.empty() == true)
     {
         net_.io_service_.post(AsioPostForSendHandler(shared_from_this()));
     }
@@ -480,6 +471,12 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
 void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                                         const size_t bytes_transferred)
 {
+    if (io_thread_)
+    {
+        io_read_handler(ec, bytes_transferred);
+        return;
+    }
+
     Critical<AsioProtonet> crit(net_);
 
     if (ec)
@@ -505,12 +502,17 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
 
     recv_offset_ += bytes_transferred;
 
-    while (recv_offset_ >= NetHeader::serial_size_)
+    // Offset of the first unprocessed byte. Remaining bytes are moved
+    // to the beginning of recv_buf_ once all complete messages have
+    // been delivered.
+    size_t consumed(0);
+
+    while (recv_offset_ - consumed >= NetHeader::serial_size_)
     {
         NetHeader hdr;
         try
         {
-            unserialize(&recv_buf_[0], recv_buf_.size(), 0, hdr);
+            unserialize(&recv_buf_[0], recv_buf_.size(), consumed, hdr);
         }
         catch (gu::Exception& e)
         {
@@ -518,13 +520,11 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                                             asio::error::system_category));
             return;
         }
-        if (recv_offset_ >= hdr.len() + NetHeader::serial_size_)
+        if (recv_offset_ - consumed >= hdr.len() + NetHeader::serial_size_)
         {
-            Datagram dg(
-                gu::SharedBuffer(
-                    new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
-                                   &recv_buf_[0] + NetHeader::serial_size_
-                                   + hdr.len())));
+            const gu::byte_t* const begin(&recv_buf_[0] + consumed
+                                          + NetHeader::serial_size_);
+            Datagram dg(recv_buffer(begin, begin + hdr.len()));
             if (net_.checksum_ != NetHeader::CS_NONE)
             {
 #ifdef TEST_NET_CHECKSUM_ERROR
@@ -547,17 +547,8 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                     return;
                 }
             }
-            ProtoUpMeta um;
-            last_delivered_tstamp_ = gu::datetime::Date::monotonic();
-            net_.dispatch(id(), dg, um);
-            recv_offset_ -= NetHeader::serial_size_ + hdr.len();
-
-            if (recv_offset_ > 0)
-            {
-                memmove(&recv_buf_[0],
-                        &recv_buf_[0] + NetHeader::serial_size_ + hdr.len(),
-                        recv_offset_);
-            }
+            dispatch_up(dg);
+            consumed += NetHeader::serial_size_ + hdr.len();
         }
         else
         {
@@ -565,16 +556,66 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         }
     }
 
+    recv_offset_ -= consumed;
+    if (consumed > 0 && recv_offset_ > 0)
+    {
+        memmove(&recv_buf_[0], &recv_buf_[0] + consumed, recv_offset_);
+    }
+
     gu::array<asio::mutable_buffer, 1>::type mbs;
     mbs[0] = asio::mutable_buffer(&recv_buf_[0] + recv_offset_,
                                   recv_buf_.size() - recv_offset_);
     read_one(mbs);
 }
 
+gu::SharedBuffer gcomm::AsioTcpSocket::recv_buffer(const gu::byte_t* first,
+                                                   const gu::byte_t* last)
+{
+    for (size_t i(0); i < recv_pool_.size(); ++i)
+    {
+        gu::SharedBuffer& buf(recv_pool_[recv_pool_next_]);
+        recv_pool_next_ = (recv_pool_next_ + 1) % recv_pool_.size();
+
+        // Only the pool references the buffer, datagram built on
+        // it has been released by upper layers.
+        if (buf.use_count() == 1)
+        {
+            // With I/O threads the last reference may have been dropped
+            // by the event loop thread. use_count() is a relaxed read,
+            // fence pairs it with the releasing decrement of the reference
+            // count so that the reads of the old contents happen before
+            // the buffer is overwritten.
+            gu_atomic_fence_acquire();
+            buf->assign(first, last);
+            return buf;
+        }
+    }
+
+    gu::SharedBuffer ret(new gu::Buffer(first, last));
+
+    if (recv_pool_.size() < recv_pool_size)
+    {
+        recv_pool_.push_back(ret);
+    }
+    else
+    {
+        // All buffers are held by upper layers, forget the next one
+        recv_pool_[recv_pool_next_] = ret;
+        recv_pool_next_ = (recv_pool_next_ + 1) % recv_pool_.size();
+    }
+
+    return ret;
+}
+
 size_t gcomm::AsioTcpSocket::read_completion_condition(
     const asio::error_code& ec,
     const size_t bytes_transferred)
 {
+    if (io_thread_)
+    {
+        return io_read_completion_condition(ec, bytes_transferred);
+    }
+
     Critical<AsioProtonet> crit(net_);
     if (ec)
     {
@@ -597,27 +638,209 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
         return 0;
     }
 
+    try
+    {
+        return read_remaining(bytes_transferred);
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "unserialize error " << e.what();
+        FAILED_HANDLER(asio::error_code(e.get_errno(),
+                                        asio::error::system_category));
+        return 0;
+    }
+}
+
+size_t gcomm::AsioTcpSocket::read_remaining(
+    const size_t bytes_transferred) const
+{
     if (recv_offset_ + bytes_transferred >= NetHeader::serial_size_)
+    {
+        NetHeader hdr;
+        unserialize(&recv_buf_[0], NetHeader::serial_size_, 0, hdr);
+        if (recv_offset_ + bytes_transferred >= NetHeader::serial_size_ + hdr.len())
+        {
+            return 0;
+        }
+    }
+
+    return (recv_buf_.size() - recv_offset_);
+}
+
+void gcomm::AsioTcpSocket::dispatch_up(const Datagram& dg)
+{
+    last_delivered_tstamp_ = gu::datetime::Date::monotonic();
+    ++recv_msgs_;
+    recv_bytes_ += dg.len();
+    net_.dispatch(id(), dg, ProtoUpMeta());
+}
+
+//
+// Reading by I/O thread. Handlers below run in I/O thread without
+// protonet lock, so they touch only read_socket_, recv_buf_,
+// recv_offset_, recv_pool_ and recv_q_, which are not accessed by other
+// threads once reading has started. Received datagrams and the error
+// which ends reading are queued into recv_q_ and dispatched by io_drain()
+// in event loop thread. If the queue gets full, reading is paused until
+// io_drain() has made room.
+//
+
+size_t gcomm::AsioTcpSocket::io_read_completion_condition(
+    const asio::error_code& ec,
+    const size_t bytes_transferred)
+{
+    if (ec)
+    {
+        // Reported by io_read_handler()
+        return 0;
+    }
+
+    try
+    {
+        return read_remaining(bytes_transferred);
+    }
+    catch (gu::Exception&)
+    {
+        // Reported by io_process_recv_buf()
+        return 0;
+    }
+}
+
+void gcomm::AsioTcpSocket::io_read_handler(const asio::error_code& ec,
+                                           const size_t bytes_transferred)
+{
+    if (ec)
+    {
+        io_queue_error(ec);
+        return;
+    }
+
+    recv_offset_ += bytes_transferred;
+    io_process_recv_buf();
+}
+
+void gcomm::AsioTcpSocket::io_process_recv_buf()
+{
+    if (read_socket_.is_open() == false)
+    {
+        // Reading has ended with error
+        return;
+    }
+
+    size_t consumed(0);
+    bool paused(false);
+
+    while (recv_offset_ - consumed >= NetHeader::serial_size_)
     {
         NetHeader hdr;
         try
         {
-            unserialize(&recv_buf_[0], NetHeader::serial_size_, 0, hdr);
+            unserialize(&recv_buf_[0], recv_buf_.size(), consumed, hdr);
         }
         catch (gu::Exception& e)
         {
             log_warn << "unserialize error " << e.what();
-            FAILED_HANDLER(asio::error_code(e.get_errno(),
+            io_queue_error(asio::error_code(e.get_errno(),
                                             asio::error::system_category));
-            return 0;
+            return;
         }
-        if (recv_offset_ + bytes_transferred >= NetHeader::serial_size_ + hdr.len())
+        if (recv_offset_ - consumed < NetHeader::serial_size_ + hdr.len())
         {
-            return 0;
+            break;
+        }
+        if (recv_q_.size() + 1 >= recv_q_.capacity())
+        {
+            paused = true;
+            break;
+        }
+        const gu::byte_t* const begin(&recv_buf_[0] + consumed
+                                      + NetHeader::serial_size_);
+        Datagram dg(recv_buffer(begin, begin + hdr.len()));
+        if (net_.checksum_ != NetHeader::CS_NONE && check_cs(hdr, dg))
+        {
+            log_warn << "checksum failed, hdr: len=" << hdr.len()
+                     << " has_crc32="  << hdr.has_crc32()
+                     << " has_crc32c=" << hdr.has_crc32c()
+                     << " crc32=" << hdr.crc32();
+            io_queue_error(asio::error_code(EPROTO,
+                                            asio::error::system_category));
+            return;
         }
+        (void)recv_q_.push(RecvEntry(dg));
+        consumed += NetHeader::serial_size_ + hdr.len();
     }
 
-    return (recv_buf_.size() - recv_offset_);
+    recv_offset_ -= consumed;
+    if (consumed > 0 && recv_offset_ > 0)
+    {
+        memmove(&recv_buf_[0], &recv_buf_[0] + consumed, recv_offset_);
+    }
+
+    if (paused)
+    {
+        // io_drain() resumes reading
+        recv_paused_ = 1;
+    }
+    if (consumed > 0 || paused)
+    {
+        io_schedule_drain();
+    }
+    if (paused == false)
+    {
+        gu::array<asio::mutable_buffer, 1>::type mbs;
+        mbs[0] = asio::mutable_buffer(&recv_buf_[0] + recv_offset_,
+                                      recv_buf_.size() - recv_offset_);
+        read_one(mbs);
+    }
+}
+
+void gcomm::AsioTcpSocket::io_queue_error(const asio::error_code& ec)
+{
+    asio::error_code ignore;
+    read_socket_.close(ignore);
+    if (recv_q_.push(RecvEntry(ec)) == false)
+    {
+        log_warn << "socket " << id() << " receive queue overflow";
+    }
+    io_schedule_drain();
+}
+
+void gcomm::AsioTcpSocket::io_schedule_drain()
+{
+    // Post unless io_drain() has already been posted and it has not
+    // started to pop the queue yet
+    if (recv_q_pending_.fetch_and_add(1) == 0)
+    {
+        net_.io_service_.post(boost::bind(&AsioTcpSocket::io_drain,
+                                          shared_from_this()));
+    }
+}
+
+void gcomm::AsioTcpSocket::io_drain()
+{
+    Critical<AsioProtonet> crit(net_);
+
+    recv_q_pending_.fetch_and_zero();
+
+    RecvEntry e;
+    while (recv_q_.pop(e))
+    {
+        if (e.ec_)
+        {
+            FAILED_HANDLER(e.ec_);
+        }
+        else if (state() == S_CONNECTED || state() == S_CLOSING)
+        {
+            dispatch_up(e.dg_);
+        }
+    }
+
+    if (recv_paused_.fetch_and_zero() != 0)
+    {
+        read_socket_.get_io_service().post(
+            boost::bind(&AsioTcpSocket::io_process_recv_buf,
+                        shared_from_this()));
+    }
 }
 
 
@@ -627,6 +850,24 @@ void gcomm::AsioTcpSocket::async_receive()
 
     gcomm_assert(state() == S_CONNECTED);
 
+    if (ssl_socket_ == 0 &&
+        &read_socket_.get_io_service() != &net_.io_service_)
+    {
+        // SSL stream state is shared by reads and writes, so only plain
+        // TCP connection can be read by I/O thread
+        int const fd(::dup(socket_.native()));
+        if (fd < 0)
+        {
+            gu_throw_error(errno) << "failed to duplicate socket descriptor";
+        }
+        read_socket_.assign(socket_.local_endpoint().protocol(), fd);
+        io_thread_ = true;
+        read_socket_.get_io_service().post(
+            boost::bind(&AsioTcpSocket::io_process_recv_buf,
+                        shared_from_this()));
+        return;
+    }
+
     gu::array<asio::mutable_buffer, 1>::type mbs;
 
     mbs[0] = asio::mutable_buffer(&recv_buf_[0], recv_buf_.size());
@@ -680,7 +921,7 @@ void gcomm::AsioTcpSocket::read_one(
     }
     else
     {
-        async_read(socket_, mbs,
+        async_read(io_thread_ ? read_socket_ : socket_, mbs,
                    boost::bind(&AsioTcpSocket::read_completion_condition,
                                shared_from_this(),
                                asio::placeholders::error,
@@ -693,12 +934,39 @@ void gcomm::AsioTcpSocket::read_one(
 }
 
 
-void gcomm::AsioTcpSocket::write_one(
-    const gu::array<asio::const_buffer, 2>::type& cbs)
+void gcomm::AsioTcpSocket::write_queued()
 {
+    assert(write_dgs_.empty() == true);
+    assert(send_q_.empty() == false);
+
+    // Datagrams are moved out of send_q_ because FairSendQueue may change
+    // its round robin order when new datagrams are pushed.
+    do
+    {
+        write_dgs_.push_back(send_q_.front());
+        write_bytes_ += write_dgs_.back().len();
+        send_q_.pop_front();
+    }
+    while (send_q_.empty() == false &&
+           write_dgs_.size() < max_write_dgs &&
+           write_bytes_ + send_q_.front().len() <= max_write_bytes);
+
+    // write_dgs_ does not change until write completes, so the buffers
+    // remain valid
+    write_cbs_.clear();
+    for (std::vector<Datagram>::const_iterator i(write_dgs_.begin());
+         i != write_dgs_.end(); ++i)
+    {
+        write_cbs_.push_back(asio::const_buffer(i->header()
+                                                + i->header_offset(),
+                                                i->header_len()));
+        write_cbs_.push_back(asio::const_buffer(i->payload().data(),
+                                                i->payload().size()));
+    }
+
     if (ssl_socket_ != 0)
     {
-        async_write(*ssl_socket_, cbs,
+        async_write(*ssl_socket_, write_cbs_,
                     boost::bind(&AsioTcpSocket::write_handler,
                                 shared_from_this(),
                                 asio::placeholders::error,
@@ -706,7 +974,7 @@ void gcomm::AsioTcpSocket::write_one(
     }
     else
     {
-        async_write(socket_, cbs,
+        async_write(socket_, write_cbs_,
                     boost::bind(&AsioTcpSocket::write_handler,
                                 shared_from_this(),
                                 asio::placeholders::error,
@@ -728,6 +996,14 @@ void gcomm::AsioTcpSocket::close_socket()
         }
         else
         {
+            if (io_thread_)
+            {
+                // Connection is shared with read_socket_, shutdown makes
+                // pending read of I/O thread to complete
+                asio::error_code ignore;
+                socket_.shutdown(asio::ip::tcp::socket::shutdown_both,
+                                 ignore);
+            }
             socket_.close();
         }
     }
@@ -809,9 +1085,13 @@ gcomm::SocketStats gcomm::AsioTcpSocket::stats() const
         Critical<AsioProtonet> crit(net_);
         ret.last_queued_since = (now - last_queued_tstamp_).get_nsecs();
         ret.last_delivered_since = (now - last_delivered_tstamp_).get_nsecs();
-        ret.send_queue_length = send_q_.size();
-        ret.send_queue_bytes = send_q_.queued_bytes();
+        ret.send_queue_length = send_q_.size() + write_dgs_.size();
+        ret.send_queue_bytes = send_q_.queued_bytes() + write_bytes_;
         ret.send_queue_segments = send_q_.segments();
+        ret.sent_msgs = sent_msgs_;
+        ret.sent_bytes = sent_bytes_;
+        ret.recv_msgs = recv_msgs_;
+        ret.recv_bytes = recv_bytes_;
     }
 #endif /* __linux__ || __FreeBSD__ */
     return ret;
@@ -8,6 +8,7 @@
 #include "socket.hpp"
 #include "asio_protonet.hpp"
 #include "fair_send_queue.hpp"
+#include "spsc_queue.hpp"
 
 #include "gu_array.hpp"
 #include "gu_shared_ptr.hpp"
@@ -85,8 +86,28 @@ private:
         gu::datetime::Date now(gu::datetime::Date::monotonic());
         last_queued_tstamp_ = last_delivered_tstamp_ = now;
     }
+    // returns number of bytes still missing from the message at the
+    // beginning of recv_buf_, throws if the header is invalid
+    size_t read_remaining(size_t bytes_transferred) const;
     void read_one(gu::array<asio::mutable_buffer, 1>::type& mbs);
-    void write_one(const gu::array<asio::const_buffer, 2>::type& cbs);
+    void dispatch_up(const Datagram& dg);
+
+    // Reading by I/O thread, see protonet.io_threads
+    size_t io_read_completion_condition(const asio::error_code& ec,
+                                        size_t bytes_transferred);
+    void io_read_handler(const asio::error_code& ec,
+                         size_t bytes_transferred);
+    // queues complete messages in recv_buf_ and continues reading
+    void io_process_recv_buf();
+    void io_queue_error(const asio::error_code& ec);
+    void io_schedule_drain();
+    // dispatches queued datagrams in event loop thread
+    void io_drain();
+    // returns buffer with a copy of [first, last) for received datagram
+    gu::SharedBuffer recv_buffer(const gu::byte_t* first,
+                                 const gu::byte_t* last);
+    // gathers datagrams from send_q_ into one write
+    void write_queued();
     void close_socket();
 
     // call to assign local/remote addresses at the point where it
@@ -104,6 +125,25 @@ private:
     AsioProtonet&                             net_;
     asio::ip::tcp::socket                     socket_;
     asio::ssl::stream<asio::ip::tcp::socket>* ssl_socket_;
+    // If protonet has I/O threads, plain TCP connection is read through
+    // duplicate of socket_ descriptor served by I/O thread. Reading is
+    // done without protonet lock and received datagrams are passed to
+    // the event loop thread through recv_q_.
+    bool                                      io_thread_;
+    asio::ip::tcp::socket                     read_socket_;
+    struct RecvEntry
+    {
+        RecvEntry() : dg_(), ec_() { }
+        RecvEntry(const Datagram& dg) : dg_(dg), ec_() { }
+        RecvEntry(const asio::error_code& ec) : dg_(), ec_(ec) { }
+        Datagram          dg_;
+        asio::error_code  ec_;
+    };
+    // One slot is reserved for the error which ends reading
+    static const size_t                       recv_q_size = 256;
+    gcomm::SpscQueue<RecvEntry>               recv_q_;
+    gu::Atomic<int>                           recv_q_pending_;
+    gu::Atomic<int>                           recv_paused_;
     // Limit the number of queued bytes. This workaround to avoid queue
     // pile up due to frequent retransmissions by the upper layers (evs).
     // It is a responsibility of upper layers (evs) to request resending
@@ -111,10 +151,28 @@ private:
     // datagrams with default gcomm MTU 32kB.
     static const size_t                       max_send_q_bytes = (1 << 25);
     gcomm::FairSendQueue                      send_q_;
+    // Datagrams taken from send_q_ for the write in progress. Gathering
+    // several datagrams into one write saves syscalls and completion
+    // handler calls when the send queue backs up.
+    static const size_t                       max_write_dgs = 64;
+    static const size_t                       max_write_bytes = (1 << 20);
+    std::vector<gcomm::Datagram>              write_dgs_;
+    std::vector<asio::const_buffer>           write_cbs_;
+    size_t                                    write_bytes_;
     gu::datetime::Date                        last_queued_tstamp_;
     std::vector<gu::byte_t>                   recv_buf_;
     size_t                                    recv_offset_;
+    // Payload buffers of delivered datagrams. A buffer is reused for the
+    // next datagram once upper layers have released it, which saves heap
+    // allocation per received message.
+    static const size_t                       recv_pool_size = 16;
+    std::vector<gu::SharedBuffer>             recv_pool_;
+    size_t                                    recv_pool_next_;
     gu::datetime::Date                        last_delivered_tstamp_;
+    long                                      sent_msgs_;
+    long                                      sent_bytes_;
+    long                                      recv_msgs_;
+    long                                      recv_bytes_;
     State                                     state_;
     // Querying addresses from failed socket does not work,
     // so need to maintain copy for diagnostics logging
@@ -7,10 +7,13 @@
 #include "gcomm/util.hpp"
 #include "gcomm/common.hpp"
 
-#include "gu_array.hpp"
-
 #include <boost/bind.hpp>
 
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <cstring>
+
 
 static bool is_multicast(const asio::ip::udp::endpoint& ep)
 {
@@ -59,8 +62,10 @@ gcomm::AsioUdpSocket::AsioUdpSocket(AsioProtonet& net, const gu::URI& uri)
     state_(S_CLOSED),
     socket_(net_.io_service_),
     target_ep_(),
-    source_ep_(),
-    recv_buf_((1 << 15) + NetHeader::serial_size_)
+    recv_buf_(batch_size*recv_slot_size),
+    recv_lens_(batch_size),
+    send_q_(),
+    dropped_msgs_(0)
 { }
 
 
@@ -128,13 +133,49 @@ void gcomm::AsioUdpSocket::close()
         }
         socket_.close();
     }
+    send_q_.clear();
     state_ = S_CLOSED;
 }
 
+namespace gcomm
+{
+    typedef gu::shared_ptr<AsioUdpSocket>::type AsioUdpSocketPtr;
+    class AsioUdpPostForSendHandler
+    {
+    public:
+        AsioUdpPostForSendHandler(const AsioUdpSocketPtr& socket)
+            :
+            socket_(socket)
+        { }
+        void operator()()
+        {
+            Critical<AsioProtonet> crit(socket_->net_);
+            if (socket_->state() == gcomm::Socket::S_CONNECTED)
+            {
+                socket_->write_queued();
+            }
+        }
+    private:
+        AsioUdpSocketPtr socket_;
+    };
+}
+
+//
+// Datagrams are queued and sent from the event loop so that all datagrams
+// sent while handling the same event go out with one system call. While
+// the queue is not empty, a write is either posted or waiting for the
+// socket to become writable.
+//
 int gcomm::AsioUdpSocket::send(int /* segment */, const Datagram& dg)
 {
     Critical<AsioProtonet> crit(net_);
-    gu::array<asio::const_buffer, 3>::type cbs;
+
+    if (send_q_.size() >= max_send_q_len)
+    {
+        ++dropped_msgs_;
+        return ENOBUFS;
+    }
+
     NetHeader hdr(dg.len(), net_.version_);
 
     if (net_.checksum_ != NetHeader::CS_NONE)
@@ -142,93 +183,273 @@ int gcomm::AsioUdpSocket::send(int /* segment */, const Datagram& dg)
         hdr.set_crc32(crc32(net_.checksum_, dg), net_.checksum_);
     }
 
-    gu::byte_t buf[NetHeader::serial_size_];
-    serialize(hdr, buf, sizeof(buf), 0);
-    cbs[0] = asio::const_buffer(buf, sizeof(buf));
-    cbs[1] = asio::const_buffer(dg.header() + dg.header_offset(),
-                          dg.header_len());
-    cbs[2] = asio::const_buffer(dg.payload().data(), dg.payload().size());
-    try
+    Datagram priv_dg(dg);
+    priv_dg.set_header_offset(priv_dg.header_offset() -
+                              NetHeader::serial_size_);
+    serialize(hdr,
+              priv_dg.header(),
+              priv_dg.header_size(),
+              priv_dg.header_offset());
+    send_q_.push_back(priv_dg);
+    if (send_q_.size() == 1)
     {
-        socket_.send_to(cbs, target_ep_);
+        net_.io_service_.post(AsioUdpPostForSendHandler(shared_from_this()));
     }
-    catch (asio::system_error& err)
+    return 0;
+}
+
+
+void gcomm::AsioUdpSocket::write_queued()
+{
+    const int fd(socket_.native());
+    size_t sent(0);
+
+    while (sent < send_q_.size())
     {
-        log_warn << "Error: " << err.what();
-        return err.code().value();
+        const size_t left(send_q_.size() - sent);
+        const size_t n(left < batch_size ? left : batch_size);
+        struct iovec iov[batch_size][2];
+#if defined(__linux__)
+        struct mmsghdr msgs[batch_size];
+#else
+        struct { struct msghdr msg_hdr; } msgs[batch_size];
+#endif /* __linux__ */
+        memset(msgs, 0, sizeof(msgs));
+        for (size_t i(0); i < n; ++i)
+        {
+            const Datagram& dg(send_q_[sent + i]);
+            iov[i][0].iov_base = const_cast<gu::byte_t*>(
+                dg.header() + dg.header_offset());
+            iov[i][0].iov_len  = dg.header_len();
+            iov[i][1].iov_base = const_cast<gu::byte_t*>(
+                dg.payload().data());
+            iov[i][1].iov_len  = dg.payload().size();
+            msgs[i].msg_hdr.msg_name    = target_ep_.data();
+            msgs[i].msg_hdr.msg_namelen = target_ep_.size();
+            msgs[i].msg_hdr.msg_iov     = iov[i];
+            msgs[i].msg_hdr.msg_iovlen  = 2;
+        }
+
+        int ret;
+#if defined(__linux__)
+        ret = ::sendmmsg(fd, msgs, n, MSG_DONTWAIT);
+#else
+        for (ret = 0; ret < int(n); ++ret)
+        {
+            if (::sendmsg(fd, &msgs[ret].msg_hdr, MSG_DONTWAIT) < 0)
+            {
+                if (ret == 0) ret = -1;
+                break;
+            }
+        }
+#endif /* __linux__ */
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Socket send buffer is full, send the rest when
+                // the socket becomes writable
+                send_q_.erase(send_q_.begin(), send_q_.begin() + sent);
+                socket_.async_send(asio::null_buffers(),
+                                   boost::bind(&AsioUdpSocket::write_handler,
+                                               shared_from_this(),
+                                               asio::placeholders::error));
+                return;
+            }
+            // Datagrams are dropped, upper layers take care of
+            // retransmission
+            log_warn << "Error: " << ::strerror(errno) << ", dropping "
+                     << send_q_.size() - sent << " datagrams";
+            dropped_msgs_ += send_q_.size() - sent;
+            break;
+        }
+        sent += ret;
     }
-    return 0;
+    send_q_.clear();
 }
 
 
-void gcomm::AsioUdpSocket::read_handler(const asio::error_code& ec,
-                                        size_t bytes_transferred)
+void gcomm::AsioUdpSocket::write_handler(const asio::error_code& ec)
 {
+    Critical<AsioProtonet> crit(net_);
+    if (state() != S_CONNECTED)
+    {
+        return;
+    }
     if (ec)
     {
-        //
+        log_warn << "Error: " << ec.message() << ", dropping "
+                 << send_q_.size() << " datagrams";
+        dropped_msgs_ += send_q_.size();
+        send_q_.clear();
         return;
     }
+    write_queued();
+}
+
+
+size_t gcomm::AsioUdpSocket::read_batch()
+{
+    const int fd(socket_.native());
+    struct iovec iov[batch_size];
+    for (size_t i(0); i < batch_size; ++i)
+    {
+        iov[i].iov_base = &recv_buf_[i*recv_slot_size];
+        iov[i].iov_len  = recv_slot_size;
+    }
 
-    if (bytes_transferred >= NetHeader::serial_size_)
+#if defined(__linux__)
+    struct mmsghdr msgs[batch_size];
+    memset(msgs, 0, sizeof(msgs));
+    for (size_t i(0); i < batch_size; ++i)
+    {
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    int ret;
+    do
     {
-        Critical<AsioProtonet> crit(net_);
-        NetHeader hdr;
-        try
+        ret = ::recvmmsg(fd, msgs, batch_size, MSG_DONTWAIT, 0);
+    }
+    while (ret < 0 && errno == EINTR);
+    if (ret < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
         {
-            unserialize(&recv_buf_[0], NetHeader::serial_size_, 0, hdr);
+            log_warn << "receive failed: " << ::strerror(errno);
         }
-        catch (gu::Exception& e)
+        return 0;
+    }
+    for (int i(0); i < ret; ++i)
+    {
+        recv_lens_[i] = msgs[i].msg_len;
+    }
+    return ret;
+#else
+    size_t n(0);
+    while (n < batch_size)
+    {
+        const ssize_t ret(::recv(fd, iov[n].iov_base, iov[n].iov_len,
+                                 MSG_DONTWAIT));
+        if (ret < 0)
         {
-            log_warn << "hdr unserialize failed: " << e.get_errno();
-            return;
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                log_warn << "receive failed: " << ::strerror(errno);
+            }
+            break;
         }
-        if (NetHeader::serial_size_ + hdr.len() != bytes_transferred)
+        recv_lens_[n++] = ret;
+    }
+    return n;
+#endif /* __linux__ */
+}
+
+
+void gcomm::AsioUdpSocket::handle_datagram(const gu::byte_t* buf,
+                                           size_t const len)
+{
+    if (len < NetHeader::serial_size_)
+    {
+        log_warn << "short read of " << len;
+        return;
+    }
+
+    NetHeader hdr;
+    try
+    {
+        unserialize(buf, NetHeader::serial_size_, 0, hdr);
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "hdr unserialize failed: " << e.get_errno();
+        return;
+    }
+    if (NetHeader::serial_size_ + hdr.len() != len)
+    {
+        log_warn << "len " << hdr.len()
+                 << " does not match to bytes transferred"
+                 << len;
+    }
+    else
+    {
+        Datagram dg(
+            gu::SharedBuffer(
+                new gu::Buffer(buf + NetHeader::serial_size_,
+                               buf + NetHeader::serial_size_
+                               + hdr.len())));
+        if (net_.checksum_ != NetHeader::CS_NONE && check_cs(hdr, dg))
         {
-            log_warn << "len " << hdr.len()
-                     << " does not match to bytes transferred"
-                     << bytes_transferred;
+            log_warn << "checksum failed, hdr: len=" << hdr.len()
+                     << " has_crc32="  << hdr.has_crc32()
+                     << " has_crc32c=" << hdr.has_crc32c()
+                     << " crc32=" << hdr.crc32();
         }
         else
         {
-            Datagram dg(
-                gu::SharedBuffer(
-                    new gu::Buffer(&recv_buf_[0] + NetHeader::serial_size_,
-                                   &recv_buf_[0] + NetHeader::serial_size_
-                                   + hdr.len())));
-            if (net_.checksum_ == true && check_cs(hdr, dg))
-            {
-                log_warn << "checksum failed, hdr: len=" << hdr.len()
-                         << " has_crc32="  << hdr.has_crc32()
-                         << " has_crc32c=" << hdr.has_crc32c()
-                         << " crc32=" << hdr.crc32();
-            }
-            else
-            {
-                net_.dispatch(id(), dg, ProtoUpMeta());
-            }
+            net_.dispatch(id(), dg, ProtoUpMeta());
         }
     }
-    else
+}
+
+
+//
+// Read handler is called when the socket becomes readable. Datagrams
+// are drained from the socket in batches, limited by max_batches in
+// order not to starve other sockets.
+//
+void gcomm::AsioUdpSocket::read_handler(const asio::error_code& ec)
+{
+    if (ec)
     {
-        log_warn << "short read of " << bytes_transferred;
+        //
+        return;
+    }
+
+    Critical<AsioProtonet> crit(net_);
+    static const size_t max_batches(4);
+    for (size_t b(0); b < max_batches && state() == S_CONNECTED; ++b)
+    {
+        const size_t n(read_batch());
+        for (size_t i(0); i < n && state() == S_CONNECTED; ++i)
+        {
+            handle_datagram(&recv_buf_[i*recv_slot_size], recv_lens_[i]);
+        }
+        if (n < batch_size)
+        {
+            break;
+        }
+    }
+    if (state() == S_CONNECTED)
+    {
+        async_receive();
     }
-    async_receive();
 }
 
 void gcomm::AsioUdpSocket::async_receive()
 {
     Critical<AsioProtonet> crit(net_);
-    gu::array<asio::mutable_buffer, 1>::type mbs;
-    mbs[0] = asio::mutable_buffer(&recv_buf_[0], recv_buf_.size());
-    socket_.async_receive_from(mbs, source_ep_,
-                               boost::bind(&AsioUdpSocket::read_handler,
-                                           shared_from_this(),
-                                           asio::placeholders::error,
-                                           asio::placeholders::bytes_transferred));
+    socket_.async_receive(asio::null_buffers(),
+                          boost::bind(&AsioUdpSocket::read_handler,
+                                      shared_from_this(),
+                                      asio::placeholders::error));
 }
 
 
+gcomm::SocketStats gcomm::AsioUdpSocket::stats() const
+{
+    SocketStats ret;
+    Critical<AsioProtonet> crit(net_);
+    ret.send_queue_length = send_q_.size();
+    ret.dropped_msgs = dropped_msgs_;
+    return ret;
+}
+
 size_t gcomm::AsioUdpSocket::mtu() const
 {
     return (1 << 15);
@@ -26,6 +26,7 @@ namespace gcomm
 {
     class AsioUdpSocket;
     class AsioProtonet;
+    class AsioUdpPostForSendHandler;
 }
 
 class gcomm::AsioUdpSocket :
@@ -39,21 +40,40 @@ public:
     void close();
     void set_option(const std::string&, const std::string&) { /* not implemented */ }
     int send(int segment, const Datagram& dg);
-    void read_handler(const asio::error_code&, size_t);
+    void read_handler(const asio::error_code&);
+    void write_handler(const asio::error_code&);
     void async_receive();
     size_t mtu() const;
     std::string local_addr() const;
     std::string remote_addr() const;
     State state() const { return state_; }
     SocketId id() const { return &socket_; }
-    SocketStats stats() const { return SocketStats(); }
+    SocketStats stats() const;
 private:
+    friend class gcomm::AsioUdpPostForSendHandler;
+
+    // Reads datagrams available in socket into recv_buf_ slots,
+    // returns number of datagrams read
+    size_t read_batch();
+    void handle_datagram(const gu::byte_t* buf, size_t len);
+    // Sends datagrams in send_q_
+    void write_queued();
+
     AsioProtonet&            net_;
     State                    state_;
     asio::ip::udp::socket    socket_;
     asio::ip::udp::endpoint  target_ep_;
-    asio::ip::udp::endpoint  source_ep_;
+    // Datagrams are received and sent in batches of at most this many
+    // in order to save system calls per datagram
+    static const size_t      batch_size = 16;
+    static const size_t      recv_slot_size = (1 << 15) + NetHeader::serial_size_;
     std::vector<gu::byte_t>  recv_buf_;
+    std::vector<size_t>      recv_lens_;
+    // Datagrams with network header waiting for write_queued()
+    static const size_t      max_send_q_len = 1024;
+    std::vector<Datagram>    send_q_;
+    // Datagrams discarded because of full send queue or send error
+    long                     dropped_msgs_;
 };
 
 #if defined(__GNUG__)
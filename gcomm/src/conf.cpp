@@ -13,6 +13,7 @@ static std::string const Delim = ".";
 // Protonet
 std::string const gcomm::Conf::ProtonetBackend("protonet.backend");
 std::string const gcomm::Conf::ProtonetVersion("protonet.version");
+std::string const gcomm::Conf::ProtonetIoThreads("protonet.io_threads");
 
 // TCP
 static std::string const SocketPrefix("socket" + Delim);
@@ -52,6 +53,10 @@ std::string const gcomm::Conf::GMCastIsolate =
     GMCastPrefix + "isolate";
 std::string const gcomm::Conf::GMCastSegment =
     GMCastPrefix + "segment";
+std::string const gcomm::Conf::GMCastSegmentFanout =
+    GMCastPrefix + "segment_fanout";
+std::string const gcomm::Conf::GMCastSegmentRelayRtt =
+    GMCastPrefix + "segment_relay_rtt";
 
 // EVS
 std::string const gcomm::Conf::EvsScheme = "evs";
@@ -84,6 +89,8 @@ std::string const gcomm::Conf::EvsUserSendWindow =
     EvsPrefix + "user_send_window";
 std::string const gcomm::Conf::EvsUseAggregate =
     EvsPrefix + "use_aggregate";
+std::string const gcomm::Conf::EvsAggregateDelay =
+    EvsPrefix + "aggregate_delay";
 std::string const gcomm::Conf::EvsCausalKeepalivePeriod =
     EvsPrefix + "causal_keepalive_period";
 std::string const gcomm::Conf::EvsMaxInstallTimeouts =
@@ -128,6 +135,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
 
     GCOMM_CONF_ADD_DEFAULT(ProtonetBackend);
     GCOMM_CONF_ADD_DEFAULT(ProtonetVersion);
+    GCOMM_CONF_ADD_DEFAULT(ProtonetIoThreads);
 
     GCOMM_CONF_ADD        (TcpNonBlocking);
     GCOMM_CONF_ADD_DEFAULT(SocketChecksum);
@@ -147,6 +155,8 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD        (GMCastPeerAddr);
     GCOMM_CONF_ADD        (GMCastIsolate);
     GCOMM_CONF_ADD_DEFAULT(GMCastSegment);
+    GCOMM_CONF_ADD_DEFAULT(GMCastSegmentFanout);
+    GCOMM_CONF_ADD_DEFAULT(GMCastSegmentRelayRtt);
 
     GCOMM_CONF_ADD        (EvsVersion);
     GCOMM_CONF_ADD_DEFAULT(EvsViewForgetTimeout);
@@ -162,6 +172,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
     GCOMM_CONF_ADD_DEFAULT(EvsSendWindow);
     GCOMM_CONF_ADD_DEFAULT(EvsUserSendWindow);
     GCOMM_CONF_ADD        (EvsUseAggregate);
+    GCOMM_CONF_ADD_DEFAULT(EvsAggregateDelay);
     GCOMM_CONF_ADD        (EvsCausalKeepalivePeriod);
     GCOMM_CONF_ADD_DEFAULT(EvsMaxInstallTimeouts);
     GCOMM_CONF_ADD_DEFAULT(EvsDelayMargin);
@@ -16,6 +16,7 @@ namespace gcomm
 #endif /* HAVE_ASIO_HPP */
 
     std::string const Defaults::ProtonetVersion         = "0";
+    std::string const Defaults::ProtonetIoThreads       = "0";
     std::string const Defaults::SocketChecksum          = "2";
     std::string const Defaults::SocketRecvBufSize       =
         GCOMM_ASIO_AUTO_BUF_SIZE;
@@ -24,6 +25,8 @@ namespace gcomm
     std::string const Defaults::GMCastVersion           = "0";
     std::string const Defaults::GMCastTcpPort           = BASE_PORT_DEFAULT;
     std::string const Defaults::GMCastSegment           = "0";
+    std::string const Defaults::GMCastSegmentFanout     = "0";
+    std::string const Defaults::GMCastSegmentRelayRtt   = "false";
     std::string const Defaults::GMCastTimeWait          = "PT5S";
     std::string const Defaults::GMCastPeerTimeout       = "PT3S";
     std::string const Defaults::EvsViewForgetTimeout    = "PT24H";
@@ -42,6 +45,7 @@ namespace gcomm
     std::string const Defaults::EvsSendWindowMin        = "1";
     std::string const Defaults::EvsUserSendWindow       = "4";
     std::string const Defaults::EvsUserSendWindowMin    = "1";
+    std::string const Defaults::EvsAggregateDelay       = "PT0S";
     std::string const Defaults::EvsMaxInstallTimeouts   = "3";
     std::string const Defaults::EvsDelayMargin          = "PT1S";
     std::string const Defaults::EvsDelayedKeepPeriod    = "PT30S";
@@ -10,6 +10,7 @@
 #include "gu_buffer.hpp"
 #include <stdexcept>
 #include <numeric>
+#include <algorithm>
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -90,22 +91,221 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMapMsg& m)
 }
 
 
+std::ostream& gcomm::evs::operator<<(std::ostream& os,
+                                     const InputMapMsgIndex& mi)
+{
+    os << "{base=" << mi.base_ << ",top=" << mi.top_
+       << ",msgs=" << mi.n_msgs_ << ",recovery=" << mi.n_recovery_;
+#ifndef NDEBUG
+    for (seqno_t seq(mi.base_); seq <= mi.top_; ++seq)
+    {
+        switch (mi.state(seq))
+        {
+        case InputMapMsgIndex::S_EMPTY:                      break;
+        case InputMapMsgIndex::S_MSG:      os << " m" << seq; break;
+        case InputMapMsgIndex::S_RECOVERY: os << " r" << seq; break;
+        }
+    }
+#endif // !NDEBUG
+    return (os << "}");
+}
+
+
 std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
 {
-    return (os << "evs::input_map: {"
-            << "aru_seq="        << im.aru_seq()   << ","
-            << "safe_seq="       << im.safe_seq()  << ","
-            << "node_index="     << *im.node_index_
+    os << "evs::input_map: {"
+       << "aru_seq="        << im.aru_seq()   << ","
+       << "safe_seq="       << im.safe_seq()  << ","
+       << "node_index="     << *im.node_index_;
 #ifndef NDEBUG
-            << ","
-            << "msg_index="      << *im.msg_index_      << ","
-            << "recovery_index=" << *im.recovery_index_
+    os << "," << "msg_index=";
+    for (InputMapNodeIndex::const_iterator i(im.node_index_->begin());
+         i != im.node_index_->end(); ++i)
+    {
+        os << i->msg_index() << " ";
+    }
 #endif // !NDEBUG
-            << "}");
+    return (os << "}");
 }
 
 
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Message index
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+gcomm::evs::InputMapMsgIndex::InputMapMsgIndex()
+    :
+    slots_     (),
+    base_      (0),
+    top_       (-1),
+    head_      (-1),
+    purged_    (-1),
+    n_msgs_    (0),
+    n_recovery_(0)
+{ }
+
+
+void gcomm::evs::InputMapMsgIndex::insert(const seqno_t      seq,
+                                          const UserMessage& msg,
+                                          const Datagram&    rb)
+{
+    gcomm_assert(seq >= base_ && state(seq) == S_EMPTY)
+        << "seq " << seq << " base " << base_;
+
+    reserve(seq);
+    Slot& s(slots_[slot(seq)]);
+    s.msg_.msg_ = msg;
+    s.msg_.rb_  = rb;
+    s.state_    = S_MSG;
+
+    if (seq > top_) top_ = seq;
+    if (n_msgs_ == 0 || seq < head_) head_ = seq;
+    ++n_msgs_;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::erase(const seqno_t seq)
+{
+    gcomm_assert(state(seq) == S_MSG) << "seq " << seq << " not found";
+
+    Slot& s(slots_[slot(seq)]);
+    --n_msgs_;
+    if (seq <= purged_)
+    {
+        // Already safe, nobody will ask for recovery
+        release(s);
+        while (base_ <= purged_ && base_ <= top_ &&
+               slots_[slot(base_)].state_ == S_EMPTY)
+        {
+            ++base_;
+        }
+    }
+    else
+    {
+        s.state_ = S_RECOVERY;
+        ++n_recovery_;
+    }
+
+    if (seq == head_ && n_msgs_ > 0)
+    {
+        head_ = next(seq + 1);
+        assert(head_ != -1);
+    }
+}
+
+
+void gcomm::evs::InputMapMsgIndex::purge(const seqno_t seq)
+{
+    const seqno_t last(std::min(seq, top_));
+    for (seqno_t s(std::max(base_, purged_ + 1)); s <= last; ++s)
+    {
+        Slot& sl(slots_[slot(s)]);
+        if (sl.state_ == S_RECOVERY)
+        {
+            release(sl);
+            --n_recovery_;
+        }
+    }
+    if (seq > purged_) purged_ = seq;
+
+    // Messages not delivered yet keep the base from advancing
+    while (base_ <= purged_ &&
+           (base_ > top_ || slots_[slot(base_)].state_ == S_EMPTY))
+    {
+        ++base_;
+    }
+}
+
+
+gcomm::evs::seqno_t gcomm::evs::InputMapMsgIndex::next(seqno_t seq) const
+{
+    if (n_msgs_ == 0) return -1;
+    for (seq = std::max(seq, head_); seq <= top_; ++seq)
+    {
+        if (slots_[slot(seq)].state_ == S_MSG) return seq;
+    }
+    return -1;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::clear()
+{
+    slots_.clear();
+    base_       = 0;
+    top_        = -1;
+    head_       = -1;
+    purged_     = -1;
+    n_msgs_     = 0;
+    n_recovery_ = 0;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::release(Slot& s)
+{
+    // Drop reference to payload buffer, user message and datagram are
+    // overwritten when slot is reused
+    s.msg_.rb_.release_payload();
+    s.state_   = S_EMPTY;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::reserve(const seqno_t seq)
+{
+    const size_t need(static_cast<size_t>(seq - base_) + 1);
+    if (need <= slots_.size()) return;
+
+    size_t size(slots_.empty() ? size_t(min_size) : slots_.size());
+    while (size < need) size *= 2;
+
+    std::vector<Slot> slots(size);
+    const size_t mask(size - 1);
+    for (seqno_t s(base_); s <= top_; ++s)
+    {
+        Slot& from(slots_[slot(s)]);
+        if (from.state_ != S_EMPTY)
+        {
+            slots[static_cast<size_t>(s) & mask] = from;
+        }
+    }
+    slots_.swap(slots);
+}
+
+
+gcomm::evs::InputMapIterator& gcomm::evs::InputMapIterator::operator++()
+{
+    const InputMapNodeIndex& ni(*node_index_);
+
+    // Message with the same seqno from the node with higher index
+    for (size_t i(index_ + 1); i < ni.size(); ++i)
+    {
+        if (ni[i].msg_index().state(seq_) == InputMapMsgIndex::S_MSG)
+        {
+            index_ = i;
+            return *this;
+        }
+    }
+
+    size_t  index(end_index);
+    seqno_t seq(-1);
+    for (size_t i(0); i < ni.size(); ++i)
+    {
+        const seqno_t s(ni[i].msg_index().next(seq_ + 1));
+        if (s != -1 && (index == end_index || s < seq))
+        {
+            index = i;
+            seq   = s;
+        }
+    }
+    index_ = index;
+    seq_   = seq;
+    return *this;
+}
+
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Constructors/destructors
@@ -117,8 +317,8 @@ gcomm::evs::InputMap::InputMap() :
     safe_seq_       (-1),
     aru_seq_        (-1),
     node_index_     (new InputMapNodeIndex()),
-    msg_index_      (new InputMapMsgIndex()),
-    recovery_index_ (new InputMapMsgIndex())
+    begin_          (),
+    begin_valid_    (false)
 { }
 
 
@@ -126,8 +326,6 @@ gcomm::evs::InputMap::~InputMap()
 {
     clear();
     delete node_index_;
-    delete msg_index_;
-    delete recovery_index_;
 }
 
 
@@ -141,9 +339,13 @@ gcomm::evs::InputMap::~InputMap()
 
 void gcomm::evs::InputMap::reset(const size_t nodes)
 {
-    gcomm_assert(msg_index_->empty()                           == true &&
-                 recovery_index_->empty()                      == true);
+    for (InputMapNodeIndex::const_iterator i(node_index_->begin());
+         i != node_index_->end(); ++i)
+    {
+        gcomm_assert(i->msg_index().empty() == true);
+    }
     node_index_->clear();
+    begin_valid_ = false;
 
     log_debug << " size " << node_index_->size();
     gu_trace(node_index_->resize(nodes, InputMapNode()));
@@ -200,30 +402,41 @@ void gcomm::evs::InputMap::set_safe_seq(const size_t uuid, const seqno_t seq)
                     NodeIndexSafeSeqCmpOp());
     const seqno_t minval = min->safe_seq();
     gcomm_assert(minval >= safe_seq_);
-    safe_seq_ = minval;
 
     // Global safe seq must always be smaller than equal to aru seq
-    gcomm_assert(safe_seq_ <= aru_seq_);
-    // Cleanup recovery index
-    cleanup_recovery_index();
+    gcomm_assert(minval <= aru_seq_);
+    // Cleanup recovery index, nothing to release if safe seq did not
+    // advance
+    if (minval > safe_seq_)
+    {
+        safe_seq_ = minval;
+        cleanup_recovery_index();
+    }
 }
 
 
 void gcomm::evs::InputMap::clear()
 {
-    if (msg_index_->empty() == false)
+    size_t n_msgs(0), n_recovery(0);
+    for (InputMapNodeIndex::iterator i(node_index_->begin());
+         i != node_index_->end(); ++i)
     {
-        log_warn << "discarding " << msg_index_->size() <<
+        n_msgs     += i->msg_index().size();
+        n_recovery += i->msg_index().recovery_size();
+        i->msg_index().clear();
+    }
+    if (n_msgs > 0)
+    {
+        log_warn << "discarding " << n_msgs <<
             " messages from message index";
     }
-    msg_index_->clear();
-    if (recovery_index_->empty() == false)
+    if (n_recovery > 0)
     {
-        log_debug << "discarding " << recovery_index_->size()
+        log_debug << "discarding " << n_recovery
                   << " messages from recovery index";
     }
-    recovery_index_->clear();
     node_index_->clear();
+    begin_valid_ = false;
     aru_seq_ = -1;
     safe_seq_ = -1;
 }
@@ -242,12 +455,14 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // User should check aru_seq before inserting. This check is left
     // also in optimized builds since violating it may cause duplicate
     // messages.
+    gcomm_assert(uuid < node_index_->size());
+    InputMapNode& node((*node_index_)[uuid]);
+    InputMapMsgIndex& msg_index(node.msg_index());
+
     gcomm_assert(aru_seq_ < msg.seq())
         << "aru seq " << aru_seq_ << " msg seq " << msg.seq()
-        << " index size " << msg_index_->size();
+        << " index size " << msg_index.size();
 
-    gcomm_assert(uuid < node_index_->size());
-    InputMapNode& node((*node_index_)[uuid]);
     range = node.range();
 
     // User should check LU before inserting. This check is left
@@ -260,8 +475,7 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // Check whether this message has already been seen
     if (msg.seq() < node.range().lu() ||
         (msg.seq() <= node.range().hs() &&
-         recovery_index_->find(InputMapMsgKey(node.index(), msg.seq())) !=
-         recovery_index_->end()))
+         msg_index.state(msg.seq()) == InputMapMsgIndex::S_RECOVERY))
     {
         return node.range();
     }
@@ -270,35 +484,26 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // already found
     for (seqno_t s = msg.seq(); s <= msg.seq() + msg.seq_range(); ++s)
     {
-        InputMapMsgIndex::iterator msg_i;
-
-        if (range.hs() < s)
-        {
-            msg_i = msg_index_->end();
-        }
-        else
+        if (range.hs() < s ||
+            msg_index.state(s) == InputMapMsgIndex::S_EMPTY)
         {
-            msg_i = msg_index_->find(InputMapMsgKey(node.index(), s));
-        }
-
-        if (msg_i == msg_index_->end())
-        {
-            Datagram ins_dg(s == msg.seq() ?
-                                Datagram(rb)   :
-                                Datagram());
-            gu_trace((void)msg_index_->insert_unique(
-                         std::make_pair(
-                             InputMapMsgKey(node.index(), s),
-                             InputMapMsg(
-                                 (s == msg.seq() ?
-                                  msg :
-                                  UserMessage(msg.version(),
-                                              msg.source(),
-                                              msg.source_view_id(),
-                                              s,
-                                              msg.aru_seq(),
-                                              0,
-                                              O_DROP)), ins_dg))));
+            update_begin(node.index(), s);
+            if (s == msg.seq())
+            {
+                gu_trace(msg_index.insert(s, msg, rb));
+            }
+            else
+            {
+                gu_trace(msg_index.insert(s,
+                                          UserMessage(msg.version(),
+                                                      msg.source(),
+                                                      msg.source_view_id(),
+                                                      s,
+                                                      msg.aru_seq(),
+                                                      0,
+                                                      O_DROP),
+                                          Datagram()));
+            }
         }
 
         // Update highest seen
@@ -317,10 +522,7 @@ gcomm::evs::InputMap::insert(const size_t uuid,
             }
             while (
                 i <= range.hs() &&
-                (msg_index_->find(InputMapMsgKey(node.index(), i))
-                 != msg_index_->end() ||
-                 recovery_index_->find(InputMapMsgKey(node.index(), i))
-                 != recovery_index_->end()));
+                msg_index.state(i) != InputMapMsgIndex::S_EMPTY);
             range.set_lu(i);
         }
     }
@@ -331,32 +533,63 @@ gcomm::evs::InputMap::insert(const size_t uuid,
 }
 
 
+gcomm::evs::InputMap::iterator gcomm::evs::InputMap::begin() const
+{
+    if (begin_valid_ == true) return begin_;
+
+    // Lowest (seq, index) over heads of node message indices
+    size_t  index(iterator::end_index);
+    seqno_t seq(-1);
+    for (size_t i(0); i < node_index_->size(); ++i)
+    {
+        const seqno_t head((*node_index_)[i].msg_index().head());
+        if (head != -1 && (index == iterator::end_index || head < seq))
+        {
+            index = i;
+            seq   = head;
+        }
+    }
+    begin_       = iterator(node_index_, index, seq);
+    begin_valid_ = true;
+    return begin_;
+}
+
+
 void gcomm::evs::InputMap::erase(iterator i)
 {
-    gu_trace(recovery_index_->insert_unique(*i));
-    gu_trace(msg_index_->erase(i));
+    gcomm_assert(i.index() < node_index_->size());
+    gu_trace((*node_index_)[i.index()].msg_index().erase(i.seq()));
+    if (begin_valid_ == true && i == begin_)
+    {
+        // Next message in order is usually found from the same seqno
+        // of the next node, so advancing is cheaper than full scan
+        ++begin_;
+    }
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::find(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
-    const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = msg_index_->find(key));
-    return ret;
+    if (node.msg_index().state(seq) == InputMapMsgIndex::S_MSG)
+    {
+        return iterator(node_index_, node.index(), seq);
+    }
+    return end();
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::recover(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
-    const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = recovery_index_->find_checked(key));
-    return ret;
+    if (node.msg_index().state(seq) != InputMapMsgIndex::S_RECOVERY)
+    {
+        gu_throw_fatal << "element " << InputMapMsgKey(node.index(), seq)
+                       << " not found";
+    }
+    return iterator(node_index_, node.index(), seq);
 }
 
 static void append_gap_range_list(std::vector<gcomm::evs::Range>& range_list,
@@ -385,14 +618,7 @@ gcomm::evs::InputMap::gap_range_list(size_t index, const Range& range) const
     std::vector<Range> ret;
     for (seqno_t seq(range.lu()); seq <= range.hs(); ++seq)
     {
-        const InputMapMsgKey key(index, seq);
-        gcomm::evs::InputMap::const_iterator msg_i(msg_index_->find(key));
-        if (msg_i != msg_index_->end())
-        {
-            continue;
-        }
-        msg_i = recovery_index_->find(key);
-        if (msg_i != recovery_index_->end())
+        if (node.msg_index().state(seq) != InputMapMsgIndex::S_EMPTY)
         {
             continue;
         }
@@ -410,6 +636,18 @@ gcomm::evs::InputMap::gap_range_list(size_t index, const Range& range) const
 //////////////////////////////////////////////////////////////////////////
 
 
+inline void gcomm::evs::InputMap::update_begin(const size_t  index,
+                                              const seqno_t seq)
+{
+    if (begin_valid_ == true &&
+        (begin_ == end() ||
+         InputMapMsgKey(index, seq) < InputMapMsgIndex::key(begin_)))
+    {
+        begin_ = iterator(node_index_, index, seq);
+    }
+}
+
+
 inline void gcomm::evs::InputMap::update_aru()
 {
     InputMapNodeIndex::const_iterator min =
@@ -425,7 +663,9 @@ inline void gcomm::evs::InputMap::update_aru()
 void gcomm::evs::InputMap::cleanup_recovery_index()
 {
     gcomm_assert(node_index_->size() > 0);
-    InputMapMsgIndex::iterator i = recovery_index_->lower_bound(
-        InputMapMsgKey(0, safe_seq_ + 1));
-    recovery_index_->erase(recovery_index_->begin(), i);
+    for (InputMapNodeIndex::iterator i(node_index_->begin());
+         i != node_index_->end(); ++i)
+    {
+        i->msg_index().purge(safe_seq_);
+    }
 }
@@ -20,7 +20,6 @@
 #define EVS_INPUT_MAP2_HPP
 
 #include "evs_message2.hpp"
-#include "gcomm/map.hpp"
 #include "gcomm/datagram.hpp"
 
 #include <vector>
@@ -36,6 +35,8 @@ namespace gcomm
         class InputMapMsg;
         std::ostream& operator<<(std::ostream&, const InputMapMsg&);
         class InputMapMsgIndex;
+        std::ostream& operator<<(std::ostream&, const InputMapMsgIndex&);
+        class InputMapIterator;
         class InputMapNode;
         std::ostream& operator<<(std::ostream&, const InputMapNode&);
         typedef std::vector<InputMapNode> InputMapNodeIndex;
@@ -73,6 +74,7 @@ private:
 class gcomm::evs::InputMapMsg
 {
 public:
+    InputMapMsg() : msg_(), rb_() { }
     InputMapMsg(const UserMessage&  msg,
                 const Datagram&     rb)
         :
@@ -85,44 +87,183 @@ public:
     const UserMessage&  msg () const { return msg_;  }
     const Datagram& rb  () const { return rb_;   }
 private:
-    void operator=(const InputMapMsg&);
+    friend class InputMapMsgIndex;
+    // Assigned only when slots of message index are relocated
+    InputMapMsg& operator=(const InputMapMsg& m)
+    {
+        msg_ = m.msg_;
+        rb_  = m.rb_;
+        return *this;
+    }
+
+    UserMessage msg_;
+    Datagram    rb_;
+};
+
+
+/*!
+ * Iterator over messages in input map. Messages are visited in
+ * (seq, index) order.
+ *
+ * Iterator stays valid over insertions, it is invalidated only when
+ * the message it points to is erased.
+ */
+class gcomm::evs::InputMapIterator
+{
+public:
+    InputMapIterator()
+        :
+        node_index_(0),
+        index_     (end_index),
+        seq_       (-1)
+    { }
+
+    size_t  index() const { return index_; }
+    seqno_t seq  () const { return seq_;   }
+
+    InputMapIterator& operator++();
+
+    bool operator==(const InputMapIterator& cmp) const
+    {
+        return (index_ == cmp.index_ && seq_ == cmp.seq_);
+    }
+
+    bool operator!=(const InputMapIterator& cmp) const
+    {
+        return !(*this == cmp);
+    }
+
+private:
+    friend class InputMap;
+    friend class InputMapMsgIndex;
+
+    static const size_t end_index = static_cast<size_t>(-1);
 
-    UserMessage const msg_;
-    Datagram          rb_;
+    InputMapIterator(const InputMapNodeIndex* node_index,
+                     size_t                   index,
+                     seqno_t                  seq)
+        :
+        node_index_(node_index),
+        index_     (index),
+        seq_       (seq)
+    { }
+
+    const InputMapNodeIndex* node_index_;
+    size_t                   index_;
+    seqno_t                  seq_;
 };
 
 
-#if defined(GALERA_USE_BOOST_POOL_ALLOC)
+/*!
+ * Message index of a single node. Since sequence numbers originated
+ * from a node are dense, messages are stored in a circular buffer
+ * indexed by sequence number. Messages which have been erased from
+ * input map but may still be needed for recovery stay in the buffer
+ * until they become safe.
+ */
+class gcomm::evs::InputMapMsgIndex
+{
+public:
+    /* Iterators exposed to user */
+    typedef InputMapIterator iterator;
+    typedef InputMapIterator const_iterator;
+
+    enum State
+    {
+        S_EMPTY,    /*!< No message                           */
+        S_MSG,      /*!< Message not delivered yet            */
+        S_RECOVERY  /*!< Message delivered, kept for recovery */
+    };
+
+    static InputMapMsgKey key(const iterator& i)
+    {
+        return InputMapMsgKey(i.index(), i.seq());
+    }
+
+    static const InputMapMsg& value(const iterator& i);
+
+    InputMapMsgIndex();
+
+    State state(const seqno_t seq) const
+    {
+        if (seq < base_ || seq > top_) return S_EMPTY;
+        return slots_[slot(seq)].state_;
+    }
+
+    const InputMapMsg& at(const seqno_t seq) const
+    {
+        assert(state(seq) != S_EMPTY);
+        return slots_[slot(seq)].msg_;
+    }
+
+    /*!
+     * Store message with given seqno, slot must be empty.
+     */
+    void insert(seqno_t seq, const UserMessage& msg, const Datagram& rb);
+
+    /*!
+     * Move message to recovery or drop it if it is already safe.
+     */
+    void erase(seqno_t seq);
+
+    /*!
+     * Drop recovery messages up to seq.
+     */
+    void purge(seqno_t seq);
+
+    /*!
+     * Return lowest seqno greater than or equal to seq which has
+     * message not delivered yet, -1 if there is none.
+     */
+    seqno_t next(seqno_t seq) const;
+
+    /*!
+     * Return lowest seqno of messages not delivered yet, -1 if there
+     * is none.
+     */
+    seqno_t head() const { return (n_msgs_ > 0 ? head_ : -1); }
+
+    size_t size         () const { return n_msgs_;     }
+    size_t recovery_size() const { return n_recovery_; }
+    bool   empty        () const { return (n_msgs_ + n_recovery_ == 0); }
+
+    void clear();
 
-#include <boost/pool/pool_alloc.hpp>
+private:
+    friend std::ostream& operator<<(std::ostream&, const InputMapMsgIndex&);
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg,
-               std::map<InputMapMsgKey,
-                        InputMapMsg,
-                        std::less<InputMapMsgKey>,
-                        boost::fast_pool_allocator<
-                            std::pair<const InputMapMsgKey, InputMapMsg>,
-                            boost::default_user_allocator_new_delete,
-                            boost::details::pool::null_mutex
-                            >
-                        >
-               >
-{};
+    struct Slot
+    {
+        Slot() : msg_(), state_(S_EMPTY) { }
+        InputMapMsg msg_;
+        State       state_;
+    };
 
-#else /* GALERA_USE_BOOST_POOL_ALLOC */
+    static const size_t min_size = 32;
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg>
-{};
+    size_t slot(const seqno_t seq) const
+    {
+        return (static_cast<size_t>(seq) & (slots_.size() - 1));
+    }
+
+    void release(Slot& s);
+    void reserve(seqno_t seq);
+
+    std::vector<Slot> slots_;
+    seqno_t           base_;       /*!< Lowest seqno which may be stored */
+    seqno_t           top_;        /*!< Highest seqno stored             */
+    seqno_t           head_;       /*!< Lowest not delivered seqno       */
+    seqno_t           purged_;     /*!< Recovery dropped up to seqno     */
+    size_t            n_msgs_;
+    size_t            n_recovery_;
+};
 
-#endif /* GALERA_USE_BOOST_POOL_ALLOC */
 
 /* Internal node representation */
 class gcomm::evs::InputMapNode
 {
 public:
-    InputMapNode() : idx_(), range_(0, -1), safe_seq_(-1) { }
+    InputMapNode() : idx_(), range_(0, -1), safe_seq_(-1), msg_index_() { }
 
     void   set_range     (const Range   r)       { range_     = r; }
     void   set_safe_seq  (const seqno_t s)       { safe_seq_  = s; }
@@ -132,13 +273,22 @@ public:
     seqno_t safe_seq  ()               const { return safe_seq_;  }
     size_t  index     ()               const { return idx_;       }
 
+    InputMapMsgIndex&       msg_index()       { return msg_index_; }
+    const InputMapMsgIndex& msg_index() const { return msg_index_; }
+
 private:
-    size_t  idx_;
-    Range   range_;
-    seqno_t safe_seq_;
+    size_t           idx_;
+    Range            range_;
+    seqno_t          safe_seq_;
+    InputMapMsgIndex msg_index_;
 };
 
 
+inline const gcomm::evs::InputMapMsg&
+gcomm::evs::InputMapMsgIndex::value(const iterator& i)
+{
+    return (*i.node_index_)[i.index()].msg_index().at(i.seq());
+}
 
 
 
@@ -151,8 +301,8 @@ class gcomm::evs::InputMap
 public:
 
     /* Iterators exposed to user */
-    typedef InputMapMsgIndex::iterator iterator;
-    typedef InputMapMsgIndex::const_iterator const_iterator;
+    typedef InputMapIterator iterator;
+    typedef InputMapIterator const_iterator;
 
     /*!
      * Default constructor.
@@ -226,14 +376,15 @@ public:
      *
      * @return Iterator pointing to the first element
      */
-    iterator begin() const { return msg_index_->begin(); }
+    iterator begin() const;
 
     /*!
      * Get iterator next to the last element of the input map
      *
      * @return Iterator pointing past the last element
      */
-    iterator end  () const { return msg_index_->end(); }
+    iterator end  () const { return iterator(node_index_,
+                                             iterator::end_index, -1); }
 
     /*!
      * Check if message pointed by iterator fulfills O_SAFE condition.
@@ -358,11 +509,16 @@ private:
      */
     void cleanup_recovery_index();
 
+    /*!
+     * Update cached begin position for newly inserted message.
+     */
+    void update_begin(size_t index, seqno_t seq);
+
     seqno_t            safe_seq_;       /*!< Safe seqno               */
     seqno_t            aru_seq_;        /*!< All received up to seqno */
     InputMapNodeIndex* node_index_;     /*!< Index of nodes           */
-    InputMapMsgIndex*  msg_index_;      /*!< Index of messages        */
-    InputMapMsgIndex*  recovery_index_; /*!< Recovery index           */
+    mutable iterator   begin_;          /*!< Cached begin position    */
+    mutable bool       begin_valid_;    /*!< Cached begin is valid    */
 };
 
 #endif // EVS_INPUT_MAP2_HPP
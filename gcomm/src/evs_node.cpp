@@ -51,7 +51,9 @@ gcomm::evs::Node::Node(const Node& n)
     last_requested_range_tstamp_(),
     last_requested_range_(),
     fifo_seq_        (n.fifo_seq_),
-    segment_         (n.segment_)
+    segment_         (n.segment_),
+    retrans_requested_(n.retrans_requested_),
+    retrans_served_  (n.retrans_served_)
 { }
 
 
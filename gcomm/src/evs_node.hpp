@@ -54,7 +54,9 @@ public:
         last_requested_range_tstamp_(),
         last_requested_range_(),
         fifo_seq_          (-1),
-        segment_           (0)
+        segment_           (0),
+        retrans_requested_ (0),
+        retrans_served_    (0)
     {}
 
     Node(const Node& n);
@@ -116,6 +118,13 @@ public:
     int64_t fifo_seq() const { return fifo_seq_; }
     SegmentId segment() const { return segment_; }
 
+    // Number of retransmission requests sent to node
+    void inc_retrans_requested() { ++retrans_requested_; }
+    long long retrans_requested() const { return retrans_requested_; }
+    // Number of messages retransmitted on requests from node
+    void add_retrans_served(const size_t n) { retrans_served_ += n; }
+    long long retrans_served() const { return retrans_served_; }
+
     bool is_inactive() const;
     bool is_suspected() const;
 
@@ -156,6 +165,8 @@ private:
     Range last_requested_range_;
     int64_t fifo_seq_;
     SegmentId segment_;
+    long long retrans_requested_;
+    long long retrans_served_;
 };
 
 class gcomm::evs::NodeMap : public Map<UUID, Node> { };
@@ -54,6 +54,9 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     safe_deliv_latency_(),
     send_queue_s_(0),
     n_send_queue_s_(0),
+    user_dgs_sent_(0),
+    user_msgs_sent_(0),
+    delayed_msgs_(0),
     sent_msgs_(Message::num_message_types, 0),
     retrans_msgs_(0),
     recovered_msgs_(0),
@@ -173,6 +176,17 @@ gcomm::evs::Proto::Proto(gu::Config&    conf,
     max_output_size_(128),
     mtu_(mtu),
     use_aggregate_(param<bool>(conf, uri, Conf::EvsUseAggregate, "true")),
+    aggregate_delay_(
+        check_range(Conf::EvsAggregateDelay,
+                    param<gu::datetime::Period>(
+                        conf, uri, Conf::EvsAggregateDelay,
+                        Defaults::EvsAggregateDelay),
+                    gu::datetime::Period(0),
+                    retrans_period_)),
+    aggregate_deadline_(gu::datetime::Date::zero()),
+    send_interval_(retrans_period_),
+    last_user_msg_tstamp_(gu::datetime::Date::monotonic()),
+    aggregate_timer_set_(false),
     self_loopback_(false),
     state_(S_CLOSED),
     shift_to_rfcnt_(0),
@@ -373,6 +387,16 @@ gcomm::evs::Proto::set_param(const std::string& key, const std::string& val,
         conf_.set(Conf::EvsUseAggregate, gu::to_string(use_aggregate_));
         return true;
     }
+    else if (key == Conf::EvsAggregateDelay)
+    {
+        aggregate_delay_ = check_range(
+            Conf::EvsAggregateDelay,
+            gu::from_string<gu::datetime::Period>(val),
+            gu::datetime::Period(0),
+            retrans_period_);
+        conf_.set(Conf::EvsAggregateDelay, gu::to_string(aggregate_delay_));
+        return true;
+    }
     else if (key == Conf::EvsDelayMargin)
     {
         delay_margin_ = gu::from_string<gu::datetime::Period>(val);
@@ -463,6 +487,19 @@ void gcomm::evs::Proto::handle_get_status(gu::Status& status) const
     }
     status.insert("evs_evict_list", evict_list_str);
 
+    // Retransmission requests sent to and messages retransmitted for
+    // each node as uuid:requested:served
+    std::ostringstream retrans_os;
+    for (NodeMap::const_iterator i(known_.begin()); i != known_.end(); ++i)
+    {
+        if (NodeMap::key(i) == uuid()) continue;
+        if (retrans_os.tellp() > 0) retrans_os << ",";
+        retrans_os << NodeMap::key(i).full_str()
+                   << ":" << NodeMap::value(i).retrans_requested()
+                   << ":" << NodeMap::value(i).retrans_served();
+    }
+    status.insert("evs_peer_retrans", retrans_os.str());
+
     if (info_mask_ & I_STATISTICS)
     {
         status.insert("evs_safe_hs", hs_safe_.to_string());
@@ -470,6 +507,10 @@ void gcomm::evs::Proto::handle_get_status(gu::Status& status) const
         status.insert("evs_outq_avg",
                       gu::to_string(std::fabs(double(send_queue_s_)/
                                               double(n_send_queue_s_))));
+        status.insert("evs_aggregate_avg",
+                      gu::to_string(std::fabs(double(user_msgs_sent_)/
+                                              double(user_dgs_sent_))));
+        status.insert("evs_aggregate_delayed", gu::to_string(delayed_msgs_));
         status.insert("evs_sent_user",
                       gu::to_string(sent_msgs_[Message::EVS_T_USER]));
         status.insert("evs_sent_delegate",
@@ -520,6 +561,8 @@ std::string gcomm::evs::Proto::stats() const
     os << "\n\tsafe deliv hist {" << hs_safe_ << "} ";
     os << "\n\tcaus deliv hist {" << hs_local_causal_ << "} ";
     os << "\n\toutq avg " << double(send_queue_s_)/double(n_send_queue_s_);
+    os << "\n\taggregate avg " << double(user_msgs_sent_)/double(user_dgs_sent_)
+       << " delayed " << delayed_msgs_;
     os << "\n\tsent {";
     std::copy(sent_msgs_.begin(), sent_msgs_.end(),
          std::ostream_iterator<long long int>(os, ","));
@@ -560,6 +603,9 @@ void gcomm::evs::Proto::reset_stats()
     safe_deliv_latency_.clear();
     send_queue_s_ = 0;
     n_send_queue_s_ = 0;
+    user_dgs_sent_ = 0;
+    user_msgs_sent_ = 0;
+    delayed_msgs_ = 0;
     last_stats_report_ = gu::datetime::Date::monotonic();
 }
 
@@ -772,6 +818,15 @@ void gcomm::evs::Proto::handle_stats_timer()
 }
 
 
+void gcomm::evs::Proto::handle_aggregate_timer()
+{
+    if (aggregate_deadline_ != gu::datetime::Date::zero())
+    {
+        flush_aggregate();
+    }
+}
+
+
 
 class TimerSelectOp
 {
@@ -818,6 +873,9 @@ gu::datetime::Date gcomm::evs::Proto::next_expiration(const Timer t) const
         }
     case T_STATS:
         return (now + stats_report_period_);
+    case T_AGGREGATE:
+        return (aggregate_deadline_ != gu::datetime::Date::zero() ?
+                aggregate_deadline_ : gu::datetime::Date::max());
     }
     gu_throw_fatal;
 }
@@ -871,6 +929,9 @@ gu::datetime::Date gcomm::evs::Proto::handle_timers()
         case T_STATS:
             handle_stats_timer();
             break;
+        case T_AGGREGATE:
+            handle_aggregate_timer();
+            break;
         }
         if (state() == S_CLOSED)
         {
@@ -1589,6 +1650,68 @@ size_t gcomm::evs::Proto::aggregate_len() const
     return (is_aggregate == true ? ret : 0);
 }
 
+gu::datetime::Period
+gcomm::evs::Proto::aggregate_delay(const Datagram& dg) const
+{
+    if (use_aggregate_ == false ||
+        aggregate_delay_ == gu::datetime::Period(0))
+    {
+        return 0;
+    }
+
+    // Not worth to wait if the next message won't fit into the same
+    // aggregate
+    AggregateMessage am;
+    if (2*(dg.len() + am.serial_size()) > mtu())
+    {
+        return 0;
+    }
+
+    // Hold only if sending is busy. The more of the user send window is
+    // occupied by messages in flight, the longer the message may be held:
+    // with the window full it would have to wait in the output queue
+    // anyway. Nothing in flight means idle link, send right away.
+    const seqno_t in_flight(
+        std::min(last_sent_ - input_map_->safe_seq(), user_send_window_));
+    if (in_flight <= 0)
+    {
+        return 0;
+    }
+    const gu::datetime::Period max_delay(
+        aggregate_delay_.get_nsecs()*in_flight/user_send_window_);
+
+    // Wait if the next message is expected to arrive within the delay
+    const gu::datetime::Period expected(send_interval_*2);
+    return (expected < max_delay ? expected : 0);
+}
+
+
+bool gcomm::evs::Proto::is_aggregate_full() const
+{
+    // Full if one more message of average size would not fit
+    AggregateMessage am;
+    const size_t n(output_.size());
+    const size_t len(output_.outbound_bytes() + n*am.serial_size());
+    return (len + len/n > mtu());
+}
+
+
+void gcomm::evs::Proto::flush_aggregate()
+{
+    aggregate_deadline_ = gu::datetime::Date::zero();
+    while (output_.empty() == false && state() == S_OPERATIONAL)
+    {
+        int err;
+        gu_trace(err = send_user(user_send_window_));
+        if (err != 0)
+        {
+            // Flow control, rest will be sent when feedback arrives
+            break;
+        }
+    }
+}
+
+
 int gcomm::evs::Proto::send_user(const seqno_t win)
 {
     gcomm_assert(output_.empty() == false);
@@ -1629,6 +1752,8 @@ int gcomm::evs::Proto::send_user(const seqno_t win)
                                                         send_buf_.end())));
         if ((ret = send_user(dg, 0xff, ord, win, -1, n)) == 0)
         {
+            ++user_dgs_sent_;
+            user_msgs_sent_ += n;
             while (n-- > 0)
             {
                 output_.pop_front();
@@ -1644,9 +1769,16 @@ int gcomm::evs::Proto::send_user(const seqno_t win)
                              win,
                              -1)) == 0)
         {
+            ++user_dgs_sent_;
+            ++user_msgs_sent_;
             output_.pop_front();
         }
     }
+    if (output_.empty() == true)
+    {
+        // Held messages were sent along with others
+        aggregate_deadline_ = gu::datetime::Date::zero();
+    }
     return ret;
 }
 
@@ -2087,6 +2219,7 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
     // therefore it does not make sense to retransmit anything below that.
     seqno_t seq(std::max(range.lu(), input_map_->safe_seq() + 1));
     evs_log_debug(D_RETRANS) << "retransmitting from " << seq;
+    size_t n_resent(0);
     while (seq <= range.hs())
     {
         InputMap::iterator msg_i = input_map_->find(
@@ -2139,6 +2272,12 @@ void gcomm::evs::Proto::resend(const UUID& gap_source, const Range range)
         }
         seq = seq + msg.seq_range() + 1;
         retrans_msgs_++;
+        ++n_resent;
+    }
+    NodeMap::iterator source_i(known_.find(gap_source));
+    if (source_i != known_.end())
+    {
+        NodeMap::value(source_i).add_retrans_served(n_resent);
     }
 }
 
@@ -2228,6 +2367,11 @@ void gcomm::evs::Proto::recover(const UUID& gap_source,
         recovered_msgs_++;
     }
     evs_log_debug(D_RETRANS) << "recovered: " << n_recovered;
+    NodeMap::iterator source_i(known_.find(gap_source));
+    if (source_i != known_.end())
+    {
+        NodeMap::value(source_i).add_retrans_served(n_recovered);
+    }
 }
 
 
@@ -2652,9 +2796,25 @@ int gcomm::evs::Proto::handle_down(Datagram& wb, const ProtoDownMeta& dm)
     send_queue_s_ += output_.size();
     ++n_send_queue_s_;
 
+    const gu::datetime::Date now(gu::datetime::Date::monotonic());
+    send_interval_ = (send_interval_*7 +
+                      std::min(now - last_user_msg_tstamp_, retrans_period_))/8;
+    last_user_msg_tstamp_ = now;
+
     int ret = 0;
+    gu::datetime::Period delay;
 
-    if (output_.empty() == true)
+    if (output_.empty() == true &&
+        (delay = aggregate_delay(wb)) > gu::datetime::Period(0))
+    {
+        // Hold the message, following ones will be aggregated with it
+        output_.push_back(std::make_pair(wb, dm));
+        aggregate_deadline_ = now + delay;
+        reset_timer(T_AGGREGATE);
+        aggregate_timer_set_ = true;
+        ++delayed_msgs_;
+    }
+    else if (output_.empty() == true)
     {
         int err;
         err = send_user(wb,
@@ -2667,8 +2827,11 @@ int gcomm::evs::Proto::handle_down(Datagram& wb, const ProtoDownMeta& dm)
         {
         case EAGAIN:
             output_.push_back(std::make_pair(wb, dm));
-            // fall through
+            ret = 0;
+            break;
         case 0:
+            ++user_dgs_sent_;
+            ++user_msgs_sent_;
             ret = 0;
             break;
         default:
@@ -2679,6 +2842,11 @@ int gcomm::evs::Proto::handle_down(Datagram& wb, const ProtoDownMeta& dm)
     else
     {
         output_.push_back(std::make_pair(wb, dm));
+        if (aggregate_deadline_ != gu::datetime::Date::zero() &&
+            (aggregate_deadline_ <= now || is_aggregate_full() == true))
+        {
+            flush_aggregate();
+        }
     }
 
     return ret;
@@ -3320,6 +3488,10 @@ void gcomm::evs::Proto::request_retrans(const UUID& target, const UUID& origin,
         if (target_i != known_.end())
         {
             target_i->second.last_requested_range(range);
+            if (gap_ranges.empty() == false)
+            {
+                target_i->second.inc_retrans_requested();
+            }
         }
     }
 }
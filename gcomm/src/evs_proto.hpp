@@ -146,6 +146,16 @@ public:
 
     bool is_output_empty() const { return output_.empty(); }
 
+    // Return true once after user message has been held for aggregation.
+    // The caller must then make event loop to reschedule timers so that
+    // the message gets sent in time.
+    bool aggregate_timer_set()
+    {
+        const bool ret(aggregate_timer_set_);
+        aggregate_timer_set_ = false;
+        return ret;
+    }
+
     std::string stats() const;
     void reset_stats();
 
@@ -166,6 +176,13 @@ public:
                   size_t n_aggregated = 1);
     size_t mtu() const { return mtu_; }
     size_t aggregate_len() const;
+    // Return period for which the message should be held for aggregation,
+    // zero if it should be sent right away.
+    gu::datetime::Period aggregate_delay(const Datagram&) const;
+    // Return true if held messages fill up aggregate.
+    bool is_aggregate_full() const;
+    // Send messages held for aggregation.
+    void flush_aggregate();
     int send_user(const seqno_t);
     void complete_user(const seqno_t);
     int send_delegate(Datagram&, const UUID& target);
@@ -356,7 +373,8 @@ public:
         T_INACTIVITY,
         T_RETRANS,
         T_INSTALL,
-        T_STATS
+        T_STATS,
+        T_AGGREGATE
     };
     /*!
      * Internal timer list
@@ -370,6 +388,7 @@ public:
     void handle_retrans_timer();
     void handle_install_timer();
     void handle_stats_timer();
+    void handle_aggregate_timer();
     gu::datetime::Date next_expiration(const Timer) const;
     void reset_timer(Timer);
     void cancel_timer(Timer);
@@ -418,6 +437,9 @@ private:
     gu::Stats     safe_deliv_latency_;
     long long int send_queue_s_;
     long long int n_send_queue_s_;
+    long long int user_dgs_sent_;   // datagrams carrying user messages
+    long long int user_msgs_sent_;  // user messages in the above
+    long long int delayed_msgs_;    // messages held for aggregation
     std::vector<long long int> sent_msgs_;
     long long int retrans_msgs_;
     long long int recovered_msgs_;
@@ -578,6 +600,14 @@ private:
     uint32_t max_output_size_;
     size_t mtu_;
     bool use_aggregate_;
+    // Maximum time to hold messages for aggregation
+    gu::datetime::Period aggregate_delay_;
+    // Time when held messages must be sent, zero if none are held
+    gu::datetime::Date aggregate_deadline_;
+    // Moving average of interval between user messages
+    gu::datetime::Period send_interval_;
+    gu::datetime::Date last_user_msg_tstamp_;
+    bool aggregate_timer_set_;
     bool self_loopback_;
     State state_;
     int shift_to_rfcnt_;
@@ -47,6 +47,19 @@ namespace gcomm
         static std::string const ProtonetBackend;
         static std::string const ProtonetVersion;
 
+        /*!
+         * @brief Number of socket I/O threads ("protonet.io_threads")
+         *
+         * If non-zero, plain TCP sockets of asio backend are read by
+         * this many dedicated threads which also verify checksums and
+         * split the stream into messages. Messages are handed over to the
+         * thread running the event loop, so protocol processing stays in
+         * one thread. SSL sockets are always read in the event loop
+         * thread. Zero means that everything is done in the event loop
+         * thread.
+         */
+        static std::string const ProtonetIoThreads;
+
         /*!
          * @brief TCP non-blocking flag ("socket.non_blocking")
          *
@@ -165,6 +178,30 @@ namespace gcomm
          */
         static std::string const GMCastSegment;
 
+        /*!
+         * @brief Fan-out of relay tree within segment
+         *        ("gmcast.segment_fanout")
+         *
+         * If non-zero, messages are forwarded to the nodes of the local
+         * segment along a tree rooted at the sending node, each node
+         * sending at most this many copies of a message. Zero means
+         * that the sender sends the message to each node directly.
+         * The tree is used only if all nodes of the segment announce
+         * relay tree support in handshake. A node which sees different
+         * set of segment nodes or fan-out than the tree root falls back
+         * to sending the message to each node directly.
+         */
+        static std::string const GMCastSegmentFanout;
+
+        /*!
+         * @brief Choose segment relay by RTT ("gmcast.segment_relay_rtt")
+         *
+         * If true, message to other segment is sent to the node with
+         * the lowest measured round trip time in that segment instead of
+         * spreading the relaying load evenly over the segment nodes.
+         */
+        static std::string const GMCastSegmentRelayRtt;
+
 
         /*!
          * @brief EVS scheme for transport URI ("evs")
@@ -301,6 +338,20 @@ namespace gcomm
          */
         static std::string const EvsUseAggregate;
 
+        /*!
+         * @brief EVS maximum aggregation delay ("evs.aggregate_delay")
+         *
+         * If non-zero and aggregation is enabled, user messages may be
+         * held back at most for this period in order to aggregate them
+         * with the following ones. The actual delay is adapted to
+         * observed send rate, messages are not held if no other
+         * messages are expected within this period. The period is
+         * scaled down by the part of user send window which is free,
+         * messages are not held if none are in flight.
+         * Default value is zero, messages are sent right away.
+         */
+        static std::string const EvsAggregateDelay;
+
         /*!
          * @brief Period to generate keepalives for causal messages
          *
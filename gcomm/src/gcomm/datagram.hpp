@@ -270,6 +270,14 @@ namespace gcomm
 
         size_t offset() const { return offset_; }
 
+        /*!
+         * @brief Drop reference to payload buffer
+         *
+         * Cheaper than assigning an empty datagram. Datagram must be
+         * assigned to before it is used again.
+         */
+        void release_payload() { payload_.reset(); }
+
     private:
 
         friend uint16_t crc16(const Datagram&, size_t);
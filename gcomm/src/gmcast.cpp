@@ -13,6 +13,7 @@
 #include "gu_convert.hpp"
 #include "gu_resolver.hpp"
 #include "gu_asio.hpp" // gu::conf::use_ssl
+#include "gu_hash.h" // gu_fast_hash32()
 
 using namespace std::rel_ops;
 
@@ -107,6 +108,15 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     relay_set_    (),
     segment_map_  (),
     self_index_   (std::numeric_limits<size_t>::max()),
+    segment_tree_ (),
+    segment_tree_view_(0),
+    segment_fanout_(check_range(Conf::GMCastSegmentFanout,
+                                param<size_t>(conf_, uri,
+                                              Conf::GMCastSegmentFanout,
+                                              Defaults::GMCastSegmentFanout),
+                                size_t(0), size_t(256))),
+    segment_relay_rtt_(param<bool>(conf_, uri, Conf::GMCastSegmentRelayRtt,
+                                   Defaults::GMCastSegmentRelayRtt)),
     time_wait_    (param<gu::datetime::Period>(
                        conf_, uri,
                        Conf::GMCastTimeWait, Defaults::GMCastTimeWait)),
@@ -224,6 +234,8 @@ gcomm::GMCast::GMCast(Protonet& net, const gu::URI& uri,
     conf_.set(Conf::GMCastMCastTTL, gu::to_string(mcast_ttl_));
     conf_.set(Conf::GMCastPeerTimeout, gu::to_string(peer_timeout_));
     conf_.set(Conf::GMCastSegment, gu::to_string<int>(segment_));
+    conf_.set(Conf::GMCastSegmentFanout, gu::to_string(segment_fanout_));
+    conf_.set(Conf::GMCastSegmentRelayRtt, gu::to_string(segment_relay_rtt_));
 }
 
 gcomm::GMCast::~GMCast()
@@ -864,6 +876,20 @@ void gcomm::GMCast::insert_address (const std::string& addr,
 }
 
 
+namespace
+{
+    // Orders segment relay tree entries by UUID
+    class SegmentTreeCmp
+    {
+    public:
+        template <class T>
+        bool operator()(const T& a, const T& b) const
+        {
+            return (a.first < b.first);
+        }
+    };
+}
+
 void gcomm::GMCast::update_addresses()
 {
     LinkMap link_map;
@@ -1026,6 +1052,47 @@ void gcomm::GMCast::update_addresses()
         }
     }
     log_debug << self_string() << " self index: " << self_index_;
+
+    segment_tree_.clear();
+    segment_tree_view_ = 0;
+    if (segment_fanout_ > 0 && !mcast_)
+    {
+        segment_tree_.push_back(std::make_pair(uuid(), RelayEntry(0, 0)));
+        for (Segment::const_iterator i(local_segment.begin());
+             i != local_segment.end(); ++i)
+        {
+            if (i->proto->tree_relay() == false)
+            {
+                // Peer would not forward F_TREE_RELAY messages, send
+                // to every segment node directly
+                log_debug << self_string() << " peer "
+                          << i->proto->remote_uuid()
+                          << " does not support relay tree";
+                segment_tree_.clear();
+                break;
+            }
+            segment_tree_.push_back(
+                std::make_pair(i->proto->remote_uuid(), *i));
+        }
+        std::sort(segment_tree_.begin(), segment_tree_.end(),
+                  SegmentTreeCmp());
+
+        // Tree is identified by fanout and member UUIDs, nodes which
+        // see different tree don't agree on children of each node
+        if (segment_tree_.empty() == false)
+        {
+            std::vector<gu::byte_t> buf(
+                4 + segment_tree_.size()*segment_tree_[0].first.serial_size());
+            size_t off(gu::serialize4(uint32_t(segment_fanout_),
+                                      &buf[0], buf.size(), 0));
+            for (SegmentTree::const_iterator i(segment_tree_.begin());
+                 i != segment_tree_.end(); ++i)
+            {
+                off = i->first.serialize(&buf[0], buf.size(), off);
+            }
+            segment_tree_view_ = gu_fast_hash32(&buf[0], off);
+        }
+    }
     log_debug << self_string() << " --- mcast tree end ---";
 }
 
@@ -1189,6 +1256,7 @@ void gcomm::GMCast::check_liveness()
         else if (p->state() == Proto::S_OK)
         {
             gcomm::SocketStats stats(p->socket()->stats());
+            p->update_rtt(stats.rtt);
             if (stats.send_queue_length >= 1024)
             {
                 log_debug << self_string()
@@ -1326,6 +1394,60 @@ void gcomm::GMCast::send(const RelayEntry& re, int segment, gcomm::Datagram& dg)
     }
 }
 
+bool gcomm::GMCast::send_tree(const UUID& root, Message& msg,
+                              gcomm::Datagram& dg)
+{
+    if (msg.tree_view() != segment_tree_view_)
+    {
+        return false;
+    }
+
+    const size_t n(segment_tree_.size());
+    size_t root_idx(n), self_idx(n);
+    for (size_t i(0); i < n; ++i)
+    {
+        if (segment_tree_[i].first == root) root_idx = i;
+        if (segment_tree_[i].first == uuid()) self_idx = i;
+    }
+    if (root_idx == n || self_idx == n)
+    {
+        return false;
+    }
+
+    // Nodes are numbered starting from root, node k has children
+    // k*fanout + 1 ... k*fanout + fanout
+    const size_t rank((self_idx + n - root_idx) % n);
+    gu_trace(push_header(msg, dg));
+    for (size_t c(rank*segment_fanout_ + 1);
+         c <= rank*segment_fanout_ + segment_fanout_ && c < n; ++c)
+    {
+        send(segment_tree_[(root_idx + c) % n].second, msg.segment_id(), dg);
+    }
+    gu_trace(pop_header(msg, dg));
+    return true;
+}
+
+size_t gcomm::GMCast::relay_index(const Segment& segment,
+                                  uint8_t segment_id) const
+{
+    size_t ret((self_index_ + segment_id) % segment.size());
+    if (segment_relay_rtt_ == true)
+    {
+        long min_rtt(std::numeric_limits<long>::max());
+        for (size_t i(0); i < segment.size(); ++i)
+        {
+            // RTT is not known before first liveness check
+            const long rtt(segment[i].proto->rtt());
+            if (rtt > 0 && rtt < min_rtt)
+            {
+                min_rtt = rtt;
+                ret = i;
+            }
+        }
+    }
+    return ret;
+}
+
 void gcomm::GMCast::relay(const Message& msg,
                           const Datagram& dg,
                           const void* exclude_id)
@@ -1384,6 +1506,14 @@ void gcomm::GMCast::relay(const Message& msg,
         }
 
         // Relay to local segment
+        if (segment_tree_.empty() == false && relay_set_.empty() == true)
+        {
+            relay_msg.set_flags(relay_msg.flags() | Message::F_TREE_RELAY);
+            relay_msg.set_relay_root(uuid());
+            relay_msg.set_tree_view(segment_tree_view_);
+            gu_trace(send_tree(uuid(), relay_msg, relay_dg));
+            return;
+        }
         gu_trace(push_header(relay_msg, relay_dg));
         Segment& segment(segment_map_[segment_]);
         for (Segment::iterator i(segment.begin()); i != segment.end(); ++i)
@@ -1391,6 +1521,29 @@ void gcomm::GMCast::relay(const Message& msg,
             send(*i, msg.segment_id(), relay_dg);
         }
     }
+    else if (msg.flags() & Message::F_TREE_RELAY)
+    {
+        relay_msg.set_flags(relay_msg.flags() | Message::F_TREE_RELAY);
+        bool sent(false);
+        gu_trace(sent = send_tree(msg.relay_root(), relay_msg, relay_dg));
+        if (sent == false)
+        {
+            // Root is not known by this node or this node sees different
+            // tree than the root, possibly due to connection changes.
+            // Fall back to sending to all peers in the segment,
+            // duplicates are discarded by upper layers.
+            relay_msg.set_flags(relay_msg.flags() & ~Message::F_TREE_RELAY);
+            gu_trace(push_header(relay_msg, relay_dg));
+            Segment& segment(segment_map_[segment_]);
+            for (Segment::iterator i(segment.begin()); i != segment.end(); ++i)
+            {
+                if ((*i).socket->id() != exclude_id)
+                {
+                    send(*i, msg.segment_id(), relay_dg);
+                }
+            }
+        }
+    }
     else
     {
         log_warn << "GMCast::relay() called without relay flags set";
@@ -1485,7 +1638,8 @@ void gcomm::GMCast::handle_up(const void*        id,
                     return;
                 }
                 if (msg.flags() &
-                    (Message::F_RELAY | Message::F_SEGMENT_RELAY))
+                    (Message::F_RELAY | Message::F_SEGMENT_RELAY |
+                     Message::F_TREE_RELAY))
                 {
                     relay(msg,
                           Datagram(dg, dg.offset() + msg.serial_size()),
@@ -1634,7 +1788,7 @@ int gcomm::GMCast::handle_down(Datagram& dg, const ProtoDownMeta& dm)
 
         if (segment_id != segment_)
         {
-            size_t target_idx((self_index_ + segment_id) % segment.size());
+            size_t target_idx(relay_index(segment, segment_id));
             msg.set_flags(msg.flags() | Message::F_SEGMENT_RELAY);
             // skip peers that are in relay set
             if (relay_set_.empty() == true ||
@@ -1645,6 +1799,14 @@ int gcomm::GMCast::handle_down(Datagram& dg, const ProtoDownMeta& dm)
                 gu_trace(pop_header(msg, dg));
             }
         }
+        else if (segment_tree_.empty() == false && relay_set_.empty() == true)
+        {
+            msg.set_flags((msg.flags() & ~Message::F_SEGMENT_RELAY) |
+                          Message::F_TREE_RELAY);
+            msg.set_tree_view(segment_tree_view_);
+            gu_trace(send_tree(uuid(), msg, dg));
+            msg.set_flags(msg.flags() & ~Message::F_TREE_RELAY);
+        }
         else
         {
             msg.set_flags(msg.flags() & ~Message::F_SEGMENT_RELAY);
@@ -1798,6 +1960,41 @@ std::string gcomm::GMCast::handle_get_address(const UUID& uuid) const
     return (ali == remote_addrs_.end() ? "" : AddrList::key(ali));
 }
 
+void gcomm::GMCast::handle_get_status(gu::Status& status) const
+{
+    // Network statistics for each established connection as
+    // uuid:addr:rtt:jitter:sent_msgs:sent_bytes:recv_msgs:recv_bytes:
+    // send_queue_length:send_queue_bytes, rtt and jitter in usecs
+    std::ostringstream os;
+    for (ProtoMap::const_iterator i(proto_map_->begin());
+         i != proto_map_->end(); ++i)
+    {
+        const Proto* p(ProtoMap::value(i));
+        if (p->state() != Proto::S_OK)
+        {
+            continue;
+        }
+        const SocketStats stats(p->socket()->stats());
+        if (os.tellp() > 0)
+        {
+            os << ",";
+        }
+        os << p->remote_uuid().full_str() << ":" << p->remote_addr()
+           << ":" << p->rtt() << ":" << p->jitter()
+           << ":" << stats.sent_msgs << ":" << stats.sent_bytes
+           << ":" << stats.recv_msgs << ":" << stats.recv_bytes
+           << ":" << stats.send_queue_length
+           << ":" << stats.send_queue_bytes;
+    }
+    status.insert("gmcast_peers", os.str());
+    if (mcast_)
+    {
+        // Multicast datagrams discarded by the socket
+        status.insert("gmcast_mcast_dropped",
+                      gu::to_string(mcast_->stats().dropped_msgs));
+    }
+}
+
 void gcomm::GMCast::add_or_del_addr(const std::string& val)
 {
     if (val.compare(0, 4, "add:") == 0)
@@ -45,6 +45,7 @@ namespace gcomm
         void handle_stable_view(const View& view);
         void handle_evict(const UUID& uuid);
         std::string handle_get_address(const UUID& uuid) const;
+        void handle_get_status(gu::Status& status) const;
         bool set_param(const std::string& key, const std::string& val,
                        Protolay::sync_param_cb_t& sync_param_cb);
         // Transport interface
@@ -215,6 +216,21 @@ namespace gcomm
         SegmentMap segment_map_;
         // self index in local segment when ordered by UUID
         size_t self_index_;
+        // Local segment nodes including self ordered by UUID, self
+        // is the entry with null proto. Empty if relay tree is not used.
+        typedef std::vector<std::pair<UUID, RelayEntry> > SegmentTree;
+        SegmentTree segment_tree_;
+        // Identifier of segment_tree_ carried in F_TREE_RELAY messages
+        uint32_t    segment_tree_view_;
+        size_t      segment_fanout_;
+        bool        segment_relay_rtt_;
+        // Send to children of this node in the local segment relay tree
+        // rooted at root. Returns false if root or self is not in tree
+        // or the tree view of the message does not match.
+        bool send_tree(const UUID& root, gmcast::Message& msg,
+                       gcomm::Datagram& dg);
+        // Index of the node in remote segment to relay messages
+        size_t relay_index(const Segment& segment, uint8_t segment_id) const;
         gu::datetime::Period time_wait_;
         gu::datetime::Period check_period_;
         gu::datetime::Period peer_timeout_;
@@ -33,7 +33,12 @@ public:
         // and to all other segments except source segment
         F_RELAY                   = 1 << 5,
         // relay message to all peers in the same segment
-        F_SEGMENT_RELAY           = 1 << 6
+        F_SEGMENT_RELAY           = 1 << 6,
+        // relay message to children in the segment relay tree,
+        // see relay_root() and tree_view(). In handshake and handshake
+        // response messages tells that the sender is able to forward
+        // messages along the segment relay tree.
+        F_TREE_RELAY              = 1 << 7
     };
 
     enum Type
@@ -62,6 +67,7 @@ private:
     gcomm::UUID       source_uuid_;
     gcomm::String<64> node_address_or_error_;
     gcomm::String<32> group_name_;
+    uint32_t          tree_view_;
 
 
     Message& operator=(const Message&);
@@ -99,6 +105,7 @@ public:
         source_uuid_           (msg.source_uuid_),
         node_address_or_error_ (msg.node_address_or_error_),
         group_name_            (msg.group_name_),
+        tree_view_             (msg.tree_view_),
         node_list_             (msg.node_list_)
     { }
 
@@ -113,6 +120,7 @@ public:
         source_uuid_           (),
         node_address_or_error_ (),
         group_name_            (),
+        tree_view_             (0),
         node_list_             ()
     {}
 
@@ -131,6 +139,7 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (),
+        tree_view_             (0),
         node_list_             ()
     {
         if (type_ != GMCAST_T_HANDSHAKE)
@@ -153,6 +162,7 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (error),
         group_name_            (),
+        tree_view_             (0),
         node_list_             ()
     {
         if (type_ != GMCAST_T_OK &&
@@ -180,6 +190,7 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (),
+        tree_view_             (0),
         node_list_             ()
     {
         if (type_ < GMCAST_T_USER_BASE)
@@ -205,6 +216,7 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (node_address),
         group_name_            (group_name),
+        tree_view_             (0),
         node_list_             ()
     {
         if (type_ != GMCAST_T_HANDSHAKE_RESPONSE)
@@ -227,6 +239,7 @@ public:
         source_uuid_           (source_uuid),
         node_address_or_error_ (),
         group_name_            (group_name),
+        tree_view_             (0),
         node_list_             (nodes)
     {
         if (type_ != GMCAST_T_TOPOLOGY_CHANGE)
@@ -237,6 +250,13 @@ public:
     ~Message() { }
 
 
+    // Tree view is carried only in user messages, F_TREE_RELAY in
+    // handshake messages is a capability flag
+    bool has_tree_view() const
+    {
+        return ((flags_ & F_TREE_RELAY) && type_ >= GMCAST_T_USER_BASE);
+    }
+
     size_t serialize(gu::byte_t* buf, const size_t buflen,
                      const size_t offset) const
     {
@@ -267,6 +287,11 @@ public:
         {
             gu_trace(off = node_list_.serialize(buf, buflen, off));
         }
+
+        if (has_tree_view())
+        {
+            gu_trace(off = gu::serialize4(tree_view_, buf, buflen, off));
+        }
         return off;
     }
 
@@ -315,6 +340,11 @@ public:
             gu_trace(off = node_list_.unserialize(buf, buflen, off));
         }
 
+        if (has_tree_view())
+        {
+            gu_trace(off = gu::unserialize4(buf, buflen, off, tree_view_));
+        }
+
         return off;
     }
 
@@ -343,7 +373,9 @@ public:
             /* Group name if set */
             + (flags_ & F_GROUP_NAME ? group_name_.serial_size() : 0)
             /* Node list if set */
-            + (flags_ & F_NODE_LIST ? node_list_.serial_size() : 0);
+            + (flags_ & F_NODE_LIST ? node_list_.serial_size() : 0)
+            /* Relay tree view if set */
+            + (has_tree_view() ? sizeof(tree_view_) : 0);
     }
 
     int version() const { return version_; }
@@ -358,6 +390,29 @@ public:
 
     const UUID&     source_uuid()  const { return source_uuid_;  }
 
+    /*
+     * Root of the relay tree for F_TREE_RELAY message. Root is the source
+     * of the message unless the message was relayed from other segment,
+     * in which case the root UUID is carried in handshake UUID field.
+     */
+    const UUID& relay_root() const
+    {
+        return (flags_ & F_HANDSHAKE_UUID ? handshake_uuid_ : source_uuid_);
+    }
+    void set_relay_root(const UUID& root)
+    {
+        handshake_uuid_ = root;
+        flags_ |= F_HANDSHAKE_UUID;
+    }
+
+    /*
+     * Identifier of the segment relay tree seen by the tree root. Nodes
+     * forward F_TREE_RELAY message along the tree only if their own tree
+     * has the same identifier, so that all nodes compute the same children.
+     */
+    uint32_t tree_view() const { return tree_view_; }
+    void set_tree_view(uint32_t view) { tree_view_ = view; }
+
     const std::string&   node_address() const { return node_address_or_error_.to_string(); }
     const std::string&   error() const { return node_address_or_error_.to_string(); }
 
@@ -33,7 +33,8 @@ std::ostream& gcomm::gmcast::operator<<(std::ostream& os, const Proto& p)
        << "pr=" << p.propagate_remote_ << ","
        << "tp=" << p.tp_ << ","
        << "rts=" << p.recv_tstamp_ << ","
-       << "sts=" << p.send_tstamp_;
+       << "sts=" << p.send_tstamp_ << ","
+       << "tr=" << p.tree_relay_;
     return os;
 }
 
@@ -93,6 +94,10 @@ void gcomm::gmcast::Proto::send_handshake()
     handshake_uuid_ = UUID(0, 0);
     Message hs (version_, Message::GMCAST_T_HANDSHAKE, handshake_uuid_,
                 gmcast_.uuid(), local_segment_);
+    if (gmcast_.segment_fanout_ > 0)
+    {
+        hs.set_flags(hs.flags() | Message::F_TREE_RELAY);
+    }
 
     send_msg(hs, false);
 
@@ -180,6 +185,7 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
     handshake_uuid_ = hs.handshake_uuid();
     remote_uuid_ = hs.source_uuid();
     remote_segment_ = hs.segment_id();
+    tree_relay_ = ((hs.flags() & Message::F_TREE_RELAY) != 0);
 
     if (validate_handshake_uuid() == false)
     {
@@ -193,6 +199,10 @@ void gcomm::gmcast::Proto::handle_handshake(const Message& hs)
                  local_addr_,
                  group_name_,
                  local_segment_);
+    if (gmcast_.segment_fanout_ > 0)
+    {
+        hsr.set_flags(hsr.flags() | Message::F_TREE_RELAY);
+    }
     send_msg(hsr, false);
 
     set_state(S_HANDSHAKE_RESPONSE_SENT);
@@ -220,6 +230,7 @@ void gcomm::gmcast::Proto::handle_handshake_response(const Message& hs)
         }
         remote_uuid_ = hs.source_uuid();
         remote_segment_ = hs.segment_id();
+        tree_relay_ = ((hs.flags() & Message::F_TREE_RELAY) != 0);
         gu::URI remote_uri(tp_->remote_addr());
         remote_addr_ = uri_string(remote_uri.get_scheme(),
                                   remote_uri.get_host(),
@@ -102,6 +102,9 @@ public:
         link_map_         (),
         send_tstamp_      (gu::datetime::Date::monotonic()),
         recv_tstamp_      (gu::datetime::Date::monotonic()),
+        rtt_              (0),
+        jitter_           (0),
+        tree_relay_       (false),
         gmcast_           (gmcast)
     { }
 
@@ -167,6 +170,31 @@ public:
     gu::datetime::Date recv_tstamp() const { return recv_tstamp_; }
     void set_send_tstamp(gu::datetime::Date ts) { send_tstamp_ = ts; }
     gu::datetime::Date send_tstamp() const { return send_tstamp_; }
+    /**
+     * Update round trip time estimate with new sample. Jitter is
+     * computed from the variation between consecutive samples as
+     * in RFC 3550. The estimate is kept scaled by 16 so that
+     * variations smaller than 16 usecs are not lost to integer
+     * division (RFC 3550 appendix A.8).
+     *
+     * @param rtt Round trip time sample in microseconds
+     */
+    void update_rtt(long rtt)
+    {
+        if (rtt_ != 0)
+        {
+            const long d(rtt > rtt_ ? rtt - rtt_ : rtt_ - rtt);
+            jitter_ += d - ((jitter_ + 8) >> 4);
+        }
+        rtt_ = rtt;
+    }
+    long rtt() const { return rtt_; }
+    long jitter() const { return (jitter_ >> 4); }
+    /**
+     * Return true if the remote endpoint announced in handshake that
+     * it forwards messages along the segment relay tree.
+     */
+    bool tree_relay() const { return tree_relay_; }
 private:
     friend std::ostream& operator<<(std::ostream&, const Proto&);
     Proto(const Proto&);
@@ -188,6 +216,9 @@ private:
     LinkMap           link_map_;
     gu::datetime::Date send_tstamp_;
     gu::datetime::Date recv_tstamp_;
+    long              rtt_;    // usecs
+    long              jitter_; // usecs, scaled by 16
+    bool              tree_relay_;
     GMCast&     gmcast_;
 };
 
@@ -40,7 +40,14 @@ int gcomm::PC::handle_down(Datagram& wb, const ProtoDownMeta& dm)
     {
         gu_throw_error(EMSGSIZE);
     }
-    return send_down(wb, dm);
+    const int ret(send_down(wb, dm));
+    // Message was held for aggregation, event loop may be waiting for
+    // some later timer and must pick up the new one
+    if (evs_->aggregate_timer_set() == true)
+    {
+        pnet().interrupt();
+    }
+    return ret;
 }
 
 
@@ -8,6 +8,10 @@
 #include "asio_protonet.hpp"
 #endif // HAVE_ASIO_HPP
 
+#ifdef HAVE_IO_URING
+#include "uring_protonet.hpp"
+#endif // HAVE_IO_URING
+
 #include "gcomm/util.hpp"
 #include "gcomm/conf.hpp"
 
@@ -73,6 +77,10 @@ gcomm::Protonet* gcomm::Protonet::create(gu::Config& conf)
 
     if (backend == "asio")
         return new AsioProtonet(conf, version);
+#ifdef HAVE_IO_URING
+    if (backend == "io_uring")
+        return new UringProtonet(conf, version);
+#endif // HAVE_IO_URING
 
     gu_throw_fatal << Conf::ProtonetBackend << " '" << backend
                    << "' not supported"; throw;
@@ -42,6 +42,11 @@ namespace gcomm
         long last_delivered_since; /** Last delivered since in msecs        */
         long send_queue_length;    /** Number of messaged pending for send. */
         long send_queue_bytes;     /** Number of bytes in send queue.       */
+        long sent_msgs;            /** Messages queued for send.            */
+        long sent_bytes;           /** Bytes queued for send.               */
+        long recv_msgs;            /** Messages received.                   */
+        long recv_bytes;           /** Bytes received.                      */
+        long dropped_msgs;         /** Messages dropped without sending.    */
         std::vector<std::pair<int, size_t> > send_queue_segments;
         socket_stats_st() : rtt(), rttvar(), rto(), lost(), last_data_recv(),
                             cwnd(),
@@ -49,6 +54,11 @@ namespace gcomm
                             last_delivered_since(),
                             send_queue_length(),
                             send_queue_bytes(),
+                            sent_msgs(),
+                            sent_bytes(),
+                            recv_msgs(),
+                            recv_bytes(),
+                            dropped_msgs(),
                             send_queue_segments()
         { }
     } SocketStats;
@@ -65,7 +75,12 @@ namespace gcomm
            << " last_queued_since: " << stats.last_queued_since
            << " last_delivered_since: " << stats.last_delivered_since
            << " send_queue_length: " << stats.send_queue_length
-           << " send_queue_bytes: " << stats.send_queue_bytes;
+           << " send_queue_bytes: " << stats.send_queue_bytes
+           << " sent_msgs: " << stats.sent_msgs
+           << " sent_bytes: " << stats.sent_bytes
+           << " recv_msgs: " << stats.recv_msgs
+           << " recv_bytes: " << stats.recv_bytes
+           << " dropped_msgs: " << stats.dropped_msgs;
         for (std::vector<std::pair<int, size_t> >::const_iterator i(stats.send_queue_segments.begin()); i != stats.send_queue_segments.end(); ++i)
         {
             os << " segment: " << i->first << " messages: " << i->second;
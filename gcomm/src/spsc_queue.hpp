@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2026 Codership Oy <info@codership.com>
+//
+
+/**
+ * Bounded lock-free queue for passing objects from one producer thread
+ * to one consumer thread.
+ *
+ * Producer and consumer each own one of the ring indices, the other
+ * side only reads it. Popped slots are reset to default value so that
+ * resources held by the objects are released by the consumer.
+ */
+
+#ifndef GCOMM_SPSC_QUEUE_HPP
+#define GCOMM_SPSC_QUEUE_HPP
+
+#include "gu_atomic.hpp"
+
+#include <vector>
+#include <cstddef>
+
+namespace gcomm
+{
+    template <typename T>
+    class SpscQueue
+    {
+    public:
+        /* Capacity is rounded up to the next power of two. */
+        explicit SpscQueue(size_t capacity)
+            : ring_(round_up(capacity))
+            , mask_(ring_.size() - 1)
+            , head_(0)
+            , tail_(0)
+        { }
+
+        /* Push back copy of t, called by producer only. Returns false
+         * if the queue is full. */
+        bool push(const T& t)
+        {
+            size_t const tail(tail_());
+            if (tail - head_() == ring_.size()) return false;
+            ring_[tail & mask_] = t;
+            tail_ = tail + 1;
+            return true;
+        }
+
+        /* Pop front into t, called by consumer only. Returns false
+         * if the queue is empty. */
+        bool pop(T& t)
+        {
+            size_t const head(head_());
+            if (head == tail_()) return false;
+            T& slot(ring_[head & mask_]);
+            t = slot;
+            slot = T();
+            head_ = head + 1;
+            return true;
+        }
+
+        /* Exact only when called by producer or consumer, otherwise
+         * an estimate. */
+        size_t size() const { return tail_() - head_(); }
+        bool empty() const { return (size() == 0); }
+        size_t capacity() const { return ring_.size(); }
+
+    private:
+        SpscQueue(const SpscQueue&);
+        void operator=(const SpscQueue&);
+
+        static size_t round_up(size_t n)
+        {
+            size_t ret(1);
+            while (ret < n) ret <<= 1;
+            return ret;
+        }
+
+        std::vector<T>     ring_;
+        size_t const       mask_;
+        gu::Atomic<size_t> head_; // next slot to pop, written by consumer
+        gu::Atomic<size_t> tail_; // next slot to push, written by producer
+    };
+}
+
+#endif // GCOMM_SPSC_QUEUE_HPP
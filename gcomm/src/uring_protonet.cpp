@@ -0,0 +1,568 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include "uring_protonet.hpp"
+#include "uring_tcp.hpp"
+
+#include "gcomm/util.hpp"
+#include "gcomm/conf.hpp"
+
+#include "gu_logger.hpp"
+#include "gu_asio.hpp" // gu::conf::use_ssl
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <string.h>
+
+// Number of submission queue entries. Completion queue is made larger
+// to absorb bursts of completions between reaps.
+static const unsigned uring_entries(256);
+static const unsigned uring_cq_entries(4 * uring_entries);
+
+static int uring_setup(unsigned entries, struct io_uring_params* p)
+{
+    return ::syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                       unsigned flags, const void* arg, size_t arg_size)
+{
+    return ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                     flags, arg, arg_size);
+}
+
+#ifdef IORING_RECV_MULTISHOT
+static int uring_register(int fd, unsigned opcode, const void* arg,
+                          unsigned nr_args)
+{
+    return ::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+#endif /* IORING_RECV_MULTISHOT */
+
+gcomm::UringProtonet::UringProtonet(gu::Config& conf, int version)
+    :
+    gcomm::Protonet(conf, "io_uring", version),
+    mutex_        (),
+    ring_fd_      (-1),
+    sq_ring_      (MAP_FAILED),
+    sq_ring_size_ (0),
+    cq_ring_      (MAP_FAILED),
+    cq_ring_size_ (0),
+    sqes_         (0),
+    sq_entries_   (0),
+    sq_khead_     (0),
+    sq_ktail_     (0),
+    sq_mask_      (0),
+    sq_array_     (0),
+    cq_khead_     (0),
+    cq_ktail_     (0),
+    cq_mask_      (0),
+    cqes_         (0),
+    sq_tail_      (0),
+    unsubmitted_  (0),
+    pending_      (0),
+    in_loop_      (false),
+    interrupted_  (false),
+    wakeup_fd_    (-1),
+    wakeup_val_   (0),
+    wakeup_op_    (new UringHandler<UringProtonet>(
+                       *this, &UringProtonet::wakeup_handler)),
+    recv_buf_ring_(0),
+    recv_buf_ring_size_(0),
+    recv_bufs_    (0),
+    recv_buf_tail_(0),
+    multishot_recv_(false),
+    poll_until_   (gu::datetime::Date::max()),
+    next_timer_   (gu::datetime::Date::zero()),
+    mtu_          (1 << 15),
+    checksum_     (NetHeader::checksum_type(
+                       conf.get<int>(gcomm::Conf::SocketChecksum,
+                                     NetHeader::CS_CRC32C)))
+{
+    conf.set(gcomm::Conf::SocketChecksum, checksum_);
+
+    bool use_ssl(conf_.is_set(gu::conf::ssl_key)  == true ||
+                 conf_.is_set(gu::conf::ssl_cert) == true);
+    try
+    {
+        use_ssl = conf_.get<bool>(gu::conf::use_ssl);
+    }
+    catch (gu::NotSet& nf) {}
+
+    if (use_ssl == true)
+    {
+        delete wakeup_op_;
+        gu_throw_error(EINVAL) << "SSL is not supported by "
+                               << "io_uring protonet backend";
+    }
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags      = IORING_SETUP_CQSIZE;
+    p.cq_entries = uring_cq_entries;
+
+    try
+    {
+        if ((ring_fd_ = uring_setup(uring_entries, &p)) < 0)
+        {
+            gu_throw_error(errno) << "io_uring_setup() failed";
+        }
+
+        // Timed waits need IORING_ENTER_EXT_ARG, not losing completions
+        // under load needs IORING_FEAT_NODROP
+        if ((p.features & IORING_FEAT_EXT_ARG) == 0 ||
+            (p.features & IORING_FEAT_NODROP)  == 0)
+        {
+            gu_throw_error(ENOSYS) << "io_uring features " << p.features
+                                   << " not sufficient, kernel 5.11 or "
+                                   << "newer is required";
+        }
+
+        sq_ring_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = p.cq_off.cqes +
+            p.cq_entries * sizeof(struct io_uring_cqe);
+
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            sq_ring_size_ = cq_ring_size_ =
+                std::max(sq_ring_size_, cq_ring_size_);
+        }
+
+        sq_ring_ = mmap(0, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_,
+                        IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED)
+        {
+            gu_throw_error(errno) << "failed to map io_uring SQ ring";
+        }
+
+        if (p.features & IORING_FEAT_SINGLE_MMAP)
+        {
+            cq_ring_ = sq_ring_;
+        }
+        else
+        {
+            cq_ring_ = mmap(0, cq_ring_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd_,
+                            IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED)
+            {
+                gu_throw_error(errno) << "failed to map io_uring CQ ring";
+            }
+        }
+
+        void* const sqes(mmap(0, p.sq_entries * sizeof(struct io_uring_sqe),
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE, ring_fd_,
+                              IORING_OFF_SQES));
+        if (sqes == MAP_FAILED)
+        {
+            gu_throw_error(errno) << "failed to map io_uring SQEs";
+        }
+        sqes_ = static_cast<struct io_uring_sqe*>(sqes);
+
+        char* const sq(static_cast<char*>(sq_ring_));
+        char* const cq(static_cast<char*>(cq_ring_));
+
+        sq_entries_ = p.sq_entries;
+        sq_khead_   = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_ktail_   = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_    = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_   = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_khead_   = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_ktail_   = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_    = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_       = reinterpret_cast<struct io_uring_cqe*>(
+            cq + p.cq_off.cqes);
+        sq_tail_    = *sq_ktail_;
+
+        if ((wakeup_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0)
+        {
+            gu_throw_error(errno) << "failed to create eventfd";
+        }
+    }
+    catch (...)
+    {
+        if (wakeup_fd_ >= 0) ::close(wakeup_fd_);
+        if (sqes_) munmap(sqes_, sq_entries_ * sizeof(struct io_uring_sqe));
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+            munmap(cq_ring_, cq_ring_size_);
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+        delete wakeup_op_;
+        throw;
+    }
+
+    setup_recv_bufs();
+
+    Critical<UringProtonet> crit(*this);
+    arm_wakeup();
+    flush();
+}
+
+gcomm::UringProtonet::~UringProtonet()
+{
+    // Operations in flight refer to handler objects (and keep sockets
+    // alive), so cancel them and run the handlers before unmapping
+    // the ring.
+    {
+        Critical<UringProtonet> crit(*this);
+        struct io_uring_sqe* sqe;
+#ifdef IORING_ASYNC_CANCEL_ANY
+        sqe = get_sqe(0);
+        sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+        sqe->fd           = -1;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_ANY;
+#endif /* IORING_ASYNC_CANCEL_ANY */
+        // IORING_ASYNC_CANCEL_ANY is not known to kernels before 5.19
+        // (nor to their headers), wakeup read must be cancelled explicitly
+        // there. Socket operations have been completed by closing
+        // the sockets.
+        sqe = get_sqe(0);
+        sqe->opcode       = IORING_OP_ASYNC_CANCEL;
+        sqe->fd           = -1;
+        sqe->addr         = reinterpret_cast<uintptr_t>(wakeup_op_);
+        commit();
+        flush();
+    }
+
+    const gu::datetime::Date until(gu::datetime::Date::monotonic() +
+                                   gu::datetime::Sec);
+    while (pending_ > 0 && gu::datetime::Date::monotonic() < until)
+    {
+        wait(gu::datetime::Sec/10);
+        Critical<UringProtonet> crit(*this);
+        reap();
+    }
+
+    if (pending_ > 0)
+    {
+        log_warn << "io_uring protonet destroyed with " << pending_
+                 << " operations in flight";
+    }
+    else
+    {
+        delete wakeup_op_;
+    }
+
+    ::close(wakeup_fd_);
+    munmap(sqes_, sq_entries_ * sizeof(struct io_uring_sqe));
+    if (cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+    munmap(sq_ring_, sq_ring_size_);
+    ::close(ring_fd_);
+    // buffer ring is unregistered when the ring is closed
+    if (recv_buf_ring_) munmap(recv_buf_ring_, recv_buf_ring_size_);
+}
+
+void gcomm::UringProtonet::enter()
+{
+    mutex_.lock();
+}
+
+void gcomm::UringProtonet::leave()
+{
+    mutex_.unlock();
+}
+
+gcomm::SocketPtr gcomm::UringProtonet::socket(const gu::URI& uri)
+{
+    if (uri.get_scheme() == gu::scheme::tcp)
+    {
+        return gu::shared_ptr<UringTcpSocket>::type(
+            new UringTcpSocket(*this, uri));
+    }
+    else
+    {
+        gu_throw_fatal << "scheme '" << uri.get_scheme()
+                       << "' not implemented by io_uring protonet backend";
+    }
+}
+
+gcomm::Acceptor* gcomm::UringProtonet::acceptor(const gu::URI& uri)
+{
+    if (uri.get_scheme() != gu::scheme::tcp)
+    {
+        gu_throw_fatal << "scheme '" << uri.get_scheme()
+                       << "' not implemented by io_uring protonet backend";
+    }
+    return new UringTcpAcceptor(*this, uri);
+}
+
+struct io_uring_sqe* gcomm::UringProtonet::get_sqe(Op* const op)
+{
+    if (sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >= sq_entries_)
+    {
+        // submission queue is full, make room
+        commit();
+        flush();
+        if (sq_tail_ - __atomic_load_n(sq_khead_, __ATOMIC_ACQUIRE) >=
+            sq_entries_)
+        {
+            gu_throw_error(EBUSY) << "io_uring submission queue is full";
+        }
+    }
+
+    unsigned const idx(sq_tail_ & sq_mask_);
+    struct io_uring_sqe* const sqe(&sqes_[idx]);
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->user_data = reinterpret_cast<uintptr_t>(op);
+    sq_array_[idx] = idx;
+    ++sq_tail_;
+    if (op != 0) ++pending_;
+    return sqe;
+}
+
+void gcomm::UringProtonet::commit()
+{
+    unsigned const ktail(*sq_ktail_);
+    if (ktail == sq_tail_) return;
+
+    unsubmitted_ += sq_tail_ - ktail;
+    __atomic_store_n(sq_ktail_, sq_tail_, __ATOMIC_RELEASE);
+
+    // Event loop thread submits the entries when it has finished calling
+    // handlers, otherwise it may be blocked waiting for completions.
+    if (in_loop_ == false) flush();
+}
+
+void gcomm::UringProtonet::flush()
+{
+    while (unsubmitted_ > 0)
+    {
+        int const ret(uring_enter(ring_fd_, unsubmitted_, 0, 0, 0, 0));
+        if (ret < 0)
+        {
+            if (errno == EINTR) continue;
+            gu_throw_error(errno) << "io_uring_enter() failed";
+        }
+        unsubmitted_ -= std::min<unsigned>(ret, unsubmitted_);
+    }
+}
+
+void gcomm::UringProtonet::wait(const gu::datetime::Period& p)
+{
+    unsigned to_submit;
+    {
+        Critical<UringProtonet> crit(*this);
+        to_submit = unsubmitted_;
+        unsubmitted_ = 0;
+    }
+
+    struct __kernel_timespec ts;
+    ts.tv_sec  = p.get_nsecs() / gu::datetime::Sec;
+    ts.tv_nsec = p.get_nsecs() % gu::datetime::Sec;
+
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = reinterpret_cast<uintptr_t>(&ts);
+
+    int const ret(uring_enter(ring_fd_, to_submit, 1,
+                              IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                              &arg, sizeof(arg)));
+    int const err(errno);
+
+    if (ret < 0 || unsigned(ret) < to_submit)
+    {
+        // entries not consumed by the kernel are submitted next time
+        Critical<UringProtonet> crit(*this);
+        unsubmitted_ += to_submit - (ret < 0 ? 0 : ret);
+    }
+
+    if (ret < 0 && err != ETIME && err != EINTR && err != EBUSY)
+    {
+        gu_throw_error(err) << "io_uring_enter() failed";
+    }
+}
+
+void gcomm::UringProtonet::reap()
+{
+    // Submissions made by handlers are deferred until the next wait()
+    // so that they all go with a single system call.
+    in_loop_ = true;
+    try
+    {
+        unsigned head(*cq_khead_);
+        while (head != __atomic_load_n(cq_ktail_, __ATOMIC_ACQUIRE))
+        {
+            const struct io_uring_cqe& cqe(cqes_[head & cq_mask_]);
+            Op* const op(reinterpret_cast<Op*>(cqe.user_data));
+            int const res(cqe.res);
+            uint32_t const flags(cqe.flags);
+            __atomic_store_n(cq_khead_, ++head, __ATOMIC_RELEASE);
+
+            if (op != 0)
+            {
+                if (more(flags) == false) --pending_;
+                op->complete(res, flags);
+            }
+        }
+    }
+    catch (...)
+    {
+        commit();
+        in_loop_ = false;
+        throw;
+    }
+    // publish only, submitted by the following wait()
+    commit();
+    in_loop_ = false;
+}
+
+bool gcomm::UringProtonet::more(uint32_t const flags)
+{
+#ifdef IORING_CQE_F_MORE
+    return (flags & IORING_CQE_F_MORE);
+#else
+    return false;
+#endif /* IORING_CQE_F_MORE */
+}
+
+void gcomm::UringProtonet::setup_recv_bufs()
+{
+#ifdef IORING_RECV_MULTISHOT
+    // ring entries are followed by buffers in the same mapping
+    size_t const ring_size(recv_buf_count * sizeof(struct io_uring_buf));
+    recv_buf_ring_size_ = ring_size + recv_buf_count * recv_buf_size;
+
+    void* const mem(mmap(0, recv_buf_ring_size_, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (mem == MAP_FAILED)
+    {
+        gu_throw_error(errno) << "failed to allocate io_uring receive buffers";
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = reinterpret_cast<uintptr_t>(mem);
+    reg.ring_entries = recv_buf_count;
+    reg.bgid         = recv_buf_group;
+
+    if (uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        log_info << "io_uring provided buffer ring not supported ("
+                 << ::strerror(errno) << "), using single-shot receive";
+        munmap(mem, recv_buf_ring_size_);
+        recv_buf_ring_size_ = 0;
+        return;
+    }
+
+    recv_buf_ring_ = static_cast<struct io_uring_buf_ring*>(mem);
+    recv_bufs_     = static_cast<gu::byte_t*>(mem) + ring_size;
+    for (unsigned bid(0); bid < recv_buf_count; ++bid)
+    {
+        recycle_recv_buf(bid);
+    }
+    multishot_recv_ = true;
+#else
+    log_info << "io_uring multishot receive not supported by kernel "
+             << "headers, using single-shot receive";
+#endif /* IORING_RECV_MULTISHOT */
+}
+
+void gcomm::UringProtonet::disable_multishot_recv()
+{
+    if (multishot_recv_ == false) return;
+
+    log_info << "io_uring multishot receive not supported by kernel, "
+             << "using single-shot receive";
+    multishot_recv_ = false;
+}
+
+void gcomm::UringProtonet::recycle_recv_buf(unsigned const bid)
+{
+#ifdef IORING_RECV_MULTISHOT
+    assert(recv_buf_ring_ != 0);
+    assert(bid < recv_buf_count);
+
+    // Entries are addressed from the start of the ring, the bufs member
+    // does not start at offset zero when the header is compiled as C++.
+    struct io_uring_buf& buf(
+        reinterpret_cast<struct io_uring_buf*>(recv_buf_ring_)
+        [recv_buf_tail_ & (recv_buf_count - 1)]);
+    buf.addr = reinterpret_cast<uintptr_t>(recv_buf(bid));
+    buf.len  = recv_buf_size;
+    buf.bid  = bid;
+    ++recv_buf_tail_;
+    __atomic_store_n(&recv_buf_ring_->tail, recv_buf_tail_, __ATOMIC_RELEASE);
+#endif /* IORING_RECV_MULTISHOT */
+}
+
+void gcomm::UringProtonet::arm_wakeup()
+{
+    struct io_uring_sqe* const sqe(get_sqe(wakeup_op_));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd     = wakeup_fd_;
+    sqe->addr   = reinterpret_cast<uintptr_t>(&wakeup_val_);
+    sqe->len    = sizeof(wakeup_val_);
+    commit();
+}
+
+void gcomm::UringProtonet::wakeup_handler(int res)
+{
+    if (res == -ECANCELED) return; // destructor
+
+    interrupted_ = true;
+    arm_wakeup();
+}
+
+gu::datetime::Period handle_timers_helper(gcomm::Protonet&            pnet,
+                                          const gu::datetime::Period& period);
+
+void gcomm::UringProtonet::event_loop(const gu::datetime::Period& period)
+{
+    interrupted_ = false;
+    gu::datetime::Date now(gu::datetime::Date::monotonic());
+    poll_until_ = now + period;
+    next_timer_ = now;
+
+    using std::rel_ops::operator>=;
+    while (true)
+    {
+        // Timers are handled only when due, like asio deadline timer
+        // in AsioProtonet does
+        if (now >= next_timer_)
+        {
+            next_timer_ = now + handle_timers_helper(*this, poll_until_ - now);
+        }
+
+        if (interrupted_ == true || poll_until_ < now) break;
+
+        wait(std::min(next_timer_, poll_until_) - now);
+
+        {
+            Critical<UringProtonet> crit(*this);
+            reap();
+        }
+
+        now = gu::datetime::Date::monotonic();
+    }
+}
+
+void gcomm::UringProtonet::dispatch(const SocketId& id,
+                                    const Datagram& dg,
+                                    const ProtoUpMeta& um)
+{
+    for (std::deque<Protostack*>::iterator i = protos_.begin();
+         i != protos_.end(); ++i)
+    {
+        (*i)->dispatch(id, dg, um);
+    }
+}
+
+void gcomm::UringProtonet::interrupt()
+{
+    uint64_t const one(1);
+    if (::write(wakeup_fd_, &one, sizeof(one)) < 0)
+    {
+        // EAGAIN means that wakeup is already pending
+        if (errno != EAGAIN)
+        {
+            gu_throw_error(errno) << "failed to interrupt event loop";
+        }
+    }
+}
+
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+//!
+// @file uring_protonet.hpp
+//
+// Protonet implementation on top of Linux io_uring. Socket operations are
+// queued into the submission ring while handlers run and all of them are
+// submitted with the same system call which waits for the next completions.
+//
+// The ring is driven by raw system calls, liburing is not required.
+//
+// Sockets receive with multishot recv from a ring of buffers provided to
+// the kernel, so a receive stays armed for the lifetime of a connection.
+// Kernels without multishot recv (before 6.0) get a single-shot recv per
+// read into the socket stream buffer instead.
+//
+// Registered (fixed) buffers are not used. TCP send and receive copy
+// between user memory and socket buffers anyway, and fixed buffers would
+// only save page pinning which plain SEND/RECV do not do. Multishot recv
+// needs provided buffers and cannot read into fixed ones. WRITE_FIXED has
+// no gather, so queued datagrams would have to be copied into the fixed
+// buffer first.
+//
+
+#ifndef GCOMM_URING_PROTONET_HPP
+#define GCOMM_URING_PROTONET_HPP
+
+#include "gcomm/protonet.hpp"
+#include "socket.hpp"
+
+#include "gu_mutex.hpp"
+#include "gu_shared_ptr.hpp"
+
+#include <stdint.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace gcomm
+{
+    class UringProtonet;
+    template <class T> class UringHandler;
+}
+
+class gcomm::UringProtonet : public gcomm::Protonet
+{
+public:
+
+    //!
+    // Completion handler of an operation submitted to the ring. The
+    // object must stay valid until the operation completes.
+    //
+    class Op
+    {
+    public:
+        virtual ~Op() { }
+        // @param res   operation result, negative errno in case of failure
+        // @param flags completion flags (IORING_CQE_F_*)
+        virtual void complete(int res, uint32_t flags) = 0;
+    };
+
+    // Returns true if completion flags say that the operation stays
+    // armed and more completions will follow (multishot)
+    static bool more(uint32_t flags);
+
+    UringProtonet(gu::Config& conf, int version = 0);
+    ~UringProtonet();
+    void event_loop(const gu::datetime::Period& p);
+    void dispatch(const SocketId&,
+                  const Datagram&,
+                  const ProtoUpMeta&);
+    void interrupt();
+    SocketPtr socket(const gu::URI&);
+    gcomm::Acceptor* acceptor(const gu::URI&);
+    void enter();
+    void leave();
+    size_t mtu() const { return mtu_; }
+
+private:
+
+    friend class UringTcpSocket;
+    friend class UringTcpAcceptor;
+    UringProtonet(const UringProtonet&);
+    void operator=(const UringProtonet&);
+
+    // Returns cleared submission queue entry which will complete to op.
+    // Must be called within critical section, entry must be filled
+    // before calling commit().
+    struct io_uring_sqe* get_sqe(Op* op);
+    // Publishes entries obtained with get_sqe() to the kernel. Outside of
+    // the event loop they are submitted right away.
+    void commit();
+    // Submits published entries now. Must be called within critical
+    // section.
+    void flush();
+    // Submits published entries and waits for at least one completion
+    // or timeout
+    void wait(const gu::datetime::Period& p);
+    // Calls handlers of available completions
+    void reap();
+    void wakeup_handler(int res);
+    void arm_wakeup();
+
+    // Registers provided buffer ring for multishot receive, leaves
+    // multishot receive disabled if the kernel does not support it
+    void setup_recv_bufs();
+    bool multishot_recv() const { return multishot_recv_; }
+    // Called when the kernel rejects multishot recv (before 6.0),
+    // sockets fall back to single-shot recv
+    void disable_multishot_recv();
+    // Returns provided buffer identified by buffer id of completion
+    const gu::byte_t* recv_buf(unsigned bid) const
+    {
+        return recv_bufs_ + size_t(bid) * recv_buf_size;
+    }
+    // Gives provided buffer back to the kernel
+    void recycle_recv_buf(unsigned bid);
+
+    // Provided buffers, shared by all sockets of the ring
+    static const unsigned       recv_buf_group = 0;
+    static const unsigned       recv_buf_count = 64;
+    static const size_t         recv_buf_size  = (1 << 16);
+
+    gu::RecursiveMutex          mutex_;
+    int                         ring_fd_;
+    void*                       sq_ring_;
+    size_t                      sq_ring_size_;
+    void*                       cq_ring_;
+    size_t                      cq_ring_size_;
+    struct io_uring_sqe*        sqes_;
+    unsigned                    sq_entries_;
+    unsigned*                   sq_khead_;
+    unsigned*                   sq_ktail_;
+    unsigned                    sq_mask_;
+    unsigned*                   sq_array_;
+    unsigned*                   cq_khead_;
+    unsigned*                   cq_ktail_;
+    unsigned                    cq_mask_;
+    struct io_uring_cqe*        cqes_;
+    unsigned                    sq_tail_;      // local tail, not yet published
+    unsigned                    unsubmitted_;  // published but not submitted
+    size_t                      pending_;      // operations in flight
+    bool                        in_loop_;      // completion handlers running
+    bool                        interrupted_;
+    int                         wakeup_fd_;    // eventfd for interrupt()
+    uint64_t                    wakeup_val_;
+    UringHandler<UringProtonet>* wakeup_op_;
+    struct io_uring_buf_ring*   recv_buf_ring_;
+    size_t                      recv_buf_ring_size_;
+    gu::byte_t*                 recv_bufs_;
+    unsigned                    recv_buf_tail_;
+    bool                        multishot_recv_;
+    gu::datetime::Date          poll_until_;
+    gu::datetime::Date          next_timer_;
+    size_t                      mtu_;
+
+    NetHeader::checksum_t       checksum_;
+};
+
+//!
+// Op which calls member function of T on completion. If hold() is called
+// before submission, T is kept alive until the last completion.
+// Completion flags are available to the handler through flags().
+//
+template <class T>
+class gcomm::UringHandler : public gcomm::UringProtonet::Op
+{
+public:
+    typedef void (T::*Fn)(int);
+
+    UringHandler(T& obj, Fn fn) : obj_(obj), fn_(fn), hold_(), flags_(0) { }
+
+    void hold(const typename gu::shared_ptr<T>::type& ptr) { hold_ = ptr; }
+
+    uint32_t flags() const { return flags_; }
+
+    void complete(int res, uint32_t flags)
+    {
+        // release reference only after the handler has returned
+        typename gu::shared_ptr<T>::type hold;
+        if (UringProtonet::more(flags) == false) hold.swap(hold_);
+        flags_ = flags;
+        (obj_.*fn_)(res);
+    }
+
+private:
+    UringHandler(const UringHandler&);
+    void operator=(const UringHandler&);
+
+    T&                                obj_;
+    Fn                                fn_;
+    typename gu::shared_ptr<T>::type  hold_;
+    uint32_t                          flags_;
+};
+
+#endif // GCOMM_URING_PROTONET_HPP
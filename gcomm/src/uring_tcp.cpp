@@ -0,0 +1,971 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include "uring_tcp.hpp"
+#include "asio_tcp.hpp" // GCOMM_ASIO_AUTO_BUF_SIZE
+#include "gcomm/util.hpp"
+#include "gcomm/common.hpp"
+#include "gcomm/conf.hpp"
+
+#include "gu_resolver.hpp"
+
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#include <algorithm>
+
+#define FAILED_HANDLER(_e) failed_handler(_e, __FUNCTION__, __LINE__)
+
+// Helper to set socket buffer sizes for both connecting and listening
+// sockets, see set_recv_buf_size_helper() in asio_tcp.cpp.
+static void uring_set_buf_size(const gu::Config&  conf,
+                               int const          fd,
+                               const std::string& key,
+                               int const          opt,
+                               const char* const  what,
+                               bool&              warned)
+{
+    if (conf.get(key) != GCOMM_ASIO_AUTO_BUF_SIZE)
+    {
+        size_t const buf_size(conf.get<size_t>(key));
+        // this should have been checked already
+        assert(ssize_t(buf_size) >= 0);
+
+        int val(buf_size);
+        if (setsockopt(fd, SOL_SOCKET, opt, &val, sizeof(val)))
+        {
+            gu_throw_error(errno) << "failed to set " << key;
+        }
+        socklen_t val_len(sizeof(val));
+        if (getsockopt(fd, SOL_SOCKET, opt, &val, &val_len))
+        {
+            gu_throw_error(errno) << "failed to get " << key;
+        }
+        log_debug << "socket " << what << " buf size " << val;
+        if (val < ssize_t(buf_size) && not warned)
+        {
+            log_warn << what << " buffer size " << val
+                     << " less than requested " << buf_size
+                     << ", this may affect performance in high latency/high "
+                     << "throughput networks.";
+            warned = true;
+        }
+    }
+}
+
+static bool uring_recv_buf_warned(false);
+static bool uring_send_buf_warned(false);
+
+static void uring_set_buf_sizes(const gu::Config& conf, int const fd)
+{
+    uring_set_buf_size(conf, fd, gcomm::Conf::SocketRecvBufSize, SO_RCVBUF,
+                       "Receive", uring_recv_buf_warned);
+    uring_set_buf_size(conf, fd, gcomm::Conf::SocketSendBufSize, SO_SNDBUF,
+                       "Send", uring_send_buf_warned);
+}
+
+// Returns socket address in the same form as AsioTcpSocket
+static std::string uring_addr_string(const struct sockaddr_storage& sa,
+                                     socklen_t const                 sa_len)
+{
+    char host[NI_MAXHOST];
+    char port[NI_MAXSERV];
+    int const err(getnameinfo(reinterpret_cast<const struct sockaddr*>(&sa),
+                              sa_len, host, sizeof(host), port, sizeof(port),
+                              NI_NUMERICHOST | NI_NUMERICSERV));
+    if (err)
+    {
+        gu_throw_error(EINVAL) << "getnameinfo() failed: "
+                               << gai_strerror(err);
+    }
+
+    return gcomm::uri_string(gu::scheme::tcp,
+                             sa.ss_family == AF_INET6 ?
+                             std::string("[") + host + "]" :
+                             std::string(host),
+                             port);
+}
+
+gcomm::UringTcpSocket::UringTcpSocket(UringProtonet& net, const gu::URI& uri,
+                                      int const fd)
+    :
+    Socket       (uri),
+    net_         (net),
+    fd_          (fd),
+    connect_op_  (*this, &UringTcpSocket::connect_handler),
+    read_op_     (*this, &UringTcpSocket::read_handler),
+    write_op_    (*this, &UringTcpSocket::write_handler),
+    connect_addr_(),
+    connect_addr_len_(0),
+    send_q_      (),
+    write_dgs_   (),
+    write_iov_   (),
+    write_iov_first_(0),
+    write_msg_   (),
+    write_bytes_ (0),
+    write_done_  (0),
+    last_queued_tstamp_(),
+    recv_buf_    (net_.mtu() + NetHeader::serial_size_),
+    recv_offset_ (0),
+    read_multishot_(false),
+    recv_pool_   (),
+    recv_pool_next_(0),
+    last_delivered_tstamp_(),
+    sent_msgs_   (0),
+    sent_bytes_  (0),
+    recv_msgs_   (0),
+    recv_bytes_  (0),
+    state_       (S_CLOSED),
+    local_addr_  (),
+    remote_addr_ ()
+{
+    log_debug << "ctor for " << id();
+}
+
+gcomm::UringTcpSocket::~UringTcpSocket()
+{
+    log_debug << "dtor for " << id() << " send q size " << send_q_.size();
+    close_socket();
+}
+
+void gcomm::UringTcpSocket::failed_handler(int const          err,
+                                           const std::string& func,
+                                           int const          line)
+{
+    log_debug << "failed handler from " << func << ":" << line
+              << " socket " << id() << " " << fd_
+              << " error " << err << " state " << state();
+
+    log_debug << "local endpoint " << local_addr()
+              << " remote endpoint " << remote_addr();
+
+    const State prev_state(state());
+
+    if (state() != S_CLOSED)
+    {
+        state_ = S_FAILED;
+    }
+
+    if (prev_state != S_FAILED && prev_state != S_CLOSED)
+    {
+        net_.dispatch(id(), Datagram(), ProtoUpMeta(err));
+    }
+}
+
+void gcomm::UringTcpSocket::connect_handler(int const res)
+{
+    if (state() != S_CONNECTING)
+    {
+        log_debug << "connect handler for " << id() << " state " << state();
+        return;
+    }
+
+    if (res < 0)
+    {
+        FAILED_HANDLER(-res);
+        return;
+    }
+
+    try
+    {
+        assign_local_addr();
+        assign_remote_addr();
+        set_socket_options();
+    }
+    catch (gu::Exception& e)
+    {
+        FAILED_HANDLER(e.get_errno());
+        return;
+    }
+
+    log_debug << "socket " << id() << " connected, remote endpoint "
+              << remote_addr() << " local endpoint " << local_addr();
+    state_ = S_CONNECTED;
+    init_tstamps();
+    net_.dispatch(id(), Datagram(), ProtoUpMeta(0));
+    // upper layers may have closed the socket
+    if (state() == S_CONNECTED) async_receive();
+}
+
+void gcomm::UringTcpSocket::connect(const gu::URI& uri)
+{
+    Critical<UringProtonet> crit(net_);
+
+    try
+    {
+        gu::net::Addrinfo const ai(gu::net::resolve(uri));
+
+        fd_ = ::socket(ai.get_family(),
+                       SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+        {
+            gu_throw_error(errno) << "failed to open socket";
+        }
+
+        const std::string bind_ip(uri.get_option(gcomm::Socket::OptIfAddr,
+                                                 ""));
+        if (!bind_ip.empty())
+        {
+            gu::net::Addrinfo const bind_ai(
+                gu::net::resolve(gu::URI(uri.get_scheme() + "://" +
+                                         bind_ip + ":0")));
+            const gu::net::Sockaddr& sa(bind_ai.get_addr());
+            if (::bind(fd_, &sa.get_sockaddr(), sa.get_sockaddr_len()))
+            {
+                gu_throw_error(errno) << "failed to bind to " << bind_ip;
+            }
+        }
+
+        set_buf_sizes(); // Must be done before connect
+
+        const gu::net::Sockaddr sa(ai.get_addr());
+        memcpy(&connect_addr_, &sa.get_sockaddr(), sa.get_sockaddr_len());
+        connect_addr_len_ = sa.get_sockaddr_len();
+
+        struct io_uring_sqe* const sqe(net_.get_sqe(&connect_op_));
+        sqe->opcode = IORING_OP_CONNECT;
+        sqe->fd     = fd_;
+        sqe->addr   = reinterpret_cast<uintptr_t>(&connect_addr_);
+        sqe->off    = connect_addr_len_;
+        connect_op_.hold(shared_from_this());
+        net_.commit();
+
+        state_ = S_CONNECTING;
+    }
+    catch (gu::Exception& e)
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        std::ostringstream msg;
+        msg << "error while connecting to remote host "
+            << uri.to_string()
+            << "', error '" << e.what() << "'";
+        log_warn << msg.str();
+        gu_throw_error(e.get_errno()) << msg.str();
+    }
+}
+
+void gcomm::UringTcpSocket::close()
+{
+    Critical<UringProtonet> crit(net_);
+
+    if (state() == S_CLOSED || state() == S_CLOSING) return;
+
+    log_debug << "closing " << id() << " state " << state()
+              << " send_q size " << send_q_.size();
+
+    if ((send_q_.empty() == true && write_dgs_.empty() == true) ||
+        state() != S_CONNECTED)
+    {
+        close_socket();
+        state_ = S_CLOSED;
+    }
+    else
+    {
+        state_ = S_CLOSING;
+    }
+}
+
+void gcomm::UringTcpSocket::write_handler(int const res)
+{
+    if (state() != S_CONNECTED && state() != S_CLOSING)
+    {
+        log_debug << "write handler for " << id()
+                  << " state " << state();
+        return;
+    }
+
+    if (res > 0)
+    {
+        if (write_dgs_.empty() == true ||
+            write_done_ + res > write_bytes_)
+        {
+            log_warn << "write_handler() bytes transferred " << res
+                     << " do not match write in progress of "
+                     << write_bytes_ - write_done_
+                     << ". Transport may not be reliable, closing the socket";
+            FAILED_HANDLER(EPROTO);
+            return;
+        }
+
+        write_done_ += res;
+
+        if (write_done_ < write_bytes_)
+        {
+            // short write, advance iovecs past transferred bytes
+            size_t skip(res);
+            while (skip > 0)
+            {
+                struct iovec& iov(write_iov_[write_iov_first_]);
+                if (skip >= iov.iov_len)
+                {
+                    skip -= iov.iov_len;
+                    ++write_iov_first_;
+                }
+                else
+                {
+                    iov.iov_base = static_cast<char*>(iov.iov_base) + skip;
+                    iov.iov_len -= skip;
+                    skip = 0;
+                }
+            }
+            write_one();
+            return;
+        }
+
+        write_dgs_.clear();
+        write_bytes_ = 0;
+        write_done_  = 0;
+
+        if (send_q_.empty() == false)
+        {
+            write_queued();
+        }
+        else if (state_ == S_CLOSING)
+        {
+            log_debug << "deferred close of " << id();
+            close_socket();
+            state_ = S_CLOSED;
+        }
+    }
+    else if (state_ == S_CLOSING)
+    {
+        log_debug << "deferred close of " << id() << " error " << res;
+        close_socket();
+        state_ = S_CLOSED;
+    }
+    else
+    {
+        FAILED_HANDLER(res < 0 ? -res : EPROTO);
+    }
+}
+
+void gcomm::UringTcpSocket::set_option(const std::string& key,
+                                       const std::string& val)
+{
+    // See AsioTcpSocket::set_option()
+    log_warn << "Setting " << key << " in run time does not have effect, "
+             << "please set the configuration in provider options "
+             << "and restart";
+}
+
+int gcomm::UringTcpSocket::send(int segment, const Datagram& dg)
+{
+    Critical<UringProtonet> crit(net_);
+
+    if (state() != S_CONNECTED)
+    {
+        return ENOTCONN;
+    }
+
+    if (send_q_.size() >= max_send_q_bytes)
+    {
+        return ENOBUFS;
+    }
+
+    NetHeader hdr(static_cast<uint32_t>(dg.len()), net_.version_);
+
+    if (net_.checksum_ != NetHeader::CS_NONE)
+    {
+        hdr.set_crc32(crc32(net_.checksum_, dg), net_.checksum_);
+    }
+
+    last_queued_tstamp_ = gu::datetime::Date::monotonic();
+    // Make copy of datagram to be able to adjust the header
+    Datagram priv_dg(dg);
+    priv_dg.set_header_offset(priv_dg.header_offset() -
+                              NetHeader::serial_size_);
+    serialize(hdr,
+              priv_dg.header(),
+              priv_dg.header_size(),
+              priv_dg.header_offset());
+    send_q_.push_back(segment, priv_dg);
+    ++sent_msgs_;
+    sent_bytes_ += dg.len();
+    // If write is in progress, write_handler() will pick up the datagram.
+    // Otherwise the write is submitted from this thread, either right away
+    // or together with other submissions if called from event loop.
+    if (write_dgs_.empty() == true)
+    {
+        write_queued();
+    }
+    return 0;
+}
+
+void gcomm::UringTcpSocket::read_handler(int const res)
+{
+    uint32_t const flags(read_op_.flags());
+
+    if (res <= 0)
+    {
+        if (read_multishot_ == true && (res == -ENOBUFS || res == -EINVAL))
+        {
+            // ENOBUFS: all provided buffers were taken, they have been
+            // given back by now. EINVAL: kernel before 6.0.
+            if (res == -EINVAL) net_.disable_multishot_recv();
+            if (fd_ >= 0 && (state() == S_CONNECTED || state() == S_CLOSING))
+            {
+                read_one();
+            }
+            return;
+        }
+        // zero means that the peer has closed the connection
+        FAILED_HANDLER(res < 0 ? -res : ECONNRESET);
+        return;
+    }
+
+    if (flags & IORING_CQE_F_BUFFER)
+    {
+        unsigned const bid(flags >> IORING_CQE_BUFFER_SHIFT);
+        bool const ok((state() == S_CONNECTED || state() == S_CLOSING) &&
+                      receive(net_.recv_buf(bid), res));
+        net_.recycle_recv_buf(bid);
+        if (ok == false)
+        {
+            log_debug << "read handler for " << id()
+                      << " state " << state();
+            return;
+        }
+    }
+    else
+    {
+        if (state() != S_CONNECTED && state() != S_CLOSING)
+        {
+            log_debug << "read handler for " << id()
+                      << " state " << state();
+            return;
+        }
+
+        recv_offset_ += res;
+
+        // Remaining bytes are moved to the beginning of recv_buf_ once
+        // all complete messages have been delivered.
+        size_t consumed(0);
+        if (deliver(&recv_buf_[0], recv_offset_, consumed) == false) return;
+
+        recv_offset_ -= consumed;
+        if (consumed > 0 && recv_offset_ > 0)
+        {
+            memmove(&recv_buf_[0], &recv_buf_[0] + consumed, recv_offset_);
+        }
+    }
+
+    // multishot receive stays armed as long as the kernel says so,
+    // upper layers may have closed the socket
+    if (UringProtonet::more(flags) == false &&
+        fd_ >= 0 && (state() == S_CONNECTED || state() == S_CLOSING))
+    {
+        read_one();
+    }
+}
+
+bool gcomm::UringTcpSocket::deliver(const gu::byte_t* const buf,
+                                    size_t const            len,
+                                    size_t&                 consumed)
+{
+    while (len - consumed >= NetHeader::serial_size_)
+    {
+        NetHeader hdr;
+        try
+        {
+            unserialize(buf, len, consumed, hdr);
+        }
+        catch (gu::Exception& e)
+        {
+            FAILED_HANDLER(e.get_errno());
+            return false;
+        }
+        if (NetHeader::serial_size_ + hdr.len() > recv_buf_.size())
+        {
+            log_warn << "message length " << hdr.len()
+                     << " exceeds receive buffer size " << recv_buf_.size();
+            FAILED_HANDLER(EPROTO);
+            return false;
+        }
+        if (len - consumed < NetHeader::serial_size_ + hdr.len())
+        {
+            break;
+        }
+
+        const gu::byte_t* const begin(buf + consumed
+                                      + NetHeader::serial_size_);
+        Datagram dg(recv_buffer(begin, begin + hdr.len()));
+        if (net_.checksum_ != NetHeader::CS_NONE && check_cs(hdr, dg))
+        {
+            log_warn << "checksum failed, hdr: len=" << hdr.len()
+                     << " has_crc32="  << hdr.has_crc32()
+                     << " has_crc32c=" << hdr.has_crc32c()
+                     << " crc32=" << hdr.crc32();
+            FAILED_HANDLER(EPROTO);
+            return false;
+        }
+        ProtoUpMeta um;
+        last_delivered_tstamp_ = gu::datetime::Date::monotonic();
+        ++recv_msgs_;
+        recv_bytes_ += hdr.len();
+        net_.dispatch(id(), dg, um);
+        consumed += NetHeader::serial_size_ + hdr.len();
+    }
+    return true;
+}
+
+bool gcomm::UringTcpSocket::receive(const gu::byte_t* data, size_t len)
+{
+    while (len > 0)
+    {
+        size_t consumed(0);
+
+        if (recv_offset_ == 0)
+        {
+            if (deliver(data, len, consumed) == false) return false;
+            data += consumed;
+            len  -= consumed;
+            // keep the partial message until the rest arrives, deliver()
+            // has checked that it fits
+            memcpy(&recv_buf_[0], data, len);
+            recv_offset_ = len;
+            break;
+        }
+
+        // complete the message started by previous receives, first its
+        // header and then the rest of it
+        size_t need(NetHeader::serial_size_);
+        if (recv_offset_ >= need)
+        {
+            NetHeader hdr;
+            try
+            {
+                unserialize(&recv_buf_[0], recv_offset_, 0, hdr);
+            }
+            catch (gu::Exception& e)
+            {
+                FAILED_HANDLER(e.get_errno());
+                return false;
+            }
+            need += hdr.len();
+            // deliver() has checked that the message fits
+            assert(need <= recv_buf_.size());
+        }
+
+        size_t const n(std::min(len, need - recv_offset_));
+        memcpy(&recv_buf_[0] + recv_offset_, data, n);
+        recv_offset_ += n;
+        data += n;
+        len  -= n;
+
+        if (deliver(&recv_buf_[0], recv_offset_, consumed) == false)
+        {
+            return false;
+        }
+        assert(consumed == 0 || consumed == recv_offset_);
+        recv_offset_ -= consumed;
+    }
+    return true;
+}
+
+gu::SharedBuffer gcomm::UringTcpSocket::recv_buffer(const gu::byte_t* first,
+                                                    const gu::byte_t* last)
+{
+    for (size_t i(0); i < recv_pool_.size(); ++i)
+    {
+        gu::SharedBuffer& buf(recv_pool_[recv_pool_next_]);
+        recv_pool_next_ = (recv_pool_next_ + 1) % recv_pool_.size();
+
+        if (buf.use_count() == 1)
+        {
+            buf->assign(first, last);
+            return buf;
+        }
+    }
+
+    gu::SharedBuffer ret(new gu::Buffer(first, last));
+
+    if (recv_pool_.size() < recv_pool_size)
+    {
+        recv_pool_.push_back(ret);
+    }
+    else
+    {
+        recv_pool_[recv_pool_next_] = ret;
+        recv_pool_next_ = (recv_pool_next_ + 1) % recv_pool_.size();
+    }
+
+    return ret;
+}
+
+void gcomm::UringTcpSocket::async_receive()
+{
+    Critical<UringProtonet> crit(net_);
+
+    gcomm_assert(state() == S_CONNECTED);
+
+    read_one();
+}
+
+void gcomm::UringTcpSocket::read_one()
+{
+    struct io_uring_sqe* const sqe(net_.get_sqe(&read_op_));
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd     = fd_;
+#ifdef IORING_RECV_MULTISHOT
+    read_multishot_ = net_.multishot_recv();
+    if (read_multishot_ == true)
+    {
+        // kernel picks a provided buffer for each completion
+        sqe->flags     = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = UringProtonet::recv_buf_group;
+        sqe->ioprio    = IORING_RECV_MULTISHOT;
+    }
+    else
+#endif /* IORING_RECV_MULTISHOT */
+    {
+        sqe->addr = reinterpret_cast<uintptr_t>(&recv_buf_[0] + recv_offset_);
+        sqe->len  = recv_buf_.size() - recv_offset_;
+    }
+    read_op_.hold(shared_from_this());
+    net_.commit();
+}
+
+size_t gcomm::UringTcpSocket::mtu() const
+{
+    return net_.mtu();
+}
+
+std::string gcomm::UringTcpSocket::local_addr() const
+{
+    return local_addr_;
+}
+
+std::string gcomm::UringTcpSocket::remote_addr() const
+{
+    return remote_addr_;
+}
+
+void gcomm::UringTcpSocket::set_socket_options()
+{
+    int const val(1);
+    if (setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val)))
+    {
+        gu_throw_error(errno) << "failed to set TCP_NODELAY";
+    }
+}
+
+void gcomm::UringTcpSocket::set_buf_sizes()
+{
+    uring_set_buf_sizes(net_.conf(), fd_);
+}
+
+void gcomm::UringTcpSocket::write_queued()
+{
+    assert(write_dgs_.empty() == true);
+    assert(send_q_.empty() == false);
+
+    // See AsioTcpSocket::write_queued()
+    do
+    {
+        write_dgs_.push_back(send_q_.front());
+        write_bytes_ += write_dgs_.back().len();
+        send_q_.pop_front();
+    }
+    while (send_q_.empty() == false &&
+           write_dgs_.size() < max_write_dgs &&
+           write_bytes_ + send_q_.front().len() <= max_write_bytes);
+
+    write_iov_.clear();
+    for (std::vector<Datagram>::const_iterator i(write_dgs_.begin());
+         i != write_dgs_.end(); ++i)
+    {
+        struct iovec iov;
+        iov.iov_base = const_cast<gu::byte_t*>(i->header()
+                                               + i->header_offset());
+        iov.iov_len  = i->header_len();
+        write_iov_.push_back(iov);
+        if (i->payload().size() > 0)
+        {
+            iov.iov_base = const_cast<gu::byte_t*>(i->payload().data());
+            iov.iov_len  = i->payload().size();
+            write_iov_.push_back(iov);
+        }
+    }
+    write_iov_first_ = 0;
+    write_done_      = 0;
+
+    write_one();
+}
+
+void gcomm::UringTcpSocket::write_one()
+{
+    memset(&write_msg_, 0, sizeof(write_msg_));
+    write_msg_.msg_iov    = &write_iov_[write_iov_first_];
+    write_msg_.msg_iovlen = write_iov_.size() - write_iov_first_;
+
+    struct io_uring_sqe* const sqe(net_.get_sqe(&write_op_));
+    sqe->opcode    = IORING_OP_SENDMSG;
+    sqe->fd        = fd_;
+    sqe->addr      = reinterpret_cast<uintptr_t>(&write_msg_);
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    write_op_.hold(shared_from_this());
+    net_.commit();
+}
+
+void gcomm::UringTcpSocket::close_socket()
+{
+    if (fd_ < 0) return;
+
+    Critical<UringProtonet> crit(net_);
+
+    // Entries referring to fd_ by number must reach the kernel before
+    // the number can be reused by another socket. Shutdown completes
+    // operations in flight, they hold reference to the file.
+    net_.commit();
+    net_.flush();
+    ::shutdown(fd_, SHUT_RDWR);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+void gcomm::UringTcpSocket::assign_local_addr()
+{
+    struct sockaddr_storage sa;
+    socklen_t sa_len(sizeof(sa));
+    if (getsockname(fd_, reinterpret_cast<struct sockaddr*>(&sa), &sa_len))
+    {
+        gu_throw_error(errno) << "getsockname() failed";
+    }
+    local_addr_ = uring_addr_string(sa, sa_len);
+}
+
+void gcomm::UringTcpSocket::assign_remote_addr()
+{
+    struct sockaddr_storage sa;
+    socklen_t sa_len(sizeof(sa));
+    if (getpeername(fd_, reinterpret_cast<struct sockaddr*>(&sa), &sa_len))
+    {
+        gu_throw_error(errno) << "getpeername() failed";
+    }
+    remote_addr_ = uring_addr_string(sa, sa_len);
+}
+
+gcomm::SocketStats gcomm::UringTcpSocket::stats() const
+{
+    SocketStats ret;
+    struct tcp_info tcpi;
+    memset(&tcpi, 0, sizeof(tcpi));
+    socklen_t tcpi_len(sizeof(tcpi));
+    if (getsockopt(fd_, SOL_TCP, TCP_INFO, &tcpi, &tcpi_len) == 0)
+    {
+        ret.rtt            = tcpi.tcpi_rtt;
+        ret.rttvar         = tcpi.tcpi_rttvar;
+        ret.rto            = tcpi.tcpi_rto;
+        ret.lost           = tcpi.tcpi_lost;
+        ret.last_data_recv = tcpi.tcpi_last_data_recv;
+        ret.cwnd           = tcpi.tcpi_snd_cwnd;
+        gu::datetime::Date now(gu::datetime::Date::monotonic());
+        Critical<UringProtonet> crit(net_);
+        ret.last_queued_since = (now - last_queued_tstamp_).get_nsecs();
+        ret.last_delivered_since = (now - last_delivered_tstamp_).get_nsecs();
+        ret.send_queue_length = send_q_.size() + write_dgs_.size();
+        ret.send_queue_bytes = send_q_.queued_bytes() +
+            (write_bytes_ - write_done_);
+        ret.send_queue_segments = send_q_.segments();
+        ret.sent_msgs = sent_msgs_;
+        ret.sent_bytes = sent_bytes_;
+        ret.recv_msgs = recv_msgs_;
+        ret.recv_bytes = recv_bytes_;
+    }
+    return ret;
+}
+
+class gcomm::UringTcpAcceptor::AcceptOp : public gcomm::UringProtonet::Op
+{
+public:
+    AcceptOp(UringTcpAcceptor* acceptor) : acceptor_(acceptor) { }
+
+    // called when acceptor is closed with accept in progress
+    void detach() { acceptor_ = 0; }
+
+    void complete(int res, uint32_t)
+    {
+        if (acceptor_ != 0)
+        {
+            acceptor_->accept_pending_ = false;
+            acceptor_->accept_handler(res);
+        }
+        else
+        {
+            if (res >= 0) ::close(res);
+            delete this;
+        }
+    }
+
+private:
+    AcceptOp(const AcceptOp&);
+    void operator=(const AcceptOp&);
+
+    UringTcpAcceptor* acceptor_;
+};
+
+gcomm::UringTcpAcceptor::UringTcpAcceptor(UringProtonet& net,
+                                          const gu::URI& uri)
+    :
+    Acceptor        (uri),
+    net_            (net),
+    fd_             (-1),
+    accept_op_      (new AcceptOp(this)),
+    accept_pending_ (false),
+    accepted_socket_()
+{
+
+}
+
+gcomm::UringTcpAcceptor::~UringTcpAcceptor()
+{
+    close();
+
+    Critical<UringProtonet> crit(net_);
+
+    if (accept_pending_ == true)
+    {
+        accept_op_->detach();
+    }
+    else
+    {
+        delete accept_op_;
+    }
+}
+
+void gcomm::UringTcpAcceptor::accept_handler(int const res)
+{
+    if (res < 0)
+    {
+        log_warn << "accept handler: " << -res << " (" << ::strerror(-res)
+                 << ")";
+        return;
+    }
+
+    UringTcpSocket* const s(new UringTcpSocket(net_, uri_, res));
+    SocketPtr socket(s);
+    try
+    {
+        s->assign_local_addr();
+        s->assign_remote_addr();
+        s->set_socket_options();
+        s->state_ = Socket::S_CONNECTED;
+        accepted_socket_ = socket;
+        log_debug << "accepted socket " << socket->id();
+        net_.dispatch(id(), Datagram(), ProtoUpMeta(0));
+    }
+    catch (gu::Exception& e)
+    {
+        // socket object should be freed automatically when it
+        // goes out of scope
+        log_debug << "accept failed: " << e.what();
+    }
+
+    if (fd_ >= 0) accept_one();
+}
+
+void gcomm::UringTcpAcceptor::accept_one()
+{
+    struct io_uring_sqe* const sqe(net_.get_sqe(accept_op_));
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->fd           = fd_;
+    sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    accept_pending_   = true;
+    net_.commit();
+}
+
+void gcomm::UringTcpAcceptor::listen(const gu::URI& uri)
+{
+    Critical<UringProtonet> crit(net_);
+
+    try
+    {
+        gu::net::Addrinfo const ai(gu::net::resolve(uri));
+
+        fd_ = ::socket(ai.get_family(),
+                       SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+        {
+            gu_throw_error(errno) << "failed to open socket";
+        }
+
+        int const val(1);
+        if (setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &val, sizeof(val)))
+        {
+            gu_throw_error(errno) << "failed to set SO_REUSEADDR";
+        }
+
+        uring_set_buf_sizes(net_.conf(), fd_); // Must be done before listen
+
+        const gu::net::Sockaddr sa(ai.get_addr());
+        if (::bind(fd_, &sa.get_sockaddr(), sa.get_sockaddr_len()))
+        {
+            gu_throw_error(errno) << "bind() failed";
+        }
+
+        if (::listen(fd_, SOMAXCONN))
+        {
+            gu_throw_error(errno) << "listen() failed";
+        }
+
+        accept_one();
+    }
+    catch (gu::Exception& e)
+    {
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+        std::ostringstream msg;
+        msg << "error while trying to listen '" << uri.to_string()
+            << "', error '" << e.what() << "'";
+        log_warn << msg.str();
+        gu_throw_error(e.get_errno()) << msg.str();
+    }
+}
+
+std::string gcomm::UringTcpAcceptor::listen_addr() const
+{
+    struct sockaddr_storage sa;
+    socklen_t sa_len(sizeof(sa));
+    if (getsockname(fd_, reinterpret_cast<struct sockaddr*>(&sa), &sa_len))
+    {
+        gu_throw_error(errno) << "failed to read listen addr";
+    }
+    return uring_addr_string(sa, sa_len);
+}
+
+void gcomm::UringTcpAcceptor::close()
+{
+    if (fd_ < 0) return;
+
+    Critical<UringProtonet> crit(net_);
+
+    // shutdown() completes accept in progress
+    net_.commit();
+    net_.flush();
+    ::shutdown(fd_, SHUT_RDWR);
+    ::close(fd_);
+    fd_ = -1;
+}
+
+gcomm::SocketPtr gcomm::UringTcpAcceptor::accept()
+{
+    if (accepted_socket_->state() == Socket::S_CONNECTED)
+    {
+        accepted_socket_->async_receive();
+    }
+    return accepted_socket_;
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#ifndef GCOMM_URING_TCP_HPP
+#define GCOMM_URING_TCP_HPP
+
+#include "socket.hpp"
+#include "uring_protonet.hpp"
+#include "fair_send_queue.hpp"
+
+#include "gu_shared_ptr.hpp"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <vector>
+
+//
+// Boost and std:: enable_shared_from_this<> does not have virtual destructor,
+// therefore need to ignore -Weffc++ and -Wnon-virtual-dtor
+//
+#if defined(__GNUG__)
+# if (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || (__GNUC__ > 4)
+#  pragma GCC diagnostic push
+# endif // (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || (__GNUC__ > 4)
+# pragma GCC diagnostic ignored "-Weffc++"
+# pragma GCC diagnostic ignored "-Wnon-virtual-dtor"
+#endif
+
+namespace gcomm
+{
+    class UringTcpSocket;
+    class UringTcpAcceptor;
+}
+
+// TCP Socket implementation. Framing and send queueing follow
+// AsioTcpSocket so that the backends interoperate.
+
+class gcomm::UringTcpSocket :
+    public gcomm::Socket,
+    public gu::enable_shared_from_this<UringTcpSocket>::type
+{
+public:
+    // fd is given for accepted connection
+    UringTcpSocket(UringProtonet& net, const gu::URI& uri, int fd = -1);
+    ~UringTcpSocket();
+    void connect(const gu::URI& uri);
+    void close();
+    void set_option(const std::string& key, const std::string& val);
+    int send(int segment, const Datagram& dg);
+    void async_receive();
+    size_t mtu() const;
+    std::string local_addr() const;
+    std::string remote_addr() const;
+    State state() const { return state_; }
+    SocketId id() const { return this; }
+    SocketStats stats() const;
+private:
+    friend class gcomm::UringTcpAcceptor;
+
+    UringTcpSocket(const UringTcpSocket&);
+    void operator=(const UringTcpSocket&);
+
+    // Completion handlers, called by event loop within critical section
+    void connect_handler(int res);
+    void read_handler(int res);
+    void write_handler(int res);
+    void failed_handler(int err, const std::string& func, int line);
+
+    void set_socket_options();
+    void set_buf_sizes();
+    void init_tstamps()
+    {
+        gu::datetime::Date now(gu::datetime::Date::monotonic());
+        last_queued_tstamp_ = last_delivered_tstamp_ = now;
+    }
+    // submits multishot receive or single-shot receive into the free
+    // space of recv_buf_
+    void read_one();
+    // delivers complete messages found in [buf, buf + len) starting from
+    // consumed, which is advanced past them, returns false if the socket
+    // failed
+    bool deliver(const gu::byte_t* buf, size_t len, size_t& consumed);
+    // processes data of multishot receive, complete messages are
+    // delivered from the provided buffer directly, a partial one is
+    // stored into recv_buf_, returns false if the socket failed
+    bool receive(const gu::byte_t* data, size_t len);
+    // returns buffer with a copy of [first, last) for received datagram
+    gu::SharedBuffer recv_buffer(const gu::byte_t* first,
+                                 const gu::byte_t* last);
+    // gathers datagrams from send_q_ into one write
+    void write_queued();
+    // submits the part of the write in progress not sent yet
+    void write_one();
+    void close_socket();
+    void assign_local_addr();
+    void assign_remote_addr();
+
+    UringProtonet&                            net_;
+    int                                       fd_;
+    UringHandler<UringTcpSocket>              connect_op_;
+    UringHandler<UringTcpSocket>              read_op_;
+    UringHandler<UringTcpSocket>              write_op_;
+    struct sockaddr_storage                   connect_addr_;
+    socklen_t                                 connect_addr_len_;
+    // See AsioTcpSocket for the limits
+    static const size_t                       max_send_q_bytes = (1 << 25);
+    gcomm::FairSendQueue                      send_q_;
+    static const size_t                       max_write_dgs = 64;
+    static const size_t                       max_write_bytes = (1 << 20);
+    std::vector<gcomm::Datagram>              write_dgs_;
+    std::vector<struct iovec>                 write_iov_;
+    size_t                                    write_iov_first_;
+    struct msghdr                             write_msg_;
+    size_t                                    write_bytes_;
+    size_t                                    write_done_;
+    gu::datetime::Date                        last_queued_tstamp_;
+    std::vector<gu::byte_t>                   recv_buf_;
+    size_t                                    recv_offset_;
+    bool                                      read_multishot_;
+    static const size_t                       recv_pool_size = 16;
+    std::vector<gu::SharedBuffer>             recv_pool_;
+    size_t                                    recv_pool_next_;
+    gu::datetime::Date                        last_delivered_tstamp_;
+    long                                      sent_msgs_;
+    long                                      sent_bytes_;
+    long                                      recv_msgs_;
+    long                                      recv_bytes_;
+    State                                     state_;
+    std::string                               local_addr_;
+    std::string                               remote_addr_;
+};
+
+class gcomm::UringTcpAcceptor : public gcomm::Acceptor
+{
+public:
+
+    UringTcpAcceptor(UringProtonet& net, const gu::URI& uri);
+    ~UringTcpAcceptor();
+    void listen(const gu::URI& uri);
+    std::string listen_addr() const;
+    void close();
+    SocketPtr accept();
+
+    State state() const
+    {
+        gu_throw_fatal << "TODO:";
+    }
+
+    SocketId id() const { return this; }
+
+private:
+    class AcceptOp;
+
+    UringTcpAcceptor(const UringTcpAcceptor&);
+    void operator=(const UringTcpAcceptor&);
+
+    void accept_handler(int res);
+    void accept_one();
+
+    UringProtonet& net_;
+    int            fd_;
+    // Accept in progress outlives the acceptor if it is closed,
+    // so the operation is allocated separately
+    AcceptOp*      accept_op_;
+    bool           accept_pending_;
+    SocketPtr      accepted_socket_;
+};
+
+#if defined(__GNUG__)
+# if (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || (__GNUC__ > 4)
+#  pragma GCC diagnostic pop
+# endif // (__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || (__GNUC__ > 4)
+#endif
+
+#endif // GCOMM_URING_TCP_HPP
@@ -2266,14 +2266,14 @@ struct TwoNodeFixture
         gu::Config conf1;  // Config for node1
         gu::Config conf2;  // Config for node2
     };
-    TwoNodeFixture()
+    TwoNodeFixture(size_t mtu = std::numeric_limits<size_t>::max())
         : conf()
         , uuid1(1)
         , uuid2(2)
         , tr1(uuid1)
         , tr2(uuid2)
-        , evs1(conf.conf1, uuid1, 0)
-        , evs2(conf.conf2, uuid2, 0)
+        , evs1(conf.conf1, uuid1, 0, gu::URI("evs://"), mtu)
+        , evs2(conf.conf2, uuid2, 0, gu::URI("evs://"), mtu)
         , top1(conf.conf1)
         , top2(conf.conf2)
     {
@@ -2508,6 +2508,168 @@ START_TEST(test_out_queue_limit)
 }
 END_TEST
 
+// Passes messages between fixture nodes until there is nothing to pass.
+static void exchange_msgs(TwoNodeFixture& f)
+{
+    bool more(true);
+    while (more)
+    {
+        more = false;
+        gcomm::evs::Message msg;
+        while (get_msg(&f.tr1, &msg) != 0)
+        {
+            f.evs2.handle_msg(msg);
+            more = true;
+        }
+        while (get_msg(&f.tr2, &msg) != 0)
+        {
+            f.evs1.handle_msg(msg);
+            more = true;
+        }
+    }
+}
+
+// Sends messages from node1 back to back until the measured interval
+// between them is short enough for aggregation delay to kick in. Each
+// message is acknowledged, so there is nothing in flight afterwards.
+static void aggregate_warm_up(TwoNodeFixture& f, const gcomm::Datagram& dg)
+{
+    for (size_t i(0); i < 50; ++i)
+    {
+        gcomm::Datagram tmp(dg);
+        ck_assert(f.evs1.handle_down(tmp, ProtoDownMeta(O_SAFE)) == 0);
+        exchange_msgs(f);
+    }
+    ck_assert(f.evs1.aggregate_timer_set() == false);
+}
+
+static void aggregate_set_params(TwoNodeFixture& f, bool use_aggregate)
+{
+    gcomm::Protolay::sync_param_cb_t spcb;
+    f.evs1.set_param("evs.send_window", "8", spcb);
+    f.evs1.set_param("evs.user_send_window", "8", spcb);
+    f.evs1.set_param("evs.aggregate_delay", "PT0.5S", spcb);
+    f.evs1.set_param("evs.use_aggregate", gu::to_string(use_aggregate), spcb);
+}
+
+// Verify that a message is held when another one is in flight and sent
+// when the aggregation deadline expires.
+START_TEST(test_aggregate_delay_deadline)
+{
+    log_info << "START test_aggregate_delay_deadline";
+    gu::datetime::SimClock::init(gu::datetime::Sec);
+    TwoNodeFixture f;
+    aggregate_set_params(f, true);
+
+    char data[16] = { 0 };
+    gcomm::Datagram dg(gu::SharedBuffer(new gu::Buffer(data, data + 16)));
+    aggregate_warm_up(f, dg);
+
+    // Nothing in flight, first message is sent right away
+    gcomm::Datagram dg1(dg);
+    ck_assert(f.evs1.handle_down(dg1, ProtoDownMeta(O_SAFE)) == 0);
+    gcomm::evs::Message um1;
+    ck_assert(get_msg(&f.tr1, &um1) != 0);
+    ck_assert(um1.type() == gcomm::evs::Message::EVS_T_USER);
+
+    // The second one is held
+    gcomm::Datagram dg2(dg);
+    ck_assert(f.evs1.handle_down(dg2, ProtoDownMeta(O_SAFE)) == 0);
+    ck_assert(f.evs1.aggregate_timer_set() == true);
+    gcomm::evs::Message um2;
+    ck_assert(get_msg(&f.tr1, &um2) == 0);
+
+    // Timer before deadline does not send it
+    f.evs1.handle_timers();
+    ck_assert(get_msg(&f.tr1, &um2) == 0);
+
+    // Delay is within evs.aggregate_delay
+    gu::datetime::SimClock::inc_time(500*gu::datetime::MSec);
+    f.evs1.handle_timers();
+    ck_assert(get_msg(&f.tr1, &um2) != 0);
+    ck_assert(um2.type() == gcomm::evs::Message::EVS_T_USER);
+    ck_assert(um2.seq() == um1.seq() + 1);
+    ck_assert((um2.flags() & gcomm::evs::Message::F_AGGREGATE) == 0);
+    ck_assert(get_msg(&f.tr1, &um2) == 0);
+
+    log_info << "END test_aggregate_delay_deadline";
+}
+END_TEST
+
+// Verify that held messages are sent in one aggregate as soon as
+// the aggregate fills up.
+START_TEST(test_aggregate_delay_full)
+{
+    log_info << "START test_aggregate_delay_full";
+    gu::datetime::SimClock::init(gu::datetime::Sec);
+    // Room for four messages with aggregate headers
+    TwoNodeFixture f(4*(16 + 4) + 64);
+    aggregate_set_params(f, true);
+
+    char data[16] = { 0 };
+    gcomm::Datagram dg(gu::SharedBuffer(new gu::Buffer(data, data + 16)));
+    aggregate_warm_up(f, dg);
+
+    gcomm::Datagram dg1(dg);
+    ck_assert(f.evs1.handle_down(dg1, ProtoDownMeta(O_SAFE)) == 0);
+    gcomm::evs::Message um;
+    ck_assert(get_msg(&f.tr1, &um) != 0);
+    const gcomm::evs::seqno_t seq(um.seq());
+
+    // Held until the aggregate is full
+    size_t n(0);
+    do
+    {
+        gcomm::Datagram tmp(dg);
+        ck_assert(f.evs1.handle_down(tmp, ProtoDownMeta(O_SAFE)) == 0);
+        ++n;
+        ck_assert(n < 8);
+    }
+    while (get_msg(&f.tr1, &um) == 0);
+
+    ck_assert_msg(n > 1, "aggregate of %zu messages", n);
+    ck_assert(um.type() == gcomm::evs::Message::EVS_T_USER);
+    ck_assert(um.seq() == seq + 1);
+    ck_assert((um.flags() & gcomm::evs::Message::F_AGGREGATE) != 0);
+    ck_assert(get_msg(&f.tr1, &um) == 0);
+
+    // Nothing is left to be sent on deadline
+    gu::datetime::SimClock::inc_time(500*gu::datetime::MSec);
+    f.evs1.handle_timers();
+    ck_assert(get_msg(&f.tr1, &um) == 0);
+
+    log_info << "END test_aggregate_delay_full";
+}
+END_TEST
+
+// Verify that with evs.use_aggregate=false messages are not held even if
+// evs.aggregate_delay is set.
+START_TEST(test_aggregate_delay_no_aggregate)
+{
+    log_info << "START test_aggregate_delay_no_aggregate";
+    gu::datetime::SimClock::init(gu::datetime::Sec);
+    TwoNodeFixture f;
+    aggregate_set_params(f, false);
+
+    char data[16] = { 0 };
+    gcomm::Datagram dg(gu::SharedBuffer(new gu::Buffer(data, data + 16)));
+    aggregate_warm_up(f, dg);
+
+    for (size_t i(0); i < 4; ++i)
+    {
+        gcomm::Datagram tmp(dg);
+        ck_assert(f.evs1.handle_down(tmp, ProtoDownMeta(O_SAFE)) == 0);
+        ck_assert(f.evs1.aggregate_timer_set() == false);
+        gcomm::evs::Message um;
+        ck_assert(get_msg(&f.tr1, &um) != 0);
+        ck_assert(um.type() == gcomm::evs::Message::EVS_T_USER);
+        ck_assert((um.flags() & gcomm::evs::Message::F_AGGREGATE) == 0);
+    }
+
+    log_info << "END test_aggregate_delay_no_aggregate";
+}
+END_TEST
+
 Suite* evs2_suite()
 {
     Suite* s = suite_create("gcomm::evs");
@@ -2695,5 +2857,17 @@ Suite* evs2_suite()
     tcase_add_test(tc, test_out_queue_limit);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_aggregate_delay_deadline");
+    tcase_add_test(tc, test_aggregate_delay_deadline);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_aggregate_delay_full");
+    tcase_add_test(tc, test_aggregate_delay_full);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_aggregate_delay_no_aggregate");
+    tcase_add_test(tc, test_aggregate_delay_no_aggregate);
+    suite_add_tcase(s, tc);
+
     return s;
 }
@@ -6,6 +6,12 @@
 #define CHECK_GCOMM_HPP
 
 struct Suite;
+namespace gu { class Config; }
+
+/* Sets protonet.backend from CHECK_GCOMM_PROTONET_BACKEND and
+ * protonet.io_threads from CHECK_GCOMM_PROTONET_IO_THREADS environment
+ * variables if given, nondeterministic tests only */
+void check_gcomm_set_backend(gu::Config& conf);
 
 /* Tests for various common types */
 Suite* types_suite();
@@ -8,6 +8,8 @@
 #include "gu_exception.hpp"
 #include "gu_logger.hpp"
 #include "gu_crc32c.h" // gu_crc32c_configure()
+#include "gu_config.hpp"
+#include "gcomm/conf.hpp"
 
 #include <string>
 #include <vector>
@@ -15,8 +17,15 @@
 #include <cstdlib>
 #include <check.h>
 #include <string.h>
+#include <stdio.h>
+#include <errno.h>
 #include <unistd.h>
 
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif // HAVE_IO_URING
+
 // <using namespace gcomm;
 
 using std::string;
@@ -37,10 +46,46 @@ static GCommSuite suites[] = {
     {"", 0}
 };
 
+void check_gcomm_set_backend(gu::Config& conf)
+{
+    const char* const backend(::getenv("CHECK_GCOMM_PROTONET_BACKEND"));
+    if (backend) conf.set(gcomm::Conf::ProtonetBackend, backend);
+    const char* const io_threads(::getenv("CHECK_GCOMM_PROTONET_IO_THREADS"));
+    if (io_threads) conf.set(gcomm::Conf::ProtonetIoThreads, io_threads);
+}
+
+// Exit code which makes test harness report the test as skipped
+#define EXIT_SKIP 77
+
+// Returns false if io_uring backend was requested but io_uring_setup()
+// fails at runtime, e.g. blocked by seccomp or kernel.io_uring_disabled
+static bool check_gcomm_backend_available()
+{
+    const char* const backend(::getenv("CHECK_GCOMM_PROTONET_BACKEND"));
+    if (backend == 0 || strcmp(backend, "io_uring") != 0) return true;
+#ifdef HAVE_IO_URING
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int const fd(::syscall(__NR_io_uring_setup, 1, &p));
+    if (fd >= 0)
+    {
+        ::close(fd);
+        return true;
+    }
+    printf("io_uring_setup() failed: %s, skipping io_uring tests\n",
+           strerror(errno));
+#else
+    printf("io_uring support not compiled in, skipping io_uring tests\n");
+#endif // HAVE_IO_URING
+    return false;
+}
+
 #define LOG_FILE "check_gcomm_nondet.log"
 
 int main(int argc, char* argv[])
 {
+    if (!check_gcomm_backend_available()) return EXIT_SKIP;
+
     SRunner* sr = srunner_create(0);
     vector<string>* suits = 0;
     FILE* log_file(0);
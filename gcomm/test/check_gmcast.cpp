@@ -10,6 +10,7 @@
 #include "gmcast_message.hpp"
 
 #include "gu_asio.hpp" // gu::ssl_register_params()
+#include "gu_string_utils.hpp" // gu::strsplit()
 
 using namespace std;
 using namespace gcomm;
@@ -32,6 +33,7 @@ START_TEST(test_gmcast_multicast)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     Transport* gm1(Transport::create(*pnet, uri1));
 
@@ -156,6 +158,7 @@ START_TEST(test_gmcast_w_user_messages)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     mark_point();
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     mark_point();
@@ -259,6 +262,7 @@ START_TEST(test_gmcast_auto_addr)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     Transport* tp1 = Transport::create(*pnet, "gmcast://?gmcast.group=test");
     Transport* tp2 = Transport::create(*pnet, "gmcast://127.0.0.1:4567"
@@ -295,6 +299,7 @@ START_TEST(test_gmcast_forget)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     Transport* tp1 = Transport::create(*pnet, "gmcast://"
                     "?gmcast.group=test&gmcast.listen_addr=tcp://127.0.0.1:0");
@@ -358,6 +363,7 @@ START_TEST(test_trac_380)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     std::auto_ptr<gcomm::Protonet> pnet(gcomm::Protonet::create(conf));
 
     // caused either assertion or exception
@@ -392,6 +398,7 @@ START_TEST(test_trac_828)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     std::auto_ptr<gcomm::Protonet> pnet(gcomm::Protonet::create(conf));
 
     // If the bug is present, this will throw because of own address being
@@ -419,6 +426,7 @@ START_TEST(test_gmcast_ipv6)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     conf.set("base_host", "ip6-localhost");
     gu_log_max_level = GU_LOG_DEBUG;
     std::auto_ptr<gcomm::Protonet> pnet(gcomm::Protonet::create(conf));
@@ -478,6 +486,336 @@ START_TEST(test_gmcast_ipv6)
 }
 END_TEST
 
+// User of segment relay tree tests
+class SegmentTreeUser : public Toplay
+{
+    Transport* tp_;
+    size_t recvd_;
+    Protostack pstack_;
+    explicit SegmentTreeUser(const SegmentTreeUser&);
+    void operator=(SegmentTreeUser&);
+
+public:
+
+    SegmentTreeUser(Protonet& pnet, const std::string& remote_addr,
+                    size_t fanout) :
+        Toplay(pnet.conf()),
+        tp_(0),
+        recvd_(0),
+        pstack_()
+    {
+        tp_ = Transport::create(
+            pnet,
+            "gmcast://" + remote_addr + "?gmcast.group=testgrp"
+            "&gmcast.segment_fanout=" + gu::to_string(fanout) +
+            "&gmcast.listen_addr=tcp://127.0.0.1:0");
+        pstack_.push_proto(tp_);
+        pstack_.push_proto(this);
+        tp_->connect();
+    }
+
+    ~SegmentTreeUser()
+    {
+        pstack_.pop_proto(this);
+        pstack_.pop_proto(tp_);
+        tp_->close();
+        delete tp_;
+    }
+
+    void send()
+    {
+        byte_t buf[16];
+        memset(buf, 0xa5, sizeof(buf));
+        Datagram dg(Buffer(buf, buf + sizeof(buf)));
+        send_down(dg, ProtoDownMeta());
+    }
+
+    void handle_up(const void*, const Datagram&, const ProtoUpMeta&)
+    {
+        recvd_++;
+    }
+
+    size_t recvd() const { return recvd_; }
+
+    // number of established connections
+    size_t peers() const
+    {
+        gu::Status status;
+        tp_->get_status(status);
+        for (gu::Status::const_iterator i(status.begin());
+             i != status.end(); ++i)
+        {
+            if (i->first == "gmcast_peers" && i->second.empty() == false)
+            {
+                return std::count(i->second.begin(), i->second.end(),
+                                  ',') + 1;
+            }
+        }
+        return 0;
+    }
+
+    Protostack& pstack() { return pstack_; }
+    std::string listen_addr() const
+    {
+        return tp_->listen_addr().erase(0, strlen("tcp://"));
+    }
+};
+
+// Connects users with given segment fanouts into one segment, sends
+// messages from each in turn and checks that every message reaches every
+// other node. If exactly is true, no node may receive duplicates.
+static void segment_tree_send(const std::vector<size_t>& fanouts,
+                              bool exactly)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    const size_t n_users(fanouts.size());
+    std::vector<SegmentTreeUser*> users(n_users);
+    users[0] = new SegmentTreeUser(*pnet, "", fanouts[0]);
+    pnet->insert(&users[0]->pstack());
+    for (size_t i(1); i < n_users; ++i)
+    {
+        users[i] = new SegmentTreeUser(*pnet, users[0]->listen_addr(),
+                                       fanouts[i]);
+        pnet->insert(&users[i]->pstack());
+    }
+
+    // wait until all nodes are connected to each other
+    for (size_t i(0); i < n_users; )
+    {
+        pnet->event_loop(Sec/10);
+        for (i = 0; i < n_users && users[i]->peers() == n_users - 1; ++i) { }
+    }
+
+    const size_t n_msgs(100);
+    for (size_t m(0); m < n_msgs; ++m)
+    {
+        users[m % n_users]->send();
+        pnet->event_loop(Sec/100);
+    }
+    pnet->event_loop(Sec/2);
+
+    for (size_t i(0); i < n_users; ++i)
+    {
+        // own messages are not delivered back
+        const size_t expected(n_msgs - n_msgs/n_users);
+        ck_assert_msg(users[i]->recvd() == expected ||
+                      (exactly == false && users[i]->recvd() > expected),
+                      "user %zu received %zu messages", i, users[i]->recvd());
+    }
+
+    for (size_t i(0); i < n_users; ++i)
+    {
+        pnet->erase(&users[i]->pstack());
+        delete users[i];
+    }
+    pnet->event_loop(0);
+}
+
+// Messages are forwarded along relay tree within segment, each node
+// must receive every message exactly once
+START_TEST(test_gmcast_segment_tree)
+{
+    segment_tree_send(std::vector<size_t>(5, 2), true);
+}
+END_TEST
+
+// Relay tree is not used if some node does not announce support for it
+// in handshake, messages are sent directly to every node exactly once
+START_TEST(test_gmcast_segment_tree_not_supported)
+{
+    std::vector<size_t> fanouts(5, 2);
+    fanouts[3] = 0;
+    segment_tree_send(fanouts, true);
+}
+END_TEST
+
+// Nodes with different fan-out compute different tree, relaying nodes
+// must detect tree view mismatch and fall back to sending to all
+// segment peers so that every message reaches every node
+START_TEST(test_gmcast_segment_tree_view_mismatch)
+{
+    std::vector<size_t> fanouts(5, 2);
+    fanouts[1] = 1;
+    fanouts[3] = 3;
+    segment_tree_send(fanouts, false);
+}
+END_TEST
+
+// Tree view is carried in user messages with F_TREE_RELAY, but
+// F_TREE_RELAY capability flag does not change handshake message
+START_TEST(test_gmcast_tree_relay_message)
+{
+    const UUID uuid(1);
+    Message msg(0, Message::GMCAST_T_USER_BASE, uuid, 1, 0);
+    const size_t plain_size(msg.serial_size());
+    msg.set_flags(msg.flags() | Message::F_TREE_RELAY);
+    msg.set_tree_view(0xdeadbeef);
+    ck_assert(msg.serial_size() == plain_size + 4);
+
+    gu::Buffer buf(msg.serial_size());
+    ck_assert(msg.serialize(&buf[0], buf.size(), 0) == buf.size());
+    Message msg2;
+    ck_assert(msg2.unserialize(&buf[0], buf.size(), 0) == buf.size());
+    ck_assert(msg2.flags() & Message::F_TREE_RELAY);
+    ck_assert(msg2.tree_view() == 0xdeadbeef);
+    ck_assert(msg2.relay_root() == uuid);
+
+    Message hs(0, Message::GMCAST_T_HANDSHAKE, UUID(2), uuid, 0);
+    const size_t hs_size(hs.serial_size());
+    hs.set_flags(hs.flags() | Message::F_TREE_RELAY);
+    ck_assert(hs.serial_size() == hs_size);
+    buf.resize(hs.serial_size());
+    ck_assert(hs.serialize(&buf[0], buf.size(), 0) == buf.size());
+    Message hs2;
+    ck_assert(hs2.unserialize(&buf[0], buf.size(), 0) == buf.size());
+    ck_assert(hs2.flags() & Message::F_TREE_RELAY);
+}
+END_TEST
+
+// Per peer statistics in gmcast_peers status variable must account
+// messages sent and received over each connection and report RTT
+START_TEST(test_gmcast_peer_stats)
+{
+    class User : public Toplay
+    {
+        Transport* tp_;
+        size_t recvd_;
+        Protostack pstack_;
+        explicit User(const User&);
+        void operator=(User&);
+
+    public:
+
+        User(Protonet& pnet, const std::string& remote_addr) :
+            Toplay(pnet.conf()),
+            tp_(0),
+            recvd_(0),
+            pstack_()
+        {
+            tp_ = Transport::create(
+                pnet,
+                "gmcast://" + remote_addr + "?gmcast.group=testgrp"
+                "&gmcast.listen_addr=tcp://127.0.0.1:0");
+            pstack_.push_proto(tp_);
+            pstack_.push_proto(this);
+            tp_->connect();
+        }
+
+        ~User()
+        {
+            pstack_.pop_proto(this);
+            pstack_.pop_proto(tp_);
+            tp_->close();
+            delete tp_;
+        }
+
+        void send()
+        {
+            byte_t buf[16];
+            memset(buf, 0xa5, sizeof(buf));
+            Datagram dg(Buffer(buf, buf + sizeof(buf)));
+            send_down(dg, ProtoDownMeta());
+        }
+
+        void handle_up(const void*, const Datagram&, const ProtoUpMeta&)
+        {
+            recvd_++;
+        }
+
+        size_t recvd() const { return recvd_; }
+
+        // numeric fields of gmcast_peers status entry:
+        // rtt, jitter, sent_msgs, sent_bytes, recv_msgs, recv_bytes,
+        // send_queue_length, send_queue_bytes
+        std::vector<long long> peer_stats() const
+        {
+            std::vector<long long> ret;
+            gu::Status status;
+            tp_->get_status(status);
+            for (gu::Status::const_iterator i(status.begin());
+                 i != status.end(); ++i)
+            {
+                if (i->first == "gmcast_peers" && i->second.empty() == false)
+                {
+                    ck_assert_msg(i->second.find(',') == std::string::npos,
+                                  "more than one peer: %s",
+                                  i->second.c_str());
+                    // address contains ':', parse fields from the end
+                    const std::vector<std::string> fields(
+                        gu::strsplit(i->second, ':'));
+                    ck_assert(fields.size() > 8);
+                    for (size_t f(fields.size() - 8); f < fields.size(); ++f)
+                    {
+                        ret.push_back(gu::from_string<long long>(fields[f]));
+                    }
+                }
+            }
+            return ret;
+        }
+
+        Protostack& pstack() { return pstack_; }
+        std::string listen_addr() const
+        {
+            return tp_->listen_addr().erase(0, strlen("tcp://"));
+        }
+    };
+
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
+    auto_ptr<Protonet> pnet(Protonet::create(conf));
+
+    User u1(*pnet, "");
+    pnet->insert(&u1.pstack());
+    User u2(*pnet, u1.listen_addr());
+    pnet->insert(&u2.pstack());
+
+    while (u1.peer_stats().empty() || u2.peer_stats().empty())
+    {
+        pnet->event_loop(Sec/10);
+    }
+
+    const std::vector<long long> before1(u1.peer_stats());
+    const std::vector<long long> before2(u2.peer_stats());
+
+    // Run for several liveness check periods to get RTT samples
+    const size_t n_msgs(30);
+    for (size_t m(0); m < n_msgs; ++m)
+    {
+        u1.send();
+        pnet->event_loop(Sec/10);
+    }
+    pnet->event_loop(Sec/2);
+    ck_assert(u2.recvd() == n_msgs);
+
+    const std::vector<long long> after1(u1.peer_stats());
+    const std::vector<long long> after2(u2.peer_stats());
+
+    // Message counts may include keepalives
+    ck_assert_msg(after1[2] - before1[2] >= long(n_msgs),
+                  "u1 sent %lld msgs", after1[2] - before1[2]);
+    ck_assert(after1[3] - before1[3] >= long(n_msgs*16));
+    ck_assert_msg(after2[4] - before2[4] >= long(n_msgs),
+                  "u2 received %lld msgs", after2[4] - before2[4]);
+    ck_assert(after2[5] - before2[5] >= long(n_msgs*16));
+
+    // RTT is sampled on both ends, jitter is non-negative
+    ck_assert_msg(after1[0] > 0, "u1 rtt %lld", after1[0]);
+    ck_assert_msg(after2[0] > 0, "u2 rtt %lld", after2[0]);
+    ck_assert(after1[1] >= 0 && after2[1] >= 0);
+
+    pnet->erase(&u2.pstack());
+    pnet->erase(&u1.pstack());
+    pnet->event_loop(0);
+}
+END_TEST
+
 Suite* gmcast_suite()
 {
 
@@ -519,6 +857,30 @@ Suite* gmcast_suite()
     tcase_add_test(tc, test_gmcast_ipv6);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_gmcast_segment_tree");
+    tcase_add_test(tc, test_gmcast_segment_tree);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_segment_tree_not_supported");
+    tcase_add_test(tc, test_gmcast_segment_tree_not_supported);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_segment_tree_view_mismatch");
+    tcase_add_test(tc, test_gmcast_segment_tree_view_mismatch);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_tree_relay_message");
+    tcase_add_test(tc, test_gmcast_tree_relay_message);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_gmcast_peer_stats");
+    tcase_add_test(tc, test_gmcast_peer_stats);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
     return s;
 
 }
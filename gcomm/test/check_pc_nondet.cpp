@@ -119,6 +119,7 @@ START_TEST(test_pc_transport)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> net(Protonet::create(conf));
     PCUser2 pu1(*net,
                 "pc://?"
@@ -181,6 +182,7 @@ START_TEST(test_set_param)
     Protolay::sync_param_cb_t sync_param_cb;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> net(Protonet::create(conf));
     PCUser2 pu1(*net,
                 "pc://?"
@@ -252,6 +254,7 @@ START_TEST(test_trac_599)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     D d(conf);
     std::auto_ptr<gcomm::Protonet> pnet(gcomm::Protonet::create(conf));
     std::auto_ptr<gcomm::Transport> tp(
@@ -284,6 +287,7 @@ START_TEST(test_trac_620)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     auto_ptr<Protonet> net(Protonet::create(conf));
     Transport* tp(Transport::create(*net, "pc://?"
                                     "evs.info_log_mask=0xff&"
@@ -7,9 +7,12 @@
 #include "gcomm/datagram.hpp"
 #include "gcomm/conf.hpp"
 
+#include "spsc_queue.hpp"
+
 #include "check_gcomm.hpp"
 
 #include "gu_logger.hpp"
+#include "gu_threads.h"
 
 #include <vector>
 #include <fstream>
@@ -179,6 +182,66 @@ START_TEST(test_view_state)
 }
 END_TEST
 
+START_TEST(test_spsc_queue)
+{
+    gcomm::SpscQueue<int> q(3);
+    ck_assert(q.capacity() == 4);
+    ck_assert(q.empty() == true);
+
+    int val(0);
+    ck_assert(q.pop(val) == false);
+    for (int i(0); i < 4; ++i)
+    {
+        ck_assert(q.push(i) == true);
+    }
+    ck_assert(q.push(4) == false);
+    ck_assert(q.size() == 4);
+
+    // wrap around the ring
+    for (int i(0); i < 10; ++i)
+    {
+        ck_assert(q.pop(val) == true);
+        ck_assert(val == i);
+        ck_assert(q.push(i + 4) == true);
+    }
+    for (int i(10); i < 14; ++i)
+    {
+        ck_assert(q.pop(val) == true);
+        ck_assert(val == i);
+    }
+    ck_assert(q.empty() == true);
+}
+END_TEST
+
+static void* spsc_queue_producer(void* arg)
+{
+    gcomm::SpscQueue<size_t>& q(*static_cast<gcomm::SpscQueue<size_t>*>(arg));
+    for (size_t i(0); i < 1000000; )
+    {
+        if (q.push(i)) ++i;
+    }
+    return 0;
+}
+
+START_TEST(test_spsc_queue_threads)
+{
+    gcomm::SpscQueue<size_t> q(64);
+    gu_thread_t thd;
+    ck_assert(gu_thread_create(&thd, 0, &spsc_queue_producer, &q) == 0);
+    for (size_t i(0); i < 1000000; )
+    {
+        size_t val;
+        if (q.pop(val))
+        {
+            ck_assert_msg(val == i, "expected %zu got %zu", i, val);
+            ++i;
+        }
+    }
+    gu_thread_join(thd, 0);
+    ck_assert(q.empty() == true);
+}
+END_TEST
+
 
 Suite* util_suite()
 {
@@ -193,5 +256,14 @@ Suite* util_suite()
     tcase_add_test(tc, test_view_state);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_spsc_queue");
+    tcase_add_test(tc, test_spsc_queue);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_spsc_queue_threads");
+    tcase_add_test(tc, test_spsc_queue_threads);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
     return s;
 }
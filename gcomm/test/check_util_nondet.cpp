@@ -6,10 +6,12 @@
 #include "gcomm/protonet.hpp"
 #include "gcomm/datagram.hpp"
 #include "gcomm/conf.hpp"
+#include "gcomm/protostack.hpp"
 
 #include "check_gcomm.hpp"
 
 #include "gu_logger.hpp"
+#include "gu_serialize.hpp"
 
 #ifdef HAVE_ASIO_HPP
 #include "asio_protonet.hpp"
@@ -31,6 +33,160 @@ using gu::Exception;
 using gu::byte_t;
 using gu::Buffer;
 
+// Test datagram payload of varying length, filled with pattern derived
+// from sequence number
+static Buffer recv_test_payload(uint32_t const seq)
+{
+    Buffer buf(4 + (seq * 7919) % 3000);
+    gu::serialize4(seq, &buf[0], buf.size(), 0);
+    for (size_t i(4); i < buf.size(); ++i)
+    {
+        buf[i] = static_cast<byte_t>(seq + i);
+    }
+    return buf;
+}
+
+// Checks contents of delivered datagrams and holds every other one, so that
+// some receive buffers stay referenced while later datagrams are read
+class HoldingReceiver : public Toplay
+{
+public:
+    HoldingReceiver(gu::Config& conf)
+        : Toplay(conf), held_(), msgs_(0), errors_(0)
+    { }
+    void handle_up(const void*, const Datagram& dg, const ProtoUpMeta& um)
+    {
+        if (um.err_no() != 0 || dg.len() == 0) return;
+        if (!(dg.payload() == recv_test_payload(msgs_))) ++errors_;
+        if (msgs_ % 2 == 0) held_.push_back(dg);
+        ++msgs_;
+    }
+    vector<Datagram> held_;
+    uint32_t         msgs_;
+    size_t           errors_;
+};
+
+// Sends n_msgs test datagrams over TCP connection, burst datagrams at a
+// time, and checks that they are delivered in order and intact and that
+// the held ones are not overwritten by later reads
+static void recv_check(Protonet& pn, gu::Config& conf,
+                       uint32_t const n_msgs, uint32_t const burst)
+{
+    HoldingReceiver receiver(conf);
+    Protostack pstack;
+    pstack.push_proto(&receiver);
+    pn.insert(&pstack);
+
+    string uri_str("tcp://127.0.0.1:0");
+    Acceptor* acc = pn.acceptor(uri_str);
+    acc->listen(uri_str);
+    uri_str = acc->listen_addr();
+
+    SocketPtr cl = pn.socket(uri_str);
+    cl->connect(uri_str);
+    pn.event_loop(gu::datetime::Sec);
+
+    SocketPtr sr = acc->accept();
+    ck_assert(sr->state() == Socket::S_CONNECTED);
+    ck_assert(cl->state() == Socket::S_CONNECTED);
+
+    for (uint32_t sent(0); sent < n_msgs; )
+    {
+        for (uint32_t i(0); i < burst && sent < n_msgs; ++i, ++sent)
+        {
+            Datagram dg(recv_test_payload(sent));
+            ck_assert(cl->send(0, dg) == 0);
+        }
+        for (int i(0); i < 100 && receiver.msgs_ < sent; ++i)
+        {
+            pn.event_loop(gu::datetime::Sec/100);
+        }
+        ck_assert_msg(receiver.msgs_ == sent, "received %u, sent %u",
+                      receiver.msgs_, sent);
+    }
+    ck_assert_msg(receiver.errors_ == 0, "errors %zu", receiver.errors_);
+
+    for (size_t i(0); i < receiver.held_.size(); ++i)
+    {
+        ck_assert_msg(receiver.held_[i].payload() ==
+                      recv_test_payload(2*i),
+                      "held datagram %zu overwritten", 2*i);
+    }
+    receiver.held_.clear();
+
+    cl->close();
+    sr->close();
+    pn.event_loop(gu::datetime::Sec/10);
+    pn.erase(&pstack);
+    pstack.pop_proto(&receiver);
+    delete acc;
+}
+
+// Queues n_msgs test datagrams, many more than fit into one gathered
+// write by count or by bytes, and closes the sending socket while a write
+// is in flight. Checks that the close is deferred until all of them have
+// been written and that they are delivered in order and intact. Sender
+// and receiver run in separate protonets so that the receiver can be
+// kept from reading while the close is issued.
+static void write_check(Protonet& spn, Protonet& rpn, gu::Config& conf,
+                        uint32_t const n_msgs)
+{
+    HoldingReceiver receiver(conf);
+    Protostack pstack;
+    pstack.push_proto(&receiver);
+    rpn.insert(&pstack);
+
+    string uri_str("tcp://127.0.0.1:0");
+    Acceptor* acc = rpn.acceptor(uri_str);
+    acc->listen(uri_str);
+    uri_str = acc->listen_addr();
+
+    SocketPtr cl = spn.socket(uri_str);
+    cl->connect(uri_str);
+    spn.event_loop(gu::datetime::Sec/10);
+    rpn.event_loop(gu::datetime::Sec/10);
+
+    SocketPtr sr = acc->accept();
+    ck_assert(sr->state() == Socket::S_CONNECTED);
+    ck_assert(cl->state() == Socket::S_CONNECTED);
+
+    for (uint32_t i(0); i < n_msgs; ++i)
+    {
+        Datagram dg(recv_test_payload(i));
+        ck_assert(cl->send(0, dg) == 0);
+    }
+    // Receiver does not read, socket buffers fill up and write stays
+    // in flight
+    spn.event_loop(gu::datetime::Sec/10);
+    ck_assert(cl->stats().send_queue_length > 0);
+
+    cl->close();
+    ck_assert(cl->state() == Socket::S_CLOSING);
+
+    for (int i(0); i < 1000 && cl->state() != Socket::S_CLOSED; ++i)
+    {
+        spn.event_loop(gu::datetime::Sec/100);
+        rpn.event_loop(gu::datetime::Sec/100);
+    }
+    ck_assert_msg(cl->state() == Socket::S_CLOSED, "sender state %d",
+                  cl->state());
+
+    for (int i(0); i < 100 && receiver.msgs_ < n_msgs; ++i)
+    {
+        rpn.event_loop(gu::datetime::Sec/100);
+    }
+    ck_assert_msg(receiver.msgs_ == n_msgs, "received %u, sent %u",
+                  receiver.msgs_, n_msgs);
+    ck_assert_msg(receiver.errors_ == 0, "errors %zu", receiver.errors_);
+    receiver.held_.clear();
+
+    sr->close();
+    rpn.event_loop(gu::datetime::Sec/10);
+    rpn.erase(&pstack);
+    pstack.pop_proto(&receiver);
+    delete acc;
+}
+
 #if defined(HAVE_ASIO_HPP)
 START_TEST(test_asio)
 {
@@ -68,6 +224,167 @@ START_TEST(test_asio)
 
 }
 END_TEST
+
+// Checks that datagrams read by I/O threads are delivered in order
+class IoThreadsReceiver : public Toplay
+{
+public:
+    IoThreadsReceiver(gu::Config& conf) : Toplay(conf), msgs_(0), errors_(0)
+    { }
+    void handle_up(const void*, const Datagram& dg, const ProtoUpMeta& um)
+    {
+        if (um.err_no() != 0 || dg.len() == 0) return;
+        uint32_t seq(msgs_ + 1);
+        if (dg.len() >= sizeof(seq))
+        {
+            gu::unserialize4(dg.payload().data(), dg.len(), 0, seq);
+        }
+        if (seq != msgs_) ++errors_;
+        ++msgs_;
+    }
+    uint32_t msgs_;
+    size_t   errors_;
+};
+
+START_TEST(test_asio_io_threads)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    conf.set(gcomm::Conf::ProtonetIoThreads, 2);
+    AsioProtonet pn(conf);
+    IoThreadsReceiver receiver(conf);
+    Protostack pstack;
+    pstack.push_proto(&receiver);
+    pn.insert(&pstack);
+
+    string uri_str("tcp://127.0.0.1:0");
+    Acceptor* acc = pn.acceptor(uri_str);
+    acc->listen(uri_str);
+    uri_str = acc->listen_addr();
+
+    SocketPtr cl = pn.socket(uri_str);
+    cl->connect(uri_str);
+    pn.event_loop(gu::datetime::Sec);
+
+    SocketPtr sr = acc->accept();
+    ck_assert(sr->state() == Socket::S_CONNECTED);
+    ck_assert(cl->state() == Socket::S_CONNECTED);
+
+    // More messages than fit into receive queue at once
+    const uint32_t n_msgs(5000);
+    vector<byte_t> buf(512);
+    for (uint32_t i(0); i < n_msgs; ++i)
+    {
+        gu::serialize4(i, &buf[0], buf.size(), 0);
+        Datagram dg(Buffer(&buf[0], &buf[0] + buf.size()));
+        ck_assert(cl->send(0, dg) == 0);
+    }
+    for (int i(0); i < 100 && receiver.msgs_ < n_msgs; ++i)
+    {
+        pn.event_loop(gu::datetime::Sec/10);
+    }
+    ck_assert_msg(receiver.msgs_ == n_msgs, "received %u", receiver.msgs_);
+    ck_assert_msg(receiver.errors_ == 0, "errors %zu", receiver.errors_);
+    ck_assert(sr->stats().recv_msgs == long(n_msgs));
+
+    cl->close();
+    sr->close();
+    pn.event_loop(gu::datetime::Sec/10);
+    pn.erase(&pstack);
+    pstack.pop_proto(&receiver);
+    delete acc;
+}
+END_TEST
+
+// Checks that datagrams sent in a burst larger than one sendmmsg() batch
+// are all delivered
+START_TEST(test_asio_udp_batch)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    AsioProtonet pn(conf);
+    IoThreadsReceiver receiver(conf);
+    Protostack pstack;
+    pstack.push_proto(&receiver);
+    pn.insert(&pstack);
+
+    // Socket sends to its own address, find a free port for it
+    unsigned short port;
+    {
+        asio::io_service io;
+        asio::ip::udp::socket s(
+            io, asio::ip::udp::endpoint(
+                asio::ip::address::from_string("127.0.0.1"), 0));
+        port = s.local_endpoint().port();
+    }
+    const string uri_str("udp://127.0.0.1:" + gu::to_string(port));
+    SocketPtr sock(pn.socket(uri_str));
+    sock->connect(uri_str);
+    ck_assert(sock->state() == Socket::S_CONNECTED);
+
+    const uint32_t n_msgs(100);
+    vector<byte_t> buf(64);
+    for (uint32_t i(0); i < n_msgs; ++i)
+    {
+        gu::serialize4(i, &buf[0], buf.size(), 0);
+        Datagram dg(Buffer(&buf[0], &buf[0] + buf.size()));
+        ck_assert(sock->send(0, dg) == 0);
+    }
+    ck_assert(sock->stats().send_queue_length == long(n_msgs));
+    for (int i(0); i < 100 && receiver.msgs_ < n_msgs; ++i)
+    {
+        pn.event_loop(gu::datetime::Sec/10);
+    }
+    ck_assert_msg(receiver.msgs_ == n_msgs, "received %u", receiver.msgs_);
+    ck_assert_msg(receiver.errors_ == 0, "errors %zu", receiver.errors_);
+    ck_assert(sock->stats().send_queue_length == 0);
+    ck_assert(sock->stats().dropped_msgs == 0);
+
+    sock->close();
+    pn.event_loop(gu::datetime::Sec/10);
+    pn.erase(&pstack);
+    pstack.pop_proto(&receiver);
+}
+END_TEST
+
+// Checks that datagrams held by upper layers stay intact while receive
+// buffers of released ones are reused for later reads
+START_TEST(test_asio_recv_hold)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    AsioProtonet pn(conf);
+    recv_check(pn, conf, 100, 1);
+}
+END_TEST
+
+// Checks that partial messages left over at the end of a read are
+// completed by following reads
+START_TEST(test_asio_recv_compaction)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    AsioProtonet pn(conf);
+    recv_check(pn, conf, 2000, 2000);
+}
+END_TEST
+
+// Checks gathered writes of long send queue and close deferred until the
+// queue has been written
+START_TEST(test_asio_write_gather)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    AsioProtonet spn(conf);
+    AsioProtonet rpn(conf);
+    write_check(spn, rpn, conf, 6000);
+}
+END_TEST
 #endif // HAVE_ASIO_HPP
 
 START_TEST(test_protonet)
@@ -75,6 +392,7 @@ START_TEST(test_protonet)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
     mark_point();
     Protonet* pn(Protonet::create(conf));
     ck_assert(pn != NULL);
@@ -84,6 +402,35 @@ START_TEST(test_protonet)
 }
 END_TEST
 
+// Receive checks above with the configured protonet backend
+START_TEST(test_protonet_recv)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
+    Protonet* pn(Protonet::create(conf));
+    recv_check(*pn, conf, 100, 1);
+    recv_check(*pn, conf, 2000, 2000);
+    delete pn;
+}
+END_TEST
+
+// Write check above with the configured protonet backend
+START_TEST(test_protonet_write)
+{
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    gcomm::Conf::register_params(conf);
+    check_gcomm_set_backend(conf);
+    Protonet* spn(Protonet::create(conf));
+    Protonet* rpn(Protonet::create(conf));
+    write_check(*spn, *rpn, conf, 6000);
+    delete spn;
+    delete rpn;
+}
+END_TEST
+
 
 Suite* util_nondet_suite()
 {
@@ -94,10 +441,29 @@ Suite* util_nondet_suite()
     tc = tcase_create("test_asio");
     tcase_add_test(tc, test_asio);
     suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_asio_io_threads");
+    tcase_add_test(tc, test_asio_io_threads);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_asio_udp_batch");
+    tcase_add_test(tc, test_asio_udp_batch);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_asio_recv");
+    tcase_add_test(tc, test_asio_recv_hold);
+    tcase_add_test(tc, test_asio_recv_compaction);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_asio_write_gather");
+    tcase_add_test(tc, test_asio_write_gather);
+    suite_add_tcase(s, tc);
 #endif // HAVE_ASIO_HPP
 
     tc = tcase_create("test_protonet");
     tcase_add_test(tc, test_protonet);
+    tcase_add_test(tc, test_protonet_recv);
+    tcase_add_test(tc, test_protonet_write);
     suite_add_tcase(s, tc);
 
 
@@ -0,0 +1,575 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark EVS and PC protocols in a simulated cluster.
+ * The real evs::Proto and pc::Proto stacks of all nodes run in a single
+ * thread on top of an in-memory network driven by simulated clock, so
+ * the results are deterministic for a given set of parameters and do not
+ * depend on the speed of the host.
+ *
+ * Each link between two nodes has one way latency and bandwidth, and
+ * datagrams sent over a link may be dropped with given probability.
+ * Each node runs a number of clients which send one message at a time
+ * and wait until the message is delivered back to the node before
+ * sending the next one. Optionally the last node is partitioned from
+ * the rest of the cluster and the partition is healed later.
+ *
+ * Reported are messages delivered per second per node, latency from
+ * send to safe delivery over all nodes, and time it took to form the
+ * primary component after joining, partition and heal.
+ *
+ * Usage: cluster_sim_bench [key=value ...]
+ *
+ * nodes=3         number of nodes
+ * seconds=10      simulated time to run after all nodes have joined
+ * clients=16      clients per node
+ * size=128        message payload size in bytes
+ * latency=500     one way link latency in microseconds
+ * bandwidth=1000  link bandwidth in Mbit/s, zero for unlimited
+ * loss=0          fraction of datagrams dropped
+ * partition=0     seconds after start to partition the last node
+ * heal=0          seconds after start to heal the partition
+ * seed=1          random seed for datagram loss
+ *
+ * Other keys are passed to gcomm configuration, e.g. evs.send_window=8
+ * or evs.suspect_timeout=PT1S.
+ */
+
+#include "evs_proto.hpp"
+#include "pc_proto.hpp"
+
+#include "gcomm/conf.hpp"
+#include "gcomm/util.hpp"
+
+#include "gu_asio.hpp" // gu::ssl_register_params()
+#include "gu_datetime.hpp"
+#include "gu_serialize.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <cstdlib>
+
+using namespace gcomm;
+
+namespace
+{
+    using gu::datetime::Date;
+    using gu::datetime::Sec;
+    using gu::datetime::MSec;
+    using gu::datetime::USec;
+
+    struct Params
+    {
+        Params()
+            : nodes(3), seconds(10), clients(16), size(128),
+              latency(500*USec), bandwidth(1000), loss(0),
+              partition(0), heal(0), seed(1)
+        { }
+        size_t    nodes;
+        long long seconds;
+        size_t    clients;
+        size_t    size;
+        long long latency;
+        long long bandwidth; // Mbit/s
+        double    loss;
+        long long partition;
+        long long heal;
+        unsigned  seed;
+    };
+
+    class SimNet;
+
+    // Bottom of the node protocol stack, passes datagrams to SimNet
+    class SimTransport : public Protolay
+    {
+    public:
+        SimTransport(gu::Config& conf, SimNet& net, size_t index)
+            : Protolay(conf), net_(net), index_(index)
+        { }
+        int handle_down(Datagram& dg, const ProtoDownMeta& dm);
+        void handle_up(const void* id, const Datagram& dg,
+                       const ProtoUpMeta& um)
+        {
+            send_up(dg, um);
+        }
+    private:
+        SimNet& net_;
+        size_t  index_;
+    };
+
+    // Top of the node protocol stack, runs clients and collects stats
+    class SimNode : public Toplay
+    {
+    public:
+        SimNode(gu::Config& conf, SimNet& net, size_t index,
+                const Params& params);
+        ~SimNode();
+
+        void connect(bool first)
+        {
+            pc_.connect(first);
+            evs_.connect(first);
+        }
+        void handle_up(const void* id, const Datagram& dg,
+                       const ProtoUpMeta& um);
+        // Passes incoming datagram to the stack
+        void receive(const Datagram& dg, const UUID& source)
+        {
+            transport_.handle_up(0, dg, ProtoUpMeta(source));
+        }
+        // Sends from idle clients, handles expired timers and returns
+        // time of the next timer
+        Date run();
+
+        const UUID& uuid() const { return uuid_; }
+        size_t prim_members() const { return prim_members_; }
+        std::vector<long long>& latencies() { return latencies_; }
+        size_t delivered() const { return delivered_; }
+        void reset_stats() { latencies_.clear(); delivered_ = 0; }
+
+    private:
+        struct Client
+        {
+            Client() : busy(false), seq(0) { }
+            bool     busy;
+            uint32_t seq;
+        };
+
+        SimNet&                net_;
+        size_t                 index_;
+        UUID                   uuid_;
+        SimTransport           transport_;
+        evs::Proto             evs_;
+        pc::Proto              pc_;
+        std::vector<Client>    clients_;
+        size_t                 size_;
+        size_t                 prim_members_;
+        std::vector<long long> latencies_;
+        size_t                 delivered_;
+    };
+
+    class SimNet
+    {
+    public:
+        SimNet(gu::Config& conf, const Params& params)
+            : params_(params),
+              nodes_(),
+              links_(params.nodes*params.nodes, Link()),
+              events_(),
+              seed_(params.seed),
+              timers_(params.nodes, 0)
+        {
+            for (size_t i(0); i < params_.nodes; ++i)
+            {
+                nodes_.push_back(new SimNode(conf, *this, i, params_));
+            }
+        }
+
+        ~SimNet()
+        {
+            for (size_t i(0); i < nodes_.size(); ++i) delete nodes_[i];
+        }
+
+        // Connects node to the network and starts its protocol stack,
+        // the nodes which have not been started yet remain disconnected
+        void connect(size_t index, bool first)
+        {
+            for (size_t i(0); i < index; ++i)
+            {
+                link(index, i).connected = true;
+                link(i, index).connected = true;
+            }
+            nodes_[index]->connect(first);
+            timers_[index] = nodes_[index]->run().get_utc();
+        }
+
+        void send(size_t from, const Datagram& dg);
+
+        // Connects or disconnects links between node and the other nodes
+        void set_connected(size_t index, bool connected)
+        {
+            for (size_t i(0); i < nodes_.size(); ++i)
+            {
+                if (i == index) continue;
+                link(index, i).connected = connected;
+                link(i, index).connected = connected;
+            }
+        }
+
+        // Runs until given time
+        void run_until(long long until);
+
+        // Runs until given nodes are in primary component of given
+        // size and returns the time it took in nanoseconds
+        long long run_until_prim(size_t first, size_t last, size_t members,
+                                 long long timeout);
+
+        SimNode& node(size_t i) { return *nodes_[i]; }
+        size_t n_nodes() const { return nodes_.size(); }
+
+        static long long now() { return Date::monotonic().get_utc(); }
+
+    private:
+        SimNet(const SimNet&);
+        void operator=(const SimNet&);
+
+        struct Link
+        {
+            Link() : connected(false), busy_until(0) { }
+            bool      connected;
+            long long busy_until; // time when the link is free to transmit
+        };
+
+        struct Delivery
+        {
+            Delivery(size_t to_, const UUID& from_, const Datagram& dg_)
+                : to(to_), from(from_), dg(dg_) { }
+            size_t   to;
+            UUID     from;
+            Datagram dg;
+        };
+
+        Link& link(size_t from, size_t to)
+        {
+            return links_[from*params_.nodes + to];
+        }
+
+        // Processes events and timers due at the next point of time
+        // if it is not later than until, returns false otherwise
+        bool step(long long until);
+
+        const Params&                       params_;
+        std::vector<SimNode*>               nodes_;
+        std::vector<Link>                   links_;
+        // Events with the same time are processed in insertion order
+        std::multimap<long long, Delivery>  events_;
+        unsigned                            seed_;
+        // Time of the next timer of each node
+        std::vector<long long>              timers_;
+    };
+
+    int SimTransport::handle_down(Datagram& dg, const ProtoDownMeta& dm)
+    {
+        net_.send(index_, dg);
+        return 0;
+    }
+
+    SimNode::SimNode(gu::Config& conf, SimNet& net, size_t index,
+                     const Params& params)
+        : Toplay       (conf),
+          net_         (net),
+          index_       (index),
+          uuid_        (static_cast<int32_t>(index + 1)),
+          transport_   (conf, net, index),
+          evs_         (conf, uuid_, 0),
+          pc_          (conf, uuid_, 0),
+          clients_     (params.clients),
+          size_        (std::max(params.size, size_t(20))),
+          prim_members_(0),
+          latencies_   (),
+          delivered_   (0)
+    {
+        gcomm::connect(&transport_, &evs_);
+        gcomm::connect(&evs_, &pc_);
+        gcomm::connect(&pc_, this);
+    }
+
+    SimNode::~SimNode()
+    {
+        gcomm::disconnect(&pc_, this);
+        gcomm::disconnect(&evs_, &pc_);
+        gcomm::disconnect(&transport_, &evs_);
+    }
+
+    void SimNode::handle_up(const void* id, const Datagram& dg,
+                            const ProtoUpMeta& um)
+    {
+        if (um.has_view())
+        {
+            const View& view(um.view());
+            prim_members_ = (view.type() == V_PRIM ? view.members().size() : 0);
+            // Messages in flight may be lost in view change
+            for (size_t i(0); i < clients_.size(); ++i)
+            {
+                clients_[i].busy = false;
+            }
+            return;
+        }
+
+        const gu::byte_t* const buf(gcomm::begin(dg));
+        size_t const buflen(gcomm::available(dg));
+        uint64_t sent;
+        uint32_t node, client, seq;
+        size_t off(gu::unserialize8(buf, buflen, 0, sent));
+        off = gu::unserialize4(buf, buflen, off, node);
+        off = gu::unserialize4(buf, buflen, off, client);
+        off = gu::unserialize4(buf, buflen, off, seq);
+
+        latencies_.push_back(SimNet::now() - static_cast<long long>(sent));
+        ++delivered_;
+
+        if (node == index_ && client < clients_.size() &&
+            clients_[client].seq == seq)
+        {
+            clients_[client].busy = false;
+        }
+    }
+
+    Date SimNode::run()
+    {
+        // Clients are run outside of handle_up() to avoid reentering
+        // the stack from delivery
+        for (size_t i(0); i < clients_.size() && prim_members_ > 0; ++i)
+        {
+            Client& c(clients_[i]);
+            if (c.busy) continue;
+
+            gu::Buffer buf(size_);
+            size_t off(gu::serialize8(uint64_t(SimNet::now()),
+                                      &buf[0], buf.size(), 0));
+            off = gu::serialize4(uint32_t(index_), &buf[0], buf.size(), off);
+            off = gu::serialize4(uint32_t(i), &buf[0], buf.size(), off);
+            off = gu::serialize4(c.seq + 1, &buf[0], buf.size(), off);
+            Datagram dg(buf);
+            if (send_down(dg, ProtoDownMeta(0)) != 0) break;
+            c.busy = true;
+            ++c.seq;
+        }
+
+        Date const evs_next(evs_.handle_timers());
+        Date const pc_next(pc_.handle_timers());
+        return (evs_next < pc_next ? evs_next : pc_next);
+    }
+
+    void SimNet::send(size_t from, const Datagram& dg)
+    {
+        long long const now(SimNet::now());
+        long long const tx_time(params_.bandwidth > 0 ?
+                                (long long)(dg.len())*8*1000
+                                / params_.bandwidth : 0);
+        for (size_t to(0); to < nodes_.size(); ++to)
+        {
+            if (to == from) continue;
+            Link& l(link(from, to));
+            if (l.connected == false) continue;
+            // Dropped datagrams consume bandwidth too
+            l.busy_until = std::max(l.busy_until, now) + tx_time;
+            if (params_.loss > 0 &&
+                double(::rand_r(&seed_))/RAND_MAX < params_.loss)
+            {
+                continue;
+            }
+            events_.insert(std::make_pair(
+                               l.busy_until + params_.latency,
+                               Delivery(to, nodes_[from]->uuid(), dg)));
+        }
+    }
+
+    bool SimNet::step(long long until)
+    {
+        long long next(events_.empty() ? Date::max().get_utc() :
+                       events_.begin()->first);
+        for (size_t i(0); i < timers_.size(); ++i)
+        {
+            next = std::min(next, timers_[i]);
+        }
+        if (next > until) return false;
+
+        long long const now(SimNet::now());
+        if (next > now) gu::datetime::SimClock::inc_time(next - now);
+
+        while (events_.empty() == false && events_.begin()->first <= next)
+        {
+            Delivery d(events_.begin()->second);
+            events_.erase(events_.begin());
+            nodes_[d.to]->receive(d.dg, d.from);
+            timers_[d.to] = nodes_[d.to]->run().get_utc();
+        }
+
+        for (size_t i(0); i < nodes_.size(); ++i)
+        {
+            if (timers_[i] <= next)
+            {
+                timers_[i] = nodes_[i]->run().get_utc();
+            }
+        }
+        return true;
+    }
+
+    void SimNet::run_until(long long until)
+    {
+        while (step(until)) { }
+        long long const now(SimNet::now());
+        if (until > now) gu::datetime::SimClock::inc_time(until - now);
+    }
+
+    long long SimNet::run_until_prim(size_t first, size_t last,
+                                     size_t members, long long timeout)
+    {
+        long long const start(now());
+        for (;;)
+        {
+            bool done(true);
+            for (size_t i(first); i <= last && done; ++i)
+            {
+                done = (nodes_[i]->prim_members() == members);
+            }
+            if (done) return (now() - start);
+            if (now() - start > timeout || step(start + timeout) == false)
+            {
+                gu_throw_fatal << "primary component of " << members
+                               << " nodes was not formed in "
+                               << timeout/Sec << " seconds";
+            }
+        }
+    }
+
+    double ms(long long nsecs) { return double(nsecs)/MSec; }
+
+    void print_latencies(std::vector<long long>& lat)
+    {
+        if (lat.empty())
+        {
+            std::cout << "no messages delivered\n";
+            return;
+        }
+        std::sort(lat.begin(), lat.end());
+        double const p[] = { 50, 90, 99, 99.9 };
+        std::cout << "safe delivery latency ms:";
+        for (size_t i(0); i < sizeof(p)/sizeof(p[0]); ++i)
+        {
+            size_t const idx(size_t(double(lat.size() - 1)*p[i]/100));
+            std::cout << " p" << p[i] << " " << ms(lat[idx]);
+        }
+        std::cout << " max " << ms(lat.back()) << '\n';
+    }
+
+    void parse_arg(gu::Config& conf, Params& params, const std::string& arg)
+    {
+        size_t const eq(arg.find('='));
+        if (eq == std::string::npos)
+        {
+            gu_throw_error(EINVAL) << "invalid argument '" << arg << "'";
+        }
+        std::string const key(arg.substr(0, eq));
+        std::string const val(arg.substr(eq + 1));
+        long long const n(::atoll(val.c_str()));
+        if      (key == "nodes")     params.nodes     = n;
+        else if (key == "seconds")   params.seconds   = n;
+        else if (key == "clients")   params.clients   = n;
+        else if (key == "size")      params.size      = n;
+        else if (key == "latency")   params.latency   = n*USec;
+        else if (key == "bandwidth") params.bandwidth = n;
+        else if (key == "loss")      params.loss      = ::atof(val.c_str());
+        else if (key == "partition") params.partition = n*Sec;
+        else if (key == "heal")      params.heal      = n*Sec;
+        else if (key == "seed")      params.seed      = n;
+        else
+        {
+            try
+            {
+                conf.set(key, val);
+            }
+            catch (gu::NotFound&)
+            {
+                gu_throw_error(EINVAL) << "unknown parameter '" << key << "'";
+            }
+        }
+    }
+
+    void run(gu::Config& conf, const Params& params)
+    {
+        long long const timeout(300*Sec);
+        SimNet net(conf, params);
+
+        // Nodes join one by one as in real cluster startup
+        long long join_time(0);
+        for (size_t i(0); i < net.n_nodes(); ++i)
+        {
+            net.connect(i, i == 0);
+            join_time += net.run_until_prim(0, i, i + 1, timeout);
+        }
+        std::cout << "join: " << ms(join_time) << " ms\n";
+
+        for (size_t i(0); i < net.n_nodes(); ++i) net.node(i).reset_stats();
+
+        long long const start(SimNet::now());
+        long long const end(start + params.seconds*Sec);
+        size_t const last(net.n_nodes() - 1);
+        if (params.partition > 0 && last > 0)
+        {
+            net.run_until(start + params.partition);
+            net.set_connected(last, false);
+            std::cout << "partition: "
+                      << ms(net.run_until_prim(0, last - 1, last, timeout))
+                      << " ms\n";
+            if (params.heal > params.partition)
+            {
+                net.run_until(start + params.heal);
+                net.set_connected(last, true);
+                std::cout << "heal: "
+                          << ms(net.run_until_prim(0, last, last + 1,
+                                                   timeout))
+                          << " ms\n";
+            }
+        }
+        net.run_until(end);
+
+        long long const elapsed(SimNet::now() - start);
+        std::vector<long long> lat;
+        size_t delivered(0);
+        for (size_t i(0); i < net.n_nodes(); ++i)
+        {
+            SimNode& n(net.node(i));
+            delivered += n.delivered();
+            lat.insert(lat.end(), n.latencies().begin(), n.latencies().end());
+        }
+        std::cout << "delivered: " << delivered/net.n_nodes()
+                  << " msgs/node, "
+                  << size_t(double(delivered)/net.n_nodes()
+                            /(double(elapsed)/Sec))
+                  << " msgs/s\n";
+        print_latencies(lat);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        // Must be initialized before protocol objects are created
+        gu::datetime::SimClock::init(100*Sec);
+
+        gu::Config conf;
+        gu::ssl_register_params(conf);
+        Conf::register_params(conf);
+
+        Params params;
+        for (int i(1); i < argc; ++i)
+        {
+            parse_arg(conf, params, argv[i]);
+        }
+        if (params.nodes == 0)
+        {
+            gu_throw_error(EINVAL) << "nodes must be positive";
+        }
+
+        std::cout << "nodes: " << params.nodes
+                  << " clients: " << params.clients
+                  << " size: " << params.size
+                  << " latency: " << params.latency/USec << " us"
+                  << " bandwidth: " << params.bandwidth << " Mbit/s"
+                  << " loss: " << params.loss << '\n';
+        run(conf, params);
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark EVS input map insert and delivery rates with
+ * different number of nodes. Messages from all nodes are inserted in
+ * windows, after each window the messages are made safe and delivered
+ * and erased from the input map head like evs::Proto::deliver() does.
+ *
+ * Usage: evs_input_map_bench [messages per node] [window]
+ */
+
+#include "evs_input_map2.hpp"
+#include "evs_message2.hpp"
+
+#include "gu_datetime.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+
+using namespace gcomm;
+using namespace gcomm::evs;
+
+static double elapsed(const gu::datetime::Date& start,
+                      const gu::datetime::Date& stop)
+{
+    return double(stop.get_utc() - start.get_utc())/gu::datetime::Sec;
+}
+
+static void run_bench(size_t const n_nodes, seqno_t const n_seqnos,
+                      seqno_t const window)
+{
+    std::vector<UUID> uuids;
+    for (size_t i(0); i < n_nodes; ++i)
+    {
+        uuids.push_back(UUID(static_cast<int32_t>(i + 1)));
+    }
+    ViewId const view(V_REG, uuids[0], 1);
+    gu::Buffer const payload(128, 0);
+    Datagram const dg(payload);
+
+    InputMap im;
+    im.reset(n_nodes);
+
+    double insert_time(0), deliver_time(0);
+    size_t delivered(0);
+
+    for (seqno_t seq(0); seq < n_seqnos; seq += window)
+    {
+        seqno_t const last(std::min(seq + window, n_seqnos) - 1);
+
+        gu::datetime::Date const t0(gu::datetime::Date::monotonic());
+        for (seqno_t s(seq); s <= last; ++s)
+        {
+            for (size_t i(0); i < n_nodes; ++i)
+            {
+                (void)im.insert(i, UserMessage(0, uuids[i], view, s), dg);
+            }
+        }
+
+        gu::datetime::Date const t1(gu::datetime::Date::monotonic());
+        for (size_t i(0); i < n_nodes; ++i)
+        {
+            im.set_safe_seq(i, last);
+        }
+        InputMap::iterator i;
+        while ((i = im.begin()) != im.end() && im.is_safe(i) == true)
+        {
+            // touch message like delivery does
+            if (InputMapMsgIndex::value(i).msg().seq() > last) abort();
+            im.erase(i);
+            ++delivered;
+        }
+        gu::datetime::Date const t2(gu::datetime::Date::monotonic());
+
+        insert_time  += elapsed(t0, t1);
+        deliver_time += elapsed(t1, t2);
+    }
+
+    if (delivered != n_nodes*size_t(n_seqnos)) abort();
+
+    std::cout << n_nodes << '\t'
+              << size_t(double(delivered)/insert_time)  << '\t'
+              << size_t(double(delivered)/deliver_time) << '\n';
+}
+
+int main(int argc, char* argv[])
+{
+    seqno_t const n_seqnos(argc > 1 ? ::atol(argv[1]) : 100000);
+    seqno_t const window  (argc > 2 ? ::atol(argv[2]) : 16);
+
+    std::cout << "nodes\tinsert/s\tdeliver+erase/s\n";
+
+    size_t const nodes[] = { 3, 9, 32 };
+    for (size_t n(0); n < sizeof(nodes)/sizeof(nodes[0]); ++n)
+    {
+        run_bench(nodes[n], n_seqnos, window);
+    }
+
+    return 0;
+}
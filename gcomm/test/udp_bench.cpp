@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark datagram rate through UDP socket. The socket sends
+ * bursts of datagrams to its own address and the received datagrams are
+ * counted after each burst has been sent, as with multicast group where
+ * the sender also receives its own messages.
+ *
+ * Usage: udp_bench [uri] [seconds] [burst] [payload size]
+ *
+ * Multicast loopback:
+ * udp_bench 'udp://239.192.0.11:10099?socket.if_addr=127.0.0.1&socket.if_loop=true'
+ */
+
+#include "gcomm/protonet.hpp"
+#include "gcomm/protostack.hpp"
+#include "gcomm/conf.hpp"
+#include "socket.hpp"
+
+#include "gu_asio.hpp"
+#include "gu_crc32c.h" // gu_crc32c_configure()
+#include "gu_datetime.hpp"
+
+#include <iostream>
+#include <memory>
+#include <cstdlib>
+
+using namespace gcomm;
+
+class Receiver : public Toplay
+{
+public:
+    Receiver(gu::Config& conf) : Toplay(conf), received_(0) { }
+    void handle_up(const void*, const Datagram&, const ProtoUpMeta&)
+    {
+        ++received_;
+    }
+    size_t received() const { return received_; }
+private:
+    size_t received_;
+};
+
+int main(int argc, char* argv[])
+{
+    std::string const uri_str(argc > 1 ? argv[1] : "udp://127.0.0.1:10099");
+    long const secs (argc > 2 ? ::atol(argv[2]) : 5);
+    long const burst(argc > 3 ? ::atol(argv[3]) : 64);
+    size_t const size(argc > 4 ? ::atol(argv[4]) : 128);
+
+    gu_crc32c_configure();
+
+    gu::Config conf;
+    gu::ssl_register_params(conf);
+    Conf::register_params(conf);
+    conf.set(Conf::ProtonetBackend, "asio");
+
+    std::auto_ptr<Protonet> pnet(Protonet::create(conf));
+    Receiver receiver(conf);
+    Protostack pstack;
+    pstack.push_proto(&receiver);
+    pnet->insert(&pstack);
+
+    gu::URI const uri(uri_str);
+    SocketPtr socket(pnet->socket(uri));
+    socket->connect(uri);
+
+    gu::Buffer const payload(size);
+    size_t sent(0), dropped(0);
+    gu::datetime::Date const start(gu::datetime::Date::monotonic());
+    gu::datetime::Date const stop(start + secs*gu::datetime::Sec);
+    gu::datetime::Date now(start);
+    while (now < stop)
+    {
+        for (long i(0); i < burst; ++i)
+        {
+            Datagram dg(payload);
+            if (socket->send(0, dg) == 0) ++sent; else ++dropped;
+        }
+        pnet->event_loop(100*gu::datetime::USec);
+        now = gu::datetime::Date::monotonic();
+    }
+    // collect datagrams in flight
+    pnet->event_loop(100*gu::datetime::MSec);
+    now = gu::datetime::Date::monotonic();
+
+    double const elapsed(double((now - start).get_nsecs())/gu::datetime::Sec);
+    std::cout << "sent: " << sent
+              << " dropped: " << dropped
+              << " received: " << receiver.received()
+              << " sent/s: " << size_t(double(sent)/elapsed)
+              << " received/s: " << size_t(double(receiver.received())/elapsed)
+              << '\n';
+
+    socket->close();
+    pnet->erase(&pstack);
+    pstack.pop_proto(&receiver);
+    return 0;
+}
@@ -15,14 +15,19 @@
 #include <errno.h>
 #include <assert.h>
 
+#include <new> // std::nothrow
+
 #include <galerautils.h>
 #include "gu_debug_sync.hpp"
+#include "gu_exception.hpp"
 
 #include "gcs_priv.hpp"
 #include "gcs_params.hpp"
 #include "gcs_fc.hpp"
+#include "gcs_fc_stats.hpp"
 #include "gcs_seqno.hpp"
 #include "gcs_core.hpp"
+#include "gcs_defrag_pool.hpp"
 #include "gcs_fifo_lite.hpp"
 #include "gcs_sm.hpp"
 #include "gcs_gcache.hpp"
@@ -96,11 +101,15 @@ static bool const GCS_FC_CONT = false;
 /** Flow control message */
 struct gcs_fc_event
 {
-    uint32_t conf_id; // least significant part of configuraiton seqno
-    uint32_t stop;    // boolean value
+    uint32_t conf_id;   // least significant part of configuraiton seqno
+    uint32_t stop;      // boolean value
+    uint32_t queue_len; // sender's slave queue length (GCS protocol 1+)
 }
 __attribute__((__packed__));
 
+/** Size of flow control message in GCS protocol 0 (no queue_len) */
+static size_t const GCS_FC_EVENT_V0_SIZE = 2 * sizeof(uint32_t);
+
 struct gcs_conn
 {
     long  my_idx;
@@ -172,6 +181,7 @@ struct gcs_conn
     long         stats_fc_stop_sent;  // FC stats counters
     long         stats_fc_cont_sent;  //
     long         stats_fc_received;   //
+    gcs_fc_stats_t* fc_stats;         // FC attribution and timeline
     gcs_fc_t     stfc; // state transfer FC object
 
     /* #603, #606 join control */
@@ -212,10 +222,12 @@ struct gcs_repl_act
     struct gcs_action*   action;
     gu_mutex_t           wait_mutex;
     gu_cond_t            wait_cond;
+    long                 batch_ret; // error set by batch leader
     gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action)
       :
         act_in(a_act_in),
-        action(a_action)
+        action(a_action),
+        batch_ret(0)
     { }
 };
 
@@ -288,12 +300,21 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
 
     conn->state = GCS_CONN_DESTROYED;
     conn->core  = gcs_core_create (conf, gcache, node_name, inc_addr,
+                                   conn->params.proto_max,
                                    repl_proto_ver, appl_proto_ver);
     if (!conn->core) {
         gu_error ("Failed to create core.");
         goto core_create_failed;
     }
 
+    if (gcs_core_set_defrag_threads (conn->core, conn->params.defrag_threads))
+    {
+        gu_warn ("Failed to start %ld defragmentation threads, fragments "
+                 "will be copied by the receiving thread.",
+                 conn->params.defrag_threads);
+        conn->params.defrag_threads = 0;
+    }
+
     conn->repl_q = gcs_fifo_lite_create (GCS_MAX_REPL_THREADS,
                                          sizeof (struct gcs_repl_act*));
     if (!conn->repl_q) {
@@ -327,6 +348,13 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto sm_create_failed;
     }
 
+    conn->fc_stats = new (std::nothrow) gcs_fc_stats_t;
+
+    if (!conn->fc_stats) {
+        gu_error ("Failed to create FC stats");
+        goto fc_stats_create_failed;
+    }
+
     conn->state        = GCS_CONN_CLOSED;
     conn->my_idx       = -1;
     conn->local_act_id = GCS_SEQNO_FIRST;
@@ -341,6 +369,10 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
 
     return conn; // success
 
+fc_stats_create_failed:
+
+    gcs_sm_destroy (conn->sm);
+
 sm_create_failed:
 
     gu_fifo_destroy (conn->recv_q);
@@ -412,8 +444,11 @@ gcs_check_error (int err, const char* warning)
 static inline long
 gcs_send_fc_event (gcs_conn_t* conn, bool stop)
 {
-    struct gcs_fc_event fc  = { htogl(conn->conf_id), stop };
-    return gcs_core_send_fc (conn->core, &fc, sizeof(fc));
+    struct gcs_fc_event fc  = { htogl(conn->conf_id), stop,
+                                htogl(uint32_t(conn->queue_len)) };
+    size_t const fc_size(gcs_core_group_protocol_version(conn->core) >= 1 ?
+                         sizeof(fc) : GCS_FC_EVENT_V0_SIZE);
+    return gcs_core_send_fc (conn->core, &fc, fc_size);
 }
 
 /* To be called under slave queue lock. Returns true if FC_STOP must be sent */
@@ -864,7 +899,9 @@ _set_fc_limits (gcs_conn_t* conn)
  *  (this is frequent, so leave it inlined) */
 static inline void
 gcs_handle_flow_control (gcs_conn_t*                conn,
-                         const struct gcs_fc_event* fc)
+                         const struct gcs_fc_event* fc,
+                         size_t                     fc_size,
+                         int                        sender_idx)
 {
     if (gtohl(fc->conf_id) != (uint32_t)conn->conf_id) {
         // obsolete fc request
@@ -874,6 +911,10 @@ gcs_handle_flow_control (gcs_conn_t*                conn,
     conn->stop_count += ((fc->stop != 0) << 1) - 1; // +1 if !0, -1 if 0
     conn->stats_fc_received += (fc->stop != 0);
 
+    long const queue_len(fc_size >= sizeof(*fc) ?
+                         long(gtohl(fc->queue_len)) : -1);
+    gcs_fc_stats_event (conn->fc_stats, sender_idx, fc->stop != 0, queue_len);
+
     if (1 == conn->stop_count) {
         gcs_sm_pause (conn->sm);    // first STOP request
     }
@@ -945,10 +986,14 @@ gcs_handle_act_conf (gcs_conn_t* conn, const void* action)
             // Count the number of non-arb members, this will be
             // used for the fc_limit calculations
             long    non_arb_memb_count = 0;
+            std::vector<std::string> memb_ids;
+            std::vector<std::string> memb_names;
             const char *  ptr = &conf->data[0];
             for (long i=0; i < conf->memb_num; i++)
             {
+                memb_ids.push_back(ptr);
                 ptr += strlen(ptr) + 1;     // move past the ID
+                memb_names.push_back(ptr);
                 ptr += strlen(ptr) + 1;     // move past the name
                 if (*ptr)                   // 0-length IP addr indicates an ARB
                     non_arb_memb_count += 1;
@@ -957,6 +1002,8 @@ gcs_handle_act_conf (gcs_conn_t* conn, const void* action)
             }
             conn->non_arb_memb_count = non_arb_memb_count;
 
+            gcs_fc_stats_conf (conn->fc_stats, memb_ids, memb_names);
+
             _set_fc_limits (conn);
 
             gu_mutex_unlock (&conn->fc_lock);
@@ -1112,8 +1159,9 @@ gcs_handle_actions (gcs_conn_t*          conn,
 
     switch (rcvd->act.type) {
     case GCS_ACT_FLOW:
-        assert (sizeof(struct gcs_fc_event) == rcvd->act.buf_len);
-        gcs_handle_flow_control (conn, (const gcs_fc_event*)rcvd->act.buf);
+        assert (GCS_FC_EVENT_V0_SIZE <= size_t(rcvd->act.buf_len));
+        gcs_handle_flow_control (conn, (const gcs_fc_event*)rcvd->act.buf,
+                                 rcvd->act.buf_len, rcvd->sender_idx);
         break;
     case GCS_ACT_CONF:
         gcs_handle_act_conf (conn, rcvd->act.buf);
@@ -1623,6 +1671,8 @@ long gcs_destroy (gcs_conn_t *conn)
     /* This must not last for long */
     while (gu_mutex_destroy (&conn->fc_lock));
 
+    delete conn->fc_stats;
+
     _cleanup_params (conn);
 
     gu_free (conn);
@@ -1674,6 +1724,134 @@ long gcs_caused(gcs_conn_t* conn, gcs_seqno_t& seqno)
     return gcs_core_caused(conn->core, seqno);
 }
 
+/*! Whether action may be batched with other concurrently replicated ones */
+static inline bool
+_batch_eligible (const gcs_conn_t* const conn, const struct gcs_action* const act)
+{
+    return (conn->params.max_batch_len > 1 &&
+            GCS_ACT_TORDERED == act->type  &&
+            act->size < conn->params.max_packet_size);
+}
+
+/*! Claims actions queued in send monitor to be sent in a batch with the
+ *  leader's one. Must be called from within send monitor.
+ *  @return number of claimed actions */
+static long
+_batch_claim (gcs_conn_t*          const conn,
+              struct gcs_repl_act*       claimed[],
+              ssize_t              const leader_size)
+{
+    long const max_len(std::min<long>(conn->params.max_batch_len,
+                                      GCS_CORE_BATCH_MAX) - 1);
+    if (max_len <= 0 || !gcs_core_batch_supported(conn->core)) return 0;
+
+    void* batch[GCS_CORE_BATCH_MAX];
+    long const len(gcs_sm_claim (conn->sm, batch, max_len,
+                                 conn->params.max_packet_size - leader_size,
+                                 conn->params.batch_window));
+
+    for (long i(0); i < len; ++i) {
+        claimed[i] = static_cast<struct gcs_repl_act*>(batch[i]);
+    }
+
+    return len;
+}
+
+/*! Wakes up claimed actions' threads that are not going to be delivered */
+static void
+_batch_fail (struct gcs_repl_act* const claimed[], long const len, long const err)
+{
+    assert (err < 0);
+
+    for (long i(0); i < len; ++i) {
+        struct gcs_repl_act* const repl_act(claimed[i]);
+        gu_mutex_lock   (&repl_act->wait_mutex);
+        repl_act->batch_ret = err;
+        gu_cond_signal  (&repl_act->wait_cond);
+        gu_mutex_unlock (&repl_act->wait_mutex);
+    }
+}
+
+/*! Queues actions for delivery and sends them as a single batch if there is
+ *  more than one. Must be called from within send monitor.
+ *  @return the size of the first action or negative error code */
+static long
+_repl_send (gcs_conn_t*                const conn,
+            struct gcs_repl_act* const batch[],
+            long                       const batch_len)
+{
+    const struct gcs_action* const act(batch[0]->action);
+    long ret;
+    long queued(0);
+
+    // some hack here to achieve one if() instead of two:
+    // ret = -EAGAIN part is a workaround for #569
+    // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
+    // ret will be -ENOTCONN
+    if ((ret = -EAGAIN,
+         conn->upper_limit >= conn->queue_len ||
+         act->type         != GCS_ACT_TORDERED)         &&
+        (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state))
+    {
+        struct gcs_repl_act** act_ptr;
+
+        while (queued < batch_len &&
+               (act_ptr = (struct gcs_repl_act**)
+                gcs_fifo_lite_get_tail (conn->repl_q)))
+        {
+            *act_ptr = batch[queued++];
+            gcs_fifo_lite_push_tail (conn->repl_q);
+        }
+
+        if (queued < batch_len) {
+            ret = -ENOTCONN;
+        }
+        else if (1 == batch_len) {
+            // Keep on trying until something else comes out
+            while ((ret = gcs_core_send (conn->core, batch[0]->act_in,
+                                         act->size, act->type)) == -ERESTART) {}
+        }
+        else {
+            const struct gu_buf* acts[GCS_CORE_BATCH_MAX];
+            size_t               sizes[GCS_CORE_BATCH_MAX];
+
+            for (long i(0); i < batch_len; ++i) {
+                acts[i]  = batch[i]->act_in;
+                sizes[i] = batch[i]->action->size;
+            }
+
+            while ((ret = gcs_core_send_batch (conn->core, acts, sizes,
+                                               batch_len, act->type))
+                   == -ERESTART) {}
+
+            if (ret > 0) ret = act->size;
+        }
+
+        if (ret < 0) {
+            /* remove items from the queue, they will never be delivered */
+            if (queued == batch_len) {
+                gu_warn ("Send action {%p, %zd, %s} (batch of %ld) "
+                         "returned %d (%s)",
+                         act->buf, act->size, gcs_act_type_to_str(act->type),
+                         batch_len, ret, strerror(-ret));
+            }
+
+            while (queued--) {
+                if (!gcs_fifo_lite_remove (conn->repl_q)) {
+                    gu_fatal ("Failed to remove unsent item from repl_q");
+                    assert(0);
+                    ret = -ENOTRECOVERABLE;
+                }
+            }
+        }
+        else {
+            assert (ret == (ssize_t)act->size);
+        }
+    }
+
+    return ret;
+}
+
 /* Puts action in the send queue and returns after it is replicated */
 long gcs_replv (gcs_conn_t*          const conn,      //!<in
                 const struct gu_buf* const act_in,    //!<in
@@ -1700,100 +1878,97 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
      * we need to lock a mutex before we can go wait for signal */
     if (!(ret = gu_mutex_lock (&repl_act.wait_mutex)))
     {
+//#ifndef NDEBUG
+        const void* const orig_buf = act->buf;
+//#endif
+        bool const batch(_batch_eligible (conn, act));
+
         // Lock here does the following:
         // 1. serializes gcs_core_send() access between gcs_repl() and
         //    gcs_send()
         // 2. avoids race with gcs_close() and gcs_destroy()
-        if (!(ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled, true)))
+        if (batch) {
+            ret = gcs_sm_enter_batch (conn->sm, &repl_act.wait_cond, scheduled,
+                                      &repl_act, act->size);
+        }
+        else {
+            ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled, true);
+        }
+
+        if (!ret)
         {
-            struct gcs_repl_act** act_ptr;
+            struct gcs_repl_act* batch_act[GCS_CORE_BATCH_MAX];
+            long batch_len(1);
 
-//#ifndef NDEBUG
-            const void* const orig_buf = act->buf;
-//#endif
+            batch_act[0] = &repl_act;
 
-            // some hack here to achieve one if() instead of two:
-            // ret = -EAGAIN part is a workaround for #569
-            // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
-            // ret will be -ENOTCONN
-            if ((ret = -EAGAIN,
-                 conn->upper_limit >= conn->queue_len ||
-                 act->type         != GCS_ACT_TORDERED)         &&
-                (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state) &&
-                (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
-            {
-                *act_ptr = &repl_act;
-                gcs_fifo_lite_push_tail (conn->repl_q);
-
-                // Keep on trying until something else comes out
-                while ((ret = gcs_core_send (conn->core, act_in, act->size,
-                                             act->type)) == -ERESTART) {}
-
-                if (ret < 0) {
-                    /* remove item from the queue, it will never be delivered */
-                    gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
-                             act->buf, act->size,gcs_act_type_to_str(act->type),
-                             ret, strerror(-ret));
-
-                    if (!gcs_fifo_lite_remove (conn->repl_q)) {
-                        gu_fatal ("Failed to remove unsent item from repl_q");
-                        assert(0);
-                        ret = -ENOTRECOVERABLE;
-                    }
-                }
-                else {
-                    assert (ret == (ssize_t)act->size);
-                }
-            }
+            if (batch) batch_len += _batch_claim (conn, batch_act + 1,
+                                                  act->size);
+
+            ret = _repl_send (conn, batch_act, batch_len);
 
             gcs_sm_leave (conn->sm);
 
+            if (gu_unlikely(ret < 0 && batch_len > 1)) {
+                _batch_fail (batch_act + 1, batch_len - 1, ret);
+            }
+
             assert(ret);
+        }
+        else if (-EALREADY == ret)
+        {
+            /* action was claimed and is being sent by the batch leader */
+            ret = act->size;
+        }
 
-            /* now we can go waiting for action delivery */
-            if (ret >= 0) {
-                gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
+        /* now we can go waiting for action delivery */
+        if (ret >= 0) {
+            gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
+
+            if (gu_unlikely(repl_act.batch_ret < 0))
+            {
+                /* batch leader failed to send the action */
+                ret = repl_act.batch_ret;
+                goto out;
+            }
 #ifndef GCS_FOR_GARB
-                /* assert (act->buf != 0); */
-                if (act->buf == 0)
-                {
-                    /* Recv thread purged repl_q before action was delivered */
-                    ret = -ENOTCONN;
-                    goto out;
-                }
+            /* assert (act->buf != 0); */
+            if (act->buf == 0)
+            {
+                /* Recv thread purged repl_q before action was delivered */
+                ret = -ENOTCONN;
+                goto out;
+            }
 #else
-                assert (act->buf == 0);
+            assert (act->buf == 0);
 #endif /* GCS_FOR_GARB */
 
-                if (act->seqno_g < 0) {
-                    assert (GCS_SEQNO_ILL    == act->seqno_l ||
-                            GCS_ACT_TORDERED != act->type);
-
-                    if (act->seqno_g == GCS_SEQNO_ILL) {
-                        /* action was not replicated for some reason */
-                        assert (orig_buf == act->buf);
-                        ret = -EINTR;
-                    }
-                    else {
-                        /* core provided an error code in global seqno */
-                        assert (orig_buf != act->buf);
-                        ret = act->seqno_g;
-                        act->seqno_g = GCS_SEQNO_ILL;
-                    }
-
-                    if (orig_buf != act->buf) // action was allocated in gcache
-                    {
-                        gu_debug("Freeing gcache buffer %p after receiving %d",
-                                 act->buf, ret);
-                        gcs_gcache_free (conn->gcache, act->buf);
-                        act->buf = orig_buf;
-                    }
+            if (act->seqno_g < 0) {
+                assert (GCS_SEQNO_ILL    == act->seqno_l ||
+                        GCS_ACT_TORDERED != act->type);
+
+                if (act->seqno_g == GCS_SEQNO_ILL) {
+                    /* action was not replicated for some reason */
+                    assert (orig_buf == act->buf);
+                    ret = -EINTR;
+                }
+                else {
+                    /* core provided an error code in global seqno */
+                    assert (orig_buf != act->buf);
+                    ret = act->seqno_g;
+                    act->seqno_g = GCS_SEQNO_ILL;
+                }
+
+                if (orig_buf != act->buf) // action was allocated in gcache
+                {
+                    gu_debug("Freeing gcache buffer %p after receiving %d",
+                             act->buf, ret);
+                    gcs_gcache_free (conn->gcache, act->buf);
+                    act->buf = orig_buf;
                 }
             }
         }
-#ifndef GCS_FOR_GARB
     out:
-#endif /* GCS_FOR_GARB */
         gu_mutex_unlock  (&repl_act.wait_mutex);
     }
     gu_mutex_destroy (&repl_act.wait_mutex);
@@ -2141,6 +2316,7 @@ gcs_flush_stats(gcs_conn_t* conn)
     conn->stats_fc_stop_sent = 0;
     conn->stats_fc_cont_sent = 0;
     conn->stats_fc_received  = 0;
+    gcs_fc_stats_flush (conn->fc_stats);
 }
 
 extern void
@@ -2161,6 +2337,8 @@ void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
 #endif
         gcs_core_get_status(conn->core, status);
     }
+
+    gcs_fc_stats_get_status(conn->fc_stats, status);
 }
 
 static long
@@ -2359,6 +2537,70 @@ _set_max_throttle (gcs_conn_t* conn, const char* value)
     }
 }
 
+static long
+_set_max_batch_len (gcs_conn_t* conn, const char* value)
+{
+    long long   len;
+    const char* const endptr = gu_str2ll (value, &len);
+
+    if (len >= 1 && len <= GCS_CORE_BATCH_MAX && *endptr == '\0') {
+
+        if (len == conn->params.max_batch_len) return 0;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_MAX_BATCH_LEN, len);
+        conn->params.max_batch_len = len;
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
+static long
+_set_batch_window (gcs_conn_t* conn, const char* value)
+{
+    try {
+        gu::datetime::Period const window(value);
+
+        if (window.get_nsecs() < 0) return -EINVAL;
+
+        if (window.get_nsecs() == conn->params.batch_window) return 0;
+
+        gu_config_set_string (conn->config, GCS_PARAMS_BATCH_WINDOW, value);
+        conn->params.batch_window = window.get_nsecs();
+
+        return 0;
+    }
+    catch (gu::Exception& e) {
+        return -EINVAL;
+    }
+}
+
+static long
+_set_defrag_threads (gcs_conn_t* conn, const char* value)
+{
+    long long   threads;
+    const char* const endptr = gu_str2ll (value, &threads);
+
+    if (threads >= 0 && threads <= GCS_DEFRAG_POOL_MAX && *endptr == '\0') {
+
+        if (threads == conn->params.defrag_threads) return 0;
+
+        /* thread pool can be started only before connection is opened */
+        long const ret = gcs_core_set_defrag_threads (conn->core, threads);
+        if (ret) return ret;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_DEFRAG_THREADS, threads);
+        conn->params.defrag_threads = threads;
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
 bool gcs_register_params (gu_config_t* const conf)
 {
     return (gcs_params_register (conf) | gcs_core_register (conf));
@@ -2390,6 +2632,15 @@ long gcs_param_set  (gcs_conn_t* conn, const char* key, const char *value)
     else if (!strcmp (key, GCS_PARAMS_MAX_THROTTLE)) {
         return _set_max_throttle (conn, value);
     }
+    else if (!strcmp (key, GCS_PARAMS_MAX_BATCH_LEN)) {
+        return _set_max_batch_len (conn, value);
+    }
+    else if (!strcmp (key, GCS_PARAMS_BATCH_WINDOW)) {
+        return _set_batch_window (conn, value);
+    }
+    else if (!strcmp (key, GCS_PARAMS_DEFRAG_THREADS)) {
+        return _set_defrag_threads (conn, value);
+    }
 #ifdef GCS_SM_DEBUG
     else if (!strcmp (key, GCS_PARAMS_SM_DUMP)) {
         gcs_sm_dump_state(conn->sm, stderr);
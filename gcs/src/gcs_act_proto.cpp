@@ -14,18 +14,21 @@
 
   Version 0 header structure
 
-bytes: 00 01                07 08       11 12       15 16       19 20
+bytes: 00 01                07 08       11 12       15 16 17 18 19 20
       +--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+---
-      |PV|      act_id        |  act_size |  frag_no  |AT|reserved|  data...
+      |PV|      act_id        |  act_size |  frag_no  |AT|rs| BL  |  data...
       +--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+--+---
 
 PV - protocol version
 AT - action type
+BL - number of actions batched in the message, 0 if the message carries
+     a single action (GCS protocol 2 and above, always 0 before that)
 
 */
 
 static const size_t PROTO_PV_OFFSET       = 0;
 static const size_t PROTO_AT_OFFSET       = 16;
+static const size_t PROTO_BL_OFFSET       = 18;
 static const size_t PROTO_DATA_OFFSET     = 20;
 // static const size_t PROTO_ACT_ID_OFFSET   = 0;
 // static const size_t PROTO_ACT_SIZE_OFFSET = 8;
@@ -70,9 +73,12 @@ gcs_act_proto_write (gcs_act_frag_t* frag, void* buf, size_t buf_len)
 
     ((uint8_t *)buf)[PROTO_PV_OFFSET] = frag->proto_ver;
     ((uint8_t *)buf)[PROTO_AT_OFFSET] = frag->act_type;
+    *(uint16_t*)((uint8_t*)buf + PROTO_BL_OFFSET) =
+        htogs((uint16_t)frag->batch_len);
 
     frag->frag     = (uint8_t*)buf + PROTO_DATA_OFFSET;
     frag->frag_len = buf_len - PROTO_DATA_OFFSET;
+    frag->msg      = NULL;
 
     return 0;
 }
@@ -104,6 +110,7 @@ gcs_act_proto_read (gcs_act_frag_t* frag, const void* buf, size_t buf_len)
     frag->frag_no  = gtohl  (((uint32_t*)buf)[3]);
     frag->act_type = static_cast<gcs_act_type_t>(
         ((uint8_t*)buf)[PROTO_AT_OFFSET]);
+    frag->batch_len = gtohs(*(uint16_t*)((uint8_t*)buf + PROTO_BL_OFFSET));
     frag->frag     = ((uint8_t*)buf) + PROTO_DATA_OFFSET;
     frag->frag_len = buf_len - PROTO_DATA_OFFSET;
 
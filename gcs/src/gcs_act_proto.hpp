@@ -20,6 +20,8 @@ typedef uint8_t gcs_proto_t;
 /*! Supported protocol range (for now only version 0 is supported) */
 #define GCS_ACT_PROTO_MAX 0
 
+struct gcs_recv_msg;
+
 /*! Internal action fragment data representation */
 typedef struct gcs_act_frag
 {
@@ -30,6 +32,9 @@ typedef struct gcs_act_frag
     unsigned long  frag_no;
     gcs_act_type_t act_type;
     int            proto_ver;
+    int            batch_len; // number of actions in a batch, 0 if not batched
+    struct gcs_recv_msg* msg; // message holding the fragment, may be NULL.
+                              // See gcs_defrag_pool_copy()
 }
 gcs_act_frag_t;
 
@@ -24,6 +24,8 @@
 
 #include <string.h> // for mempcpy
 #include <errno.h>
+#include <algorithm> // std::min
+#include <vector>
 
 bool
 gcs_core_register (gu_config_t* conf)
@@ -34,6 +36,22 @@ gcs_core_register (gu_config_t* conf)
 const size_t CORE_FIFO_LEN = (1 << 10); // 1024 elements (no need to have more)
 const size_t CORE_INIT_BUF_SIZE = (1 << 16); // 65K - IP packet size
 
+/* batched action being delivered, see core_batch_next() */
+typedef struct core_batch
+{
+    const uint8_t*       buf;        // batch payload (all actions)
+    size_t               size;       // payload size
+    size_t               offset;     // offset of the next action in payload
+    gcs_seqno_t          id;         // seqno of the next action or error code
+    gcs_act_type_t       type;
+    int                  sender_idx;
+    int                  len;        // number of actions in the batch
+    int                  next;       // index of the next action
+    bool                 local;      // own batch, local buffers are known
+    const struct gu_buf* local_act[GCS_CORE_BATCH_MAX];
+}
+core_batch_t;
+
 typedef enum core_state
 {
     CORE_PRIMARY,
@@ -68,6 +86,7 @@ struct gcs_core
 
     /* recv part */
     gcs_recv_msg_t  recv_msg;
+    core_batch_t    batch;     // batch being delivered
 
     /* local action FIFO */
     gcs_fifo_lite_t* fifo;
@@ -91,6 +110,8 @@ typedef struct core_act
     gcs_seqno_t sent_act_id;
     const void* action;
     size_t      action_size;
+    const struct gu_buf* const* batch; // batched actions if any
+    int         batch_len;
 }
 core_act_t;
 
@@ -102,17 +123,38 @@ typedef struct causal_act
     gu_cond_t*   cond;
 } causal_act_t;
 
-static int const GCS_PROTO_MAX = 0;
+/*! GCS protocol versions:
+ *  0 - original
+ *  1 - flow control events carry sender's slave queue length
+ *  2 - several actions can be batched in a single action message
+ *  Action fragments are still written in GCS_ACT_PROTO_MAX format.
+ *  Versions above 0 are used only if allowed by gcs.proto_max. */
+static int const GCS_PROTO_MAX = GCS_CORE_PROTO_MAX;
+
+/*! First protocol version that supports action batching */
+static int const GCS_PROTO_BATCH = 2;
+
+/*! Every action in a batch is prefixed by its size */
+static size_t const CORE_BATCH_HDR_SIZE = sizeof(uint32_t);
+
+/*! Action protocol version to use in the current group protocol */
+static inline int
+core_act_proto_ver (const gcs_core_t* const core)
+{
+    return std::min<int>(core->proto_ver, GCS_ACT_PROTO_MAX);
+}
 
 gcs_core_t*
 gcs_core_create (gu_config_t* const conf,
                  gcache_t*    const cache,
                  const char*  const node_name,
                  const char*  const inc_addr,
+                 int          const gcs_proto_ver,
                  int          const repl_proto_ver,
                  int          const appl_proto_ver)
 {
     assert (conf);
+    assert (gcs_proto_ver >= 0 && gcs_proto_ver <= GCS_PROTO_MAX);
 
     gcs_core_t* core = GU_CALLOC (1, gcs_core_t);
 
@@ -138,7 +180,7 @@ gcs_core_create (gu_config_t* const conf,
                     gu_mutex_init  (&core->send_lock, NULL);
                     core->proto_ver = -1; // shall be bumped in gcs_group_act_conf()
                     gcs_group_init (&core->group, cache, node_name, inc_addr,
-                                    GCS_PROTO_MAX, repl_proto_ver,
+                                    gcs_proto_ver, repl_proto_ver,
                                     appl_proto_ver);
                     core->state = CORE_CLOSED;
                     core->send_act_no = 1; // 0 == no actions sent
@@ -300,17 +342,19 @@ core_msg_send_retry (gcs_core_t*    core,
     return ret;
 }
 
-ssize_t
-gcs_core_send (gcs_core_t*          const conn,
-               const struct gu_buf* const action,
-               size_t                     act_size,
-               gcs_act_type_t       const act_type)
+static ssize_t
+core_send_act (gcs_core_t*                 const conn,
+               const struct gu_buf*        const action,
+               size_t                            act_size,
+               gcs_act_type_t              const act_type,
+               const struct gu_buf* const* const batch,
+               int                         const batch_len)
 {
     ssize_t        ret  = 0;
     ssize_t        sent = 0;
     gcs_act_frag_t frg;
     ssize_t        send_size;
-    const unsigned char proto_ver = conn->proto_ver;
+    const unsigned char proto_ver = core_act_proto_ver(conn);
     const ssize_t  hdr_size       = gcs_act_proto_hdr_size (proto_ver);
 
     core_act_t*    local_act;
@@ -330,12 +374,14 @@ gcs_core_send (gcs_core_t*          const conn,
     frg.act_id    = conn->send_act_no; /* incremented for every new action */
     frg.frag_no   = 0;
     frg.proto_ver = proto_ver;
+    frg.batch_len = batch_len;
 
     if ((ret = gcs_act_proto_write (&frg, conn->send_buf, conn->send_buf_len)))
         return ret;
 
     if ((local_act = (core_act_t*)gcs_fifo_lite_get_tail (conn->fifo))) {
-        *local_act = (core_act_t){ conn->send_act_no, action, act_size };
+        *local_act = (core_act_t){ conn->send_act_no, action, act_size,
+                                   batch, batch_len };
         gcs_fifo_lite_push_tail (conn->fifo);
     }
     else {
@@ -457,6 +503,66 @@ out:
     return ret;
 }
 
+ssize_t
+gcs_core_send (gcs_core_t*          const conn,
+               const struct gu_buf* const action,
+               size_t               const act_size,
+               gcs_act_type_t       const act_type)
+{
+    return core_send_act (conn, action, act_size, act_type, NULL, 0);
+}
+
+ssize_t
+gcs_core_send_batch (gcs_core_t*                 const conn,
+                     const struct gu_buf* const* const acts,
+                     const size_t*               const act_sizes,
+                     int                         const batch_len,
+                     gcs_act_type_t              const act_type)
+{
+    assert (batch_len > 0);
+
+    if (gu_unlikely(batch_len > GCS_CORE_BATCH_MAX)) return -EMSGSIZE;
+
+    /* protocol could have been downgraded by configuration change */
+    if (gu_unlikely(conn->proto_ver < GCS_PROTO_BATCH)) return -EAGAIN;
+
+    /* gather batch payload: each action is prefixed by its size */
+    uint32_t                   hdr[GCS_CORE_BATCH_MAX];
+    std::vector<struct gu_buf> bufs;
+    bufs.reserve (2 * batch_len);
+
+    size_t size = 0;
+
+    for (int i = 0; i < batch_len; ++i) {
+        assert (act_sizes[i] > 0);
+
+        hdr[i] = htog32 (act_sizes[i]);
+        struct gu_buf const hdr_buf = { &hdr[i], sizeof(hdr[i]) };
+        bufs.push_back (hdr_buf);
+
+        ssize_t left = act_sizes[i];
+        for (int j = 0; left > 0; ++j) {
+            bufs.push_back (acts[i][j]);
+            left -= acts[i][j].size;
+        }
+        assert (0 == left);
+
+        size += CORE_BATCH_HDR_SIZE + act_sizes[i];
+    }
+
+    if (gu_unlikely(size > GCS_MAX_ACT_SIZE)) return -EMSGSIZE;
+
+    ssize_t ret = core_send_act (conn, &bufs[0], size, act_type,
+                                 acts, batch_len);
+
+    if (gu_likely(ret > 0)) {
+        assert (size_t(ret) == size);
+        ret -= batch_len * CORE_BATCH_HDR_SIZE;
+    }
+
+    return ret;
+}
+
 /* A helper for gcs_core_recv().
  * Deals with fetching complete message from backend
  * and reallocates recv buf if needed */
@@ -500,6 +606,118 @@ core_msg_recv (gcs_backend_t* backend, gcs_recv_msg_t* recv_msg,
     return ret;
 }
 
+/*!
+ * Helper for gcs_core_recv(). Extracts the next action from the batch being
+ * delivered into a separately allocated buffer.
+ *
+ * @return action size or negative error code.
+ */
+static ssize_t
+core_batch_next (gcs_core_t* const core, struct gcs_act_rcvd* const act)
+{
+    core_batch_t* const batch(&core->batch);
+    ssize_t size;
+
+    assert (batch->next < batch->len);
+
+#ifndef GCS_FOR_GARB
+    uint32_t hdr;
+
+    if (gu_unlikely(batch->size - batch->offset < CORE_BATCH_HDR_SIZE)) {
+        gu_fatal ("Batched action %d/%d header is out of batch bounds: "
+                  "offset %zu, batch size %zu", batch->next, batch->len,
+                  batch->offset, batch->size);
+        return -ENOTRECOVERABLE;
+    }
+
+    memcpy (&hdr, batch->buf + batch->offset, sizeof(hdr));
+    size = gtoh32 (hdr);
+    batch->offset += CORE_BATCH_HDR_SIZE;
+
+    if (gu_unlikely(0 == size ||
+                    (size_t)size > batch->size - batch->offset)) {
+        gu_fatal ("Batched action %d/%d of size %zd is out of batch bounds: "
+                  "offset %zu, batch size %zu", batch->next, batch->len,
+                  size, batch->offset, batch->size);
+        return -ENOTRECOVERABLE;
+    }
+
+    void* const buf(gcs_gcache_malloc (core->cache, size));
+
+    if (gu_unlikely(NULL == buf)) {
+        gu_error ("Could not allocate memory for batched action of size: %zd",
+                  size);
+        return -ENOMEM;
+    }
+
+    memcpy (buf, batch->buf + batch->offset, size);
+    batch->offset += size;
+#else
+    /* arbitrator does not store action payload, only the seqnos matter */
+    void* const buf(NULL);
+    size = batch->size / batch->len;
+#endif /* GCS_FOR_GARB */
+
+    act->act.buf     = buf;
+    act->act.buf_len = size;
+    act->act.type    = batch->type;
+    act->id          = batch->id;
+    act->sender_idx  = batch->sender_idx;
+    act->local       = batch->local ? batch->local_act[batch->next] : NULL;
+
+    if (batch->id > 0) batch->id++; // otherwise error code is passed to all
+
+    if (++batch->next == batch->len) {
+        assert (batch->offset == batch->size);
+        gcs_gcache_free (core->cache, batch->buf);
+        batch->buf = NULL;
+    }
+
+    return size;
+}
+
+/*!
+ * Helper for core_handle_act_msg(). Sets up delivery of the received batch
+ * of actions and returns the first one.
+ *
+ * @return action size or negative error code.
+ */
+static ssize_t
+core_batch_start (gcs_core_t*                 const core,
+                  struct gcs_act_rcvd*        const act,
+                  int                         const batch_len,
+                  const struct gu_buf* const* const local)
+{
+    core_batch_t* const batch(&core->batch);
+
+    assert (NULL == batch->buf);
+    assert (batch->next == batch->len);
+
+    if (NULL != local) {
+        if (gu_unlikely(batch_len > GCS_CORE_BATCH_MAX)) {
+            gu_fatal ("Local batch length %d exceeds maximum %d",
+                      batch_len, GCS_CORE_BATCH_MAX);
+            return -ENOTRECOVERABLE;
+        }
+
+        std::copy (local, local + batch_len, batch->local_act);
+    }
+
+    batch->buf        = static_cast<const uint8_t*>(act->act.buf);
+    batch->size       = act->act.buf_len;
+    batch->offset     = 0;
+    batch->id         = act->id;
+    batch->type       = act->act.type;
+    batch->sender_idx = act->sender_idx;
+    batch->len        = batch_len;
+    batch->next       = 0;
+    batch->local      = (NULL != local);
+
+    *act = gcs_act_rcvd(); // batch buffer is owned by core->batch now
+
+    return core_batch_next (core, act);
+}
+
 /*!
  * Helper for gcs_core_recv(). Handles GCS_MSG_ACTION.
  *
@@ -515,16 +733,17 @@ core_handle_act_msg (gcs_core_t*          core,
     gcs_act_frag_t frg;
     bool  my_msg = (gcs_group_my_idx(group) == msg->sender_idx);
     bool  commonly_supported_version = true;
+    const struct gu_buf* const* local_batch = NULL;
 
     assert (GCS_MSG_ACTION == msg->type);
 
     if ((CORE_PRIMARY == core->state) || my_msg){//should always handle own msgs
 
         if (gu_unlikely(gcs_act_proto_ver(msg->buf) !=
-                        gcs_core_group_protocol_version(core))) {
+                        core_act_proto_ver(core))) {
             gu_info ("Message with protocol version %d != highest commonly supported: %d. ",
                      gcs_act_proto_ver(msg->buf),
-                     gcs_core_group_protocol_version(core));
+                     core_act_proto_ver(core));
             commonly_supported_version = false;
             if (!my_msg) {
                 gu_info ("Discard message from member %d because of "
@@ -545,6 +764,8 @@ core_handle_act_msg (gcs_core_t*          core,
             return -ENOTRECOVERABLE;
         }
 
+        frg.msg = msg; // msg->buf may be taken over by defrag pool
+
         ret = gcs_group_handle_act_msg (group, &frg, msg, act,
                                         commonly_supported_version);
 
@@ -571,6 +792,7 @@ core_handle_act_msg (gcs_core_t*          core,
                     act->local       = (const struct gu_buf*)local_act->action;
                     act->act.buf_len = local_act->action_size;
                     sent_act_id      = local_act->sent_act_id;
+                    local_batch      = local_act->batch;
                     gcs_fifo_lite_pop_head (core->fifo);
 
                     assert (NULL != act->local);
@@ -587,6 +809,13 @@ core_handle_act_msg (gcs_core_t*          core,
                                   act->act.buf_len, ret);
                         ret = -ENOTRECOVERABLE;
                     }
+                    if (gu_unlikely((NULL != local_batch) !=
+                                    (frg.batch_len > 0))) {
+                        gu_fatal ("Send/recv action batch mismatch: %s/%d",
+                                  local_batch ? "batch" : "single",
+                                  frg.batch_len);
+                        ret = -ENOTRECOVERABLE;
+                    }
                 }
                 else {
                     gu_fatal ("FIFO violation: queue empty when local action "
@@ -604,6 +833,11 @@ core_handle_act_msg (gcs_core_t*          core,
                 }
             }
 
+            if (gu_unlikely(frg.batch_len > 0) && ret > 0) {
+                assert (GCS_ACT_TORDERED == act->act.type);
+                ret = core_batch_start (core, act, frg.batch_len,local_batch);
+            }
+
             if (gu_unlikely(GCS_ACT_STATE_REQ == act->act.type && ret > 0 &&
                             // note: #gh74.
                             // if lingering STR sneaks in when core->state != CORE_PRIMARY
@@ -993,6 +1227,7 @@ core_msg_to_action (gcs_core_t*          core,
         case GCS_MSG_FLOW: // most frequent
             ret = 1;
             act_type = GCS_ACT_FLOW;
+            rcvd->sender_idx = msg->sender_idx; // for FC attribution
             break;
         case GCS_MSG_JOIN:
             ret = gcs_group_handle_join_msg (group, msg);
@@ -1089,6 +1324,12 @@ ssize_t gcs_core_recv (gcs_core_t*          conn,
 
     *recv_act = zero_act;
 
+    if (gu_unlikely(conn->batch.next < conn->batch.len)) {
+        /* deliver the rest of the batch before receiving new messages */
+        ret = core_batch_next (conn, recv_act);
+        goto out;
+    }
+
     /* receive messages from group and demultiplex them
      * until finally some complete action is ready */
     do
@@ -1236,8 +1477,12 @@ long gcs_core_destroy (gcs_core_t* core)
     }
     gcs_fifo_lite_destroy (core->fifo);
     gcs_group_free (&core->group);
+    if (core->group.defrag_pool) {
+        gcs_defrag_pool_destroy (core->group.defrag_pool);
+    }
 
     /* free buffers */
+    if (core->batch.buf) gcs_gcache_free (core->cache, core->batch.buf);
     gu_free (core->recv_msg.buf);
     gu_free (core->send_buf);
 
@@ -1256,6 +1501,12 @@ gcs_core_group_protocol_version (const gcs_core_t* conn)
     return conn->proto_ver;
 }
 
+bool
+gcs_core_batch_supported (const gcs_core_t* conn)
+{
+    return (conn->proto_ver >= GCS_PROTO_BATCH);
+}
+
 int
 gcs_core_set_pkt_size (gcs_core_t* core, int const pkt_size)
 {
@@ -1264,7 +1515,7 @@ gcs_core_set_pkt_size (gcs_core_t* core, int const pkt_size)
         return -EBADFD;
     }
 
-    int const hdr_size(gcs_act_proto_hdr_size(core->proto_ver));
+    int const hdr_size(gcs_act_proto_hdr_size(core_act_proto_ver(core)));
     if (hdr_size < 0) return hdr_size;
 
     int const min_msg_size(hdr_size + 1);
@@ -1312,6 +1563,23 @@ gcs_core_set_pkt_size (gcs_core_t* core, int const pkt_size)
     return ret;
 }
 
+long
+gcs_core_set_defrag_threads (gcs_core_t* core, int const threads)
+{
+    if (core->state != CORE_CLOSED || core->group.defrag_pool) {
+        gu_error ("Defragmentation threads can be set only once before "
+                  "opening connection");
+        return -EBUSY;
+    }
+
+    if (threads > 0) {
+        core->group.defrag_pool = gcs_defrag_pool_create (threads);
+        if (!core->group.defrag_pool) return -ENOMEM;
+    }
+
+    return 0;
+}
+
 static inline long
 core_send_seqno (gcs_core_t* core, gcs_seqno_t seqno, gcs_msg_type_t msg_type)
 {
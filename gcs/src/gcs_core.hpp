@@ -46,9 +46,13 @@ gcs_core_create (gu_config_t* conf,
                  gcache_t*    cache,
                  const char*  node_name,
                  const char*  inc_addr,
+                 int          gcs_proto_ver,
                  int          repl_proto_ver,
                  int          appl_proto_ver);
 
+/*! Highest GCS protocol version supported by this implementation */
+#define GCS_CORE_PROTO_MAX 2
+
 /* initializes action history (global seqno, group UUID). See gcs.h */
 extern long
 gcs_core_init (gcs_core_t* core, gcs_seqno_t seqno, const gu_uuid_t* uuid);
@@ -105,6 +109,29 @@ gcs_core_send (gcs_core_t*          core,
                size_t               act_size,
                gcs_act_type_t       act_type);
 
+/*! Maximum number of actions in a batch sent by gcs_core_send_batch() */
+#define GCS_CORE_BATCH_MAX 128
+
+/*
+ * gcs_core_send_batch() atomically sends several actions to group in a single
+ * message. Actions are received as separate actions with consecutive global
+ * seqnos in the order they were passed. Requires group protocol version 2.
+ *
+ * NOT THREAD SAFE! Access should be serialized.
+ *
+ * Return values:
+ * non-negative - total size of the sent actions (sans headers)
+ * negative     - error code, as for gcs_core_send(),
+ *                -EAGAIN is also returned if group protocol does not
+ *                support batching
+ */
+extern ssize_t
+gcs_core_send_batch (gcs_core_t*                 core,
+                     const struct gu_buf* const* acts,
+                     const size_t*               act_sizes,
+                     int                         batch_len,
+                     gcs_act_type_t              act_type);
+
 /*
  * gcs_core_recv() blocks until some action is received from group.
  *
@@ -131,6 +158,10 @@ gcs_core_recv (gcs_core_t*          conn,
 extern gcs_proto_t
 gcs_core_group_protocol_version (const gcs_core_t* conn);
 
+/* whether group protocol supports gcs_core_send_batch() */
+extern bool
+gcs_core_batch_supported (const gcs_core_t* conn);
+
 /* Configuration functions */
 /* Sets maximum message size to achieve requested network packet size.
  * In case of failure returns negative error code, in case of success -
@@ -138,6 +169,13 @@ gcs_core_group_protocol_version (const gcs_core_t* conn);
 extern int
 gcs_core_set_pkt_size (gcs_core_t* conn, int pkt_size);
 
+/* Starts a pool of threads to copy action fragments into action buffers.
+ * Can be called only once, before gcs_core_open(). 0 threads means that
+ * fragments are copied by the receiving thread.
+ * Returns 0 on success or negative error code */
+extern long
+gcs_core_set_defrag_threads (gcs_core_t* conn, int threads);
+
 /* sends this node's last applied value to group */
 extern long
 gcs_core_set_last_applied (gcs_core_t* core, gcs_seqno_t seqno);
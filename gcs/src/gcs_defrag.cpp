@@ -5,6 +5,7 @@
  */
 
 #include "gcs_defrag.hpp"
+#include "gcs_recv_msg.hpp"
 
 #include <errno.h>
 #include <unistd.h>
@@ -60,6 +61,9 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
                  * Reinit counters and continue with the new action. */
                 gu_debug ("Local action %lld, size %ld reset.",
                           frg->act_id, frg->act_size);
+#ifndef GCS_FOR_GARB
+                gcs_defrag_sync (df); // buffer is going to be reused
+#endif
                 df->frag_no  = 0;
                 df->received = 0;
                 df->tail     = df->head;
@@ -145,7 +149,21 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
 
 #ifndef GCS_FOR_GARB
     assert (df->tail);
-    memcpy (df->tail, frg->frag, frg->frag_len);
+    if (df->pool && df->received < df->size && // last fragment is copied here
+        frg->frag_len >= GCS_DEFRAG_POOL_MIN_FRAG && frg->msg) {
+        uint64_t const ticket(gcs_defrag_pool_copy (df->pool, df->worker,
+                                                    df->tail,
+                                                    frg->frag, frg->frag_len,
+                                                    &frg->msg->buf,
+                                                    frg->msg->buf_len));
+        if (gu_likely(ticket > 0))
+            df->ticket = ticket;
+        else
+            memcpy (df->tail, frg->frag, frg->frag_len);
+    }
+    else {
+        memcpy (df->tail, frg->frag, frg->frag_len);
+    }
     df->tail += frg->frag_len;
 #else
     /* we skip memcpy since have not allocated any buffer */
@@ -155,9 +173,12 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
 
 #if 1
     if (df->received == df->size) {
+#ifndef GCS_FOR_GARB
+        gcs_defrag_sync (df);
+#endif
         act->buf     = df->head;
         act->buf_len = df->received;
-        gcs_defrag_init (df, df->cache);
+        gcs_defrag_clear (df);
         return act->buf_len;
     }
     else {
@@ -187,7 +208,7 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
             assert(local);
             ret = -ERESTART;
         }
-        gcs_defrag_init (df, df->cache); // this also clears df->reset flag
+        gcs_defrag_clear (df); // this also clears df->reset flag
         assert(!df->reset);
     }
     else {
@@ -15,6 +15,7 @@
 #include "gcs_act_proto.hpp"
 #include "gcs_act.hpp"
 #include "gcs_gcache.hpp"
+#include "gcs_defrag_pool.hpp"
 
 #include <string.h>   // for memset()
 #include <stdbool.h>
@@ -29,6 +30,9 @@ typedef struct gcs_defrag
     size_t         received;
     ulong          frag_no; // number of fragment received
     bool           reset;
+    gcs_defrag_pool_t* pool;   // to offload payload copies to, may be NULL
+    int            worker;  // pool worker assigned to this defragmenter
+    uint64_t       ticket;  // last copy scheduled on the worker, 0 - none
 }
 gcs_defrag_t;
 
@@ -40,6 +44,36 @@ gcs_defrag_init (gcs_defrag_t* df, gcache_t* cache)
     df->sent_id = GCS_SEQNO_ILL;
 }
 
+/*! Associate defragmenter with a pool worker */
+static inline void
+gcs_defrag_set_pool (gcs_defrag_t* df, gcs_defrag_pool_t* pool, int worker)
+{
+    df->pool   = pool;
+    df->worker = pool ? worker % gcs_defrag_pool_workers (pool) : 0;
+}
+
+/*! Reinitialize for the next action, preserving cache and pool association */
+static inline void
+gcs_defrag_clear (gcs_defrag_t* df)
+{
+    gcs_defrag_pool_t* const pool = df->pool;
+    int const worker = df->worker;
+
+    gcs_defrag_init (df, df->cache);
+    df->pool   = pool;
+    df->worker = worker;
+}
+
+/*! Wait for all scheduled copies to the action buffer to complete */
+static inline void
+gcs_defrag_sync (gcs_defrag_t* df)
+{
+    if (df->ticket) {
+        gcs_defrag_pool_wait (df->pool, df->worker, df->ticket);
+        df->ticket = 0;
+    }
+}
+
 /*!
  * Handle received action fragment
  *
@@ -57,7 +91,7 @@ gcs_defrag_handle_frag (gcs_defrag_t*         df,
 static inline void
 gcs_defrag_forget (gcs_defrag_t* df)
 {
-    gcs_defrag_init (df, df->cache);
+    gcs_defrag_clear (df);
 }
 
 /*! Free resources associated with defrag (for lost node cleanup) */
@@ -66,14 +100,15 @@ gcs_defrag_free (gcs_defrag_t* df)
 {
 #ifndef GCS_FOR_GARB
     if (df->head) {
+        gcs_defrag_sync (df);
         gcs_gcache_free (df->cache, df->head);
-        // df->head, df->tail will be zeroed in gcs_defrag_init() below
+        // df->head, df->tail will be zeroed in gcs_defrag_clear() below
     }
 #else
     assert(NULL == df->head);
 #endif
 
-    gcs_defrag_init (df, df->cache);
+    gcs_defrag_clear (df);
 }
 
 /*! Mark current action as reset */
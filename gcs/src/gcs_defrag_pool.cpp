@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ *
+ * $Id$
+ */
+
+#include "gcs_defrag_pool.hpp"
+
+#include <string.h>
+#include <errno.h>
+
+/* must be a power of 2 */
+#define DEFRAG_QUEUE_LEN  16
+#define DEFRAG_QUEUE_MASK (DEFRAG_QUEUE_LEN - 1)
+
+typedef struct defrag_task
+{
+    void*       dst;
+    const void* src;
+    size_t      len;
+    void*       buf;     // buffer holding src, to be recycled
+    int         buf_len;
+}
+defrag_task_t;
+
+typedef struct defrag_buf
+{
+    void* ptr;
+    int   len;
+}
+defrag_buf_t;
+
+typedef struct defrag_worker
+{
+    gcs_defrag_pool_t* pool;
+    gu_thread_t   thread;
+    gu_mutex_t    lock;
+    gu_cond_t     cond;      // signals new task or stop
+    gu_cond_t     done;      // signals completed task to waiting receiver
+    uint64_t      submitted; // number of tasks submitted
+    uint64_t      completed; // number of tasks completed
+    bool          waiting;   // receiver waits on done
+    bool          stop;
+    defrag_task_t queue[DEFRAG_QUEUE_LEN];
+}
+defrag_worker_t;
+
+struct gcs_defrag_pool
+{
+    int              workers_num;
+    defrag_worker_t* workers;
+
+    /* recycled message buffers */
+    gu_mutex_t       bufs_lock;
+    int              bufs_num;
+    int              bufs_max;
+    defrag_buf_t*    bufs;
+};
+
+static void*
+defrag_buf_get (gcs_defrag_pool_t* pool, int len)
+{
+    void* ret = NULL;
+
+    gu_mutex_lock (&pool->bufs_lock);
+    for (int i = pool->bufs_num - 1; i >= 0; i--) {
+        if (pool->bufs[i].len >= len) {
+            ret = pool->bufs[i].ptr;
+            pool->bufs[i] = pool->bufs[--pool->bufs_num];
+            break;
+        }
+    }
+    gu_mutex_unlock (&pool->bufs_lock);
+
+    if (!ret) ret = gu_malloc (len);
+
+    return ret;
+}
+
+static void
+defrag_buf_put (gcs_defrag_pool_t* pool, void* ptr, int len)
+{
+    gu_mutex_lock (&pool->bufs_lock);
+    if (pool->bufs_num < pool->bufs_max) {
+        pool->bufs[pool->bufs_num].ptr = ptr;
+        pool->bufs[pool->bufs_num].len = len;
+        pool->bufs_num++;
+        ptr = NULL;
+    }
+    gu_mutex_unlock (&pool->bufs_lock);
+
+    if (ptr) gu_free (ptr);
+}
+
+static void*
+defrag_worker_thread (void* arg)
+{
+    defrag_worker_t* const w = static_cast<defrag_worker_t*>(arg);
+
+    gu_mutex_lock (&w->lock);
+
+    while (true) {
+        while (w->completed == w->submitted && !w->stop) {
+            gu_cond_wait (&w->cond, &w->lock);
+        }
+
+        if (w->completed == w->submitted) break; // stopped and drained
+
+        /* receiver does not touch the slot until completed is advanced */
+        defrag_task_t const task = w->queue[w->completed & DEFRAG_QUEUE_MASK];
+
+        gu_mutex_unlock (&w->lock);
+
+        memcpy (task.dst, task.src, task.len);
+        defrag_buf_put (w->pool, task.buf, task.buf_len);
+
+        gu_mutex_lock (&w->lock);
+
+        w->completed++;
+        if (w->waiting) gu_cond_signal (&w->done);
+    }
+
+    gu_mutex_unlock (&w->lock);
+
+    return NULL;
+}
+
+static void
+defrag_workers_stop (gcs_defrag_pool_t* pool, int num)
+{
+    for (int i = 0; i < num; i++) {
+        defrag_worker_t* const w = &pool->workers[i];
+
+        gu_mutex_lock (&w->lock);
+        w->stop = true;
+        gu_cond_signal (&w->cond);
+        gu_mutex_unlock (&w->lock);
+
+        gu_thread_join (w->thread, NULL);
+
+        gu_cond_destroy  (&w->done);
+        gu_cond_destroy  (&w->cond);
+        gu_mutex_destroy (&w->lock);
+    }
+}
+
+gcs_defrag_pool_t*
+gcs_defrag_pool_create (int const workers)
+{
+    if (workers < 1 || workers > GCS_DEFRAG_POOL_MAX) {
+        gu_error ("Invalid number of defragmentation threads: %d", workers);
+        return NULL;
+    }
+
+    gcs_defrag_pool_t* pool = GU_CALLOC (1, gcs_defrag_pool_t);
+    if (!pool) return NULL;
+
+    pool->workers_num = workers;
+    pool->workers     = GU_CALLOC (workers, defrag_worker_t);
+    pool->bufs_max    = workers * DEFRAG_QUEUE_LEN;
+    pool->bufs        = GU_CALLOC (pool->bufs_max, defrag_buf_t);
+
+    if (!pool->workers || !pool->bufs) goto alloc_failed;
+
+    gu_mutex_init (&pool->bufs_lock, NULL);
+
+    for (int i = 0; i < workers; i++) {
+        defrag_worker_t* const w = &pool->workers[i];
+
+        w->pool = pool;
+        gu_mutex_init (&w->lock, NULL);
+        gu_cond_init  (&w->cond, NULL);
+        gu_cond_init  (&w->done, NULL);
+
+        int const err = gu_thread_create (&w->thread, NULL,
+                                          defrag_worker_thread, w);
+        if (err) {
+            gu_error ("Failed to start defragmentation thread: %d (%s)",
+                      err, strerror(err));
+            gu_cond_destroy  (&w->done);
+            gu_cond_destroy  (&w->cond);
+            gu_mutex_destroy (&w->lock);
+            defrag_workers_stop (pool, i);
+            gu_mutex_destroy (&pool->bufs_lock);
+            goto alloc_failed;
+        }
+    }
+
+    return pool;
+
+alloc_failed:
+    gu_free (pool->bufs);
+    gu_free (pool->workers);
+    gu_free (pool);
+    return NULL;
+}
+
+void
+gcs_defrag_pool_destroy (gcs_defrag_pool_t* pool)
+{
+    defrag_workers_stop (pool, pool->workers_num);
+
+    for (int i = 0; i < pool->bufs_num; i++) gu_free (pool->bufs[i].ptr);
+    gu_mutex_destroy (&pool->bufs_lock);
+
+    gu_free (pool->bufs);
+    gu_free (pool->workers);
+    gu_free (pool);
+}
+
+int
+gcs_defrag_pool_workers (const gcs_defrag_pool_t* pool)
+{
+    return pool->workers_num;
+}
+
+uint64_t
+gcs_defrag_pool_copy (gcs_defrag_pool_t* const pool,
+                      int                const worker,
+                      void*              const dst,
+                      const void*        const src,
+                      size_t             const len,
+                      void**             const buf,
+                      int                const buf_len)
+{
+    assert (worker >= 0 && worker < pool->workers_num);
+    assert ((const char*)src >= (const char*)*buf);
+    assert ((const char*)src + len <= (const char*)*buf + buf_len);
+
+    defrag_worker_t* const w = &pool->workers[worker];
+
+    /* Only this (receiving) thread submits tasks, so free space in the
+     * queue can only grow after this check. */
+    gu_mutex_lock (&w->lock);
+    bool const full = (w->submitted - w->completed >= DEFRAG_QUEUE_LEN);
+    gu_mutex_unlock (&w->lock);
+
+    if (full) return 0;
+
+    void* const replacement = defrag_buf_get (pool, buf_len);
+    if (gu_unlikely(!replacement)) return 0;
+
+    gu_mutex_lock (&w->lock);
+
+    defrag_task_t& task = w->queue[w->submitted & DEFRAG_QUEUE_MASK];
+    task.dst     = dst;
+    task.src     = src;
+    task.len     = len;
+    task.buf     = *buf;
+    task.buf_len = buf_len;
+
+    uint64_t const ticket = ++w->submitted;
+    gu_cond_signal (&w->cond);
+
+    gu_mutex_unlock (&w->lock);
+
+    *buf = replacement;
+
+    return ticket;
+}
+
+void
+gcs_defrag_pool_wait (gcs_defrag_pool_t* const pool,
+                      int                const worker,
+                      uint64_t           const ticket)
+{
+    assert (worker >= 0 && worker < pool->workers_num);
+
+    defrag_worker_t* const w = &pool->workers[worker];
+
+    gu_mutex_lock (&w->lock);
+
+    assert (ticket <= w->submitted);
+
+    while (w->completed < ticket) {
+        w->waiting = true;
+        gu_cond_wait (&w->done, &w->lock);
+    }
+    w->waiting = false;
+
+    gu_mutex_unlock (&w->lock);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ *
+ * $Id$
+ */
+
+/*!
+ * @file Pool of threads to copy action fragment payload into action buffers
+ *
+ * Fragment bookkeeping and delivery order are still decided by the receiving
+ * thread, only memcpy() of the fragment payload is done by a worker. Each
+ * source node is mapped to one worker, so copies of one action are done in
+ * order while copies of actions from different nodes proceed in parallel.
+ *
+ * Since the fragment payload resides in the receive message buffer, the pool
+ * takes over that buffer for the time of the copy and supplies the receiving
+ * thread with another one from the recycled buffer list.
+ */
+
+#ifndef _gcs_defrag_pool_h_
+#define _gcs_defrag_pool_h_
+
+#include <galerautils.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*! Maximum number of worker threads */
+#define GCS_DEFRAG_POOL_MAX 32
+
+/*! Fragments smaller than that are not worth handing over to a worker */
+#define GCS_DEFRAG_POOL_MIN_FRAG 1024
+
+typedef struct gcs_defrag_pool gcs_defrag_pool_t;
+
+/*!
+ * Creates pool with a given number of worker threads.
+ *
+ * @return pool handle or NULL in case of failure.
+ */
+extern gcs_defrag_pool_t*
+gcs_defrag_pool_create (int workers);
+
+/*! Stops worker threads (after finishing outstanding copies) and frees pool */
+extern void
+gcs_defrag_pool_destroy (gcs_defrag_pool_t* pool);
+
+/*! @return number of worker threads */
+extern int
+gcs_defrag_pool_workers (const gcs_defrag_pool_t* pool);
+
+/*!
+ * Schedules copy of len bytes from src to dst on a given worker.
+ * src must point inside *buf which the pool takes over. In exchange *buf is
+ * replaced with another buffer of at least buf_len bytes.
+ *
+ * @return ticket to wait for (positive) or 0 if worker queue is full or
+ *         replacement buffer could not be allocated. In the latter case
+ *         nothing is done and the caller should copy the data itself.
+ */
+extern uint64_t
+gcs_defrag_pool_copy (gcs_defrag_pool_t* pool,
+                      int                worker,
+                      void*              dst,
+                      const void*        src,
+                      size_t             len,
+                      void**             buf,
+                      int                buf_len);
+
+/*!
+ * Waits until all copies scheduled on a worker up to ticket are complete.
+ */
+extern void
+gcs_defrag_pool_wait (gcs_defrag_pool_t* pool, int worker, uint64_t ticket);
+
+#endif /* _gcs_defrag_pool_h_ */
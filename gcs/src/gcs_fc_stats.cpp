@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+#include "gcs_fc_stats.hpp"
+
+#include <string.h>
+
+#include <iomanip>
+#include <sstream>
+
+/* Closes the pause started by the source, if any */
+static void
+fc_stats_end_pause (gcs_fc_source& src, long long const now)
+{
+    if (src.stop_depth > 0)
+    {
+        long long const pause(now - src.stop_start);
+
+        src.paused_ns += pause;
+        src.pause_hist.insert(pause * 1.0e-9);
+        src.stop_depth = 0;
+        src.stop_start = 0;
+    }
+}
+
+void
+gcs_fc_stats_conf (gcs_fc_stats_t*                 const stats,
+                   const std::vector<std::string>& ids,
+                   const std::vector<std::string>& names)
+{
+    assert (ids.size() == names.size());
+
+    long long const now(gu_time_monotonic());
+
+    gu_mutex_lock (&stats->lock);
+
+    typedef std::map<std::string, gcs_fc_source>::iterator source_iter;
+
+    for (source_iter i(stats->sources.begin()); i != stats->sources.end(); ++i)
+    {
+        fc_stats_end_pause (i->second, now);
+        i->second.member = false;
+    }
+
+    for (size_t n(0); n < ids.size(); ++n)
+    {
+        source_iter const i(stats->sources.insert(
+                                std::make_pair(ids[n],
+                                               gcs_fc_source(names[n]))).first);
+        i->second.name   = names[n];
+        i->second.member = true;
+    }
+
+    /* don't let departed nodes accumulate forever */
+    for (source_iter i(stats->sources.begin());
+         stats->sources.size() > GCS_FC_STATS_MAX_SOURCES &&
+             i != stats->sources.end();)
+    {
+        if (!i->second.member) stats->sources.erase(i++);
+        else ++i;
+    }
+
+    stats->members = ids;
+
+    gu_mutex_unlock (&stats->lock);
+}
+
+void
+gcs_fc_stats_event (gcs_fc_stats_t* const stats,
+                    int             const sender_idx,
+                    bool            const stop,
+                    long            const queue_len)
+{
+    gu_mutex_lock (&stats->lock);
+
+    if (gu_unlikely(sender_idx < 0 ||
+                    size_t(sender_idx) >= stats->members.size()))
+    {
+        gu_mutex_unlock (&stats->lock);
+        return;
+    }
+
+    const std::string& id(stats->members[sender_idx]);
+
+    std::map<std::string, gcs_fc_source>::iterator const i
+        (stats->sources.find(id));
+    assert (i != stats->sources.end());
+
+    gcs_fc_source& src(i->second);
+    long long const now(gu_time_monotonic());
+
+    if (stop)
+    {
+        ++src.stops;
+        if (0 == src.stop_depth++) src.stop_start = now;
+        src.last_queue = queue_len;
+        if (queue_len > src.max_queue) src.max_queue = queue_len;
+    }
+    else
+    {
+        ++src.conts;
+        if (src.stop_depth > 1) --src.stop_depth;
+        else fc_stats_end_pause (src, now);
+    }
+
+    gcs_fc_stats_rec& ev(stats->ring[stats->ring_next]);
+    ev.time      = gu_time_calendar();
+    ev.queue_len = queue_len;
+    ev.stop      = stop;
+    strncpy (ev.id, id.c_str(), sizeof(ev.id) - 1);
+    ev.id[sizeof(ev.id) - 1] = '\0';
+
+    stats->ring_next = (stats->ring_next + 1) % GCS_FC_STATS_RING_LEN;
+    if (stats->ring_used < GCS_FC_STATS_RING_LEN) ++stats->ring_used;
+
+    gu_mutex_unlock (&stats->lock);
+}
+
+void
+gcs_fc_stats_flush (gcs_fc_stats_t* const stats)
+{
+    gu_mutex_lock (&stats->lock);
+
+    typedef std::map<std::string, gcs_fc_source>::iterator source_iter;
+
+    for (source_iter i(stats->sources.begin()); i != stats->sources.end(); ++i)
+    {
+        gcs_fc_source& src(i->second);
+
+        src.pause_hist.clear();
+        src.stops      = 0;
+        src.conts      = 0;
+        src.paused_ns  = 0;
+        src.max_queue  = src.last_queue;
+    }
+
+    gu_mutex_unlock (&stats->lock);
+}
+
+void
+gcs_fc_stats_get_status (gcs_fc_stats_t* const stats, gu::Status& status)
+{
+    std::ostringstream sources;
+    std::ostringstream hist;
+    std::ostringstream events;
+
+    sources << std::fixed << std::setprecision(3);
+    events  << std::fixed << std::setprecision(3);
+
+    gu_mutex_lock (&stats->lock);
+
+    long long const now(gu_time_monotonic());
+
+    typedef std::map<std::string, gcs_fc_source>::const_iterator source_iter;
+
+    for (source_iter i(stats->sources.begin()); i != stats->sources.end(); ++i)
+    {
+        const gcs_fc_source& src(i->second);
+
+        if (0 == src.stops && 0 == src.conts) continue;
+
+        /* count the ongoing pause too */
+        long long const paused(src.paused_ns + (src.stop_depth > 0 ?
+                                                now - src.stop_start : 0));
+        if (sources.tellp() > 0)
+        {
+            sources << ',';
+            hist    << ';';
+        }
+
+        sources << i->first << ':' << src.name << ':' << src.stops << ':'
+                << src.conts << ':' << paused * 1.0e-9 << ':'
+                << src.last_queue << ':' << src.max_queue;
+
+        hist << i->first << ':' << src.pause_hist;
+    }
+
+    for (long n(0); n < stats->ring_used; ++n)
+    {
+        long const pos((stats->ring_next - stats->ring_used + n +
+                        GCS_FC_STATS_RING_LEN) % GCS_FC_STATS_RING_LEN);
+        const gcs_fc_stats_rec& ev(stats->ring[pos]);
+
+        if (n > 0) events << ',';
+
+        events << ev.time * 1.0e-9 << ':' << ev.id << ':'
+               << (ev.stop ? "STOP" : "CONT") << ':' << ev.queue_len;
+    }
+
+    gu_mutex_unlock (&stats->lock);
+
+    status.insert("flow_control_sources",    sources.str());
+    status.insert("flow_control_pause_hist", hist.str());
+    status.insert("flow_control_events",     events.str());
+}
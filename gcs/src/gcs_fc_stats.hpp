@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/*! @file Flow control event attribution: which node paused the cluster,
+ *        for how long and what that node's slave queue looked like. */
+
+#ifndef _gcs_fc_stats_h_
+#define _gcs_fc_stats_h_
+
+#include "gu_histogram.hpp"
+#include "gu_status.hpp"
+
+#include <galerautils.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define GCS_FC_STATS_RING_LEN     64 // number of recent events to remember
+#define GCS_FC_STATS_MAX_SOURCES  64 // purge departed nodes beyond that
+#define GCS_FC_STATS_PAUSE_HIST   "0.0,0.001,0.01,0.1,1.0,10.0" // seconds
+
+/*! Per source node FC counters */
+struct gcs_fc_source
+{
+    std::string   name;
+    gu::Histogram pause_hist; // pause durations, seconds
+    long long     stops;      // STOP events from this node
+    long long     conts;      // CONT events from this node
+    long long     paused_ns;  // total time the node kept the cluster paused
+    long long     stop_start; // monotonic time of the first outstanding STOP
+    long          stop_depth; // outstanding STOPs from this node
+    long          last_queue; // slave queue length at last STOP (-1 unknown)
+    long          max_queue;  // maximum slave queue length at STOP
+    bool          member;     // node is in current configuration
+
+    explicit gcs_fc_source(const std::string& n)
+        :
+        name      (n),
+        pause_hist(GCS_FC_STATS_PAUSE_HIST),
+        stops     (0),
+        conts     (0),
+        paused_ns (0),
+        stop_start(0),
+        stop_depth(0),
+        last_queue(-1),
+        max_queue (-1),
+        member    (true)
+    {}
+};
+
+/*! FC event record for the recent events ring */
+struct gcs_fc_stats_rec
+{
+    long long time;                             // calendar time, ns
+    char      id[GU_UUID_STR_LEN + 1];          // source node ID
+    long      queue_len;                        // -1 if unknown
+    bool      stop;
+};
+
+typedef struct gcs_fc_stats
+{
+    gu_mutex_t lock;
+    std::map<std::string, gcs_fc_source> sources; // by node ID
+    std::vector<std::string>             members; // node IDs by index
+    gcs_fc_stats_rec   ring[GCS_FC_STATS_RING_LEN];
+    long               ring_next; // next ring slot to write
+    long               ring_used; // number of valid ring slots
+
+    gcs_fc_stats() : lock(), sources(), members(), ring(),
+                     ring_next(0), ring_used(0)
+    {
+        gu_mutex_init(&lock, NULL);
+    }
+
+    ~gcs_fc_stats() { gu_mutex_destroy(&lock); }
+
+private:
+    gcs_fc_stats(const gcs_fc_stats&);
+    gcs_fc_stats& operator=(const gcs_fc_stats&);
+}
+gcs_fc_stats_t;
+
+/*! Sets new configuration membership: node IDs and names by node index.
+ *  Pauses still outstanding are closed since FC is reset on conf change. */
+extern void
+gcs_fc_stats_conf (gcs_fc_stats_t*                 stats,
+                   const std::vector<std::string>& ids,
+                   const std::vector<std::string>& names);
+
+/*! Records FC event from node sender_idx of the current configuration.
+ *  @param queue_len sender's slave queue length or -1 if unknown */
+extern void
+gcs_fc_stats_event (gcs_fc_stats_t* stats,
+                    int             sender_idx,
+                    bool            stop,
+                    long            queue_len);
+
+/*! Resets per source counters (but not the recent events ring) */
+extern void
+gcs_fc_stats_flush (gcs_fc_stats_t* stats);
+
+/*! Exports per source counters and recent events to status map */
+extern void
+gcs_fc_stats_get_status (gcs_fc_stats_t* stats, gu::Status& status);
+
+#endif /* _gcs_fc_stats_h_ */
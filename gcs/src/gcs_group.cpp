@@ -40,7 +40,12 @@ gcs_group_init (gcs_group_t* group, gcache_t* const cache,
     group->state        = GCS_GROUP_NON_PRIMARY;
     group->last_applied = GCS_SEQNO_ILL; // mark for recalculation
     group->last_node    = -1;
+    group->la_heap      = NULL;
+    group->la_heap_len  = 0;
+    group->la_heap_size = 0;
+    group->la_heap_dirty= true;
     group->frag_reset   = true; // just in case
+    group->defrag_pool  = NULL;
     group->nodes        = GU_CALLOC(group->num, gcs_node_t); // this must be removed (#474)
 
     if (!group->nodes) return -ENOMEM; // this should be removed (#474)
@@ -116,6 +121,8 @@ group_nodes_init (const gcs_group_t* group, const gcs_comp_msg_t* comp)
                                group->gcs_proto_ver, group->repl_proto_ver,
                                group->appl_proto_ver, memb->segment);
             }
+
+            gcs_defrag_set_pool (&ret[i].app, group->defrag_pool, i);
         }
     }
     else {
@@ -144,6 +151,7 @@ group_nodes_free (gcs_group_t* group)
     group->nodes  = NULL;
     group->num    = 0;
     group->my_idx = -1;
+    group->la_heap_dirty = true;
 }
 
 void
@@ -152,6 +160,10 @@ gcs_group_free (gcs_group_t* group)
     if (group->my_name)    free ((char*)group->my_name);
     if (group->my_address) free ((char*)group->my_address);
     group_nodes_free (group);
+    if (group->la_heap)    gu_free (group->la_heap);
+    group->la_heap      = NULL;
+    group->la_heap_size = 0;
+    group->la_heap_len  = 0;
 }
 
 /* Reset nodes array without breaking the statistics */
@@ -172,10 +184,145 @@ group_nodes_reset (gcs_group_t* group)
     group->frag_reset = true;
 }
 
+/* Whether node's last_applied should be counted in the group minimum */
+static inline bool
+group_counts_last_applied (const gcs_group_t* group, const gcs_node_t* node)
+{
+    if (gu_unlikely (0 == group->last_applied_proto_ver)) {
+        /* @note: this may be removed after quorum v1 is phased out */
+        return (GCS_NODE_STATE_SYNCED == node->status ||
+                GCS_NODE_STATE_DONOR  == node->status);
+    }
+
+    /* NOTE: It is crucial for consistency that last_applied algorithm
+     *       is absolutely identical on all nodes. Therefore for the
+     *       generality sake and future compatibility we have to assume
+     *       non-blocking donor.
+     *       GCS_BLOCKING_DONOR should never be defined unless in some
+     *       very custom builds. Commenting it out for safety sake. */
+//#ifndef GCS_BLOCKING_DONOR
+    return node->count_last_applied;
+//#else
+//    return (GCS_NODE_STATE_SYNCED == node->status); /* ignore donor */
+//#endif
+}
+
+/*
+ * Counted nodes are kept in a binary min-heap ordered by last_applied, so
+ * that a LAST message costs O(log N) instead of a scan over all nodes.
+ * Ties are broken by node index which makes the choice of last_node the same
+ * as with the linear scan. The second half of la_heap maps node index to its
+ * position in the heap (-1 if not counted).
+ */
+#define GROUP_LA_POS(group, n) ((group)->la_heap[(group)->la_heap_size + (n)])
+
+static inline bool
+group_la_less (const gcs_group_t* group, long const a, long const b)
+{
+    gcs_seqno_t const la(group->nodes[a].last_applied);
+    gcs_seqno_t const lb(group->nodes[b].last_applied);
+
+    return (la < lb || (la == lb && a < b));
+}
+
+static inline void
+group_la_place (gcs_group_t* group, long const pos, long const n)
+{
+    group->la_heap[pos]     = n;
+    GROUP_LA_POS(group, n) = pos;
+}
+
+/* last_applied can only grow, so a node can only move down the heap */
+static void
+group_la_sift_down (gcs_group_t* group, long pos)
+{
+    long const len = group->la_heap_len;
+    long const n   = group->la_heap[pos];
+
+    for (;;) {
+        long child = 2 * pos + 1;
+
+        if (child >= len) break;
+
+        if (child + 1 < len &&
+            group_la_less (group, group->la_heap[child + 1],
+                           group->la_heap[child])) child++;
+
+        if (!group_la_less (group, group->la_heap[child], n)) break;
+
+        group_la_place (group, pos, group->la_heap[child]);
+        pos = child;
+    }
+
+    group_la_place (group, pos, n);
+}
+
+/* Collect counted nodes into the heap.
+ * @return false if heap could not be allocated */
+static bool
+group_la_heap_build (gcs_group_t* group)
+{
+    long n;
+
+    group->la_heap_dirty = true;
+    group->la_heap_len   = 0;
+
+    if (group->la_heap_size < group->num) {
+        long* const heap = static_cast<long*>(
+            gu_realloc (group->la_heap, 2 * group->num * sizeof(long)));
+
+        if (!heap) {
+            gu_warn ("Could not allocate last applied heap for %ld nodes",
+                     group->num);
+            return false;
+        }
+
+        group->la_heap      = heap;
+        group->la_heap_size = group->num;
+    }
+
+    for (n = 0; n < group->num; n++) {
+        if (group_counts_last_applied (group, &group->nodes[n])) {
+            group_la_place (group, group->la_heap_len++, n);
+        }
+        else {
+            GROUP_LA_POS(group, n) = -1;
+        }
+    }
+
+    for (n = group->la_heap_len / 2 - 1; n >= 0; n--) {
+        group_la_sift_down (group, n);
+    }
+
+    /* in the old protocol node is counted based on its status, which may
+     * change anywhere, so the heap has to be rebuilt every time */
+    group->la_heap_dirty = (0 == group->last_applied_proto_ver);
+
+    return true;
+}
+
+/* Set last_applied from the top of the heap */
+static inline void
+group_la_heap_top (gcs_group_t* group)
+{
+    if (gu_likely (group->la_heap_len > 0)) {
+        long const n = group->la_heap[0];
+        assert (group->nodes[n].last_applied >= 0);
+        group->last_applied = group->nodes[n].last_applied;
+        group->last_node    = n;
+    }
+}
+
 /* Find node with the smallest last_applied */
 static inline void
 group_redo_last_applied (gcs_group_t* group)
 {
+    if (gu_likely (group_la_heap_build (group))) {
+        group_la_heap_top (group);
+        return;
+    }
+
+    /* no memory for the heap, fall back to a linear scan */
     long       n;
     long       last_node    = -1;
     gu_seqno_t last_applied = GU_LLONG_MAX;
@@ -183,35 +330,12 @@ group_redo_last_applied (gcs_group_t* group)
     for (n = 0; n < group->num; n++) {
         const gcs_node_t* const node = &group->nodes[n];
         gcs_seqno_t const seqno = node->last_applied;
-        bool count = node->count_last_applied;
 
-        if (gu_unlikely (0 == group->last_applied_proto_ver)) {
-            /* @note: this may be removed after quorum v1 is phased out */
-            count = (GCS_NODE_STATE_SYNCED == node->status ||
-                     GCS_NODE_STATE_DONOR  == node->status);
-        }
-
-//        gu_debug("redo_last_applied[%ld]: %lld, count: %s",
-//                 n, seqno, count ? "yes" : "no");
-
-        /* NOTE: It is crucial for consistency that last_applied algorithm
-         *       is absolutely identical on all nodes. Therefore for the
-         *       generality sake and future compatibility we have to assume
-         *       non-blocking donor.
-         *       GCS_BLOCKING_DONOR should never be defined unless in some
-         *       very custom builds. Commenting it out for safety sake. */
-//#ifndef GCS_BLOCKING_DONOR
-        if (count
-//#else
-//        if ((GCS_NODE_STATE_SYNCED == node->status) /* ignore donor */
-//#endif
-            && (seqno < last_applied)) {
+        if (group_counts_last_applied (group, node) && seqno < last_applied) {
             assert (seqno >= 0);
             last_applied = seqno;
             last_node    = n;
         }
-        // extra diagnostic, ignore
-        //else if (!count) { gu_warn("not counting %d", n); }
     }
 
     if (gu_likely (last_node >= 0)) {
@@ -343,6 +467,8 @@ group_post_state_exchange (gcs_group_t* group)
         gcs_node_update_status (&group->nodes[i], quorum);
     }
 
+    group->la_heap_dirty = true; // nodes may have changed counting flags
+
     if (quorum->primary) {
         // primary configuration
         if (new_exchange) {
@@ -682,12 +808,22 @@ gcs_group_handle_last_msg (gcs_group_t* group, const gcs_recv_msg_t* msg)
 
     gcs_node_set_last_applied (&group->nodes[msg->sender_idx], seqno);
 
+    if (!group->la_heap_dirty) {
+        long const pos = GROUP_LA_POS(group, msg->sender_idx);
+        if (pos >= 0) group_la_sift_down (group, pos);
+    }
+
     if (msg->sender_idx == group->last_node && seqno > group->last_applied) {
         /* node that was responsible for the last value, has changed it.
          * need to recompute it */
         gcs_seqno_t old_val = group->last_applied;
 
-        group_redo_last_applied (group);
+        if (gu_likely (!group->la_heap_dirty)) {
+            group_la_heap_top (group);
+        }
+        else {
+            group_redo_last_applied (group);
+        }
 
         if (old_val < group->last_applied) {
             gu_debug ("New COMMIT CUT %lld after %lld from %d",
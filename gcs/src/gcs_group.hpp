@@ -49,8 +49,13 @@ typedef struct gcs_group
     gcs_group_state_t state;    // group state: PRIMARY | NON_PRIMARY
     gcs_seqno_t   last_applied; // last_applied action group-wide
     long          last_node;    // node that reported last_applied
+    long*         la_heap;      // counted nodes ordered by last_applied
+    long          la_heap_len;  // number of nodes in la_heap
+    long          la_heap_size; // number of node slots allocated in la_heap
+    bool          la_heap_dirty;// set of counted nodes may have changed
     bool          frag_reset;   // indicate that fragmentation was reset
     gcs_node_t*   nodes;        // array of node contexts
+    gcs_defrag_pool_t* defrag_pool; // fragment copy offload, may be NULL
 
     /* values from the last primary component */
     gu_uuid_t        prim_uuid;
@@ -192,6 +197,8 @@ gcs_group_handle_act_msg (gcs_group_t*          const group,
              * increment and assign act_id only for totally ordered actions
              * and only in PRIM (skip messages while in state exchange) */
             rcvd->id = ++group->act_id_;
+            /* batched actions get consecutive ids starting with rcvd->id */
+            if (frg->batch_len > 1) group->act_id_ += frg->batch_len - 1;
         }
         else if (GCS_ACT_TORDERED  == rcvd->act.type) {
             /* Rare situations */
@@ -5,9 +5,13 @@
  */
 
 #include "gcs_params.hpp"
-#include "gcs_fc.hpp" // gcs_fc_hard_limit_fix
+#include "gcs_fc.hpp"   // gcs_fc_hard_limit_fix
+#include "gcs_core.hpp" // GCS_CORE_BATCH_MAX
+#include "gcs_defrag_pool.hpp" // GCS_DEFRAG_POOL_MAX
 
 #include "gu_inttypes.hpp"
+#include "gu_datetime.hpp"
+#include "gu_exception.hpp"
 
 #include <cerrno>
 
@@ -20,6 +24,10 @@ const char* const GCS_PARAMS_MAX_PKT_SIZE      = "gcs.max_packet_size";
 const char* const GCS_PARAMS_RECV_Q_HARD_LIMIT = "gcs.recv_q_hard_limit";
 const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT = "gcs.recv_q_soft_limit";
 const char* const GCS_PARAMS_MAX_THROTTLE      = "gcs.max_throttle";
+const char* const GCS_PARAMS_MAX_BATCH_LEN     = "gcs.max_batch_len";
+const char* const GCS_PARAMS_BATCH_WINDOW      = "gcs.batch_window";
+const char* const GCS_PARAMS_DEFRAG_THREADS    = "gcs.defrag_threads";
+const char* const GCS_PARAMS_PROTO_MAX         = "gcs.proto_max";
 #ifdef GCS_SM_DEBUG
 const char* const GCS_PARAMS_SM_DUMP           = "gcs.sm_dump";
 #endif /* GCS_SM_DEBUG */
@@ -33,6 +41,10 @@ static const char* const GCS_PARAMS_MAX_PKT_SIZE_DEFAULT      = "64500";
 static ssize_t const GCS_PARAMS_RECV_Q_HARD_LIMIT_DEFAULT     = SSIZE_MAX;
 static const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT_DEFAULT = "0.25";
 static const char* const GCS_PARAMS_MAX_THROTTLE_DEFAULT      = "0.25";
+static const char* const GCS_PARAMS_MAX_BATCH_LEN_DEFAULT     = "1";
+static const char* const GCS_PARAMS_BATCH_WINDOW_DEFAULT      = "PT0S";
+static const char* const GCS_PARAMS_DEFRAG_THREADS_DEFAULT    = "0";
+static const char* const GCS_PARAMS_PROTO_MAX_DEFAULT         = "0";
 
 bool
 gcs_params_register(gu_config_t* conf)
@@ -61,6 +73,14 @@ gcs_params_register(gu_config_t* conf)
                           GCS_PARAMS_RECV_Q_SOFT_LIMIT_DEFAULT);
     ret |= gu_config_add (conf, GCS_PARAMS_MAX_THROTTLE,
                           GCS_PARAMS_MAX_THROTTLE_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_MAX_BATCH_LEN,
+                          GCS_PARAMS_MAX_BATCH_LEN_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_BATCH_WINDOW,
+                          GCS_PARAMS_BATCH_WINDOW_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_DEFRAG_THREADS,
+                          GCS_PARAMS_DEFRAG_THREADS_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_PROTO_MAX,
+                          GCS_PARAMS_PROTO_MAX_DEFAULT);
 #ifdef GCS_SM_DEBUG
     ret |= gu_config_add (conf, GCS_PARAMS_SM_DUMP, "0");
 #endif /* GCS_SM_DEBUG */
@@ -178,6 +198,38 @@ params_init_double (gu_config_t* conf, const char* const name,
     return 0;
 }
 
+static long
+params_init_period (gu_config_t* conf, const char* const name,
+                    int64_t* const var)
+{
+    const char* str;
+
+    long rc = gu_config_get_string(conf, name, &str);
+
+    if (rc < 0) {
+        /* Cannot parse parameter value */
+        gu_error ("Bad %s value", name);
+        return rc;
+    }
+
+    try {
+        gu::datetime::Period const val(str);
+
+        if (val.get_nsecs() < 0) {
+            gu_error ("%s value is negative: %s", name, str);
+            return -EINVAL;
+        }
+
+        *var = val.get_nsecs();
+    }
+    catch (gu::Exception& e) {
+        gu_error ("Bad %s value: %s", name, e.what());
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
 long
 gcs_params_init (struct gcs_params* params, gu_config_t* config)
 {
@@ -192,6 +244,21 @@ gcs_params_init (struct gcs_params* params, gu_config_t* config)
     if ((ret = params_init_long (config, GCS_PARAMS_MAX_PKT_SIZE, 0,LONG_MAX,
                                  &params->max_packet_size))) return ret;
 
+    if ((ret = params_init_long (config, GCS_PARAMS_MAX_BATCH_LEN,
+                                 1, GCS_CORE_BATCH_MAX,
+                                 &params->max_batch_len))) return ret;
+
+    if ((ret = params_init_period (config, GCS_PARAMS_BATCH_WINDOW,
+                                   &params->batch_window))) return ret;
+
+    if ((ret = params_init_long (config, GCS_PARAMS_DEFRAG_THREADS,
+                                 0, GCS_DEFRAG_POOL_MAX,
+                                 &params->defrag_threads))) return ret;
+
+    if ((ret = params_init_long (config, GCS_PARAMS_PROTO_MAX,
+                                 0, GCS_CORE_PROTO_MAX,
+                                 &params->proto_max))) return ret;
+
     if ((ret = params_init_double (config, GCS_PARAMS_FC_FACTOR, 0.0, 1.0,
                                    &params->fc_resume_factor))) return ret;
 
@@ -16,6 +16,10 @@ struct gcs_params
     ssize_t recv_q_hard_limit;
     long    fc_base_limit;
     long    max_packet_size;
+    long    max_batch_len;
+    int64_t batch_window;   // nanoseconds
+    long    defrag_threads;
+    long    proto_max;
     long    fc_debug;
     bool    fc_master_slave;
     bool    sync_donor;
@@ -30,6 +34,10 @@ extern const char* const GCS_PARAMS_MAX_PKT_SIZE;
 extern const char* const GCS_PARAMS_RECV_Q_HARD_LIMIT;
 extern const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT;
 extern const char* const GCS_PARAMS_MAX_THROTTLE;
+extern const char* const GCS_PARAMS_MAX_BATCH_LEN;
+extern const char* const GCS_PARAMS_BATCH_WINDOW;
+extern const char* const GCS_PARAMS_DEFRAG_THREADS;
+extern const char* const GCS_PARAMS_PROTO_MAX;
 #ifdef GCS_SM_DEBUG
 extern const char* const GCS_PARAMS_SM_DUMP;
 #endif /* GCS_SM_DEBUG */
@@ -47,6 +47,7 @@ gcs_sm_create (long len, long n)
         sm_init_stats (&sm->stats);
         gu_mutex_init (&sm->lock, NULL);
         gu_cond_init  (&sm->cond, NULL);
+        gu_cond_init  (&sm->batch_cond, NULL);
         sm->cond_wait   = 0;
         sm->wait_q_len  = len;
         sm->wait_q_mask = sm->wait_q_len - 1;
@@ -61,6 +62,7 @@ gcs_sm_create (long len, long n)
         sm->cc          = n; // concurrency param.
 #endif /* GCS_SM_CONCURRENCY */
         sm->pause       = false;
+        sm->batch_wait  = false;
         sm->wait_time   = gu::datetime::Sec;
 
 #ifdef GCS_SM_DEBUG
@@ -85,6 +87,11 @@ gcs_sm_close (gcs_sm_t* sm)
 
     if (sm->pause) _gcs_sm_continue_common (sm);
 
+    if (sm->batch_wait) {
+        sm->batch_wait = false;
+        gu_cond_signal (&sm->batch_cond);
+    }
+
     gu_cond_t cond;
     gu_cond_init (&cond, NULL);
 
@@ -135,10 +142,74 @@ gcs_sm_open (gcs_sm_t* sm)
 void
 gcs_sm_destroy (gcs_sm_t* sm)
 {
+    gu_cond_destroy (&sm->batch_cond);
     gu_mutex_destroy(&sm->lock);
     gu_free (sm);
 }
 
+long
+gcs_sm_claim (gcs_sm_t* sm, void* batch[], long max_len, size_t max_size,
+              const gu::datetime::Period& window)
+{
+    long   len(0);
+    size_t size(0);
+
+    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+
+    GCS_SM_ASSERT(sm->entered > 0);
+
+    /* batching relies on the leader being the only user in the monitor */
+    unsigned long cursor(sm->wait_q_head);
+    struct timespec ts;
+    bool waited(false);
+
+    while (0 == sm->ret && !sm->pause) {
+
+        while (len < max_len && cursor != sm->wait_q_tail) {
+            unsigned long next(cursor);
+            GCS_SM_INCREMENT(next);
+            gcs_sm_user_t* const user(&sm->wait_q[next]);
+
+            if (user->wait) {
+                if (NULL == user->batch || size + user->size > max_size)
+                    goto out; // preserve order
+
+                size += user->size;
+                batch[len++] = user->batch;
+
+                /* from now on this slot is treated as an interrupted one */
+                user->wait    = false;
+                user->claimed = true;
+                user->batch   = NULL;
+                gu_cond_signal (user->cond);
+                user->cond    = NULL;
+                GCS_SM_HIST_LOG("claimed %lu", next);
+            }
+            /* else interrupted or already claimed, skip */
+
+            cursor = next;
+        }
+
+        if (len >= max_len || window.get_nsecs() <= 0) break;
+
+        if (!waited) {
+            gu::datetime::Date abstime(gu::datetime::Date::calendar());
+            abstime = abstime + window;
+            abstime._timespec(ts);
+            waited = true;
+        }
+
+        sm->batch_wait = true;
+        if (gu_cond_timedwait (&sm->batch_cond, &sm->lock, &ts)) break;
+    }
+
+out:
+    sm->batch_wait = false;
+    gu_mutex_unlock (&sm->lock);
+
+    return len;
+}
+
 void
 gcs_sm_stats_get (gcs_sm_t*  sm,
                   int*       q_len,
@@ -24,7 +24,10 @@
 typedef struct gcs_sm_user
 {
     gu_cond_t* cond;
+    void*      batch;   // batching context, NULL if user can't be batched
+    size_t     size;    // size of the action to be batched
     bool       wait;
+    bool       claimed; // action was claimed by the batch leader
 }
 gcs_sm_user_t;
 
@@ -60,6 +63,8 @@ typedef struct gcs_sm
     long          cc;
 #endif /* GCS_SM_CONCURRENCY */
     bool          pause;
+    bool          batch_wait; // batch leader waits for more users
+    gu_cond_t     batch_cond;
     gu::datetime::Period wait_time;
 
 #ifdef GCS_SM_DEBUG
@@ -216,13 +221,20 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
     sm->wait_q[tail].wait = true;
     int ret;
 
+    if (gu_unlikely(sm->batch_wait)) {
+        /* let batch leader know about a new user */
+        sm->batch_wait = false;
+        gu_cond_signal (&sm->batch_cond);
+    }
+
     if (block == true)
     {
         GCS_SM_HIST_LOG("queueing at %lu", tail);
         gu_cond_wait (cond, &sm->lock);
         assert(tail == sm->wait_q_head || false == sm->wait_q[tail].wait);
         assert(sm->wait_q[tail].cond == cond || false == sm->wait_q[tail].wait);
-        ret = sm->wait_q[tail].wait ? 0 : -EINTR;
+        ret = sm->wait_q[tail].wait ? 0 :
+            (sm->wait_q[tail].claimed ? -EALREADY : -EINTR);
     }
     else
     {
@@ -237,7 +249,8 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
         ret = -gu_cond_timedwait(cond, &sm->lock, &ts);
         if (0 == ret)
         {
-            ret = sm->wait_q[tail].wait ? 0 : -EINTR;
+            ret = sm->wait_q[tail].wait ? 0 :
+                (sm->wait_q[tail].claimed ? -EALREADY : -EINTR);
             // sm->wait_time is incremented by second each time cond wait
             // times out, reset back to one second when cond wait succeeds.
             sm->wait_time = std::max(sm->wait_time*2/3,
@@ -269,8 +282,10 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
         // to reproduce GAL-495: if (0 == ret && (tail & 1)) { ret = -EINTR; }
     }
 
-    sm->wait_q[tail].cond = NULL;
-    sm->wait_q[tail].wait = false;
+    sm->wait_q[tail].cond    = NULL;
+    sm->wait_q[tail].batch   = NULL;
+    sm->wait_q[tail].wait    = false;
+    sm->wait_q[tail].claimed = false;
 
     if (gu_unlikely(0 != ret)) GCS_SM_HIST_LOG("%ld wait failed: %d", tail, ret);
 
@@ -333,22 +348,9 @@ gcs_sm_schedule (gcs_sm_t* sm)
     return ret;
 }
 
-/*!
- * Enter send monitor critical section
- *
- * @param sm   send monitor object
- * @param cond condition to signal to wake up thread in case of wait
- * @param block if true block until entered or send monitor is closed,
- *              if false enter wait times out eventually
- *
- * @retval -EAGAIN - out of space
- * @retval -EBADFD - monitor closed
- * @retval -EINTR  - was interrupted by another thread
- * @retval -ETIMEDOUT - timedout waiting for its turn
- * @retval 0 - successfully entered
- */
 static inline long
-gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
+_gcs_sm_enter_common (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled,
+                      bool block, void* batch, size_t size)
 {
     long ret = 0; /* if scheduled and no queue */
 
@@ -360,6 +362,8 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
            was true) */
         bool wait = GCS_SM_HAS_TO_WAIT;
         while (wait && ret >= 0) {
+            sm->wait_q[tail].batch = batch;
+            sm->wait_q[tail].size  = size;
             ret = _gcs_sm_enqueue_common (sm, cond, block, tail);
             if (gu_likely((0 == ret))) {
                 ret = sm->ret;
@@ -381,11 +385,12 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
         }
         else {
             if (tail != sm->wait_q_head) {
-                /* was interrupted in the middle,
+                /* was interrupted or claimed in the middle,
                  * will be handled by someone else (with tail == head) */
             }
             else {
-                GCS_SM_ASSERT(-EINTR != ret || sm->pause);
+                GCS_SM_ASSERT((-EINTR != ret && -EALREADY != ret) ||
+                              sm->pause);
                 /* update head, wake up next */
                 _gcs_sm_leave_common(sm);
             }
@@ -402,6 +407,63 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
     return ret;
 }
 
+/*!
+ * Enter send monitor critical section
+ *
+ * @param sm   send monitor object
+ * @param cond condition to signal to wake up thread in case of wait
+ * @param block if true block until entered or send monitor is closed,
+ *              if false enter wait times out eventually
+ *
+ * @retval -EAGAIN - out of space
+ * @retval -EBADFD - monitor closed
+ * @retval -EINTR  - was interrupted by another thread
+ * @retval -ETIMEDOUT - timedout waiting for its turn
+ * @retval 0 - successfully entered
+ */
+static inline long
+gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
+{
+    return _gcs_sm_enter_common (sm, cond, scheduled, block, NULL, 0);
+}
+
+/*!
+ * Enter send monitor critical section offering the action to be batched
+ * by the user that is in the monitor (see gcs_sm_claim()). Always blocks.
+ *
+ * @param batch opaque batching context to be passed to the batch leader
+ * @param size  size of the action to be batched
+ *
+ * @retval -EALREADY - the action was claimed by the batch leader, the user
+ *                     did not enter the monitor and must not leave it
+ * @retval other     - as for gcs_sm_enter()
+ */
+static inline long
+gcs_sm_enter_batch (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled,
+                    void* batch, size_t size)
+{
+    assert (NULL != batch);
+    return _gcs_sm_enter_common (sm, cond, scheduled, true, batch, size);
+}
+
+/*!
+ * Claims users queued right behind the caller for sending their actions
+ * together with the caller's one. Must be called from within the monitor.
+ * Stops at the first user that can't be batched to preserve sending order.
+ * Claimed users leave the queue and return -EALREADY from
+ * gcs_sm_enter_batch().
+ *
+ * @param batch    array to store batching contexts of the claimed users
+ * @param max_len  maximum number of users to claim
+ * @param max_size maximum total size of the claimed actions
+ * @param window   how long to wait for more users if the batch is not full
+ *
+ * @return number of claimed users
+ */
+extern long
+gcs_sm_claim (gcs_sm_t* sm, void* batch[], long max_len, size_t max_size,
+              const gu::datetime::Period& window);
+
 static inline void
 gcs_sm_leave (gcs_sm_t* sm)
 {
@@ -336,7 +336,7 @@ core_test_init (gu::Config* config, bool bootstrap = true,
     ck_assert(config != NULL);
 
     Core = gcs_core_create (reinterpret_cast<gu_config_t*>(config), NULL, name,
-                            "aaa.bbb.ccc.ddd:xxxx", 0, 0);
+                            "aaa.bbb.ccc.ddd:xxxx", GCS_CORE_PROTO_MAX, 0, 0);
 
     ck_assert(NULL != Core);
 
@@ -489,6 +489,47 @@ START_TEST (gcs_core_test_api)
 }
 END_TEST
 
+// several actions sent in a single batch are delivered as separate actions
+START_TEST (gcs_core_test_batch)
+{
+    gu::Config config;
+    core_test_init (&config);
+    ck_assert(NULL != Core);
+    ck_assert(gcs_core_batch_supported (Core));
+
+    gcs_core_send_lock_step (Core, false);
+
+    const struct gu_buf* const acts[] = { act1, act2, act3 };
+    const void*  const bufs[]  = { act1_str, act2_str, act3_str };
+    size_t const sizes[] = { sizeof(act1_str), sizeof(act2_str),
+                             sizeof(act3_str) };
+    int const batch_len(sizeof(acts)/sizeof(acts[0]));
+
+    long ret = gcs_core_send_batch (Core, acts, sizes, batch_len,
+                                    GCS_ACT_TORDERED);
+    ck_assert_msg(ret == long(sizes[0] + sizes[1] + sizes[2]),
+                  "gcs_core_send_batch(): expected %zu, got %ld (%s)",
+                  sizes[0] + sizes[1] + sizes[2], ret, strerror(-ret));
+
+    for (int i(0); i < batch_len; ++i) {
+        action_t act_r(acts[i], NULL, NULL, -1, (gcs_act_type_t)-1, -1,
+                       (gu_thread_t)-1);
+        // checks that seqnos are consecutive and local buffer is preserved
+        ck_assert(!CORE_RECV_ACT (&act_r, bufs[i], sizes[i],
+                                  GCS_ACT_TORDERED));
+        free (act_r.out);
+    }
+
+    ret = gcs_core_send_batch (Core, acts, sizes, GCS_CORE_BATCH_MAX + 1,
+                               GCS_ACT_TORDERED);
+    ck_assert_msg(-EMSGSIZE == ret, "Expected -EMSGSIZE, got %ld (%s)",
+                  ret, strerror(-ret));
+
+    gcs_core_send_lock_step (Core, true);
+    core_test_cleanup ();
+}
+END_TEST
+
 // do a single send step, compare with the expected result
 static inline bool
 CORE_SEND_STEP (gcs_core_t* core, long timeout, long ret)
@@ -747,6 +788,7 @@ START_TEST (gcs_core_test_gh74)
     frg.act_id = 1;
     frg.act_size = act_size;
     frg.act_type = GCS_ACT_STATE_REQ;
+    frg.batch_len = 0;
     char msg_buf[1024];
     ck_assert(!gcs_act_proto_write(&frg, msg_buf, sizeof(msg_buf)));
     memcpy(const_cast<void*>(frg.frag), act_ptr, act_size);
@@ -971,6 +1013,7 @@ Suite *gcs_core_suite(void)
   if (skip == false) {
       tcase_add_test  (tcase, gcs_core_test_api);
       tcase_add_test  (tcase, gcs_core_test_own);
+      tcase_add_test  (tcase, gcs_core_test_batch);
 #ifdef GCS_ALLOW_GH74
       tcase_add_test  (tcase, gcs_core_test_gh74);
 #endif /* GCS_ALLOW_GH74 */
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2026 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark reassembly of large actions arriving concurrently from
+ * several writers with and without offloading fragment copies to defrag pool.
+ *
+ * Usage: gcs_defrag_bench [actions per writer] [action size in MB]
+ */
+
+#define NDEBUG 1
+
+#include "../gcs_defrag.hpp"
+#include "../gcs_recv_msg.hpp"
+
+#include <galerautils.h>
+
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+
+static long const FRAG_LEN = 64500 - 32; // default packet size less headers
+static long const HDR_LEN  = 32;
+
+static double
+run_bench (int const writers, int const threads, int const actions,
+           long const act_len)
+{
+    gcs_defrag_pool_t* const pool(threads ? gcs_defrag_pool_create(threads)
+                                          : NULL);
+    if (threads && !pool) abort();
+
+    std::vector<gcs_defrag_t>   defrag(writers);
+    std::vector<gcs_act_frag_t> frg(writers);
+    std::vector<char>           src(act_len);
+
+    for (long i(0); i < act_len; ++i) src[i] = char(i);
+
+    for (int w(0); w < writers; ++w)
+    {
+        gcs_defrag_init (&defrag[w], NULL);
+        gcs_defrag_set_pool (&defrag[w], pool, w);
+
+        frg[w].act_size  = act_len;
+        frg[w].act_type  = GCS_ACT_TORDERED;
+        frg[w].proto_ver = 0;
+        frg[w].batch_len = 0;
+    }
+
+    gcs_recv_msg_t msg(gu_malloc(HDR_LEN + FRAG_LEN), HDR_LEN + FRAG_LEN,
+                       0, 0, GCS_MSG_ACTION);
+
+    long const frags((act_len + FRAG_LEN - 1) / FRAG_LEN);
+
+    long long const start(gu_time_monotonic());
+
+    for (int a(0); a < actions; ++a)
+    {
+        for (long f(0); f < frags; ++f)
+        {
+            long const offset(f * FRAG_LEN);
+            long const len(std::min(FRAG_LEN, act_len - offset));
+
+            for (int w(0); w < writers; ++w)
+            {
+                /* "receive" the fragment into message buffer */
+                char* const payload(static_cast<char*>(msg.buf) + HDR_LEN);
+                ::memcpy(payload, &src[offset], len);
+
+                frg[w].act_id   = a + 1;
+                frg[w].frag     = payload;
+                frg[w].frag_len = len;
+                frg[w].frag_no  = f;
+                frg[w].msg      = &msg;
+
+                struct gcs_act act;
+                ssize_t const ret(gcs_defrag_handle_frag(&defrag[w], &frg[w],
+                                                         &act, false));
+                if (ret < 0) abort();
+                if (ret > 0) gcs_gcache_free(NULL, act.buf);
+            }
+        }
+    }
+
+    long long const stop(gu_time_monotonic());
+
+    gu_free(msg.buf);
+    if (pool) gcs_defrag_pool_destroy(pool);
+
+    double const duration(double(stop - start) * 1.0e-9);
+    return double(act_len) * actions * writers / duration / (1 << 20);
+}
+
+int main(int argc, char* argv[])
+{
+    int  const actions(argc > 1 ? ::atoi(argv[1]) : 64);
+    long const act_len((argc > 2 ? ::atol(argv[2]) : 4) << 20);
+
+    std::cout << "writers\tthreads\tMB/s\n";
+
+    for (int writers(4); writers <= 8; writers *= 2)
+    {
+        for (int threads(0); threads <= writers; threads = threads ? threads*2:1)
+        {
+            std::cout << writers << '\t' << threads << '\t'
+                      << run_bench(writers, threads, actions, act_len) << '\n';
+        }
+    }
+
+    return 0;
+}
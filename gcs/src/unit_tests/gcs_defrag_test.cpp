@@ -11,6 +11,7 @@
 
 #include "gcs_defrag_test.hpp"
 #include "../gcs_defrag.hpp"
+#include "../gcs_recv_msg.hpp"
 
 #define TRUE (0 == 0)
 #define FALSE (!TRUE)
@@ -67,6 +68,7 @@ START_TEST (gcs_defrag_test)
     frg1.frag_no   = 0;
     frg1.act_type  = GCS_ACT_TORDERED;
     frg1.proto_ver = 0;
+    frg1.batch_len = 0;
 
     // normal fragments
     frg2 = frg3 = frg1;
@@ -167,6 +169,80 @@ START_TEST (gcs_defrag_test)
 }
 END_TEST
 
+/* interleaves multi-fragment actions from several sources with payload
+ * copies offloaded to defrag pool */
+START_TEST (gcs_defrag_pool_test)
+{
+    static int  const SOURCES   = 3;
+    static int  const FRAGS     = 20;
+    static long const FRAG_LEN  = 4 * GCS_DEFRAG_POOL_MIN_FRAG;
+    static long const HDR_LEN   = 32; // to simulate protocol header
+    static long const ACT_LEN   = FRAGS * FRAG_LEN;
+
+    gcs_defrag_pool_t* const pool = gcs_defrag_pool_create (2);
+    ck_assert(NULL != pool);
+
+    gcs_defrag_t   defrag[SOURCES];
+    gcs_act_frag_t frg[SOURCES];
+    char*          act_buf[SOURCES];
+
+    for (int i = 0; i < SOURCES; i++) {
+        gcs_defrag_init (&defrag[i], NULL);
+        gcs_defrag_set_pool (&defrag[i], pool, i);
+
+        act_buf[i] = static_cast<char*>(malloc (ACT_LEN));
+        ck_assert(NULL != act_buf[i]);
+        for (long j = 0; j < ACT_LEN; j++) act_buf[i][j] = (i*7 + j) % 251;
+
+        frg[i].act_id    = i + 1;
+        frg[i].act_size  = ACT_LEN;
+        frg[i].frag_len  = FRAG_LEN;
+        frg[i].act_type  = GCS_ACT_TORDERED;
+        frg[i].proto_ver = 0;
+        frg[i].batch_len = 0;
+    }
+
+    gcs_recv_msg_t msg(gu_malloc(HDR_LEN + FRAG_LEN), HDR_LEN + FRAG_LEN,
+                       HDR_LEN + FRAG_LEN, 0, GCS_MSG_ACTION);
+    ck_assert(NULL != msg.buf);
+
+    for (int f = 0; f < FRAGS; f++) {
+        for (int i = 0; i < SOURCES; i++) {
+            /* "receive" next fragment into message buffer */
+            char* const payload = static_cast<char*>(msg.buf) + HDR_LEN;
+            memcpy (payload, act_buf[i] + f * FRAG_LEN, FRAG_LEN);
+
+            frg[i].frag    = payload;
+            frg[i].frag_no = f;
+            frg[i].msg     = &msg;
+
+            struct gcs_act act;
+            ssize_t const ret(gcs_defrag_handle_frag (&defrag[i], &frg[i],
+                                                      &act, FALSE));
+            if (f < FRAGS - 1) {
+                ck_assert_msg(0 == ret, "ret = %zd", ret);
+                /* worker queues are empty, first copy must be offloaded */
+                if (0 == f) ck_assert(defrag[i].ticket > 0);
+                continue;
+            }
+
+            ck_assert_msg(ACT_LEN == ret, "ret = %zd", ret);
+            ck_assert(act.buf_len == ACT_LEN);
+            ck_assert(!memcmp (act.buf, act_buf[i], ACT_LEN));
+            defrag_check_init (&defrag[i]);
+            ck_assert(0 == defrag[i].ticket);
+
+            gcs_gcache_free (defrag[i].cache, act.buf);
+        }
+    }
+
+    gu_free (msg.buf);
+    gcs_defrag_pool_destroy (pool);
+
+    for (int i = 0; i < SOURCES; i++) free (act_buf[i]);
+}
+END_TEST
+
 Suite *gcs_defrag_suite(void)
 {
   Suite *suite = suite_create("GCS defragmenter");
@@ -174,6 +250,7 @@ Suite *gcs_defrag_suite(void)
 
   suite_add_tcase (suite, tcase);
   tcase_add_test  (tcase, gcs_defrag_test);
+  tcase_add_test  (tcase, gcs_defrag_pool_test);
   return suite;
 }
 
@@ -2,6 +2,8 @@
 
 // $Id$
 
+#include "../gcs_fc_stats.hpp"
+
 #include "gcs_fc_test.hpp"
 #include "../gcs_fc.hpp"
 
@@ -121,6 +123,54 @@ START_TEST(gcs_fc_test_precise)
 }
 END_TEST
 
+START_TEST(gcs_fc_test_stats)
+{
+    gcs_fc_stats_t stats;
+
+    std::vector<std::string> ids;
+    std::vector<std::string> names;
+    ids.push_back("node0-id"); names.push_back("node0");
+    ids.push_back("node1-id"); names.push_back("node1");
+
+    gcs_fc_stats_conf (&stats, ids, names);
+
+    gcs_fc_stats_event (&stats, 1, true,  100);
+    gcs_fc_stats_event (&stats, 1, false, 10);
+    gcs_fc_stats_event (&stats, 1, true,  200);
+    gcs_fc_stats_event (&stats, 5, true,  200); // out of range, ignored
+
+    const gcs_fc_source& src(stats.sources.find("node1-id")->second);
+    ck_assert(src.stops      == 2);
+    ck_assert(src.conts      == 1);
+    ck_assert(src.stop_depth == 1);
+    ck_assert(src.last_queue == 200);
+    ck_assert(src.max_queue  == 200);
+    ck_assert(stats.sources.find("node0-id")->second.stops == 0);
+    ck_assert(stats.ring_used == 3);
+
+    /* configuration change closes outstanding pause */
+    ids.pop_back(); names.pop_back();
+    gcs_fc_stats_conf (&stats, ids, names);
+    ck_assert(src.stop_depth == 0);
+    ck_assert(src.member == false);
+
+    gu::Status status;
+    gcs_fc_stats_get_status (&stats, status);
+    ck_assert(status.size() == 3);
+
+    /* ring must be bounded */
+    for (int i(0); i < 2*GCS_FC_STATS_RING_LEN; ++i)
+    {
+        gcs_fc_stats_event (&stats, 0, i % 2 == 0, i);
+    }
+    ck_assert(stats.ring_used == GCS_FC_STATS_RING_LEN);
+
+    gcs_fc_stats_flush (&stats);
+    ck_assert(stats.sources.find("node0-id")->second.stops == 0);
+    ck_assert(stats.ring_used == GCS_FC_STATS_RING_LEN);
+}
+END_TEST
+
 Suite *gcs_fc_suite(void)
 {
     Suite *s  = suite_create("GCS state transfer FC");
@@ -130,6 +180,7 @@ Suite *gcs_fc_suite(void)
     tcase_add_test  (tc, gcs_fc_test_limits);
     tcase_add_test  (tc, gcs_fc_test_basic);
     tcase_add_test  (tc, gcs_fc_test_precise);
+    tcase_add_test  (tc, gcs_fc_test_stats);
 
     return s;
 }
@@ -116,6 +116,7 @@ START_TEST (gcs_group_configuration)
     frg1.frag_no   = 0;
     frg1.act_type  = GCS_ACT_TORDERED;
     frg1.proto_ver = 0;
+    frg1.batch_len = 0;
 
     // normal fragments
     frg2 = frg3 = frg1;
@@ -498,6 +499,68 @@ START_TEST(gcs_group_last_applied)
 }
 END_TEST
 
+// Checks that incrementally maintained last applied matches the minimum
+// over all nodes with many nodes reporting in random order
+START_TEST(gcs_group_last_applied_many)
+{
+    static long const nodes_num = 9;
+
+    gt_group gt(nodes_num, true);
+    gcs_group_t& group(gt.nodes[0]->group);
+
+    uint8_t        buf[sizeof(gcs_seqno_t)];
+    gcs_recv_msg_t msg;
+    msg.type    = GCS_MSG_LAST;
+    msg.buf_len = sizeof(gcs_seqno_t);
+    msg.size    = sizeof(gcs_seqno_t);
+    msg.buf     = buf;
+
+    gcs_seqno_t seqnos[nodes_num] = { 0, };
+    gcs_seqno_t expected(group.last_applied);
+    long        expected_node(group.last_node);
+    unsigned int seed(1);
+
+    ck_assert(0 == expected);
+
+    for (int i(0); i < 10000; ++i)
+    {
+        long const n(rand_r(&seed) % nodes_num);
+        seqnos[n] += rand_r(&seed) % 3; // sometimes report the same value
+
+        msg.sender_idx = n;
+        group_set_last_msg (&msg, seqnos[n]);
+        gcs_seqno_t const ret(gcs_group_handle_last_msg (&group, &msg));
+
+        if (n == expected_node && seqnos[n] > expected)
+        {
+            gcs_seqno_t const old(expected);
+
+            expected_node = 0;
+            for (long j(1); j < nodes_num; ++j)
+            {
+                if (seqnos[j] < seqnos[expected_node]) expected_node = j;
+            }
+            expected = seqnos[expected_node];
+
+            ck_assert_msg(ret == (expected > old ? expected : 0),
+                          "Iteration %d: expected %" PRId64 ", got %" PRId64,
+                          i, expected > old ? expected : 0, ret);
+        }
+        else
+        {
+            ck_assert(0 == ret);
+        }
+
+        ck_assert_msg(group.last_applied == expected,
+                      "Iteration %d: expected last_applied %" PRId64
+                      ", got %" PRId64, i, expected, group.last_applied);
+        ck_assert_msg(group.last_node == expected_node,
+                      "Iteration %d: expected last_node %ld, got %ld",
+                      i, expected_node, group.last_node);
+    }
+}
+END_TEST
+
 START_TEST(test_gcs_group_find_donor)
 {
     gcs_group_t group;
@@ -611,6 +674,7 @@ Suite *gcs_group_suite(void)
 
     tcase_add_test  (tcase, gcs_group_configuration);
     tcase_add_test  (tcase, gcs_group_last_applied);
+    tcase_add_test  (tcase, gcs_group_last_applied_many);
     tcase_add_test  (tcase, test_gcs_group_find_donor);
 
     return suite;
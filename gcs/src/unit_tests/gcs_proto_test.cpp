@@ -19,6 +19,7 @@ frgcmp (gcs_act_frag_t* f1, gcs_act_frag_t* f2)
         (f1->act_id   == f2->act_id)   &&
         (f1->act_size == f2->act_size) &&
         (f1->act_type == f2->act_type) &&
+        (f1->batch_len == f2->batch_len) &&
         (f1->frag_len == f2->frag_len) && // expect to point
         (f1->frag     == f2->frag)        // at the same buffer here
        ) return 0;
@@ -44,6 +45,7 @@ START_TEST (gcs_proto_test)
     frg_send.frag_no   = 0;
     frg_send.act_type  = (gcs_act_type_t)0;
     frg_send.proto_ver = 0;
+    frg_send.batch_len = 0;
 
     // set up action header
     ret = gcs_act_proto_write (&frg_send, buf, buf_len);
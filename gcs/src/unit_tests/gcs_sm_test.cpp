@@ -530,6 +530,90 @@ START_TEST (gcs_sm_test_interrupt)
 END_TEST
 
 
+struct claim_ctx
+{
+    gcs_sm_t*     sm;
+    volatile long ret;
+};
+
+static void* claim_thread(void* arg)
+{
+    claim_ctx* const ctx = (claim_ctx*) arg;
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    if (0 == (ctx->ret = gcs_sm_enter_batch (ctx->sm, &cond, false, ctx, 1))) {
+        gcs_sm_leave (ctx->sm);
+    }
+
+    gu_cond_destroy (&cond);
+
+    return NULL;
+}
+
+START_TEST (gcs_sm_test_claim)
+{
+    int ret;
+
+    gcs_sm_t* sm = gcs_sm_create(4, 1);
+    ck_assert(sm != NULL);
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    ret = gcs_sm_enter(sm, &cond, false, true);
+    ck_assert_msg(0 == ret, "gcs_sm_enter() failed: %d (%s)",
+                  ret, strerror(-ret));
+
+    gu_thread_t t1, t2, t3;
+
+    claim_ctx ctx1 = { sm, 1 };
+    claim_ctx ctx2 = { sm, 1 };
+
+    gu_thread_create (&t1, NULL, claim_thread, &ctx1);
+    WAIT_FOR(2 == sm->users);
+    ck_assert_msg(2 == sm->users, "users = %ld, expected 2", sm->users);
+    gu_thread_create (&t2, NULL, claim_thread, &ctx2);
+    WAIT_FOR(3 == sm->users);
+    ck_assert_msg(3 == sm->users, "users = %ld, expected 3", sm->users);
+    // the user without batch context stops claiming
+    simple_ret = 1;
+    gu_thread_create (&t3, NULL, simple_thread, sm);
+    WAIT_FOR(4 == sm->users);
+    ck_assert_msg(4 == sm->users, "users = %ld, expected 4", sm->users);
+
+    void* batch[4];
+    long len = gcs_sm_claim (sm, batch, 1, 1000, gu::datetime::Period(0));
+    ck_assert_msg(1 == len, "claimed %ld, expected 1", len);
+    ck_assert(batch[0] == &ctx1);
+
+    len = gcs_sm_claim (sm, batch, 4, 1000, gu::datetime::Period(0));
+    ck_assert_msg(1 == len, "claimed %ld, expected 1", len);
+    ck_assert(batch[0] == &ctx2);
+
+    gu_thread_join (t1, NULL);
+    gu_thread_join (t2, NULL);
+    ck_assert_msg(-EALREADY == ctx1.ret, "ctx1.ret = %ld (%s)",
+                  ctx1.ret, strerror(-ctx1.ret));
+    ck_assert_msg(-EALREADY == ctx2.ret, "ctx2.ret = %ld (%s)",
+                  ctx2.ret, strerror(-ctx2.ret));
+
+    gcs_sm_leave(sm);
+
+    gu_thread_join (t3, NULL);
+    ck_assert_msg(0 == simple_ret, "simple_ret = %ld (%s)",
+                  simple_ret, strerror(-simple_ret));
+    ck_assert_msg(0 == sm->users, "users = %ld, expected 0", sm->users);
+
+    ret = gcs_sm_close(sm);
+    ck_assert(0 == ret);
+
+    gcs_sm_destroy(sm);
+    gu_cond_destroy(&cond);
+}
+END_TEST
+
 Suite *gcs_send_monitor_suite(void)
 {
   Suite *s  = suite_create("GCS send monitor");
@@ -541,6 +625,7 @@ Suite *gcs_send_monitor_suite(void)
   tcase_add_test  (tc, gcs_sm_test_close);
   tcase_add_test  (tc, gcs_sm_test_pause);
   tcase_add_test  (tc, gcs_sm_test_interrupt);
+  tcase_add_test  (tc, gcs_sm_test_claim);
   return s;
 }
 